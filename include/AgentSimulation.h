@@ -0,0 +1,92 @@
+#pragma once
+#include "JobSystem.h"
+#include "SpatialHash.h"
+#include "Terrain.h"
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Physics constants shared by every agent; defaults match CharacterController
+struct AgentSettings {
+    float gravity = -20.0f;
+    float terminalVelocity = -20.0f;
+    float radius = 0.3f;
+    float height = 1.8f;
+    float moveSpeed = 3.0f;
+    float jumpForce = 8.0f;
+};
+
+enum AgentFlags : uint8_t {
+    AGENT_ON_GROUND = 1 << 0,
+    AGENT_BLOCKED   = 1 << 1   // hit a wall during the last tick
+};
+
+// Many NPC bodies walking on the voxel terrain, stored as structure of arrays.
+// Each tick steers, integrates (SSE, four agents at a time) and resolves voxel
+// collisions per axis, in parallel batches on the JobSystem. Agents then push
+// each other apart, with pairs found through a SpatialHash.
+class AgentSimulation {
+public:
+    AgentSimulation(const Terrain& terrain, JobSystem& jobs);
+
+    // Returns the new agent's index
+    int addAgent(const glm::vec3& position, uint32_t seed);
+    // Drop agents at random columns, standing on the terrain surface
+    void spawnRandom(int count, uint32_t seed);
+    void clear();
+
+    // Moves every agent, then pushes overlapping agents apart
+    void update(float deltaTime);
+    // Shove agents out of another body's cylinder, e.g. the player's
+    void pushAway(const glm::vec3& feet, float radius, float height);
+
+    void setSettings(const AgentSettings& s) { settings = s; }
+    const AgentSettings& getSettings() const { return settings; }
+    // Agents per job; a batch as large as the population runs on the calling thread
+    void setBatchSize(int size) { batchSize = size; }
+
+    int getAgentCount() const { return static_cast<int>(positionX.size()); }
+    glm::vec3 getPosition(int agent) const;
+    glm::vec3 getVelocity(int agent) const;
+    uint8_t getFlags(int agent) const { return flags[agent]; }
+
+    // Raw arrays for batched consumers (broadphase, rendering)
+    const float* getPositionsX() const { return positionX.data(); }
+    const float* getPositionsY() const { return positionY.data(); }
+    const float* getPositionsZ() const { return positionZ.data(); }
+
+    // Broadphase as of the last update, for radius and box queries
+    const SpatialHash& getBroadphase() const { return broadphase; }
+    // Agent pairs found touching during the last update
+    int getContactCount() const { return contactCount; }
+
+private:
+    const Terrain& terrain;
+    JobSystem& jobs;
+    AgentSettings settings;
+    int batchSize;
+
+    std::vector<float> positionX, positionY, positionZ;
+    std::vector<float> velocityX, velocityY, velocityZ;
+    std::vector<float> headingX, headingZ;   // desired walking direction
+    std::vector<uint32_t> randomState;       // per-agent xorshift state
+    std::vector<uint16_t> wanderTimer;       // ticks until the next heading change
+    std::vector<uint8_t> flags;
+
+    SpatialHash broadphase;
+    std::vector<BodyPair> pairs;
+    std::vector<int> queryResults;
+    int contactCount;
+
+    void steer(int begin, int end);
+    void integrate(int begin, int end, float deltaTime);
+    void collide(int begin, int end, float deltaTime);
+    void separate();
+    // Slide agent sideways by (dx, dz) unless that would put it inside a block
+    void nudge(int agent, float dx, float dz);
+
+    // Same voxel data the player collides with; the world edge and floor are solid
+    bool isSolid(int x, int y, int z) const;
+    bool overlapsSolid(float x, float y, float z) const;
+    uint32_t nextRandom(int agent);
+};
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// Subsystems allocations are attributed to with AllocationScope
+enum AllocationSubsystem : uint8_t {
+    ALLOC_OTHER,
+    ALLOC_TERRAIN,
+    ALLOC_AGENTS,
+    ALLOC_LIGHTING,
+    ALLOC_SHADOWS,
+    ALLOC_RENDER,
+    ALLOC_JOBS,
+    ALLOC_SUBSYSTEM_COUNT
+};
+
+struct AllocationCounts {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+};
+
+// Counts every global operator new, per subsystem and per frame. The counting
+// replacements of operator new and delete are defined in AllocationTracker.cpp,
+// so anything linking the core sources is tracked. Allocations made directly
+// with malloc (e.g. inside GL drivers) are not seen.
+class AllocationTracker {
+public:
+    // Start a new frame; the frame counts below are relative to this call
+    static void beginFrame();
+    static AllocationCounts getFrameCounts(AllocationSubsystem subsystem);
+    static AllocationCounts getFrameTotal();
+    // Since program start, all subsystems
+    static AllocationCounts getTotal();
+
+    static const char* getSubsystemName(AllocationSubsystem subsystem);
+    // One line per subsystem that allocated during the current frame
+    static void reportFrame(std::ostream& out);
+
+    // Subsystem this thread's allocations are currently charged to
+    static AllocationSubsystem getCurrentSubsystem();
+    static void setCurrentSubsystem(AllocationSubsystem subsystem);
+};
+
+// Charges this thread's allocations to a subsystem until the scope ends
+class AllocationScope {
+public:
+    explicit AllocationScope(AllocationSubsystem subsystem) : previous(AllocationTracker::getCurrentSubsystem()) {
+        AllocationTracker::setCurrentSubsystem(subsystem);
+    }
+    ~AllocationScope() { AllocationTracker::setCurrentSubsystem(previous); }
+    AllocationScope(const AllocationScope&) = delete;
+    AllocationScope& operator=(const AllocationScope&) = delete;
+
+private:
+    AllocationSubsystem previous;
+};
@@ -0,0 +1,64 @@
+#pragma once
+#include "Chunk.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// World parameters stored in the header of a baked chunk file
+struct BakeHeader {
+    uint32_t seed = 0;
+    int32_t minX = 0, minZ = 0;   // baked block range [min, max) in noise coordinates
+    int32_t maxX = 0, maxZ = 0;
+    uint16_t worldHeight = 0;
+};
+
+// Streams baked chunk meshes to disk as they are produced, so only the
+// chunks currently being written are held in memory. Any combination of
+// outputs can be enabled by passing a non-empty path to open():
+// - chunk file: packed ChunkVertex meshes, the format a server or client loads
+// - OBJ: triangles in world space, for inspection in any model viewer
+// - glTF: a .gltf document plus a .bin buffer, one node per chunk. The buffer
+//   is the document's path with its extension replaced by .bin.
+// open() fails if two outputs, including the glTF buffer, share a path.
+class BakedWorldWriter {
+public:
+    BakedWorldWriter();
+    ~BakedWorldWriter();
+    BakedWorldWriter(const BakedWorldWriter&) = delete;
+    BakedWorldWriter& operator=(const BakedWorldWriter&) = delete;
+
+    bool open(const std::string& chunkPath, const std::string& objPath, const std::string& gltfPath,
+              const BakeHeader& header);
+    // origin is the chunk's minimum corner in world blocks
+    bool writeChunk(int originX, int originY, int originZ, const ChunkMeshData& mesh);
+    // Patches the chunk count and writes the glTF document
+    bool close();
+
+    int getChunksWritten() const { return chunksWritten; }
+    uint64_t getBytesWritten() const { return bytesWritten; }
+
+private:
+    // Per-chunk glTF data; everything else is already on disk
+    struct GltfChunk {
+        int originX, originY, originZ;
+        uint64_t byteOffset;
+        uint32_t vertexCount, indexCount;
+        float minPosition[3], maxPosition[3];
+    };
+
+    std::ofstream chunkFile, objFile, gltfBin;
+    std::string gltfPath, gltfBinName;
+    std::vector<GltfChunk> gltfChunks;
+    std::vector<uint8_t> buffer;   // reused per chunk
+    uint64_t objVertexCount;
+    uint64_t gltfBinSize;
+    int chunksWritten;
+    uint64_t bytesWritten;
+    bool failed;
+
+    void writeChunkRecord(int originX, int originY, int originZ, const ChunkMeshData& mesh);
+    void writeObj(int originX, int originY, int originZ, const ChunkMeshData& mesh);
+    void writeGltfBuffers(int originX, int originY, int originZ, const ChunkMeshData& mesh);
+    bool writeGltfDocument();
+};
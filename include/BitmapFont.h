@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Built-in 5x7 pixel font for printable ASCII, laid out as an atlas of 8x8
+// cells, 16 per row. The cell of code 127 is solid, so untextured shapes can
+// be drawn from the same texture as text.
+const int FONT_FIRST_CHAR = 32;
+const int FONT_LAST_CHAR = 127;
+const int FONT_GLYPH_WIDTH = 5;
+const int FONT_GLYPH_HEIGHT = 7;
+const int FONT_CELL_SIZE = 8;
+const int FONT_ATLAS_COLUMNS = 16;
+const int FONT_ATLAS_WIDTH = FONT_ATLAS_COLUMNS * FONT_CELL_SIZE;
+const int FONT_ATLAS_HEIGHT = (FONT_LAST_CHAR - FONT_FIRST_CHAR + FONT_ATLAS_COLUMNS) / FONT_ATLAS_COLUMNS * FONT_CELL_SIZE;
+// Horizontal advance and line height in font pixels
+const int FONT_ADVANCE = FONT_GLYPH_WIDTH + 1;
+const int FONT_LINE_HEIGHT = FONT_GLYPH_HEIGHT + 2;
+const char FONT_SOLID_CHAR = 127;
+
+// One byte per texel, 255 where the glyph is set; rows top to bottom
+std::vector<uint8_t> generateFontAtlas();
+
+// Top-left texel of a character's cell; characters outside the font map to '?'
+void getFontCell(char c, int& x, int& y);
+
+// Size of text in font pixels; '\n' starts a new line
+void measureText(const char* text, int& width, int& height);
@@ -0,0 +1,44 @@
+#pragma once
+#include "Chunk.h"
+#include <cstdint>
+#include <vector>
+
+// Layers of the block texture array. Chunk vertices store the layer of their
+// face, so grass can have a different top, side and bottom.
+enum MaterialLayer : uint8_t {
+    MATERIAL_SAND,
+    MATERIAL_GRASS_TOP,
+    MATERIAL_GRASS_SIDE,
+    MATERIAL_DIRT,
+    MATERIAL_DARK_GRASS_TOP,
+    MATERIAL_DARK_GRASS_SIDE,
+    MATERIAL_STONE,
+    MATERIAL_SNOW,
+    MATERIAL_LAMP,
+    MATERIAL_LAYER_COUNT
+};
+
+// Width and height of every layer in texels
+const int MATERIAL_TEXTURE_SIZE = 32;
+
+// Layer of one face of a block. Faces are in ChunkVertex normal order:
+// +Z, -Z, -X, +X, +Y, -Y.
+inline uint8_t getBlockMaterial(uint8_t blockType, int face) {
+    // top, side, bottom
+    static const uint8_t materials[BLOCK_TYPE_COUNT][3] = {
+        {MATERIAL_DIRT, MATERIAL_DIRT, MATERIAL_DIRT},                                  // air, never meshed
+        {MATERIAL_SAND, MATERIAL_SAND, MATERIAL_SAND},
+        {MATERIAL_GRASS_TOP, MATERIAL_GRASS_SIDE, MATERIAL_DIRT},
+        {MATERIAL_DARK_GRASS_TOP, MATERIAL_DARK_GRASS_SIDE, MATERIAL_DIRT},
+        {MATERIAL_STONE, MATERIAL_STONE, MATERIAL_STONE},
+        {MATERIAL_SNOW, MATERIAL_SNOW, MATERIAL_SNOW},
+        {MATERIAL_LAMP, MATERIAL_LAMP, MATERIAL_LAMP},
+    };
+    int slot = face == 4 ? 0 : (face == 5 ? 2 : 1);
+    return materials[blockType < BLOCK_TYPE_COUNT ? blockType : 0][slot];
+}
+
+// Procedural RGBA8 texels for every layer, one MATERIAL_TEXTURE_SIZE square
+// after another with rows running bottom to top. The same pixels come out on
+// every run, so no texture assets are needed.
+std::vector<uint8_t> generateMaterialPixels();
@@ -36,4 +36,6 @@ public:
     float movementSpeed;
     float mouseSensitivity;
     float zoom;
+    float nearPlane;
+    float farPlane;
 }; 
\ No newline at end of file
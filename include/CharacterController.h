@@ -1,7 +1,7 @@
 #pragma once
 #include "Camera.h"
+#include "InputState.h"
 #include "Terrain.h"
-#include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 
 class CharacterController {
@@ -9,10 +9,12 @@ public:
     CharacterController(Camera& camera, Terrain& terrain);
     
     void update(float deltaTime);
-    void processInput(GLFWwindow* window);
+    // Look and movement from one tick of input
+    void applyInput(const InputState& input);
     void processMouseMovement(float xoffset, float yoffset);
     void setPosition(const glm::vec3& position);
     glm::vec3 getPosition() const;
+    glm::vec3 getVelocity() const { return velocity; }
     void setSpeed(float speed);
     float getSpeed() const;
     
@@ -24,8 +26,16 @@ public:
     // Physics
     void setGravity(float gravity);
     void setJumpForce(float jumpForce);
+    float getGravity() const { return gravity; }
+    float getJumpForce() const { return jumpForce; }
     void setGroundLevel(float groundLevel);
 
+    // Collision cylinder standing on getPosition()
+    float getRadius() const { return playerRadius; }
+    float getHeight() const { return playerHeight; }
+    // Block probes made by collision tests since the controller was created
+    uint64_t getCollisionChecks() const { return collisionChecks; }
+
 private:
     Camera& camera;
     Terrain& terrain;
@@ -50,6 +60,8 @@ private:
     
     // Input
     bool keys[4]; // W, A, S, D
+    bool jumpHeld; // jump only on the tick the button goes down
+    mutable uint64_t collisionChecks;
     
     void updatePhysics(float deltaTime);
     void updateCamera();
@@ -0,0 +1,69 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+const int CHUNK_SIZE = 16;
+
+enum BlockType : uint8_t {
+    BLOCK_AIR = 0,
+    BLOCK_SAND,
+    BLOCK_GRASS,
+    BLOCK_DARK_GRASS,
+    BLOCK_STONE,
+    BLOCK_SNOW,
+    BLOCK_LAMP,
+    BLOCK_TYPE_COUNT
+};
+
+inline bool isBlockOpaque(uint8_t type) {
+    return type != BLOCK_AIR;
+}
+
+// Block light level emitted by a block (0 = not a light source)
+inline int getBlockEmission(uint8_t type) {
+    return type == BLOCK_LAMP ? 14 : 0;
+}
+
+// Packed chunk vertex, decoded by the PACKED_VERTEX shader variant
+// data0: x(5) y(5) z(5) normal(3) ao(2), position relative to the chunk origin
+// data1: material layer(8) sun light(4) block light(4), layers from BlockMaterials.h
+struct ChunkVertex {
+    uint32_t data0;
+    uint32_t data1;
+};
+
+inline ChunkVertex packChunkVertex(int x, int y, int z, int normal, int ao,
+                                   uint8_t material, int sunLight, int blockLight) {
+    ChunkVertex v;
+    v.data0 = static_cast<uint32_t>(x & 31) |
+              (static_cast<uint32_t>(y & 31) << 5) |
+              (static_cast<uint32_t>(z & 31) << 10) |
+              (static_cast<uint32_t>(normal & 7) << 15) |
+              (static_cast<uint32_t>(ao & 3) << 18);
+    v.data1 = static_cast<uint32_t>(material) |
+              (static_cast<uint32_t>(sunLight & 15) << 8) |
+              (static_cast<uint32_t>(blockLight & 15) << 12);
+    return v;
+}
+
+// CPU-side mesh of one chunk, uploaded by TerrainRenderer
+struct ChunkMeshData {
+    std::vector<ChunkVertex> vertices;
+    std::vector<unsigned int> indices;
+};
+
+// Chunk::connectivity has bit (a * 6 + b) set when faces a and b (ChunkMesher
+// order) are joined by a path of empty cells inside the chunk
+const uint64_t CHUNK_ALL_FACES_CONNECTED = (uint64_t(1) << 36) - 1;
+
+inline bool areChunkFacesConnected(uint64_t connectivity, int a, int b) {
+    return (connectivity >> (a * 6 + b)) & 1;
+}
+
+struct Chunk {
+    int x, y, z;            // chunk coordinates (grid position / CHUNK_SIZE)
+    ChunkMeshData mesh;
+    bool dirty;             // blocks or light changed since the mesh was built
+    unsigned int revision;  // bumped every time the mesh is rebuilt
+    uint64_t connectivity;  // face pairs that can see each other, updated with the mesh
+};
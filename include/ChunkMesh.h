@@ -0,0 +1,20 @@
+#pragma once
+#include "Chunk.h"
+#include <GL/glew.h>
+
+// GPU copy of one chunk's packed mesh
+class ChunkMesh {
+public:
+    ChunkMesh();
+    ~ChunkMesh();
+    ChunkMesh(const ChunkMesh&) = delete;
+    ChunkMesh& operator=(const ChunkMesh&) = delete;
+
+    void upload(const ChunkMeshData& data);
+    void draw();
+    unsigned int getIndexCount() const { return indexCount; }
+
+private:
+    unsigned int VAO, VBO, EBO;
+    unsigned int indexCount;
+};
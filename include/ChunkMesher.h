@@ -0,0 +1,18 @@
+#pragma once
+#include "Chunk.h"
+
+class Terrain;
+
+// Builds packed chunk meshes with per-vertex light and ambient occlusion baked in
+class ChunkMesher {
+public:
+    // Emit the visible faces of every solid block in the chunk
+    static void buildMesh(const Terrain& terrain, const Chunk& chunk, ChunkMeshData& mesh);
+    // Flood-fill the chunk's empty cells and record which faces each region touches
+    static uint64_t computeConnectivity(const Terrain& terrain, const Chunk& chunk);
+
+    // Face indices match Cube: 0=Front(+Z), 1=Back(-Z), 2=Left(-X), 3=Right(+X), 4=Top(+Y), 5=Bottom(-Y)
+    static const int faceNormals[6][3];
+    // Unit-cube corners of each face, counter-clockwise seen from outside
+    static const int faceCorners[6][4][3];
+};
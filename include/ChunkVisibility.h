@@ -0,0 +1,91 @@
+#pragma once
+#include "Terrain.h"
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+enum CullingMode {
+    CULLING_NONE,          // every chunk
+    CULLING_FRUSTUM,       // chunks whose box touches the view frustum
+    CULLING_CONNECTIVITY   // frustum, plus only chunks reachable through empty cells
+};
+
+// Planes of a view-projection matrix, normals pointing inwards
+struct Frustum {
+    glm::vec4 planes[6];
+};
+
+Frustum extractFrustum(const glm::mat4& viewProjection);
+bool isBoxInFrustum(const Frustum& frustum, const glm::vec3& boxMin, const glm::vec3& boxMax);
+
+// Finds the chunks the camera can see. With CULLING_CONNECTIVITY it walks
+// outwards from the camera's chunk, leaving each chunk only through a face
+// that its connectivity joins to the face it was entered by, never turning
+// back against a direction already taken, and only into chunks in the
+// frustum. Caves sealed off from the camera are never reached.
+//
+// Results carry over between frames. Each chunk's frustum test also records
+// how far it is from changing result, measured against the camera of the
+// last full pass. While the camera stays close enough to that pass that no
+// plane can have moved by more than the coherence margin, only chunks within
+// the margin are tested again, and the walk reruns only if a result, the
+// camera's chunk or the terrain changed. The visible set is always the same
+// as a full pass would give.
+class ChunkVisibility {
+public:
+    // Margin in blocks; larger allows more camera motion between full passes
+    // but retests more chunks. Negative makes every update a full pass.
+    explicit ChunkVisibility(const Terrain& terrain, float coherenceMargin = 8.0f);
+
+    void update(const glm::vec3& eye, const glm::mat4& view, const glm::mat4& projection, CullingMode mode);
+
+    // Indices into Terrain::getChunks(); nearest first with CULLING_CONNECTIVITY, ascending otherwise
+    const std::vector<int>& getVisibleChunks() const { return visibleChunks; }
+    int getVisibleCount() const { return static_cast<int>(visibleChunks.size()); }
+    // Chunks whose frustum test ran in the last update
+    int getTestedCount() const { return testedChunks; }
+    bool wasFullUpdate() const { return fullUpdate; }
+    // Updates since construction, and how many of them were full passes
+    int getUpdateCount() const { return updateCount; }
+    int getFullUpdateCount() const { return fullUpdateCount; }
+
+private:
+    const Terrain& terrain;
+    float coherenceMargin;
+    std::vector<int> visibleChunks;
+    int testedChunks;
+    bool fullUpdate;
+    int updateCount, fullUpdateCount;
+
+    // Camera of the last full pass
+    bool hasReference;
+    CullingMode referenceMode;
+    glm::vec3 referenceEye;
+    glm::mat4 referenceView, referenceProjection;
+    Frustum referenceFrustum;
+    float frustumRadius;  // distance from the eye to the furthest frustum corner
+
+    // Per chunk: lowest corner, frustum result (0 = not tested since the last full pass, 1 = in, 2 = out),
+    // and faces the walk entered it through
+    std::vector<glm::vec3> chunkMins;
+    std::vector<uint8_t> frustumState;
+    std::vector<uint8_t> enteredFaces;
+    // Chunks whose result may change before the next full pass
+    std::vector<int> boundaryChunks;
+    int walkStart;
+    unsigned long long walkRevision;
+    struct Step {
+        int chunk;
+        uint8_t entryFace;
+        uint8_t directions;  // faces stepped out of so far, as a mask
+    };
+    std::vector<Step> queue;
+
+    bool resize();
+    bool isNearReference(const glm::vec3& eye, const glm::mat4& view) const;
+    bool isChunkInFrustum(int index, const glm::vec3& eye, const Frustum& frustum);
+    bool retestBoundary(const glm::vec3& eye, const Frustum& frustum);
+    bool testChunk(int index, const glm::vec3& eye, const Frustum& frustum, float* margin);
+    int findStartChunk(const glm::vec3& eye) const;
+    void walk(int startIndex, const glm::vec3& eye, const Frustum& frustum);
+};
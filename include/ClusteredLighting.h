@@ -0,0 +1,74 @@
+#pragma once
+#include "Camera.h"
+#include "JobSystem.h"
+#include "Shader.h"
+#include <GL/glew.h>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+struct PointLight {
+    glm::vec3 position;
+    float radius;
+    glm::vec3 color;
+    float intensity;
+};
+
+// Clustered forward lighting: the view frustum is split into a 3D grid of clusters
+// (screen tiles x exponential depth slices). Lights are assigned to clusters on the
+// CPU each frame and fragments only shade the lights of their own cluster.
+class ClusteredLighting {
+public:
+    static const int GRID_X = 16;
+    static const int GRID_Y = 9;
+    static const int GRID_Z = 24;
+    static const int MAX_LIGHTS = 4096;
+    static const int MAX_LIGHTS_PER_CLUSTER = 256;
+
+    explicit ClusteredLighting(JobSystem& jobs);
+    ~ClusteredLighting();
+    ClusteredLighting(const ClusteredLighting&) = delete;
+    ClusteredLighting& operator=(const ClusteredLighting&) = delete;
+
+    // Assign lights to clusters for this frame's view and upload the lists
+    void update(Camera& camera, int viewportWidth, int viewportHeight, const std::vector<PointLight>& lights);
+    // Bind the light buffers and set cluster uniforms on a CLUSTERED shader variant
+    void bind(Shader& shader);
+
+    int getLightCount() const { return lightCount; }
+    size_t getIndexCount() const { return lightIndices.size(); }
+    float getAssignMilliseconds() const { return assignMilliseconds; }
+
+private:
+    struct ClusterRange {
+        int minX, maxX;
+        int minY, maxY;
+        int minZ, maxZ;
+    };
+
+    JobSystem& jobs;
+
+    // Light data as two RGBA32F texels: position + radius, color + intensity
+    std::vector<glm::vec4> lightData;
+    std::vector<ClusterRange> lightRanges;
+    // Per cluster (offset, count) into lightIndices
+    std::vector<uint32_t> clusterGrid;
+    std::vector<uint32_t> lightIndices;
+    // Per depth slice scratch lists, merged into lightIndices
+    std::vector<std::vector<uint32_t>> sliceIndices;
+    std::vector<std::vector<uint32_t>> sliceCounts;
+
+    unsigned int lightBuffer, gridBuffer, indexBuffer;
+    unsigned int lightTexture, gridTexture, indexTexture;
+
+    int lightCount;
+    float viewportWidth, viewportHeight;
+    float sliceScale, sliceBias;
+    float assignMilliseconds;
+
+    int getSlice(float depth, float nearPlane) const;
+    void computeLightRanges(const glm::mat4& view, const glm::mat4& projection,
+                            float nearPlane, float farPlane, const std::vector<PointLight>& lights);
+    void buildSlice(int slice);
+    void upload();
+};
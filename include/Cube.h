@@ -1,18 +1,28 @@
 #pragma once
-#include "Mesh.h"
-#include <memory>
+#include "MeshRegistry.h"
+
+// Per-instance data for SHADER_INSTANCED draws (attribute locations 3 and 4)
+struct CubeInstance {
+    glm::vec3 offset;
+    glm::vec3 color;
+};
 
 class Cube {
 public:
-    Cube();
+    // All cubes share one registry mesh
+    explicit Cube(MeshRegistry& registry);
     ~Cube();
     
     void draw();
     void drawFace(int faceIndex);
-    static std::vector<Vertex> getCubeVertices();
-    static std::vector<unsigned int> getCubeIndices();
-    static std::vector<unsigned int> getFaceIndices(int faceIndex);
+    // Draw one face for instanceCount instances read from instanceVBO starting at firstInstance
+    void drawFaceInstanced(int faceIndex, unsigned int instanceVBO, size_t firstInstance, int instanceCount);
+    // Shared static tables, built once
+    static const std::vector<Vertex>& getCubeVertices();
+    static const std::vector<unsigned int>& getCubeIndices();
+    // The face's 6 indices inside getCubeIndices(), nullptr for an invalid face
+    static const unsigned int* getFaceIndices(int faceIndex);
 
 private:
-    std::unique_ptr<Mesh> mesh;
+    MeshHandle mesh;
 }; 
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+#include "NoiseGenerator.h"
+#include <cstdint>
+#include <vector>
+
+// Parameters of the 3D density terrain, in grid (block) units
+struct DensitySettings {
+    float scale = 20.0f;          // blocks per noise unit
+    int octaves = 4;
+    float persistence = 0.5f;
+    float lacunarity = 2.0f;
+    float surfaceLevel = 6.0f;    // height where the density gradient crosses zero
+    float surfaceRange = 8.0f;    // blocks of relief per unit of noise
+    float caveScale = 24.0f;
+    int caveOctaves = 1;
+    float caveThreshold = 0.06f;  // tunnel half width in noise units, 0 disables caves
+    int caveFloor = 1;            // layers below this are never carved
+    int originX = 0;              // noise position of grid (0, 0); keep it a multiple of
+    int originZ = 0;              // LATTICE_SPACING so lattice tiles line up seamlessly
+};
+
+// 3D density terrain: a block is solid where density > 0.
+// Density falls off with height around surfaceLevel and is displaced by 3D noise,
+// which produces overhangs; caves are carved where a second noise field is near zero.
+class DensityField {
+public:
+    // Lattice spacing of fillLattice(); one SSE vector spans one lattice cell in x
+    static const int LATTICE_SPACING = 4;
+
+    DensityField(const NoiseGenerator& terrainNoise, const NoiseGenerator& caveNoise, const DensitySettings& settings);
+
+    // Full-octave density at a grid position
+    float sample(float x, float y, float z) const;
+
+    // Solid mask (1 = solid) for a sizeX * sizeY * sizeZ grid in Terrain's
+    // (y, z, x) index order. fillPerVoxel() samples the noise at every voxel;
+    // fillLattice() samples every LATTICE_SPACING blocks and interpolates.
+    void fillPerVoxel(int sizeX, int sizeY, int sizeZ, std::vector<uint8_t>& solid) const;
+    void fillLattice(int sizeX, int sizeY, int sizeZ, std::vector<uint8_t>& solid) const;
+
+private:
+    const NoiseGenerator& terrainNoise;
+    const NoiseGenerator& caveNoise;
+    DensitySettings settings;
+
+    // The two fields are interpolated separately: the cave carve is not linear
+    float terrainDensity(float x, float y, float z) const;
+    float caveValue(float x, float y, float z) const;
+    // Both fields along a row of lattice points at height y and depth z.
+    // coords is scratch for the noise positions, 3 * count floats.
+    void sampleLatticeRow(float y, float z, int count, float* coords, float* terrainRow, float* caveRow) const;
+    bool hasCaves(float y) const { return settings.caveThreshold > 0.0f && y >= settings.caveFloor; }
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include "Shader.h"
+#include <GL/glew.h>
+
+// Offscreen scene target rendered at a fraction of the window size and
+// upscaled into the window. The target is allocated at maxScale of the window
+// and only a corner of it is used, so changing the scale costs nothing;
+// it is reallocated only when the window is resized.
+class DynamicResolution {
+public:
+    // Needs a GL context
+    explicit DynamicResolution(float maxScale = 1.0f);
+    ~DynamicResolution();
+    DynamicResolution(const DynamicResolution&) = delete;
+    DynamicResolution& operator=(const DynamicResolution&) = delete;
+
+    // Binds the target with a viewport of scale times the window size
+    void beginScene(int windowWidth, int windowHeight, float scale);
+    // Runs the artificial load, then blits the scene into the window's framebuffer
+    void endScene();
+
+    // Size the scene is being rendered at, valid after beginScene()
+    int getRenderWidth() const { return renderWidth; }
+    int getRenderHeight() const { return renderHeight; }
+
+    // Fragment shader iterations per scene pixel, to test scaling on slow or
+    // software GL (0 = off). The pass leaves the image unchanged.
+    void setArtificialLoad(int iterations) { loadIterations = iterations; }
+
+private:
+    float maxScale;
+    unsigned int framebuffer;
+    unsigned int colorBuffer, depthBuffer;
+    int targetWidth, targetHeight;
+    int windowWidth, windowHeight;
+    int renderWidth, renderHeight;
+
+    int loadIterations;
+    Shader loadShader;
+    unsigned int loadVAO;
+    bool loadShaderReady;
+
+    void resize(int width, int height);
+    void drawArtificialLoad();
+};
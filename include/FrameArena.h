@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Linear allocator for data that lives for one frame: allocations bump an
+// offset and reset() drops everything at once. A frame that runs out of space
+// falls back to the heap, and the following reset() grows the buffer to that
+// frame's high-water mark, so a steady frame loop stops touching the heap.
+class FrameArena {
+public:
+    explicit FrameArena(size_t capacity = 1 << 20);
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+    // Uninitialized storage for count objects; nothing is destroyed on reset()
+    template<typename T>
+    T* allocateArray(size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value, "Arena memory is released without destructors");
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    void reset();
+
+    size_t getUsed() const { return offset + overflowBytes; }
+    size_t getCapacity() const { return capacity; }
+    size_t getHighWater() const { return highWater; }
+
+private:
+    std::unique_ptr<uint8_t[]> buffer;
+    size_t capacity;
+    size_t offset;
+    size_t highWater;
+
+    // Heap blocks of a frame that outgrew the buffer, freed by reset()
+    std::vector<std::unique_ptr<uint8_t[]>> overflow;
+    size_t overflowBytes;
+};
@@ -0,0 +1,104 @@
+#pragma once
+#include "ImageWriter.h"
+#include <GL/glew.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum CaptureFormat {
+    CAPTURE_PNG,  // one numbered PNG per frame
+    CAPTURE_Y4M   // a single raw video file
+};
+
+// Captures the window's back buffer without stalling the frame. Each frame is
+// read into one of a ring of pixel pack buffers and fenced; the copy is mapped
+// once its fence has passed, normally PBO_COUNT - 1 frames later, and handed to
+// a writer thread that encodes and writes it. Frames are never dropped: when
+// the GPU or the writer falls behind, captureFrame() waits and counts a stall.
+class FrameCapture {
+public:
+    // Readbacks in flight
+    static const int PBO_COUNT = 3;
+    // CPU copies queued for the writer
+    static const int QUEUE_FRAMES = 4;
+
+    FrameCapture();
+    ~FrameCapture();
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    // PNG: path is a prefix, frames are written as <path>000000.png and up.
+    // Y4M: path is the video file; its size is the size of the first frame.
+    bool start(CaptureFormat format, const std::string& path, int framesPerSecond = 60);
+    // Queues a readback of framebuffer 0's back buffer; needs a GL context
+    void captureFrame(int width, int height);
+    // Waits for every frame in flight to be written, then closes the output
+    void stop();
+
+    bool isActive() const { return active; }
+    int getFramesCaptured() const { return framesCaptured; }
+    int getFramesWritten() const;
+    int getStalls() const { return stalls; }
+    // Render thread time spent in captureFrame()
+    double getCaptureMilliseconds() const { return captureMilliseconds; }
+    // Wall time from the first captured frame to the last
+    double getElapsedMilliseconds() const;
+
+private:
+    struct Readback {
+        unsigned int buffer = 0;
+        size_t capacity = 0;
+        GLsync fence = nullptr;
+        int width = 0, height = 0;
+    };
+
+    struct CpuFrame {
+        std::vector<uint8_t> pixels;
+        int width = 0, height = 0;
+        int index = 0;
+    };
+
+    CaptureFormat format;
+    std::string path;
+    int framesPerSecond;
+    bool active;
+
+    Readback readbacks[PBO_COUNT];
+    int oldestReadback;
+    int pendingReadbacks;
+
+    // Frames cycle free -> queued -> written -> free; both lists are fixed
+    // size rings of indices into frames, so steady capture does not allocate
+    CpuFrame frames[QUEUE_FRAMES];
+    int freeFrames[QUEUE_FRAMES];
+    int freeCount;
+    int queuedFrames[QUEUE_FRAMES];
+    int queueHead, queueCount;
+    int framesWritten;
+    bool stopping;
+    mutable std::mutex mutex;
+    std::condition_variable condition;
+    std::thread writer;
+
+    Y4mWriter video;
+    bool videoSizeWarned;
+    // Set by the writer when the video can't be opened; captureFrame() then stops reading frames back
+    std::atomic<bool> outputFailed;
+    std::vector<uint8_t> encodeScratch;
+
+    int framesCaptured;
+    int stalls;
+    double captureMilliseconds;
+    std::chrono::steady_clock::time_point firstCapture, lastCapture;
+
+    // Maps a finished readback and queues it; with wait false, returns false
+    // if its fence has not passed yet
+    bool collect(bool wait);
+    void writerLoop();
+    void writeFrame(const CpuFrame& frame);
+};
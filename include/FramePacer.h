@@ -0,0 +1,42 @@
+#pragma once
+#include <chrono>
+
+// Holds frames to a fixed rate. Sleeping alone overshoots by up to a
+// scheduler tick, so wait() sleeps until a margin before the deadline and
+// spins the rest of the way. The margin is the 90th percentile of how late
+// recent sleeps woke up, so a precise timer spins for a fraction of a
+// millisecond and rare long wakeups do not make every frame spin.
+class FramePacer {
+public:
+    // Recent sleeps the margin is taken from
+    static const int LATENESS_SAMPLES = 32;
+
+    explicit FramePacer(double framesPerSecond = 60.0);
+
+    void setRate(double framesPerSecond);
+    double getRate() const { return rate; }
+
+    // Blocks until the next frame is due. A frame that ran more than a whole
+    // period late restarts the schedule instead of rushing to catch up.
+    void wait();
+    // Starts the schedule over from now, e.g. after the loop was idle
+    void reset();
+
+    // Totals over all wait() calls
+    double getSleepMilliseconds() const { return sleepMilliseconds; }
+    double getSpinMilliseconds() const { return spinMilliseconds; }
+    double getSpinMarginMilliseconds() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    double rate;
+    Clock::duration period;
+    Clock::time_point deadline;
+    bool started;
+    // How late recent sleeps woke up, microseconds, as a ring
+    double lateness[LATENESS_SAMPLES];
+    int latenessNext;
+    double margin;
+    double sleepMilliseconds, spinMilliseconds;
+};
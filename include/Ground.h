@@ -1,10 +1,9 @@
 #pragma once
-#include "Mesh.h"
-#include <memory>
+#include "MeshRegistry.h"
 
 class Ground {
 public:
-    Ground(float size = 20.0f);
+    explicit Ground(MeshRegistry& registry, float size = 20.0f);
     ~Ground();
     
     void draw();
@@ -12,5 +11,5 @@ public:
     static std::vector<unsigned int> getGroundIndices();
 
 private:
-    std::unique_ptr<Mesh> mesh;
+    MeshHandle mesh;
 }; 
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Max-height mip pyramid over a grid of column heights. Level 0 holds each
+// column's height; each level above halves the grid and holds the largest
+// height of the (up to) 2x2 cells below it, up to a single cell over the
+// whole grid. A ray that stays above a cell's height cannot hit anything in
+// the columns under it.
+class HeightPyramid {
+public:
+    // Heights are whole blocks, width * depth of them with x fastest
+    void build(const float* heights, int width, int depth);
+    // Change one column and refresh the cells above it; stops at the first
+    // level whose maximum stays the same. Columns outside the grid are ignored.
+    void setHeight(int x, int z, int height);
+
+    int getLevelCount() const { return static_cast<int>(levels.size()); }
+    int getLevelWidth(int level) const { return levelWidths[level]; }
+    int getLevelDepth(int level) const { return levelDepths[level]; }
+    // Cell (x, z) of a level covers columns [x << level, (x + 1) << level)
+    int getMaxHeight(int level, int x, int z) const {
+        return levels[level][static_cast<size_t>(z) * levelWidths[level] + x];
+    }
+
+private:
+    std::vector<std::vector<uint16_t>> levels;
+    std::vector<int> levelWidths, levelDepths;
+
+    // Maximum of the children of cell (x, z) of level, read from level - 1
+    uint16_t reduce(int level, int x, int z) const;
+};
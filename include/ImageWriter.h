@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Encoders for captured frames. Input pixels are RGBA8 with rows bottom to
+// top, as glReadPixels returns them; both formats store rows top to bottom.
+
+// RGB PNG with uncompressed deflate blocks: no zlib needed, and encoding is
+// little more than a copy and a checksum. scratch is reused between calls.
+bool writePng(const std::string& path, const uint8_t* rgba, int width, int height, std::vector<uint8_t>& scratch);
+
+// Raw YUV 4:2:0 video (BT.601 limited range), readable by ffmpeg and most players
+class Y4mWriter {
+public:
+    Y4mWriter();
+    Y4mWriter(const Y4mWriter&) = delete;
+    Y4mWriter& operator=(const Y4mWriter&) = delete;
+
+    bool open(const std::string& path, int width, int height, int framesPerSecond);
+    // Frames must match the size given to open()
+    bool writeFrame(const uint8_t* rgba);
+    bool close();
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+private:
+    std::ofstream file;
+    int width, height;
+    std::vector<uint8_t> planes;  // Y, then U, then V
+};
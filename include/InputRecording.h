@@ -0,0 +1,38 @@
+#pragma once
+#include "InputState.h"
+#include "Session.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Per-tick input of a session at a fixed tick rate, the options its world was
+// built with and the player checksum it ended on. Files store the ticks run
+// length encoded, so idle stretches cost a single 7-byte run.
+class InputRecording {
+public:
+    static const int DEFAULT_TICK_RATE = 60;
+
+    InputRecording();
+
+    void clear();
+    void addTick(const InputState& input) { ticks.push_back(input); }
+    int getTickCount() const { return static_cast<int>(ticks.size()); }
+    const InputState& getTick(int tick) const { return ticks[tick]; }
+
+    void setOptions(const SessionOptions& o) { options = o; }
+    const SessionOptions& getOptions() const { return options; }
+    void setTickRate(int rate) { tickRate = rate; }
+    int getTickRate() const { return tickRate; }
+    float getTickSeconds() const { return 1.0f / tickRate; }
+    void setFinalChecksum(uint32_t checksum) { finalChecksum = checksum; }
+    uint32_t getFinalChecksum() const { return finalChecksum; }
+
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+private:
+    SessionOptions options;
+    int tickRate;
+    uint32_t finalChecksum;
+    std::vector<InputState> ticks;
+};
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+
+enum InputButton : uint8_t {
+    INPUT_FORWARD = 1 << 0,
+    INPUT_LEFT    = 1 << 1,
+    INPUT_BACK    = 1 << 2,
+    INPUT_RIGHT   = 1 << 3,
+    INPUT_JUMP    = 1 << 4,
+    INPUT_BREAK   = 1 << 5,   // remove the targeted block
+    INPUT_PLACE   = 1 << 6    // place a lamp against it
+};
+
+// Player input for one simulation tick. Mouse motion is kept in fixed point so
+// a recording holds exactly what the live session applied.
+struct InputState {
+    static const int MOUSE_UNITS_PER_PIXEL = 16;
+
+    uint8_t buttons = 0;
+    int16_t mouseX = 0;   // look offsets since the last tick, in 1/16 pixel
+    int16_t mouseY = 0;
+
+    bool isDown(InputButton button) const { return (buttons & button) != 0; }
+    bool operator==(const InputState& other) const {
+        return buttons == other.buttons && mouseX == other.mouseX && mouseY == other.mouseY;
+    }
+    bool operator!=(const InputState& other) const { return !(*this == other); }
+};
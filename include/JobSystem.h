@@ -0,0 +1,50 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed pool of worker threads for data-parallel CPU work
+class JobSystem {
+public:
+    // threadCount 0 = one worker per hardware thread, minus the calling thread
+    explicit JobSystem(unsigned int threadCount = 0);
+    ~JobSystem();
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Run fn(begin, end) over [0, count) in batches of at least minBatch items.
+    // The calling thread takes part and the call returns when every batch is done.
+    // Not reentrant: don't call it from inside another job.
+    void parallelFor(int count, int minBatch, const std::function<void(int, int)>& fn);
+
+    // Queue a single task, the future becomes ready when it has run
+    template<typename F>
+    auto submit(F&& fn) -> std::future<decltype(fn())> {
+        using Result = decltype(fn());
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(fn));
+        std::future<Result> result = task->get_future();
+        enqueue([task]() { (*task)(); });
+        return result;
+    }
+
+    // Workers plus the calling thread
+    unsigned int getConcurrency() const { return static_cast<unsigned int>(workers.size()) + 1; }
+
+private:
+    std::vector<std::thread> workers;
+    // Ring buffer of pending tasks; it only grows when full, so a steady
+    // stream of parallelFor calls doesn't allocate queue nodes
+    std::vector<std::function<void()>> tasks;
+    size_t taskHead;
+    size_t taskCount;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopping;
+
+    void enqueue(std::function<void()> task);
+    void workerLoop();
+};
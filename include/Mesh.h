@@ -1,25 +1,44 @@
 #pragma once
+#include "Vertex.h"
 #include <GL/glew.h>
+#include <cstddef>
 #include <vector>
 #include <glm/glm.hpp>
 
-struct Vertex {
-    glm::vec3 position;
-    glm::vec3 normal;
-    glm::vec2 texCoords;
-};
-
+// Indexed triangle mesh. Owns its GL objects, so it can be moved but not copied.
 class Mesh {
 public:
-    Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices);
+    // upload = false leaves the GPU copy to a later setupMesh() (see MeshRegistry)
+    Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, bool upload = true);
     ~Mesh();
-    
+    Mesh(const Mesh&) = delete;
+    Mesh& operator=(const Mesh&) = delete;
+    Mesh(Mesh&& other) noexcept;
+    Mesh& operator=(Mesh&& other) noexcept;
+
     void draw();
     void setupMesh();
     unsigned int getVAO() const { return VAO; }
+    bool isUploaded() const { return VAO != 0; }
+
+    // CPU copies are only needed for upload or collision; dropping them keeps
+    // the GPU buffers and index count
+    void releaseCpuData();
+    bool hasCpuData() const { return !vertices.empty(); }
+    const std::vector<Vertex>& getVertices() const { return vertices; }
+    const std::vector<unsigned int>& getIndices() const { return indices; }
+
+    size_t getVertexCount() const { return vertexCount; }
+    size_t getIndexCount() const { return indexCount; }
+    // Size of the vertex and index data, resident on the GPU once uploaded
+    size_t getDataBytes() const { return vertexCount * sizeof(Vertex) + indexCount * sizeof(unsigned int); }
+    size_t getCpuBytes() const { return vertices.capacity() * sizeof(Vertex) + indices.capacity() * sizeof(unsigned int); }
 
 private:
     std::vector<Vertex> vertices;
     std::vector<unsigned int> indices;
+    size_t vertexCount, indexCount;
     unsigned int VAO, VBO, EBO;
-}; 
\ No newline at end of file
+
+    void destroyBuffers();
+};
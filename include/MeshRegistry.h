@@ -0,0 +1,101 @@
+#pragma once
+#include "Mesh.h"
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class MeshRegistry;
+
+// Whether a mesh keeps its CPU vertices and indices after upload
+enum MeshCpuData {
+    MESH_RELEASE_CPU,   // dropped once the GPU has a copy
+    MESH_KEEP_CPU       // kept, e.g. for collision queries
+};
+
+// Counted reference to a registry mesh; the mesh is freed with its last handle.
+// The registry must outlive every handle it gave out.
+class MeshHandle {
+public:
+    MeshHandle() : registry(nullptr), slot(0) {}
+    MeshHandle(const MeshHandle& other);
+    MeshHandle(MeshHandle&& other) noexcept;
+    MeshHandle& operator=(MeshHandle other) noexcept;
+    ~MeshHandle() { reset(); }
+
+    void reset();
+    Mesh* get() const;
+    Mesh* operator->() const { return get(); }
+    explicit operator bool() const { return registry != nullptr; }
+    // False until the upload queue has reached this mesh
+    bool isReady() const;
+
+private:
+    friend class MeshRegistry;
+    MeshHandle(MeshRegistry* registry, uint32_t slot) : registry(registry), slot(slot) {}
+
+    MeshRegistry* registry;
+    uint32_t slot;
+};
+
+struct MeshStats {
+    int meshCount = 0;          // live meshes, after deduplication
+    int pendingUploads = 0;
+    int dedupHits = 0;          // create() calls that reused an existing mesh
+    size_t gpuBytes = 0;        // resident vertex and index buffers
+    size_t cpuBytes = 0;        // CPU copies still held (pending or MESH_KEEP_CPU)
+    size_t uploadedBytes = 0;   // by the last processUploads()
+};
+
+// Owner of shared meshes. Identical geometry is stored once: create() hashes the
+// vertex and index data and hands out another handle to a matching mesh. Every
+// match is confirmed byte for byte, so only meshes that still hold their CPU data
+// (not uploaded yet, or MESH_KEEP_CPU) are shared; once a MESH_RELEASE_CPU mesh
+// is uploaded, the same geometry created again gets a mesh of its own. New
+// meshes are uploaded by processUploads() under a per-frame byte budget.
+class MeshRegistry {
+public:
+    MeshRegistry() = default;
+    ~MeshRegistry() = default;
+    MeshRegistry(const MeshRegistry&) = delete;
+    MeshRegistry& operator=(const MeshRegistry&) = delete;
+
+    MeshHandle create(std::vector<Vertex> vertices, std::vector<unsigned int> indices,
+                      MeshCpuData cpuData = MESH_RELEASE_CPU);
+
+    // Upload queued meshes in creation order until byteBudget is spent. At least
+    // one mesh is uploaded per call so a mesh larger than the budget still goes
+    // through. Returns the number uploaded.
+    int processUploads(size_t byteBudget);
+    // Upload one mesh now, e.g. when it's needed before the next frame
+    void uploadNow(const MeshHandle& handle);
+
+    MeshStats getStats() const;
+
+private:
+    friend class MeshHandle;
+
+    struct Entry {
+        std::unique_ptr<Mesh> mesh;
+        uint64_t hash = 0;
+        int refCount = 0;
+        bool keepCpu = false;
+    };
+
+    std::vector<Entry> entries;
+    std::vector<uint32_t> freeSlots;
+    // Content hash to slots, several only when hashes collide
+    std::unordered_map<uint64_t, std::vector<uint32_t>> slotsByHash;
+    // Slots waiting for upload; uploadHead skips the ones already done
+    std::vector<uint32_t> uploadQueue;
+    size_t uploadHead = 0;
+    int dedupHits = 0;
+    size_t uploadedBytes = 0;
+
+    void addReference(uint32_t slot) { entries[slot].refCount++; }
+    void removeReference(uint32_t slot);
+    void upload(Entry& entry);
+    static uint64_t hashGeometry(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+    static bool sameGeometry(const Mesh& mesh, const std::vector<Vertex>& vertices,
+                             const std::vector<unsigned int>& indices);
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+// Interface of the gradient noise backends (PerlinNoise, SimplexNoise).
+// Values are roughly in [-1, 1]. The batch overloads evaluate count points at
+// once; backends override them when they have a faster path than the scalar loop.
+class NoiseGenerator {
+public:
+    virtual ~NoiseGenerator() = default;
+
+    virtual float noise(float x, float y) const = 0;
+    virtual float noise(float x, float y, float z) const = 0;
+
+    virtual void noise(const float* x, const float* y, float* out, int count) const;
+    virtual void noise(const float* x, const float* y, const float* z, float* out, int count) const;
+
+    // Generate octave noise (multiple frequencies)
+    float octaveNoise(float x, float y, int octaves, float persistence, float lacunarity) const;
+    float octaveNoise(float x, float y, float z, int octaves, float persistence, float lacunarity) const;
+
+    // Octave noise over count points, one batch call per octave
+    void octaveNoise(const float* x, const float* y, float* out, int count,
+                     int octaves, float persistence, float lacunarity) const;
+    void octaveNoise(const float* x, const float* y, const float* z, float* out, int count,
+                     int octaves, float persistence, float lacunarity) const;
+};
@@ -0,0 +1,56 @@
+#pragma once
+#include "Shader.h"
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+// Screen-space 2D overlay: lines, filled rectangles and bitmap-font text.
+// Everything added between begin() and end() becomes triangles in one
+// streaming vertex buffer and goes out in a single draw, textured from the
+// font atlas; untextured shapes sample its solid cell. Coordinates are
+// pixels with the origin at the top left of the window.
+class OverlayRenderer {
+public:
+    // Texture unit the font atlas is bound to while drawing
+    static const int FONT_TEXTURE_UNIT = 6;
+
+    // Needs a GL context
+    OverlayRenderer();
+    ~OverlayRenderer();
+    OverlayRenderer(const OverlayRenderer&) = delete;
+    OverlayRenderer& operator=(const OverlayRenderer&) = delete;
+
+    // Starts a batch for a window of this size in pixels
+    void begin(int width, int height);
+    void addLine(const glm::vec2& from, const glm::vec2& to, float thickness, const glm::vec4& color);
+    void addRect(const glm::vec2& min, const glm::vec2& max, const glm::vec4& color);
+    // Text at integer multiples of the font size; '\n' starts a new line.
+    // Returns the width drawn in pixels.
+    float addText(const glm::vec2& position, const char* text, const glm::vec4& color, int scale = 1);
+    // Uploads the batch and draws it over whatever is in the framebuffer
+    void end();
+
+    // Counts from the last end()
+    int getVertexCount() const { return drawnVertices; }
+    int getDrawCalls() const { return drawCalls; }
+
+private:
+    struct OverlayVertex {
+        glm::vec2 position;
+        glm::vec2 texCoord;
+        uint32_t color;  // RGBA8
+    };
+
+    std::vector<OverlayVertex> vertices;
+    int width, height;
+    int drawnVertices, drawCalls;
+
+    Shader shader;
+    bool shaderReady;
+    unsigned int vao, vbo;
+    size_t vboCapacity;  // vertices
+    unsigned int fontTexture;
+    glm::vec2 solidTexCoord;
+
+    void addQuad(const glm::vec2 corners[4], const glm::vec2 texCoords[4], uint32_t color);
+};
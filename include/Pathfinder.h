@@ -0,0 +1,130 @@
+#pragma once
+#include "JobSystem.h"
+#include "Terrain.h"
+#include <cstdint>
+#include <future>
+#include <glm/glm.hpp>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// What a walker can move over, in whole blocks
+struct NavigationRules {
+    int maxClimb = 1;         // highest ledge it can jump onto
+    int maxDrop = 3;          // deepest drop it will step off
+    float climbCost = 1.0f;   // extra cost of a jump, in blocks walked
+};
+
+// Climb from the height of a standing jump, jumpForce^2 / (2 |gravity|), in whole blocks
+NavigationRules makeNavigationRules(float jumpForce, float gravity, int maxDrop = 3);
+
+enum PathSearch {
+    PATH_HIERARCHICAL,  // HPA*: search the cluster graph, then refine inside each cluster
+    PATH_FLAT           // A* over every column
+};
+
+struct Path {
+    bool found = false;
+    float cost = 0.0f;
+    std::vector<glm::vec3> points;  // column centers at standing height, start to goal
+};
+
+// Paths over the terrain surface. Each column is a cell where a walker stands
+// on its top block, with nothing above it; it can step to any of its eight
+// neighbours within the climb and drop limits, diagonally only if both
+// straight moves around the corner are possible too.
+//
+// The world is split into square clusters. Where a run of columns along a
+// cluster border can be crossed, one or two of them become nodes of an
+// abstract graph, with edges across the border and edges to every other node
+// of the same cluster, costed by a search inside the cluster. A path request
+// joins the start and goal to the nodes of their clusters, searches the
+// abstract graph and refines each edge back into columns. Paths are within a
+// few percent of the shortest.
+class Pathfinder {
+public:
+    Pathfinder(const Terrain& terrain, const NavigationRules& rules, int clusterSize = 16);
+    ~Pathfinder();
+    Pathfinder(const Pathfinder&) = delete;
+    Pathfinder& operator=(const Pathfinder&) = delete;
+
+    // Reads every column height and builds all clusters, in parallel when given jobs
+    void build(JobSystem* jobs = nullptr);
+    // Re-reads columns [min, max] (world block coordinates, inclusive) after edits and
+    // rebuilds the clusters whose graph they touch. Returns how many were rebuilt.
+    // No path requests may be running.
+    int updateColumns(int minX, int minZ, int maxX, int maxZ);
+
+    // Start and goal are world positions; only their columns matter.
+    // Safe to call from several threads at once.
+    bool findPath(const glm::vec3& start, const glm::vec3& goal, Path& path,
+                  PathSearch search = PATH_HIERARCHICAL) const;
+    // findPath on one of the workers
+    std::future<Path> requestPath(JobSystem& jobs, const glm::vec3& start, const glm::vec3& goal) const;
+
+    const NavigationRules& getRules() const { return rules; }
+    int getClusterCount() const { return static_cast<int>(clusters.size()); }
+    // Abstract graph size
+    int getNodeCount() const;
+    int getEdgeCount() const;
+
+private:
+    struct AbstractEdge {
+        int cell;
+        float cost;
+        int pathStart, pathLength;  // columns after the source up to cell, in the cluster's paths
+    };
+    struct AbstractNode {
+        int cell;
+        std::vector<AbstractEdge> edges;  // to nodes of the same cluster and across borders
+    };
+    struct Cluster {
+        std::vector<AbstractNode> nodes;
+        std::vector<int> paths;
+    };
+    struct Transition {
+        int cellA, cellB;                 // A in the lower cluster, B in the higher one
+        float forwardCost, backwardCost;  // A to B and back, negative when it can't be crossed
+    };
+    struct SearchScratch;
+
+    const Terrain& terrain;
+    NavigationRules rules;
+    int clusterSize;
+    int width, depth;
+    int clustersX, clustersZ;
+    // Standing height of each column as of the last build or update, 0 = nowhere to stand
+    std::vector<int16_t> heights;
+    // Bit d of a column's mask is set when it can move by MOVES[d] (see Pathfinder.cpp)
+    std::vector<uint8_t> moveMasks;
+    std::vector<Cluster> clusters;
+
+    // Scratch buffers of finished searches, reused by the next ones
+    mutable std::mutex scratchMutex;
+    mutable std::vector<std::unique_ptr<SearchScratch>> freeScratch;
+
+    std::unique_ptr<SearchScratch> acquireScratch() const;
+    void releaseScratch(std::unique_ptr<SearchScratch> scratch) const;
+
+    void readHeights(int minX, int minZ, int maxX, int maxZ);
+    void buildCluster(int cluster, SearchScratch& scratch);
+    // Crossings from a cluster to its neighbour in +x (alongZ) or +z
+    void findTransitions(int lowCluster, bool alongZ, std::vector<Transition>& transitions) const;
+    int getClusterOf(int cell) const;
+    void updateMoveMasks(int minX, int minZ, int maxX, int maxZ);
+    // Climb, drop and corner rules for the move from column (x, z) by (dx, dz)
+    bool isMoveOpen(int x, int z, int dx, int dz) const;
+    // Cost of moving out of a cell in one of the eight directions, negative when it can't
+    float getMoveCost(int cell, int direction) const;
+    float estimateCost(int fromCell, int toCell) const;
+
+    // A* inside one cluster from source to target, or with target -1 a search of the
+    // whole cluster. Reverse searches follow moves into each column instead of out of it.
+    bool searchCluster(int cluster, int source, int target, bool reverse, SearchScratch& scratch) const;
+    // Cost from the source of the last cluster search, negative if it didn't get there
+    float getClusterCost(int cell, const SearchScratch& scratch) const;
+    // Columns after the source on the way to target, from the last cluster search
+    void appendClusterPath(int target, SearchScratch& scratch, std::vector<int>& cells) const;
+    bool findHierarchical(int start, int goal, SearchScratch& scratch, std::vector<int>& cells, float& cost) const;
+    bool findFlat(int start, int goal, SearchScratch& scratch, std::vector<int>& cells, float& cost) const;
+};
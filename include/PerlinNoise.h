@@ -1,25 +1,25 @@
 #pragma once
-#include <vector>
+#include "NoiseGenerator.h"
+#include "PermutationTable.h"
 #include <cmath>
 
-class PerlinNoise {
+// Classic 3D Perlin noise; 2D samples are the z = 0 slice
+class PerlinNoise : public NoiseGenerator {
 public:
     PerlinNoise(unsigned int seed = 0);
     
     // Generate noise value at given coordinates
-    float noise(float x, float y) const;
-    float noise(float x, float y, float z) const;
-    
-    // Generate octave noise (multiple frequencies)
-    float octaveNoise(float x, float y, int octaves, float persistence, float lacunarity) const;
+    using NoiseGenerator::noise;
+    float noise(float x, float y) const override;
+    float noise(float x, float y, float z) const override;
     
     // Set seed for reproducible results
     void setSeed(unsigned int seed);
 
 private:
-    std::vector<int> p;
+    PermutationTable p;
     
     float fade(float t) const;
     float lerp(float t, float a, float b) const;
     float grad(int hash, float x, float y, float z) const;
-}; 
\ No newline at end of file
+};
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+// Small deterministic PRNG (SplitMix64). Unlike the std:: engines and
+// distributions, its output is the same on every compiler and platform.
+class PortableRandom {
+public:
+    constexpr explicit PortableRandom(uint64_t seed) : state(seed) {}
+
+    constexpr uint32_t next() {
+        state += 0x9E3779B97F4A7C15ull;
+        uint64_t z = state;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return static_cast<uint32_t>((z ^ (z >> 31)) >> 32);
+    }
+
+    // Uniform in [0, bound) by multiply-shift
+    constexpr uint32_t nextBelow(uint32_t bound) {
+        return static_cast<uint32_t>((static_cast<uint64_t>(next()) * bound) >> 32);
+    }
+
+private:
+    uint64_t state;
+};
+
+// Perlin permutation: a shuffle of 0..255, stored twice so lookups of
+// p[i + 1] and p[p[i] + j] need no wrapping
+using PermutationTable = std::array<uint8_t, 512>;
+
+constexpr PermutationTable makePermutationTable(uint32_t seed) {
+    PermutationTable table{};
+    for (int i = 0; i < 256; i++) {
+        table[i] = static_cast<uint8_t>(i);
+    }
+
+    // Fisher-Yates
+    PortableRandom random(seed);
+    for (int i = 255; i > 0; i--) {
+        int j = static_cast<int>(random.nextBelow(static_cast<uint32_t>(i + 1)));
+        uint8_t swap = table[i];
+        table[i] = table[j];
+        table[j] = swap;
+    }
+
+    for (int i = 0; i < 256; i++) {
+        table[i + 256] = table[i];
+    }
+    return table;
+}
+
+// FNV-1a over the table, used to pin known seeds
+constexpr uint32_t hashPermutationTable(const PermutationTable& table) {
+    uint32_t hash = 2166136261u;
+    for (uint8_t value : table) {
+        hash = (hash ^ value) * 16777619u;
+    }
+    return hash;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <GL/glew.h>
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// CPU and GPU timings of named sections of the frame.
+// GPU times come from timestamp queries read back QUERY_LATENCY frames later,
+// so measuring never stalls the pipeline. Sections may nest.
+class Profiler {
+public:
+    static const int QUERY_LATENCY = 4;
+
+    Profiler();
+    ~Profiler();
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    // Look up a section once, then time it by id every frame
+    int getSectionId(const std::string& name);
+
+    void beginFrame();
+    void beginSection(int id);
+    void endSection(int id);
+
+    // Smoothed timings; sections skipped this frame keep their last values
+    float getCpuMilliseconds(int id) const;
+    float getGpuMilliseconds(int id) const;
+    // Frames since the section last ran (0 = ran this frame)
+    int getFramesSinceRun(int id) const;
+    // Newest unsmoothed GPU time and the frame it was measured in (-1 before the first)
+    float getLatestGpuMilliseconds(int id) const;
+    long long getLatestGpuFrame(int id) const;
+    long long getFrameIndex() const { return frameIndex; }
+
+    void report(std::ostream& out) const;
+
+private:
+    struct Section {
+        std::string name;
+        unsigned int startQueries[QUERY_LATENCY];
+        unsigned int endQueries[QUERY_LATENCY];
+        bool issued[QUERY_LATENCY];
+        std::chrono::high_resolution_clock::time_point cpuStart;
+        float cpuMilliseconds;
+        float gpuMilliseconds;
+        float latestGpuMilliseconds;
+        long long latestGpuFrame;
+        long long lastFrame;
+    };
+
+    std::vector<Section> sections;
+    long long frameIndex;
+
+    void collect(Section& section, int slot);
+};
+
+// Times the enclosing scope
+class ProfileScope {
+public:
+    ProfileScope(Profiler* profiler, int id) : profiler(profiler), id(id) {
+        if (profiler) profiler->beginSection(id);
+    }
+    ~ProfileScope() {
+        if (profiler) profiler->endSection(id);
+    }
+
+private:
+    Profiler* profiler;
+    int id;
+};
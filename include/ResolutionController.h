@@ -0,0 +1,37 @@
+#pragma once
+
+struct ResolutionSettings {
+    float targetMilliseconds = 16.6f;  // GPU frame time to hold
+    float minScale = 0.5f;             // render scale per axis
+    float maxScale = 1.0f;
+    float headroom = 0.9f;             // aim this far under the target so spikes have room
+    float raiseRate = 0.05f;           // share of the gap to a higher scale closed per sample
+};
+
+// Picks the render scale of each frame from measured GPU frame times. GPU
+// samples arrive a few frames late, so each is judged against the scale its
+// own frame was rendered at. Cost is assumed to follow the pixel count
+// (scale squared): over budget the scale drops at once to the estimate that
+// fits, under budget it climbs back slowly so it does not oscillate.
+class ResolutionController {
+public:
+    // Frames a GPU sample may lag behind and still be used
+    static const int HISTORY = 16;
+
+    explicit ResolutionController(const ResolutionSettings& settings = ResolutionSettings());
+
+    // Scale to render `frame` at. sampleMilliseconds is the GPU time measured for
+    // sampleFrame, an earlier frame; the same sample passed again is ignored.
+    float update(long long frame, float sampleMilliseconds, long long sampleFrame);
+
+    float getScale() const { return scale; }
+    const ResolutionSettings& getSettings() const { return settings; }
+    void setSettings(const ResolutionSettings& settings);
+
+private:
+    ResolutionSettings settings;
+    float scale;
+    long long lastSampleFrame;
+    float history[HISTORY];       // scale each recent frame was rendered at
+    long long historyFrames[HISTORY];
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include "AgentSimulation.h"
+#include "Camera.h"
+#include "CharacterController.h"
+#include "InputState.h"
+#include "JobSystem.h"
+#include "Terrain.h"
+#include <cstdint>
+
+// World settings a session is built from; recordings store them so a replay
+// rebuilds the same world
+struct SessionOptions {
+    bool densityTerrain = false;
+    NoiseBackend noise = NOISE_PERLIN;
+    int agents = 0;
+};
+
+// The simulated part of the app: terrain, player and agents. It has no OpenGL,
+// so the same ticks run in the window and in headless replays.
+class Session {
+public:
+    Session(const SessionOptions& options, Camera& camera, JobSystem& jobs);
+
+    // One tick: player input and physics, block edits, then agents
+    void tick(const InputState& input, float deltaTime);
+
+    // Hash of the player's position, velocity, view angles and ground state
+    uint32_t getPlayerChecksum() const;
+
+    const SessionOptions& getOptions() const { return options; }
+    Terrain& getTerrain() { return terrain; }
+    CharacterController& getPlayer() { return player; }
+    AgentSimulation& getAgents() { return agents; }
+
+private:
+    SessionOptions options;
+    Camera& camera;
+    Terrain terrain;
+    CharacterController player;
+    AgentSimulation agents;
+    uint8_t previousButtons;
+
+    void editBlocks(const InputState& input);
+};
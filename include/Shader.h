@@ -1,7 +1,8 @@
 #pragma once
 #include <GL/glew.h>
 #include <string>
-#include <unordered_map>
+#include <cstdint>
+#include <vector>
 #include <glm/glm.hpp>
 
 class Shader {
@@ -12,17 +13,32 @@ public:
     bool loadFromFiles(const std::string& vertexPath, const std::string& fragmentPath);
     bool loadFromStrings(const std::string& vertexSource, const std::string& fragmentSource);
     void use();
-    void setBool(const std::string& name, bool value);
-    void setInt(const std::string& name, int value);
-    void setFloat(const std::string& name, float value);
-    void setVec3(const std::string& name, const glm::vec3& value);
-    void setMat4(const std::string& name, const glm::mat4& value);
+    unsigned int getProgramID() const { return programID; }
+    void setBool(const char* name, bool value);
+    void setInt(const char* name, int value);
+    void setFloat(const char* name, float value);
+    void setFloatArray(const char* name, const float* values, int count);
+    void setVec2(const char* name, const glm::vec2& value);
+    void setVec3(const char* name, const glm::vec3& value);
+    void setVec3Array(const char* name, const glm::vec3* values, int count);
+    void setMat3(const char* name, const glm::mat3& value);
+    void setMat4(const char* name, const glm::mat4& value);
+    void setMat4Array(const char* name, const glm::mat4* values, int count);
+
+    // Reads a whole source file, falling back to ../path when run from build/
+    static bool readSourceFile(const std::string& path, std::string& source, std::string& usedPath);
 
 private:
     unsigned int programID;
-    std::unordered_map<std::string, int> uniformCache;
+    // Looked up by name hash first; setting a cached uniform never allocates
+    struct UniformEntry {
+        uint32_t hash;
+        std::string name;
+        int location;
+    };
+    std::vector<UniformEntry> uniformCache;
     
     bool compileShader(const std::string& source, GLenum type, unsigned int& shaderID);
     bool linkProgram();
-    int getUniformLocation(const std::string& name);
+    int getUniformLocation(const char* name);
 }; 
\ No newline at end of file
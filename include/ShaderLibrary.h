@@ -0,0 +1,59 @@
+#pragma once
+#include "Shader.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Feature bits selecting a #define-specialized permutation of one shader source
+enum ShaderFeature : unsigned int {
+    SHADER_INSTANCED     = 1u << 0, // per-instance offset/color attributes instead of model/objectColor
+    SHADER_NORMAL_MATRIX = 1u << 1, // model has non-uniform scale, use the CPU-computed normalMatrix
+    SHADER_NO_SPECULAR   = 1u << 2, // diffuse + ambient only
+    SHADER_FOG           = 1u << 3, // exponential distance fog
+    SHADER_PACKED_VERTEX = 1u << 4, // packed ChunkVertex input, positioned by chunkOrigin, textured by blockTextures
+    SHADER_BAKED_LIGHT   = 1u << 5, // per-vertex voxel light and AO instead of per-fragment Phong
+    SHADER_CLUSTERED     = 1u << 6, // point lights from ClusteredLighting's per-cluster lists
+    SHADER_SHADOWS       = 1u << 7, // sun visibility from ShadowCascades
+    SHADER_DEPTH_ONLY    = 1u << 8  // shadow map pass, no shading
+};
+const int SHADER_FEATURE_COUNT = 9;
+
+class ShaderLibrary {
+public:
+    ShaderLibrary();
+    ~ShaderLibrary();
+
+    // Load the shared sources every permutation is generated from
+    bool loadSources(const std::string& vertexPath, const std::string& fragmentPath);
+
+    // Define applied to every variant (e.g. lighting constants); drops compiled variants
+    void setDefine(const std::string& name, const std::string& value);
+
+    // Get the variant for a feature set, compiling it now if it isn't cached yet.
+    // Returns nullptr if the variant failed to compile.
+    Shader* get(unsigned int features);
+
+    // Queue variants to be compiled ahead of use by compilePending()
+    void request(unsigned int features);
+    // Compile up to maxVariants queued variants, returns how many were compiled
+    int compilePending(int maxVariants = 1);
+
+    bool isReady(unsigned int features) const;
+    size_t getVariantCount() const { return variants.size(); }
+
+    static std::string getFeatureDefines(unsigned int features);
+
+private:
+    std::string vertexSource;
+    std::string fragmentSource;
+    std::vector<std::pair<std::string, std::string>> defines;
+
+    std::unordered_map<unsigned int, std::unique_ptr<Shader>> variants;
+    std::unordered_set<unsigned int> failedVariants;
+    std::vector<unsigned int> pendingVariants;
+
+    Shader* compileVariant(unsigned int features);
+    std::string specialize(const std::string& source, unsigned int features) const;
+};
@@ -0,0 +1,62 @@
+#pragma once
+#include "Camera.h"
+#include "Profiler.h"
+#include "Shader.h"
+#include "Terrain.h"
+#include "TerrainRenderer.h"
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+// Cascaded shadow maps for the directional sun light.
+// Each cascade covers a slice of the camera frustum. Its depth map is cached and
+// only re-rendered when the light direction changes, the camera leaves the cached
+// region, or a chunk inside the cascade's light volume was remeshed.
+class ShadowCascades {
+public:
+    static const int NUM_CASCADES = 3;
+    static const int RESOLUTION = 1024;
+
+    ShadowCascades(Terrain& terrain, TerrainRenderer& renderer);
+    ~ShadowCascades();
+    ShadowCascades(const ShadowCascades&) = delete;
+    ShadowCascades& operator=(const ShadowCascades&) = delete;
+
+    void setLightDirection(const glm::vec3& direction);
+    void setShadowDistance(float distance) { shadowDistance = distance; }
+    void setProfiler(Profiler* profiler);
+
+    // Re-render the cascades that are out of date. depthShader is a DEPTH_ONLY variant.
+    void update(Camera& camera, float aspectRatio, Shader& depthShader);
+    // Bind the shadow map and cascade uniforms on a SHADOWS shader variant
+    void bind(Shader& shader, int textureUnit);
+
+    int getRenderedCascadeCount() const { return renderedThisFrame; }
+
+private:
+    struct Cascade {
+        float splitFar;          // view depth where this cascade ends
+        glm::vec3 center;        // center of the cached region
+        float radius;            // radius of the cached region
+        glm::mat4 lightViewProjection;
+        unsigned long long terrainRevision;
+        bool valid;
+    };
+
+    Terrain& terrain;
+    TerrainRenderer& renderer;
+    Profiler* profiler;
+    int profilerSections[NUM_CASCADES];
+
+    Cascade cascades[NUM_CASCADES];
+    glm::vec3 lightDirection;
+    float shadowDistance;
+    int renderedThisFrame;
+
+    unsigned int depthTexture;
+    unsigned int framebuffer;
+
+    glm::mat4 getLightViewProjection(const glm::vec3& center, float radius) const;
+    glm::vec3 getLightUp() const;
+    unsigned long long getTerrainRevision(const glm::mat4& lightViewProjection) const;
+    void renderCascade(int index, Shader& depthShader);
+};
@@ -0,0 +1,25 @@
+#pragma once
+#include "NoiseGenerator.h"
+#include "PermutationTable.h"
+
+// Simplex-lattice gradient noise in the style of OpenSimplex2: each sample sums
+// radial kernels from the corners of its simplex, 3 in 2D and 4 in 3D, instead
+// of the 8 cube corners Perlin noise blends. The 2D batch path runs on SSE.
+class SimplexNoise : public NoiseGenerator {
+public:
+    SimplexNoise(unsigned int seed = 0);
+
+    using NoiseGenerator::noise;
+    float noise(float x, float y) const override;
+    float noise(float x, float y, float z) const override;
+    void noise(const float* x, const float* y, float* out, int count) const override;
+    void noise(const float* x, const float* y, const float* z, float* out, int count) const override;
+
+    void setSeed(unsigned int seed);
+
+private:
+    PermutationTable p;
+
+    float noise2D(float x, float y) const;
+    float noise3D(float x, float y, float z) const;
+};
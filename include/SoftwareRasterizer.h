@@ -0,0 +1,149 @@
+#pragma once
+#include "JobSystem.h"
+#include "Vertex.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <glm/glm.hpp>
+#include <vector>
+
+// Uniforms of the default shader's Phong path (objectColor, no baked light), see fragment.glsl
+struct PhongShading {
+    glm::vec3 lightPos = glm::vec3(10.0f, 20.0f, 10.0f);
+    glm::vec3 lightColor = glm::vec3(1.0f);
+    glm::vec3 viewPos = glm::vec3(0.0f);
+    float ambientStrength = 0.1f;   // AMBIENT_STRENGTH
+    float specularStrength = 0.5f;  // SPECULAR_STRENGTH, 0 for the NO_SPECULAR variant
+    float shininess = 32.0f;        // SHININESS
+    bool fog = false;               // the FOG variant
+    glm::vec3 fogColor = glm::vec3(0.2f, 0.3f, 0.3f);
+    float fogDensity = 0.015f;
+};
+
+// Per-channel differences between two RGBA8 images of the same size, alpha ignored
+struct ImageDifference {
+    int maxDifference = 0;
+    double meanDifference = 0.0;
+    int pixelsOverTolerance = 0;  // pixels with any channel further apart than the tolerance
+};
+
+ImageDifference compareImages(const uint8_t* a, const uint8_t* b, int width, int height, int tolerance);
+
+// Renders the vertex data a Mesh uploads into an in-memory framebuffer on the
+// CPU, shaded like the default shader, for machines without a GPU. It keeps
+// GL's conventions: clipping to the near and far planes, pixel centers at
+// half coordinates, a depth test of GL_LESS with triangles in draw order and
+// no face culling, and rows bottom to top as glReadPixels returns them.
+//
+// end() runs in stages, on the job system when given one. Vertices are transformed, then
+// triangles are clipped, set up and binned into TILE_SIZE squares in batches
+// of a fixed size, so the result doesn't depend on the thread count. Each
+// tile is then rasterized on its own: edge functions four pixels at a time
+// with SSE, keeping the nearest triangle per pixel, then one shading pass
+// over the tile. Positions snap to 1/256 pixel and shared edges go to one
+// triangle only (top-left rule), so meshes have no cracks or double hits.
+class SoftwareRasterizer {
+public:
+    static const int TILE_SIZE = 64;
+
+    // Without jobs every stage runs on the calling thread
+    explicit SoftwareRasterizer(JobSystem* jobs = nullptr);
+
+    // Starts a frame: sizes the framebuffer, clears it to clearColor and depth 1 and drops queued draws
+    void begin(int width, int height, const glm::vec3& clearColor);
+    // Camera and lighting apply to the whole frame, as of end()
+    void setCamera(const glm::mat4& view, const glm::mat4& projection);
+    void setShading(const PhongShading& shading) { this->shading = shading; }
+    // Queues indexed triangles, as Mesh::draw() draws them with model and objectColor.
+    // The vectors are read by end() and must stay alive until then.
+    void draw(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, const glm::mat4& model,
+              const glm::vec3& objectColor);
+    void end();
+
+    // SSE edge functions where the build has them; off runs the scalar loop, which gives the same image
+    void setSimd(bool enabled) { simd = enabled && isSimdAvailable(); }
+    bool isSimdEnabled() const { return simd; }
+    static bool isSimdAvailable();
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    // RGBA8, rows bottom to top
+    const std::vector<uint8_t>& getColor() const { return color; }
+    // Window depth in [0, 1]
+    const std::vector<float>& getDepth() const { return depth; }
+
+    // Last frame: triangles after clipping that cover a pixel center, and their tile references
+    int getTriangleCount() const { return triangleCount; }
+    int getBinnedCount() const { return static_cast<int>(tileTriangles.size()); }
+
+private:
+    struct DrawCall {
+        const Vertex* vertices;
+        const unsigned int* indices;
+        size_t vertexCount, triangleCount;
+        size_t firstVertex, firstTriangle;  // in the frame's transformed vertices and input triangles
+        glm::mat4 model;
+        glm::mat3 normalModel;  // mat3(model), as the shader transforms normals
+        glm::vec3 color;
+    };
+    struct TransformedVertex {
+        glm::vec4 clip;
+        glm::vec3 world;
+        glm::vec3 normal;
+    };
+    struct Triangle {
+        // Edge i is E(x, y) = A x + B y + C over window coordinates: positive inside,
+        // zero on the edge opposite vertex i, and twice the area at vertex i
+        double edgeA[3], edgeB[3], edgeC[3];
+        double depthA, depthB, depthC;  // window depth plane
+        double inverseArea;             // 1 / twice the area
+        float inverseW[3];
+        glm::vec3 worldOverW[3];
+        glm::vec3 normalOverW[3];
+        int draw;
+        int minX, minY, maxX, maxY;  // pixels whose centers the triangle may cover
+        uint8_t ownedEdges;          // bit i: pixel centers exactly on edge i are inside
+    };
+    // Setup output of a fixed run of input triangles; triangle ids are batch << 16 | index
+    struct TriangleBatch {
+        std::vector<Triangle> triangles;
+        std::vector<uint32_t> binTiles, binTriangles;  // tile references in triangle order
+    };
+
+    JobSystem* jobs;
+    bool simd;
+    int width, height;
+    int tilesX, tilesY;
+    uint8_t clearRgba[4];
+    glm::mat4 view, projection;
+    PhongShading shading;
+
+    std::vector<DrawCall> draws;
+    std::vector<TransformedVertex> transformed;
+    std::vector<TriangleBatch> batches;
+    int triangleCount;
+    // Triangle ids of tile t, in draw order, are tileTriangles[tileStarts[t], tileStarts[t + 1])
+    std::vector<uint32_t> tileStarts, tileTriangles;
+
+    std::vector<uint8_t> color;
+    std::vector<float> depth;
+
+    const Triangle& getTriangle(uint32_t id) const { return batches[id >> 16].triangles[id & 0xffff]; }
+    size_t findDraw(size_t index, bool byTriangle) const;
+    // parallelFor on the jobs, or fn(0, count) without them
+    void runBatches(int count, int minBatch, const std::function<void(int, int)>& fn);
+
+    void transformVertices();
+    void setupBatch(int batch, size_t firstTriangle, size_t endTriangle);
+    // Sutherland-Hodgman against the near, far and guard band planes; returns the vertex count
+    static int clipPolygon(TransformedVertex* polygon, int count, unsigned int planes);
+    // Sets up and bins a triangle of the batch, unless it covers no pixel center
+    void addTriangle(const TransformedVertex& v0, const TransformedVertex& v1, const TransformedVertex& v2,
+                     int drawIndex, int batchIndex);
+    bool setupTriangle(const TransformedVertex& v0, const TransformedVertex& v1, const TransformedVertex& v2,
+                       int drawIndex, Triangle& triangle) const;
+    void binTriangle(const Triangle& triangle, uint32_t id, TriangleBatch& batch) const;
+    void sortBins();
+    void rasterizeTile(int tile);
+    glm::vec3 shadePixel(const Triangle& triangle, int x, int y) const;
+};
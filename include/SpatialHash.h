@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Two bodies whose bounding boxes overlap, a < b
+struct BodyPair {
+    int a;
+    int b;
+};
+
+// Broadphase for upright cylinders (feet position, shared radius and height),
+// hashed by the block column they stand in. The hash is rebuilt every tick with
+// a counting sort, so building, queries and pair finding stay linear in the
+// number of bodies. Bodies are stored sorted by bucket for cache-friendly scans.
+class SpatialHash {
+public:
+    explicit SpatialHash(float cellSize = 1.0f);
+
+    void build(const float* xs, const float* ys, const float* zs, int count, float radius, float height);
+
+    // Bodies whose cylinders reach into the box, sphere or cylinder. Indices are
+    // those passed to build() and are appended to out.
+    void queryBox(const glm::vec3& boxMin, const glm::vec3& boxMax, std::vector<int>& out) const;
+    void queryRadius(const glm::vec3& center, float radius, std::vector<int>& out) const;
+    void queryCylinder(const glm::vec3& feet, float radius, float height, std::vector<int>& out) const;
+
+    // Pairs whose bounding boxes overlap, for a narrowphase cylinder test
+    void findPairs(std::vector<BodyPair>& out) const;
+
+    static bool cylindersOverlap(const glm::vec3& feetA, float radiusA, float heightA,
+                                 const glm::vec3& feetB, float radiusB, float heightB);
+
+    int getBodyCount() const { return static_cast<int>(bodies.size()); }
+    int getBucketCount() const { return static_cast<int>(bucketStart.size()) - 1; }
+    float getCellSize() const { return cellSize; }
+
+private:
+    float cellSize;
+    float inverseCellSize;
+    float radius;
+    float height;
+    uint32_t bucketMask;
+
+    // Per bucket, the first entry in the sorted arrays (one extra at the end)
+    std::vector<int> bucketStart;
+    // Entries sorted by bucket
+    std::vector<float> sortedX, sortedY, sortedZ;
+    std::vector<int> cellX, cellZ;
+    std::vector<int> bodies;        // original index of each entry
+    std::vector<uint32_t> bodyBucket;  // scratch for build()
+
+    int cellOf(float coordinate) const;
+    uint32_t bucketOf(int x, int z) const;
+
+    // Calls visit(entry) once for every body whose cell lies in the range
+    template<typename F>
+    void forEachInCells(int minX, int minZ, int maxX, int maxZ, F&& visit) const;
+};
@@ -0,0 +1,139 @@
+#pragma once
+#include "PermutationTable.h"
+#include <utility>
+
+// Seed policies for StaticPerlinNoise
+
+// Seed known at compile time: the table is built constexpr and shared by all instances
+template<uint32_t Seed>
+struct FixedSeed {
+    static constexpr PermutationTable table = makePermutationTable(Seed);
+
+    constexpr const PermutationTable& permutation() const { return table; }
+};
+
+// Seed chosen at run time: each instance carries its own table inline
+struct RuntimeSeed {
+    PermutationTable table;
+
+    constexpr explicit RuntimeSeed(uint32_t seed) : table(makePermutationTable(seed)) {}
+    constexpr const PermutationTable& permutation() const { return table; }
+};
+
+// Classic Perlin noise with the octave count fixed at compile time, so the
+// octave loop is unrolled and the whole evaluation can run in constant expressions.
+// Output matches PerlinNoise with the same seed bit for bit.
+template<int Octaves, typename SeedPolicy = FixedSeed<0>>
+class StaticPerlinNoise : private SeedPolicy {
+public:
+    static_assert(Octaves >= 1, "StaticPerlinNoise needs at least one octave");
+    static constexpr int octaves = Octaves;
+
+    using SeedPolicy::SeedPolicy;
+    constexpr StaticPerlinNoise() = default;
+
+    constexpr float noise(float x, float y, float z) const {
+        const PermutationTable& p = this->permutation();
+        int xi = fastFloor(x), yi = fastFloor(y), zi = fastFloor(z);
+        x -= static_cast<float>(xi);
+        y -= static_cast<float>(yi);
+        z -= static_cast<float>(zi);
+        int X = xi & 255, Y = yi & 255, Z = zi & 255;
+
+        float u = fade(x), v = fade(y), w = fade(z);
+
+        int A  = p[X] + Y;
+        int AA = p[A] + Z;
+        int AB = p[A + 1] + Z;
+        int B  = p[X + 1] + Y;
+        int BA = p[B] + Z;
+        int BB = p[B + 1] + Z;
+
+        return lerp(w, lerp(v, lerp(u, grad(p[AA], x, y, z),
+                                       grad(p[BA], x - 1, y, z)),
+                               lerp(u, grad(p[AB], x, y - 1, z),
+                                       grad(p[BB], x - 1, y - 1, z))),
+                       lerp(v, lerp(u, grad(p[AA + 1], x, y, z - 1),
+                                       grad(p[BA + 1], x - 1, y, z - 1)),
+                               lerp(u, grad(p[AB + 1], x, y - 1, z - 1),
+                                       grad(p[BB + 1], x - 1, y - 1, z - 1))));
+    }
+
+    // The z = 0 slice of the 3D noise: fade(0) is 0, so only the four corners of
+    // the near face contribute and the far face is skipped
+    constexpr float noise(float x, float y) const {
+        const PermutationTable& p = this->permutation();
+        int xi = fastFloor(x), yi = fastFloor(y);
+        x -= static_cast<float>(xi);
+        y -= static_cast<float>(yi);
+        int X = xi & 255, Y = yi & 255;
+
+        float u = fade(x), v = fade(y);
+
+        int A  = p[X] + Y;
+        int B  = p[X + 1] + Y;
+
+        return lerp(v, lerp(u, grad(p[p[A]], x, y, 0.0f),
+                               grad(p[p[B]], x - 1, y, 0.0f)),
+                       lerp(u, grad(p[p[A + 1]], x, y - 1, 0.0f),
+                               grad(p[p[B + 1]], x - 1, y - 1, 0.0f)));
+    }
+
+    constexpr float octaveNoise(float x, float y, float persistence, float lacunarity) const {
+        return accumulate(std::make_integer_sequence<int, Octaves>(), persistence, lacunarity,
+                          [this, x, y](float frequency) { return noise(x * frequency, y * frequency); });
+    }
+
+    constexpr float octaveNoise(float x, float y, float z, float persistence, float lacunarity) const {
+        return accumulate(std::make_integer_sequence<int, Octaves>(), persistence, lacunarity,
+                          [this, x, y, z](float frequency) {
+                              return noise(x * frequency, y * frequency, z * frequency);
+                          });
+    }
+
+private:
+    template<int... I, typename Sample>
+    static constexpr float accumulate(std::integer_sequence<int, I...>, float persistence, float lacunarity,
+                                      Sample sample) {
+        float total = 0.0f;
+        float frequency = 1.0f;
+        float amplitude = 1.0f;
+        float maxValue = 0.0f;
+
+        // Same operation order as PerlinNoise::octaveNoise, expanded once per octave
+        ((static_cast<void>(I),
+          total += sample(frequency) * amplitude,
+          maxValue += amplitude,
+          amplitude *= persistence,
+          frequency *= lacunarity), ...);
+
+        return total / maxValue;
+    }
+
+    // std::floor is not constexpr before C++23
+    static constexpr int fastFloor(float x) {
+        int i = static_cast<int>(x);
+        return i - static_cast<int>(x < static_cast<float>(i));
+    }
+
+    static constexpr float fade(float t) {
+        return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+    }
+
+    static constexpr float lerp(float t, float a, float b) {
+        return a + t * (b - a);
+    }
+
+    // Branch-free form of PerlinNoise::grad: the same 12 edge directions (plus 4
+    // repeats) as a table, giving identical sums
+    static constexpr float grad(int hash, float x, float y, float z) {
+        constexpr signed char gradients[16][3] = {
+            { 1,  1,  0}, {-1,  1,  0}, { 1, -1,  0}, {-1, -1,  0},
+            { 1,  0,  1}, {-1,  0,  1}, { 1,  0, -1}, {-1,  0, -1},
+            { 0,  1,  1}, { 0, -1,  1}, { 0,  1, -1}, { 0, -1, -1},
+            { 1,  1,  0}, { 0, -1,  1}, {-1,  1,  0}, { 0, -1, -1}
+        };
+        const signed char* g = gradients[hash & 15];
+        return g[0] * x + g[1] * y + g[2] * z;
+    }
+};
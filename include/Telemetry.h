@@ -0,0 +1,95 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Live frame telemetry in a named shared-memory block: one process publishes
+// a frame at a time into a ring, any number of others read it without locks.
+// The layout is versioned; readers refuse blocks of any other version.
+const uint32_t TELEMETRY_VERSION = 1;
+const int TELEMETRY_RING_FRAMES = 1024;
+// Frame time histogram: 0.25 ms buckets, the last one holds everything slower
+const int TELEMETRY_HISTOGRAM_BUCKETS = 128;
+const float TELEMETRY_BUCKET_MILLISECONDS = 0.25f;
+const char* const TELEMETRY_DEFAULT_NAME = "/rendering3d-telemetry";
+
+// Shared layout, defined in Telemetry.cpp
+struct TelemetryBlock;
+
+// Per-frame counters; new ones go at the end along with a version bump
+enum TelemetryCounter {
+    TELEMETRY_DRAW_CALLS,
+    TELEMETRY_TRIANGLES,
+    TELEMETRY_CHUNKS_RESIDENT,   // chunks with an uploaded mesh
+    TELEMETRY_CHUNKS_DRAWN,
+    TELEMETRY_TICKS,             // simulation ticks run this frame
+    TELEMETRY_COLLISION_CHECKS,  // player block probes over those ticks
+    TELEMETRY_ALLOCATIONS,
+    TELEMETRY_COUNTER_COUNT
+};
+
+// One published frame
+struct TelemetryFrame {
+    uint64_t frame;              // 0 for the first published frame
+    uint64_t timeMicroseconds;   // since the publisher opened the block
+    float frameMilliseconds;     // wall time since the previous frame
+    float cpuMilliseconds;       // frame loop work before the buffer swap
+    uint32_t counters[TELEMETRY_COUNTER_COUNT];
+};
+
+// Creates the block and writes frames into it. Not thread safe: publish from one thread.
+class TelemetryPublisher {
+public:
+    TelemetryPublisher();
+    ~TelemetryPublisher();
+    TelemetryPublisher(const TelemetryPublisher&) = delete;
+    TelemetryPublisher& operator=(const TelemetryPublisher&) = delete;
+
+    // Replaces any block left behind under the same name
+    bool open(const std::string& name = TELEMETRY_DEFAULT_NAME);
+    // Marks the block closed for readers and removes the name
+    void close();
+    bool isOpen() const { return block != nullptr; }
+
+    // Counters collect into the pending frame until publishFrame()
+    void setCounter(TelemetryCounter counter, uint32_t value) { pending.counters[counter] = value; }
+    void addCounter(TelemetryCounter counter, uint32_t value) { pending.counters[counter] += value; }
+    // Copies the pending frame into the ring and clears its counters; no system calls, no allocation
+    void publishFrame(float frameMilliseconds, float cpuMilliseconds);
+
+private:
+    TelemetryBlock* block;
+    void* handle;        // platform mapping handle
+    std::string name;
+    TelemetryFrame pending;
+    uint64_t frameCount;
+    uint64_t openMicroseconds;
+};
+
+// Maps an existing block read-only
+class TelemetryReader {
+public:
+    TelemetryReader();
+    ~TelemetryReader();
+    TelemetryReader(const TelemetryReader&) = delete;
+    TelemetryReader& operator=(const TelemetryReader&) = delete;
+
+    bool open(const std::string& name = TELEMETRY_DEFAULT_NAME);
+    void close();
+    bool isOpen() const { return block != nullptr; }
+
+    // Appends the frames published after the first `cursor` frames and returns
+    // the new cursor. Frames the ring already overwrote are skipped.
+    uint64_t readFrames(uint64_t cursor, std::vector<TelemetryFrame>& frames) const;
+    uint64_t getFramesPublished() const;
+    // Frame time histogram over every published frame
+    void readHistogram(uint64_t (&buckets)[TELEMETRY_HISTOGRAM_BUCKETS]) const;
+    // The publisher closed the block (a crashed one just stops publishing)
+    bool isClosed() const;
+
+private:
+    const TelemetryBlock* block;
+    void* handle;
+};
+
+const char* getTelemetryCounterName(TelemetryCounter counter);
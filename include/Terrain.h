@@ -1,25 +1,104 @@
 #pragma once
-#include "Cube.h"
-#include "Shader.h"
+#include "Chunk.h"
+#include "DensityField.h"
+#include "HeightPyramid.h"
 #include "PerlinNoise.h"
+#include "SimplexNoise.h"
+#include "VoxelLighting.h"
+#include <cstdint>
 #include <vector>
 #include <glm/glm.hpp>
 
+enum TerrainGenerator {
+    TERRAIN_HEIGHTMAP,  // 2D noise heightfield, one solid column per (x, z)
+    TERRAIN_DENSITY     // 3D density field with overhangs and caves
+};
+
+enum DensitySampling {
+    DENSITY_LATTICE,    // noise on a coarse lattice, interpolated per voxel
+    DENSITY_PER_VOXEL   // noise at every voxel (reference, much slower)
+};
+
+enum NoiseBackend {
+    NOISE_PERLIN,       // classic Perlin, 8 corners per sample
+    NOISE_SIMPLEX       // simplex lattice, 3 corners in 2D and 4 in 3D
+};
+
+// How batched surface queries read the heightfield
+enum HeightSampling {
+    HEIGHT_NEAREST,     // height of the column the point is in
+    HEIGHT_BILINEAR     // blend of the four nearest column centers
+};
+
+// How raycasts find the first solid block; both give the same hits
+enum RaycastMethod {
+    RAYCAST_DDA,        // visit every block along the ray
+    RAYCAST_PYRAMID     // skip columns the ray passes over using the max-height pyramid
+};
+
+// Noise fields that make up the world; each can use its own backend
+enum TerrainLayer {
+    LAYER_HEIGHT,       // heightfield (TERRAIN_HEIGHTMAP)
+    LAYER_DENSITY,      // 3D ground shape (TERRAIN_DENSITY)
+    LAYER_CAVES,        // cave carving (TERRAIN_DENSITY)
+    TERRAIN_LAYER_COUNT
+};
+
 class Terrain {
 public:
     Terrain(int width, int height, float scale = 1.0f);
     ~Terrain();
-    
+
     void generate();
-    void draw(Shader& shader);
+    // Height of the column containing (x, z), or baseHeight outside the world
     float getHeightAt(float x, float z) const;
+    // Batched getHeightAt plus surface normals and the top block of each
+    // column. Any output may be null. Columns outside the world count as
+    // baseHeight high with no surface block (BLOCK_AIR).
+    void querySurface(const float* xs, const float* zs, int count, HeightSampling sampling, float* heights,
+                      glm::vec3* normals, uint8_t* surfaceBlockTypes) const;
     bool isInBounds(int x, int z) const;
     bool hasBlockAt(int x, int y, int z) const;
-    
+
+    // Voxel access in world block coordinates
+    uint8_t getBlock(int x, int y, int z) const;
+    bool setBlock(int x, int y, int z, uint8_t type);
+    int getSunLight(int x, int y, int z) const;
+    int getBlockLight(int x, int y, int z) const;
+
+    // First solid block along a ray; previousBlock is the empty cell before the hit.
+    // A block counts if the ray enters it before maxDistance, not if it only touches it there.
+    bool raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+                 glm::ivec3& hitBlock, glm::ivec3& previousBlock, RaycastMethod method = RAYCAST_DDA) const;
+    // True when no solid block lies on the segment, counting the blocks that hold either end
+    // unless the segment only touches one at to
+    bool hasLineOfSight(const glm::vec3& from, const glm::vec3& to, RaycastMethod method = RAYCAST_PYRAMID) const;
+    // Column heights and their maxima, kept up to date through edits
+    const HeightPyramid& getHeightPyramid() const { return heightPyramid; }
+
+    // Grid coordinates: x in [0, width), y in [0, worldHeight), z in [0, height)
+    bool isGridInside(int gx, int gy, int gz) const;
+    uint8_t getGridBlock(int gx, int gy, int gz) const;
+    int getGridOffsetX() const { return width / 2; }
+    int getGridOffsetZ() const { return height / 2; }
+    const VoxelLighting& getLighting() const { return lighting; }
+
+    // Rebuild meshes of chunks whose blocks or light changed (maxChunks < 0 = all)
+    int updateDirtyChunks(int maxChunks = -1);
+    const std::vector<Chunk>& getChunks() const { return chunks; }
+    // Changes whenever any chunk is created or remeshed
+    unsigned long long getMeshRevision() const { return meshRevision; }
+    glm::vec3 getChunkOrigin(const Chunk& chunk) const;
+    // Chunks along x, y and z; chunk (x, y, z) is at index (y * z count + z) * x count + x
+    glm::ivec3 getChunkCounts() const { return glm::ivec3(chunksX, chunksY, chunksZ); }
+
+    static glm::vec3 getBlockColor(uint8_t type);
+
     // Getters
     int getWidth() const { return width; }
     int getHeight() const { return height; }
-    
+    int getWorldHeight() const { return worldHeight; }
+
     // Terrain properties
     void setScale(float scale);
     void setOctaves(int octaves);
@@ -27,26 +106,64 @@ public:
     void setLacunarity(float lacunarity);
     void setBaseHeight(float baseHeight);
     void setHeightMultiplier(float heightMultiplier);
+    void setWorldHeight(int worldHeight);
+    void setGenerator(TerrainGenerator generator);
+    void setDensitySampling(DensitySampling sampling);
+    void setCaveThreshold(float caveThreshold);
+    void setNoiseBackend(TerrainLayer layer, NoiseBackend backend);
+    void setSeed(unsigned int seed);
+    // Noise position of grid (0, 0), so a large world can be generated as
+    // separate tiles that line up; multiples of CHUNK_SIZE keep density tiles seamless
+    void setNoiseOrigin(int x, int z);
+    const NoiseGenerator& getLayerNoise(TerrainLayer layer) const;
+    DensitySettings getDensitySettings() const;
 
 private:
     int width, height;
+    int worldHeight;
     float scale;
     float baseHeight;
     float heightMultiplier;
     int octaves;
     float persistence;
     float lacunarity;
-    
-    std::vector<std::vector<float>> heightMap;
-    std::vector<glm::vec3> cubePositions;
-    std::vector<glm::vec3> cubeColors;
-    
-    Cube cube;
+    TerrainGenerator generator;
+    DensitySampling densitySampling;
+    float caveThreshold;
+    unsigned int seed;
+    int noiseOriginX, noiseOriginZ;
+
+    std::vector<float> heightMap;        // width * height columns, x fastest
+    std::vector<uint8_t> surfaceBlocks;  // top solid block of each column
+    HeightPyramid heightPyramid;         // over heightMap
+    std::vector<uint8_t> blocks;
+    VoxelLighting lighting;
+
+    std::vector<Chunk> chunks;
+    int chunksX, chunksY, chunksZ;
+    unsigned long long meshRevision;
+
     PerlinNoise noiseGenerator;
-    
+    SimplexNoise simplexNoise;
+    NoiseBackend layerBackends[TERRAIN_LAYER_COUNT];
+
     void generateHeightMap();
-    void generateCubes();
-    glm::vec3 getTerrainColor(float height) const;
-    bool isFaceVisible(int x, int y, int z, int face) const;
-    void drawCubeWithFaceCulling(Shader& shader, const glm::vec3& position, const glm::vec3& color);
-}; 
\ No newline at end of file
+    void generateBlocks();
+    void generateDensityBlocks();
+    void createChunks();
+    uint8_t getBlockTypeForHeight(int y) const;
+    void updateColumnHeight(int gx, int gz);
+    bool raycastDda(const glm::vec3& origin, const glm::vec3& dir, float maxDistance,
+                    glm::ivec3& hitBlock, glm::ivec3& previousBlock) const;
+    bool raycastPyramid(const glm::vec3& origin, const glm::vec3& dir, float maxDistance,
+                        glm::ivec3& hitBlock, glm::ivec3& previousBlock) const;
+    float getColumnHeight(int gx, int gz) const {
+        return isInBounds(gx, gz) ? heightMap[static_cast<size_t>(gz) * width + gx] : baseHeight;
+    }
+    void querySurfaceScalar(float x, float z, HeightSampling sampling, float* height, glm::vec3* normal,
+                            uint8_t* surfaceBlock) const;
+    void markChunksDirty(const glm::ivec3& gridMin, const glm::ivec3& gridMax);
+    size_t gridIndex(int gx, int gy, int gz) const {
+        return (static_cast<size_t>(gy) * height + gz) * width + gx;
+    }
+};
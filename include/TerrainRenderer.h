@@ -0,0 +1,44 @@
+#pragma once
+#include "ChunkMesh.h"
+#include "ChunkVisibility.h"
+#include "Shader.h"
+#include "Terrain.h"
+#include <memory>
+#include <vector>
+
+// Keeps GPU meshes of Terrain's chunks in sync and draws them
+class TerrainRenderer {
+public:
+    // Texture unit the block material array is bound to while drawing
+    static const int MATERIAL_TEXTURE_UNIT = 5;
+
+    // Needs a GL context: builds the block material texture array
+    explicit TerrainRenderer(Terrain& terrain);
+    ~TerrainRenderer();
+    TerrainRenderer(const TerrainRenderer&) = delete;
+    TerrainRenderer& operator=(const TerrainRenderer&) = delete;
+
+    // Remesh up to maxChunkUpdates dirty chunks (< 0 = all) and upload the results,
+    // returns how many chunk meshes changed
+    int update(int maxChunkUpdates = 8);
+    // Expects a PACKED_VERTEX shader variant. Draws only the visible chunks
+    // when given a visibility set, e.g. not for shadow maps.
+    void draw(Shader& shader, const ChunkVisibility* visibility = nullptr);
+
+    // Counts from the last draw()
+    int getDrawCalls() const { return drawCalls; }
+    int getTrianglesDrawn() const { return trianglesDrawn; }
+    int getResidentChunks() const { return residentChunks; }
+
+private:
+    Terrain& terrain;
+    std::vector<std::unique_ptr<ChunkMesh>> meshes;
+    std::vector<unsigned int> uploadedRevisions;
+    int drawCalls;
+    int trianglesDrawn;
+    int residentChunks;
+    // GL_TEXTURE_2D_ARRAY with one mipmapped layer per MaterialLayer
+    unsigned int materialTexture;
+
+    void createMaterialTexture();
+};
@@ -0,0 +1,9 @@
+#pragma once
+#include <glm/glm.hpp>
+
+// Vertex of a Mesh, also read by the software rasterizer without GL
+struct Vertex {
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 texCoords;
+};
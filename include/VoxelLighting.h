@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+class Terrain;
+
+const int MAX_LIGHT_LEVEL = 15;
+
+// BFS flood-fill sunlight and block light over Terrain's voxel grid.
+// One byte per block: sun light in the high nibble, block light in the low nibble.
+// All coordinates are grid coordinates (see Terrain::getGridBlock).
+class VoxelLighting {
+public:
+    explicit VoxelLighting(const Terrain& terrain);
+
+    void resize(int sizeX, int sizeY, int sizeZ);
+
+    // Relight the whole grid from scratch
+    void computeAll();
+    // Re-propagate light around one changed block, touching only the affected region
+    void onBlockChanged(int x, int y, int z, uint8_t oldBlock, uint8_t newBlock);
+
+    int getSunLight(int x, int y, int z) const;
+    int getBlockLight(int x, int y, int z) const;
+
+    // Inclusive bounds of cells whose light changed since resetChanges()
+    bool hasChanges() const { return changed; }
+    glm::ivec3 getChangedMin() const { return changedMin; }
+    glm::ivec3 getChangedMax() const { return changedMax; }
+    void resetChanges();
+
+private:
+    enum Channel { SUN = 0, BLOCK = 1 };
+
+    struct LightNode {
+        int x, y, z;
+        int level;
+    };
+
+    const Terrain& terrain;
+    int sizeX, sizeY, sizeZ;
+    std::vector<uint8_t> light;
+
+    std::vector<LightNode> addQueue;
+    std::vector<LightNode> removeQueue;
+
+    bool changed;
+    glm::ivec3 changedMin;
+    glm::ivec3 changedMax;
+
+    bool isInside(int x, int y, int z) const;
+    int index(int x, int y, int z) const { return (y * sizeZ + z) * sizeX + x; }
+    int getLevel(Channel channel, int x, int y, int z) const;
+    void setLevel(Channel channel, int x, int y, int z, int level);
+
+    void propagate(Channel channel);
+    void propagateRemoval(Channel channel);
+};
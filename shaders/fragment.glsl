@@ -4,31 +4,191 @@ out vec4 FragColor;
 in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoords;
+#ifdef INSTANCED
+in vec3 BaseColor;
+#endif
+#ifdef PACKED_VERTEX
+flat in uint MaterialLayer;
+uniform sampler2DArray blockTextures;
+#endif
+#ifdef BAKED_LIGHT
+in vec3 BakedSun;
+in vec3 BakedLight;
+#endif
+#if defined(CLUSTERED) || defined(SHADOWS)
+in float ViewDepth;
+#endif
+
+// Lighting constants, overridable through ShaderLibrary::setDefine
+#ifndef AMBIENT_STRENGTH
+#define AMBIENT_STRENGTH 0.1
+#endif
+#ifndef SPECULAR_STRENGTH
+#define SPECULAR_STRENGTH 0.5
+#endif
+#ifndef SHININESS
+#define SHININESS 32.0
+#endif
+#ifndef SHADOW_SUN_FLOOR
+#define SHADOW_SUN_FLOOR 0.45
+#endif
 
 uniform vec3 lightPos;
 uniform vec3 viewPos;
 uniform vec3 lightColor;
+#if !defined(INSTANCED) && !defined(PACKED_VERTEX)
 uniform vec3 objectColor;
+#endif
+#ifdef FOG
+uniform vec3 fogColor;
+uniform float fogDensity;
+#endif
+
+#ifdef CLUSTERED
+// Grid dimensions come from ClusteredLighting through ShaderLibrary::setDefine
+uniform samplerBuffer pointLightData;       // position + radius, color + intensity
+uniform usamplerBuffer clusterGrid;         // offset, count
+uniform usamplerBuffer clusterLightIndices;
+uniform vec2 viewportSize;
+uniform float clusterScale;
+uniform float clusterBias;
+
+vec3 shadeClusteredLights(vec3 norm)
+{
+    int slice = clamp(int(log(ViewDepth) * clusterScale + clusterBias), 0, CLUSTER_GRID_Z - 1);
+    ivec2 tile = ivec2(gl_FragCoord.xy / viewportSize * vec2(CLUSTER_GRID_X, CLUSTER_GRID_Y));
+    tile = clamp(tile, ivec2(0), ivec2(CLUSTER_GRID_X - 1, CLUSTER_GRID_Y - 1));
+    int cluster = (slice * CLUSTER_GRID_Y + tile.y) * CLUSTER_GRID_X + tile.x;
+
+    uvec2 range = texelFetch(clusterGrid, cluster).xy;
+    vec3 total = vec3(0.0);
+    for (uint i = 0u; i < range.y; i++) {
+        int lightIndex = int(texelFetch(clusterLightIndices, int(range.x + i)).x);
+        vec4 positionRadius = texelFetch(pointLightData, lightIndex * 2);
+        vec4 colorIntensity = texelFetch(pointLightData, lightIndex * 2 + 1);
+
+        vec3 toLight = positionRadius.xyz - FragPos;
+        float distanceSquared = dot(toLight, toLight);
+        float radiusSquared = positionRadius.w * positionRadius.w;
+        if (distanceSquared >= radiusSquared) {
+            continue;
+        }
+
+        // Smooth falloff reaching zero at the light radius
+        float falloff = 1.0 - distanceSquared / radiusSquared;
+        falloff *= falloff;
+        float diff = max(dot(norm, toLight * inversesqrt(max(distanceSquared, 0.0001))), 0.0);
+        total += colorIntensity.rgb * colorIntensity.a * diff * falloff;
+    }
+    return total;
+}
+#endif
+
+#ifdef SHADOWS
+// Cascade count comes from ShadowCascades through ShaderLibrary::setDefine
+uniform sampler2DArrayShadow shadowMap;
+uniform mat4 lightSpaceMatrices[SHADOW_CASCADES];
+uniform float cascadeSplits[SHADOW_CASCADES];
+uniform vec3 sunDirection; // direction the sunlight travels
+
+// 1 = fully lit by the sun, 0 = in shadow
+float sampleSunVisibility(vec3 norm)
+{
+    // Faces turned away from the sun are always in shadow
+    if (dot(norm, -sunDirection) <= 0.0) {
+        return 0.0;
+    }
+    // Beyond the last cascade everything is lit
+    if (ViewDepth >= cascadeSplits[SHADOW_CASCADES - 1]) {
+        return 1.0;
+    }
+
+    int cascade = SHADOW_CASCADES - 1;
+    for (int i = 0; i < SHADOW_CASCADES; i++) {
+        if (ViewDepth < cascadeSplits[i]) {
+            cascade = i;
+            break;
+        }
+    }
+
+    // Normal offset keeps lit faces from shadowing themselves
+    vec4 lightSpacePos = lightSpaceMatrices[cascade] * vec4(FragPos + norm * 0.05, 1.0);
+    vec3 coords = lightSpacePos.xyz / lightSpacePos.w * 0.5 + 0.5;
+
+    // 2x2 PCF on top of the hardware comparison
+    vec2 texelSize = 1.0 / vec2(textureSize(shadowMap, 0).xy);
+    float visibility = 0.0;
+    for (int x = 0; x < 2; x++) {
+        for (int y = 0; y < 2; y++) {
+            vec2 offset = (vec2(x, y) - 0.5) * texelSize;
+            visibility += texture(shadowMap, vec4(coords.xy + offset, float(cascade), coords.z));
+        }
+    }
+    return visibility * 0.25;
+}
+#endif
 
 void main()
 {
+#ifdef DEPTH_ONLY
+    // Shadow pass: only depth matters
+    FragColor = vec4(1.0);
+#else
+#if defined(PACKED_VERTEX)
+    vec3 baseColor = texture(blockTextures, vec3(TexCoords, float(MaterialLayer))).rgb;
+#elif defined(INSTANCED)
+    vec3 baseColor = BaseColor;
+#else
+    vec3 baseColor = objectColor;
+#endif
+
+#ifdef BAKED_LIGHT
+    // Light and occlusion were propagated on the CPU and interpolated per vertex
+#ifdef SHADOWS
+    float sunVisibility = mix(SHADOW_SUN_FLOOR, 1.0, sampleSunVisibility(normalize(Normal)));
+#else
+    float sunVisibility = 1.0;
+#endif
+    vec3 lighting = max(BakedSun * sunVisibility, BakedLight);
+#ifdef CLUSTERED
+    lighting += shadeClusteredLights(normalize(Normal));
+#endif
+    vec3 result = lighting * baseColor;
+#else
     // Ambient
-    float ambientStrength = 0.1;
-    vec3 ambient = ambientStrength * lightColor;
+    vec3 ambient = AMBIENT_STRENGTH * lightColor;
 
     // Diffuse
     vec3 norm = normalize(Normal);
     vec3 lightDir = normalize(lightPos - FragPos);
     float diff = max(dot(norm, lightDir), 0.0);
     vec3 diffuse = diff * lightColor;
+#ifdef SHADOWS
+    diffuse *= sampleSunVisibility(norm);
+#endif
+#ifdef CLUSTERED
+    diffuse += shadeClusteredLights(norm);
+#endif
 
+#ifdef NO_SPECULAR
+    vec3 result = (ambient + diffuse) * baseColor;
+#else
     // Specular
-    float specularStrength = 0.5;
     vec3 viewDir = normalize(viewPos - FragPos);
     vec3 reflectDir = reflect(-lightDir, norm);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
-    vec3 specular = specularStrength * spec * lightColor;
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), SHININESS);
+    vec3 specular = SPECULAR_STRENGTH * spec * lightColor;
+
+    vec3 result = (ambient + diffuse + specular) * baseColor;
+#endif
+#endif
+
+#ifdef FOG
+    float fogDistance = length(viewPos - FragPos);
+    float fogFactor = exp(-pow(fogDensity * fogDistance, 2.0));
+    result = mix(fogColor, result, clamp(fogFactor, 0.0, 1.0));
+#endif
 
-    vec3 result = (ambient + diffuse + specular) * objectColor;
     FragColor = vec4(result, 1.0);
+#endif
 }
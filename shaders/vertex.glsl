@@ -1,21 +1,110 @@
 #version 330 core
+#ifdef PACKED_VERTEX
+layout (location = 0) in uvec2 aPacked;
+#else
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
+#endif
+#ifdef INSTANCED
+layout (location = 3) in vec3 aInstanceOffset;
+layout (location = 4) in vec3 aInstanceColor;
+#endif
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoords;
+#ifdef INSTANCED
+out vec3 BaseColor;
+#endif
+#ifdef PACKED_VERTEX
+flat out uint MaterialLayer;
+#endif
+#ifdef BAKED_LIGHT
+out vec3 BakedSun;
+out vec3 BakedLight;
+#endif
+#if defined(CLUSTERED) || defined(SHADOWS)
+out float ViewDepth;
+#endif
 
+#ifdef PACKED_VERTEX
+uniform vec3 chunkOrigin;
+#elif !defined(INSTANCED)
 uniform mat4 model;
+#endif
+#ifdef NORMAL_MATRIX
+uniform mat3 normalMatrix;
+#endif
 uniform mat4 view;
 uniform mat4 projection;
 
+#ifdef BAKED_LIGHT
+uniform float sunBrightness;
+uniform vec3 blockLightColor;
+
+float lightCurve(uint level)
+{
+    // Each step away from a source dims light by 20%
+    return pow(0.8, float(15u - level));
+}
+#endif
+
+#ifdef PACKED_VERTEX
+const vec3 faceNormals[6] = vec3[6](
+    vec3( 0.0,  0.0,  1.0), vec3( 0.0,  0.0, -1.0),
+    vec3(-1.0,  0.0,  0.0), vec3( 1.0,  0.0,  0.0),
+    vec3( 0.0,  1.0,  0.0), vec3( 0.0, -1.0,  0.0));
+#endif
+
 void main()
 {
+#if defined(PACKED_VERTEX)
+    // data0: x(5) y(5) z(5) normal(3) ao(2), data1: material(8) sun(4) block light(4)
+    uint data0 = aPacked.x;
+    uint data1 = aPacked.y;
+    vec3 localPos = vec3(float(data0 & 31u), float((data0 >> 5) & 31u), float((data0 >> 10) & 31u));
+    uint normalIndex = (data0 >> 15) & 7u;
+
+    FragPos = chunkOrigin + localPos;
+    Normal = faceNormals[normalIndex];
+    MaterialLayer = data1 & 255u;
+    // World-aligned coordinates repeat the texture once per block on every face
+    TexCoords = normalIndex >= 4u ? FragPos.xz : (normalIndex >= 2u ? FragPos.zy : FragPos.xy);
+
+#ifdef BAKED_LIGHT
+    uint ao = (data0 >> 18) & 3u;
+    uint sunLevel = (data1 >> 8) & 15u;
+    uint blockLevel = (data1 >> 12) & 15u;
+
+    // Fixed per-direction shading keeps block edges readable without a light vector
+    const float faceShade[6] = float[6](0.8, 0.8, 0.7, 0.7, 1.0, 0.5);
+    float aoFactor = 0.4 + 0.2 * float(ao);
+    float shade = faceShade[normalIndex] * aoFactor;
+    // Sun and block light stay separate so shadows can only darken the sun
+    BakedSun = vec3(lightCurve(sunLevel) * sunBrightness) * shade;
+    BakedLight = max(lightCurve(blockLevel) * blockLightColor, vec3(0.03)) * shade;
+#endif
+#elif defined(INSTANCED)
+    // Instances are translated copies, so normals need no transform
+    FragPos = aPos + aInstanceOffset;
+    Normal = aNormal;
+    BaseColor = aInstanceColor;
+    TexCoords = aTexCoords;
+#else
     FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+#ifdef NORMAL_MATRIX
+    Normal = normalMatrix * aNormal;
+#else
+    // Valid for rotation/translation/uniform scale, normalize() in the fragment shader fixes length
+    Normal = mat3(model) * aNormal;
+#endif
     TexCoords = aTexCoords;
-    
-    gl_Position = projection * view * vec4(FragPos, 1.0);
+#endif
+
+    vec4 viewPos = view * vec4(FragPos, 1.0);
+#if defined(CLUSTERED) || defined(SHADOWS)
+    ViewDepth = -viewPos.z;
+#endif
+    gl_Position = projection * viewPos;
 }
@@ -0,0 +1,316 @@
+#include "AgentSimulation.h"
+#include <algorithm>
+#include <cmath>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define AGENTS_USE_SSE 1
+#endif
+
+namespace {
+    // Longer frames are split so no agent moves a whole block in one step
+    const float MAX_STEP = 1.0f / 30.0f;
+    const int DEFAULT_BATCH = 256;
+    // Broadphase pairs reserved per agent before the pair list has to grow
+    const int PAIRS_PER_AGENT = 4;
+
+    // Wander headings: 16 directions around the circle
+    const float HEADINGS[16][2] = {
+        { 1.000000f,  0.000000f}, { 0.923880f,  0.382683f}, { 0.707107f,  0.707107f}, { 0.382683f,  0.923880f},
+        { 0.000000f,  1.000000f}, {-0.382683f,  0.923880f}, {-0.707107f,  0.707107f}, {-0.923880f,  0.382683f},
+        {-1.000000f,  0.000000f}, {-0.923880f, -0.382683f}, {-0.707107f, -0.707107f}, {-0.382683f, -0.923880f},
+        { 0.000000f, -1.000000f}, { 0.382683f, -0.923880f}, { 0.707107f, -0.707107f}, { 0.923880f, -0.382683f}
+    };
+
+    inline int floorToInt(float x) {
+        return static_cast<int>(std::floor(x));
+    }
+}
+
+AgentSimulation::AgentSimulation(const Terrain& terrain, JobSystem& jobs)
+    : terrain(terrain), jobs(jobs), batchSize(DEFAULT_BATCH), contactCount(0) {
+    // Agents touching the player in one tick; more only grows the list once
+    queryResults.reserve(64);
+}
+
+int AgentSimulation::addAgent(const glm::vec3& position, uint32_t seed) {
+    positionX.push_back(position.x);
+    positionY.push_back(position.y);
+    positionZ.push_back(position.z);
+    velocityX.push_back(0.0f);
+    velocityY.push_back(0.0f);
+    velocityZ.push_back(0.0f);
+    headingX.push_back(0.0f);
+    headingZ.push_back(0.0f);
+    // xorshift must not start at zero
+    randomState.push_back(seed * 2654435761u | 1u);
+    wanderTimer.push_back(0);
+    flags.push_back(0);
+    return getAgentCount() - 1;
+}
+
+void AgentSimulation::spawnRandom(int count, uint32_t seed) {
+    uint32_t state = seed * 2654435761u | 1u;
+    auto next = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    };
+
+    // Pick every spawn point first, then look the ground up in one batch
+    int halfWidth = terrain.getWidth() / 2;
+    int halfDepth = terrain.getHeight() / 2;
+    std::vector<float> xs(count), zs(count), ground(count);
+    std::vector<uint32_t> seeds(count);
+    for (int i = 0; i < count; i++) {
+        // Stay a block away from the world edge
+        xs[i] = static_cast<float>(static_cast<int>(next() % static_cast<uint32_t>(terrain.getWidth() - 2)) - halfWidth + 1);
+        zs[i] = static_cast<float>(static_cast<int>(next() % static_cast<uint32_t>(terrain.getHeight() - 2)) - halfDepth + 1);
+        seeds[i] = next();
+    }
+    terrain.querySurface(xs.data(), zs.data(), count, HEIGHT_NEAREST, ground.data(), nullptr, nullptr);
+    for (int i = 0; i < count; i++) {
+        addAgent(glm::vec3(xs[i] + 0.5f, ground[i] + 0.01f, zs[i] + 0.5f), seeds[i]);
+    }
+}
+
+void AgentSimulation::clear() {
+    for (std::vector<float>* array : {&positionX, &positionY, &positionZ, &velocityX, &velocityY, &velocityZ,
+                                      &headingX, &headingZ}) {
+        array->clear();
+    }
+    randomState.clear();
+    wanderTimer.clear();
+    flags.clear();
+}
+
+glm::vec3 AgentSimulation::getPosition(int agent) const {
+    return glm::vec3(positionX[agent], positionY[agent], positionZ[agent]);
+}
+
+glm::vec3 AgentSimulation::getVelocity(int agent) const {
+    return glm::vec3(velocityX[agent], velocityY[agent], velocityZ[agent]);
+}
+
+void AgentSimulation::update(float deltaTime) {
+    int count = getAgentCount();
+    if (count == 0 || deltaTime <= 0.0f) {
+        return;
+    }
+
+    int steps = std::max(1, static_cast<int>(std::ceil(deltaTime / MAX_STEP)));
+    float step = deltaTime / steps;
+    for (int i = 0; i < steps; i++) {
+        // Agents don't interact, so each batch runs the whole tick for its range
+        jobs.parallelFor(count, batchSize, [this, step](int begin, int end) {
+            steer(begin, end);
+            integrate(begin, end, step);
+            collide(begin, end, step);
+        });
+    }
+    separate();
+}
+
+void AgentSimulation::separate() {
+    int count = getAgentCount();
+    broadphase.build(positionX.data(), positionY.data(), positionZ.data(), count, settings.radius, settings.height);
+    pairs.clear();
+    // Crowds bunch up over time; reserving for a dense crowd up front keeps
+    // the pair list from growing (and allocating) mid-simulation
+    pairs.reserve(static_cast<size_t>(count) * PAIRS_PER_AGENT);
+    broadphase.findPairs(pairs);
+
+    // Narrowphase: split the overlap of each touching pair between both agents.
+    // Pairs share agents, so this pass stays on one thread.
+    float minDistance = settings.radius * 2.0f;
+    contactCount = 0;
+    for (const BodyPair& pair : pairs) {
+        glm::vec3 a = getPosition(pair.a);
+        glm::vec3 b = getPosition(pair.b);
+        if (!SpatialHash::cylindersOverlap(a, settings.radius, settings.height, b, settings.radius, settings.height)) {
+            continue;
+        }
+        contactCount++;
+
+        float dx = b.x - a.x;
+        float dz = b.z - a.z;
+        float distance = std::sqrt(dx * dx + dz * dz);
+        float nx = 1.0f, nz = 0.0f;   // exactly on top of each other: any direction will do
+        if (distance > 1.0e-4f) {
+            nx = dx / distance;
+            nz = dz / distance;
+        }
+        float push = (minDistance - distance) * 0.5f;
+        nudge(pair.a, -nx * push, -nz * push);
+        nudge(pair.b, nx * push, nz * push);
+    }
+}
+
+void AgentSimulation::pushAway(const glm::vec3& feet, float radius, float height) {
+    queryResults.clear();
+    broadphase.queryCylinder(feet, radius, height, queryResults);
+
+    // The broadphase holds last update's positions, so re-test the current ones
+    float minDistance = radius + settings.radius;
+    for (int agent : queryResults) {
+        glm::vec3 position = getPosition(agent);
+        if (!SpatialHash::cylindersOverlap(feet, radius, height, position, settings.radius, settings.height)) {
+            continue;
+        }
+        float dx = position.x - feet.x;
+        float dz = position.z - feet.z;
+        float distance = std::sqrt(dx * dx + dz * dz);
+        float nx = 1.0f, nz = 0.0f;
+        if (distance > 1.0e-4f) {
+            nx = dx / distance;
+            nz = dz / distance;
+        }
+        float push = minDistance - distance;
+        nudge(agent, nx * push, nz * push);
+    }
+}
+
+void AgentSimulation::nudge(int agent, float dx, float dz) {
+    float x = positionX[agent] + dx;
+    float z = positionZ[agent] + dz;
+    if (!overlapsSolid(x, positionY[agent], z)) {
+        positionX[agent] = x;
+        positionZ[agent] = z;
+    }
+}
+
+void AgentSimulation::steer(int begin, int end) {
+    for (int i = begin; i < end; i++) {
+        // Still blocked in mid-jump: the wall is too tall, turn away instead
+        if ((flags[i] & AGENT_BLOCKED) && !(flags[i] & AGENT_ON_GROUND)) {
+            wanderTimer[i] = 0;
+        }
+        if (wanderTimer[i] == 0) {
+            uint32_t r = nextRandom(i);
+            const float* heading = HEADINGS[r & 15];
+            headingX[i] = heading[0];
+            headingZ[i] = heading[1];
+            // Walk one way for 1 to 4 seconds at 60 ticks per second
+            wanderTimer[i] = static_cast<uint16_t>(60 + (r >> 8) % 180);
+        }
+        wanderTimer[i]--;
+
+        // Try to hop onto whatever blocked us
+        if ((flags[i] & AGENT_BLOCKED) && (flags[i] & AGENT_ON_GROUND)) {
+            velocityY[i] = settings.jumpForce;
+            flags[i] &= ~AGENT_ON_GROUND;
+        }
+    }
+}
+
+void AgentSimulation::integrate(int begin, int end, float deltaTime) {
+    int i = begin;
+#ifdef AGENTS_USE_SSE
+    const __m128 gravityStep = _mm_set1_ps(settings.gravity * deltaTime);
+    const __m128 terminal = _mm_set1_ps(settings.terminalVelocity);
+    const __m128 speed = _mm_set1_ps(settings.moveSpeed);
+    for (; i + 4 <= end; i += 4) {
+        // Gravity only pulls airborne agents
+        __m128 airborne = _mm_castsi128_ps(_mm_setr_epi32(
+            (flags[i] & AGENT_ON_GROUND) ? 0 : -1, (flags[i + 1] & AGENT_ON_GROUND) ? 0 : -1,
+            (flags[i + 2] & AGENT_ON_GROUND) ? 0 : -1, (flags[i + 3] & AGENT_ON_GROUND) ? 0 : -1));
+        __m128 vy = _mm_loadu_ps(&velocityY[i]);
+        vy = _mm_add_ps(vy, _mm_and_ps(airborne, gravityStep));
+        _mm_storeu_ps(&velocityY[i], _mm_max_ps(vy, terminal));
+
+        _mm_storeu_ps(&velocityX[i], _mm_mul_ps(_mm_loadu_ps(&headingX[i]), speed));
+        _mm_storeu_ps(&velocityZ[i], _mm_mul_ps(_mm_loadu_ps(&headingZ[i]), speed));
+    }
+#endif
+    for (; i < end; i++) {
+        if (!(flags[i] & AGENT_ON_GROUND)) {
+            velocityY[i] += settings.gravity * deltaTime;
+        }
+        velocityY[i] = std::max(velocityY[i], settings.terminalVelocity);
+        velocityX[i] = headingX[i] * settings.moveSpeed;
+        velocityZ[i] = headingZ[i] * settings.moveSpeed;
+    }
+}
+
+void AgentSimulation::collide(int begin, int end, float deltaTime) {
+    for (int i = begin; i < end; i++) {
+        float x = positionX[i], y = positionY[i], z = positionZ[i];
+        uint8_t state = 0;
+
+        // Resolve one axis at a time so agents slide along walls
+        float newX = x + velocityX[i] * deltaTime;
+        if (!overlapsSolid(newX, y, z)) {
+            x = newX;
+        } else {
+            velocityX[i] = 0.0f;
+            state |= AGENT_BLOCKED;
+        }
+
+        float newZ = z + velocityZ[i] * deltaTime;
+        if (!overlapsSolid(x, y, newZ)) {
+            z = newZ;
+        } else {
+            velocityZ[i] = 0.0f;
+            state |= AGENT_BLOCKED;
+        }
+
+        float newY = y + velocityY[i] * deltaTime;
+        if (!overlapsSolid(x, newY, z)) {
+            y = newY;
+        } else {
+            if (velocityY[i] < 0.0f) {
+                // Landed: stand on top of the block we fell into
+                y = std::min(y, std::floor(newY) + 1.0f);
+            }
+            velocityY[i] = 0.0f;
+        }
+
+        // Standing on something: settle onto the block top and stop falling
+        if (velocityY[i] <= 0.0f && overlapsSolid(x, y - 0.05f, z)) {
+            y = std::min(y, std::floor(y - 0.05f) + 1.0f);
+            velocityY[i] = 0.0f;
+            state |= AGENT_ON_GROUND;
+        }
+
+        positionX[i] = x;
+        positionY[i] = y;
+        positionZ[i] = z;
+        flags[i] = state;
+    }
+}
+
+bool AgentSimulation::isSolid(int x, int y, int z) const {
+    int gx = x + terrain.getGridOffsetX();
+    int gz = z + terrain.getGridOffsetZ();
+    if (y < 0 || gx < 0 || gx >= terrain.getWidth() || gz < 0 || gz >= terrain.getHeight()) {
+        return true;
+    }
+    return isBlockOpaque(terrain.getGridBlock(gx, y, gz));
+}
+
+bool AgentSimulation::overlapsSolid(float x, float y, float z) const {
+    // Axis-aligned box around the agent's cylinder, blocks occupy [x, x + 1)
+    const float epsilon = 0.001f;
+    int minX = floorToInt(x - settings.radius), maxX = floorToInt(x + settings.radius);
+    int minY = floorToInt(y), maxY = floorToInt(y + settings.height - epsilon);
+    int minZ = floorToInt(z - settings.radius), maxZ = floorToInt(z + settings.radius);
+    for (int by = minY; by <= maxY; by++) {
+        for (int bz = minZ; bz <= maxZ; bz++) {
+            for (int bx = minX; bx <= maxX; bx++) {
+                if (isSolid(bx, by, bz)) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+uint32_t AgentSimulation::nextRandom(int agent) {
+    uint32_t state = randomState[agent];
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    randomState[agent] = state;
+    return state;
+}
@@ -0,0 +1,181 @@
+#include "AllocationTracker.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    std::atomic<uint64_t> allocationCounts[ALLOC_SUBSYSTEM_COUNT];
+    std::atomic<uint64_t> byteCounts[ALLOC_SUBSYSTEM_COUNT];
+    // Snapshot taken by beginFrame(), only touched by the thread running frames
+    AllocationCounts frameStart[ALLOC_SUBSYSTEM_COUNT];
+
+    thread_local AllocationSubsystem currentSubsystem = ALLOC_OTHER;
+
+    const char* SUBSYSTEM_NAMES[ALLOC_SUBSYSTEM_COUNT] = {
+        "other", "terrain", "agents", "lighting", "shadows", "render", "jobs"
+    };
+
+    void record(std::size_t size) {
+        allocationCounts[currentSubsystem].fetch_add(1, std::memory_order_relaxed);
+        byteCounts[currentSubsystem].fetch_add(size, std::memory_order_relaxed);
+    }
+
+    void* allocate(std::size_t size) {
+        void* pointer = std::malloc(size != 0 ? size : 1);
+        if (pointer) {
+            record(size);
+        }
+        return pointer;
+    }
+
+    void* allocateAligned(std::size_t size, std::size_t alignment) {
+        // aligned_alloc wants the size to be a multiple of the alignment
+        std::size_t rounded = (size + alignment - 1) / alignment * alignment;
+#ifdef _WIN32
+        void* pointer = _aligned_malloc(rounded != 0 ? rounded : alignment, alignment);
+#else
+        void* pointer = std::aligned_alloc(alignment, rounded != 0 ? rounded : alignment);
+#endif
+        if (pointer) {
+            record(size);
+        }
+        return pointer;
+    }
+
+    void freeAligned(void* pointer) {
+#ifdef _WIN32
+        _aligned_free(pointer);
+#else
+        std::free(pointer);
+#endif
+    }
+}
+
+void AllocationTracker::beginFrame() {
+    for (int i = 0; i < ALLOC_SUBSYSTEM_COUNT; i++) {
+        frameStart[i].allocations = allocationCounts[i].load(std::memory_order_relaxed);
+        frameStart[i].bytes = byteCounts[i].load(std::memory_order_relaxed);
+    }
+}
+
+AllocationCounts AllocationTracker::getFrameCounts(AllocationSubsystem subsystem) {
+    AllocationCounts counts;
+    counts.allocations = allocationCounts[subsystem].load(std::memory_order_relaxed) - frameStart[subsystem].allocations;
+    counts.bytes = byteCounts[subsystem].load(std::memory_order_relaxed) - frameStart[subsystem].bytes;
+    return counts;
+}
+
+AllocationCounts AllocationTracker::getFrameTotal() {
+    AllocationCounts total;
+    for (int i = 0; i < ALLOC_SUBSYSTEM_COUNT; i++) {
+        AllocationCounts counts = getFrameCounts(static_cast<AllocationSubsystem>(i));
+        total.allocations += counts.allocations;
+        total.bytes += counts.bytes;
+    }
+    return total;
+}
+
+AllocationCounts AllocationTracker::getTotal() {
+    AllocationCounts total;
+    for (int i = 0; i < ALLOC_SUBSYSTEM_COUNT; i++) {
+        total.allocations += allocationCounts[i].load(std::memory_order_relaxed);
+        total.bytes += byteCounts[i].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+const char* AllocationTracker::getSubsystemName(AllocationSubsystem subsystem) {
+    return SUBSYSTEM_NAMES[subsystem];
+}
+
+void AllocationTracker::reportFrame(std::ostream& out) {
+    for (int i = 0; i < ALLOC_SUBSYSTEM_COUNT; i++) {
+        AllocationCounts counts = getFrameCounts(static_cast<AllocationSubsystem>(i));
+        if (counts.allocations > 0) {
+            out << "  " << SUBSYSTEM_NAMES[i] << ": " << counts.allocations << " allocations, "
+                << counts.bytes << " bytes" << std::endl;
+        }
+    }
+}
+
+AllocationSubsystem AllocationTracker::getCurrentSubsystem() {
+    return currentSubsystem;
+}
+
+void AllocationTracker::setCurrentSubsystem(AllocationSubsystem subsystem) {
+    currentSubsystem = subsystem;
+}
+
+// Counting replacements of the global allocation functions
+
+void* operator new(std::size_t size) {
+    void* pointer = allocate(size);
+    if (!pointer) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    void* pointer = allocateAligned(size, static_cast<std::size_t>(alignment));
+    if (!pointer) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+    freeAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept {
+    freeAligned(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept {
+    freeAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept {
+    freeAligned(pointer);
+}
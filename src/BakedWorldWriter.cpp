@@ -0,0 +1,320 @@
+#include "BakedWorldWriter.h"
+#include "ChunkMesher.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace {
+    // Chunk file layout, all little endian:
+    //   "R3DW", u16 version, u16 chunk size, u32 seed, i32 min x, i32 min z, i32 max x, i32 max z,
+    //   u16 world height, u16 reserved, u32 chunk count,
+    //   then per chunk: i32 origin x, y, z, u32 vertex count, u32 index count,
+    //   vertex count * (u32 data0, u32 data1), index count * u32
+    const char MAGIC[4] = {'R', '3', 'D', 'W'};
+    const uint16_t VERSION = 1;
+    const size_t CHUNK_COUNT_OFFSET = 32;
+
+    void writeU16(std::vector<uint8_t>& out, uint16_t value) {
+        out.push_back(static_cast<uint8_t>(value));
+        out.push_back(static_cast<uint8_t>(value >> 8));
+    }
+
+    void writeU32(std::vector<uint8_t>& out, uint32_t value) {
+        writeU16(out, static_cast<uint16_t>(value));
+        writeU16(out, static_cast<uint16_t>(value >> 16));
+    }
+
+    void writeF32(std::vector<uint8_t>& out, float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        writeU32(out, bits);
+    }
+
+    // Local block position and face of a packed vertex
+    void unpackVertex(const ChunkVertex& vertex, int& x, int& y, int& z, int& face) {
+        x = static_cast<int>(vertex.data0 & 31u);
+        y = static_cast<int>((vertex.data0 >> 5) & 31u);
+        z = static_cast<int>((vertex.data0 >> 10) & 31u);
+        face = static_cast<int>((vertex.data0 >> 15) & 7u);
+    }
+
+    std::string fileName(const std::string& path) {
+        size_t slash = path.find_last_of("/\\");
+        return slash == std::string::npos ? path : path.substr(slash + 1);
+    }
+
+    // The glTF buffer is the document's path with its extension replaced by .bin
+    std::string gltfBufferPath(const std::string& gltfPath) {
+        std::string binPath = gltfPath;
+        size_t dot = binPath.find_last_of('.');
+        if (dot != std::string::npos && dot > binPath.find_last_of("/\\") + 1) {
+            binPath.erase(dot);
+        }
+        return binPath + ".bin";
+    }
+}
+
+BakedWorldWriter::BakedWorldWriter()
+    : objVertexCount(0), gltfBinSize(0), chunksWritten(0), bytesWritten(0), failed(false) {}
+
+BakedWorldWriter::~BakedWorldWriter() = default;
+
+bool BakedWorldWriter::open(const std::string& chunkPath, const std::string& objPath, const std::string& gltfPath,
+                            const BakeHeader& header) {
+    // Two outputs on one file would overwrite each other, so check before opening any of them
+    std::string binPath = gltfPath.empty() ? std::string() : gltfBufferPath(gltfPath);
+    const std::string* paths[] = {&chunkPath, &objPath, &gltfPath, &binPath};
+    const char* names[] = {"chunk file", "OBJ file", "glTF document", "glTF buffer"};
+    for (int i = 0; i < 4; i++) {
+        for (int j = i + 1; j < 4; j++) {
+            if (!paths[i]->empty() && *paths[i] == *paths[j]) {
+                std::cerr << "The " << names[i] << " and the " << names[j] << " would both be written to "
+                          << *paths[i] << std::endl;
+                return false;
+            }
+        }
+    }
+
+    if (!chunkPath.empty()) {
+        chunkFile.open(chunkPath, std::ios::binary);
+        if (!chunkFile) {
+            std::cerr << "Failed to open chunk file for writing: " << chunkPath << std::endl;
+            return false;
+        }
+        buffer.assign(MAGIC, MAGIC + 4);
+        writeU16(buffer, VERSION);
+        writeU16(buffer, CHUNK_SIZE);
+        writeU32(buffer, header.seed);
+        writeU32(buffer, static_cast<uint32_t>(header.minX));
+        writeU32(buffer, static_cast<uint32_t>(header.minZ));
+        writeU32(buffer, static_cast<uint32_t>(header.maxX));
+        writeU32(buffer, static_cast<uint32_t>(header.maxZ));
+        writeU16(buffer, header.worldHeight);
+        writeU16(buffer, 0);
+        writeU32(buffer, 0); // chunk count, patched by close()
+        chunkFile.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+        bytesWritten += buffer.size();
+    }
+
+    if (!objPath.empty()) {
+        objFile.open(objPath);
+        if (!objFile) {
+            std::cerr << "Failed to open OBJ file for writing: " << objPath << std::endl;
+            return false;
+        }
+        objFile << "# Baked world, seed " << header.seed << "\n";
+        // Faces share the six axis normals
+        for (const int* normal : ChunkMesher::faceNormals) {
+            objFile << "vn " << normal[0] << " " << normal[1] << " " << normal[2] << "\n";
+        }
+    }
+
+    if (!gltfPath.empty()) {
+        this->gltfPath = gltfPath;
+        gltfBinName = fileName(binPath);
+        gltfBin.open(binPath, std::ios::binary);
+        if (!gltfBin) {
+            std::cerr << "Failed to open glTF buffer for writing: " << binPath << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BakedWorldWriter::writeChunk(int originX, int originY, int originZ, const ChunkMeshData& mesh) {
+    if (mesh.vertices.empty()) {
+        return true;
+    }
+    if (chunkFile.is_open()) {
+        writeChunkRecord(originX, originY, originZ, mesh);
+    }
+    if (objFile.is_open()) {
+        writeObj(originX, originY, originZ, mesh);
+    }
+    if (gltfBin.is_open()) {
+        writeGltfBuffers(originX, originY, originZ, mesh);
+    }
+    chunksWritten++;
+
+    if ((chunkFile.is_open() && !chunkFile) || (objFile.is_open() && !objFile) || (gltfBin.is_open() && !gltfBin)) {
+        if (!failed) {
+            std::cerr << "Failed writing baked chunk at (" << originX << ", " << originY << ", " << originZ << ")"
+                      << std::endl;
+        }
+        failed = true;
+    }
+    return !failed;
+}
+
+bool BakedWorldWriter::close() {
+    if (chunkFile.is_open()) {
+        buffer.clear();
+        writeU32(buffer, static_cast<uint32_t>(chunksWritten));
+        chunkFile.seekp(CHUNK_COUNT_OFFSET);
+        chunkFile.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+        chunkFile.close();
+        failed = failed || chunkFile.fail();
+    }
+    if (objFile.is_open()) {
+        objFile.close();
+        failed = failed || objFile.fail();
+    }
+    if (gltfBin.is_open()) {
+        gltfBin.close();
+        failed = failed || gltfBin.fail() || !writeGltfDocument();
+    }
+    return !failed;
+}
+
+void BakedWorldWriter::writeChunkRecord(int originX, int originY, int originZ, const ChunkMeshData& mesh) {
+    buffer.clear();
+    writeU32(buffer, static_cast<uint32_t>(originX));
+    writeU32(buffer, static_cast<uint32_t>(originY));
+    writeU32(buffer, static_cast<uint32_t>(originZ));
+    writeU32(buffer, static_cast<uint32_t>(mesh.vertices.size()));
+    writeU32(buffer, static_cast<uint32_t>(mesh.indices.size()));
+    for (const ChunkVertex& vertex : mesh.vertices) {
+        writeU32(buffer, vertex.data0);
+        writeU32(buffer, vertex.data1);
+    }
+    for (unsigned int index : mesh.indices) {
+        writeU32(buffer, index);
+    }
+    chunkFile.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    bytesWritten += buffer.size();
+}
+
+void BakedWorldWriter::writeObj(int originX, int originY, int originZ, const ChunkMeshData& mesh) {
+    char line[96];
+    std::snprintf(line, sizeof(line), "o chunk_%d_%d_%d\n", originX, originY, originZ);
+    objFile << line;
+    for (const ChunkVertex& vertex : mesh.vertices) {
+        int x, y, z, face;
+        unpackVertex(vertex, x, y, z, face);
+        std::snprintf(line, sizeof(line), "v %d %d %d\n", originX + x, originY + y, originZ + z);
+        objFile << line;
+    }
+    // OBJ indices are 1-based and global across the file
+    for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+        uint64_t a = objVertexCount + mesh.indices[i] + 1;
+        uint64_t b = objVertexCount + mesh.indices[i + 1] + 1;
+        uint64_t c = objVertexCount + mesh.indices[i + 2] + 1;
+        int x, y, z, face;
+        unpackVertex(mesh.vertices[mesh.indices[i]], x, y, z, face);
+        std::snprintf(line, sizeof(line), "f %llu//%d %llu//%d %llu//%d\n", static_cast<unsigned long long>(a),
+                      face + 1, static_cast<unsigned long long>(b), face + 1, static_cast<unsigned long long>(c),
+                      face + 1);
+        objFile << line;
+    }
+    objVertexCount += mesh.vertices.size();
+}
+
+void BakedWorldWriter::writeGltfBuffers(int originX, int originY, int originZ, const ChunkMeshData& mesh) {
+    // Positions, then normals, then indices; every element is 4-byte aligned
+    GltfChunk chunk;
+    chunk.originX = originX;
+    chunk.originY = originY;
+    chunk.originZ = originZ;
+    chunk.byteOffset = gltfBinSize;
+    chunk.vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+    chunk.indexCount = static_cast<uint32_t>(mesh.indices.size());
+    std::fill(chunk.minPosition, chunk.minPosition + 3, static_cast<float>(CHUNK_SIZE));
+    std::fill(chunk.maxPosition, chunk.maxPosition + 3, 0.0f);
+
+    buffer.clear();
+    for (const ChunkVertex& vertex : mesh.vertices) {
+        int position[3], face;
+        unpackVertex(vertex, position[0], position[1], position[2], face);
+        for (int axis = 0; axis < 3; axis++) {
+            float value = static_cast<float>(position[axis]);
+            chunk.minPosition[axis] = std::min(chunk.minPosition[axis], value);
+            chunk.maxPosition[axis] = std::max(chunk.maxPosition[axis], value);
+            writeF32(buffer, value);
+        }
+    }
+    for (const ChunkVertex& vertex : mesh.vertices) {
+        int x, y, z, face;
+        unpackVertex(vertex, x, y, z, face);
+        for (int axis = 0; axis < 3; axis++) {
+            writeF32(buffer, static_cast<float>(ChunkMesher::faceNormals[face][axis]));
+        }
+    }
+    for (unsigned int index : mesh.indices) {
+        writeU32(buffer, index);
+    }
+    gltfBin.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    gltfBinSize += buffer.size();
+    bytesWritten += buffer.size();
+    gltfChunks.push_back(chunk);
+}
+
+bool BakedWorldWriter::writeGltfDocument() {
+    std::ofstream out(gltfPath);
+    if (!out) {
+        std::cerr << "Failed to open glTF file for writing: " << gltfPath << std::endl;
+        return false;
+    }
+
+    // Three buffer views and accessors per chunk: positions, normals, indices
+    out << "{\n\"asset\": {\"version\": \"2.0\", \"generator\": \"Rendering3D WorldBaker\"},\n";
+    out << "\"buffers\": [{\"uri\": \"" << gltfBinName << "\", \"byteLength\": " << gltfBinSize << "}],\n";
+
+    out << "\"bufferViews\": [\n";
+    for (size_t i = 0; i < gltfChunks.size(); i++) {
+        const GltfChunk& chunk = gltfChunks[i];
+        uint64_t vertexBytes = static_cast<uint64_t>(chunk.vertexCount) * 12;
+        out << (i ? ",\n" : "")
+            << "{\"buffer\": 0, \"byteOffset\": " << chunk.byteOffset << ", \"byteLength\": " << vertexBytes
+            << ", \"target\": 34962},\n"
+            << "{\"buffer\": 0, \"byteOffset\": " << chunk.byteOffset + vertexBytes << ", \"byteLength\": "
+            << vertexBytes << ", \"target\": 34962},\n"
+            << "{\"buffer\": 0, \"byteOffset\": " << chunk.byteOffset + vertexBytes * 2 << ", \"byteLength\": "
+            << static_cast<uint64_t>(chunk.indexCount) * 4 << ", \"target\": 34963}";
+    }
+    out << "\n],\n";
+
+    out << "\"accessors\": [\n";
+    for (size_t i = 0; i < gltfChunks.size(); i++) {
+        const GltfChunk& chunk = gltfChunks[i];
+        size_t view = i * 3;
+        out << (i ? ",\n" : "")
+            << "{\"bufferView\": " << view << ", \"componentType\": 5126, \"count\": " << chunk.vertexCount
+            << ", \"type\": \"VEC3\", \"min\": [" << chunk.minPosition[0] << ", " << chunk.minPosition[1] << ", "
+            << chunk.minPosition[2] << "], \"max\": [" << chunk.maxPosition[0] << ", " << chunk.maxPosition[1]
+            << ", " << chunk.maxPosition[2] << "]},\n"
+            << "{\"bufferView\": " << view + 1 << ", \"componentType\": 5126, \"count\": " << chunk.vertexCount
+            << ", \"type\": \"VEC3\"},\n"
+            << "{\"bufferView\": " << view + 2 << ", \"componentType\": 5125, \"count\": " << chunk.indexCount
+            << ", \"type\": \"SCALAR\"}";
+    }
+    out << "\n],\n";
+
+    out << "\"meshes\": [\n";
+    for (size_t i = 0; i < gltfChunks.size(); i++) {
+        size_t accessor = i * 3;
+        out << (i ? ",\n" : "") << "{\"primitives\": [{\"attributes\": {\"POSITION\": " << accessor
+            << ", \"NORMAL\": " << accessor + 1 << "}, \"indices\": " << accessor + 2 << "}]}";
+    }
+    out << "\n],\n";
+
+    out << "\"nodes\": [\n";
+    for (size_t i = 0; i < gltfChunks.size(); i++) {
+        const GltfChunk& chunk = gltfChunks[i];
+        out << (i ? ",\n" : "") << "{\"mesh\": " << i << ", \"translation\": [" << chunk.originX << ", "
+            << chunk.originY << ", " << chunk.originZ << "]}";
+    }
+    out << "\n],\n";
+
+    out << "\"scenes\": [{\"nodes\": [";
+    for (size_t i = 0; i < gltfChunks.size(); i++) {
+        out << (i ? ", " : "") << i;
+    }
+    out << "]}],\n\"scene\": 0\n}\n";
+
+    if (!out) {
+        std::cerr << "Failed writing glTF file: " << gltfPath << std::endl;
+        return false;
+    }
+    return true;
+}
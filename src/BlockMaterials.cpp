@@ -0,0 +1,87 @@
+#include "BlockMaterials.h"
+#include <algorithm>
+
+namespace {
+    struct Color {
+        float r, g, b;
+    };
+
+    // Same base colors as Terrain::getBlockColor, plus dirt
+    const Color SAND = {0.6f, 0.4f, 0.2f};
+    const Color GRASS = {0.2f, 0.8f, 0.2f};
+    const Color DARK_GRASS = {0.4f, 0.6f, 0.2f};
+    const Color DIRT = {0.45f, 0.3f, 0.15f};
+    const Color STONE = {0.5f, 0.5f, 0.5f};
+    const Color SNOW = {1.0f, 1.0f, 1.0f};
+    const Color LAMP = {1.0f, 0.9f, 0.6f};
+
+    // Deterministic per-texel noise in [0, 1)
+    float texelNoise(int x, int y, int layer) {
+        uint32_t h = static_cast<uint32_t>(x) * 374761393u + static_cast<uint32_t>(y) * 668265263u +
+                     static_cast<uint32_t>(layer) * 2147483647u;
+        h = (h ^ (h >> 13)) * 1274126177u;
+        h ^= h >> 16;
+        return (h & 0xffffu) / 65536.0f;
+    }
+
+    Color scale(Color color, float factor) {
+        return {color.r * factor, color.g * factor, color.b * factor};
+    }
+
+    // Color of one texel; y = 0 is the bottom row
+    Color shadeTexel(int layer, int x, int y) {
+        const int size = MATERIAL_TEXTURE_SIZE;
+        float noise = texelNoise(x, y, layer);
+        switch (layer) {
+            case MATERIAL_SAND:
+                return scale(SAND, 0.9f + 0.2f * noise);
+            case MATERIAL_GRASS_TOP:
+                return scale(GRASS, 0.75f + 0.35f * noise);
+            case MATERIAL_DARK_GRASS_TOP:
+                return scale(DARK_GRASS, 0.75f + 0.35f * noise);
+            case MATERIAL_GRASS_SIDE:
+            case MATERIAL_DARK_GRASS_SIDE: {
+                // Grass overhangs the top of the dirt by a ragged few texels
+                Color grass = layer == MATERIAL_GRASS_SIDE ? GRASS : DARK_GRASS;
+                int overhang = size / 8 + static_cast<int>(texelNoise(x, 0, layer + 100) * (size / 8));
+                return y >= size - overhang ? scale(grass, 0.75f + 0.35f * noise) : scale(DIRT, 0.8f + 0.3f * noise);
+            }
+            case MATERIAL_DIRT:
+                return scale(DIRT, 0.8f + 0.3f * noise);
+            case MATERIAL_STONE:
+                // Sparse dark speckles on a slightly mottled base
+                return scale(STONE, noise > 0.92f ? 0.6f : 0.85f + 0.2f * texelNoise(x / 4, y / 4, layer));
+            case MATERIAL_SNOW:
+                return scale(SNOW, 0.92f + 0.08f * noise);
+            case MATERIAL_LAMP: {
+                // Bright core inside a darker frame
+                bool frame = x < 2 || y < 2 || x >= size - 2 || y >= size - 2;
+                return scale(LAMP, frame ? 0.55f : 0.95f + 0.05f * noise);
+            }
+            default:
+                return {1.0f, 0.0f, 1.0f};
+        }
+    }
+}
+
+std::vector<uint8_t> generateMaterialPixels() {
+    const int size = MATERIAL_TEXTURE_SIZE;
+    std::vector<uint8_t> pixels(static_cast<size_t>(size) * size * 4 * MATERIAL_LAYER_COUNT);
+    auto toByte = [](float value) {
+        return static_cast<uint8_t>(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+    };
+
+    size_t i = 0;
+    for (int layer = 0; layer < MATERIAL_LAYER_COUNT; layer++) {
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                Color color = shadeTexel(layer, x, y);
+                pixels[i++] = toByte(color.r);
+                pixels[i++] = toByte(color.g);
+                pixels[i++] = toByte(color.b);
+                pixels[i++] = 255;
+            }
+        }
+    }
+    return pixels;
+}
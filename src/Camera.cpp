@@ -4,7 +4,8 @@
 Camera::Camera(glm::vec3 position, glm::vec3 up, float yaw, float pitch)
     : position(position), worldUp(up), yaw(yaw), pitch(pitch),
       front(glm::vec3(0.0f, 0.0f, -1.0f)), movementSpeed(2.5f),
-      mouseSensitivity(0.1f), zoom(45.0f) {
+      mouseSensitivity(0.1f), zoom(45.0f),
+      nearPlane(0.1f), farPlane(100.0f) {
     updateCameraVectors();
 }
 
@@ -13,7 +14,7 @@ glm::mat4 Camera::getViewMatrix() {
 }
 
 glm::mat4 Camera::getProjectionMatrix(float aspectRatio) {
-    return glm::perspective(glm::radians(zoom), aspectRatio, 0.1f, 100.0f);
+    return glm::perspective(glm::radians(zoom), aspectRatio, nearPlane, farPlane);
 }
 
 void Camera::processKeyboard(Camera_Movement direction, float deltaTime) {
@@ -7,7 +7,8 @@ CharacterController::CharacterController(Camera& camera, Terrain& terrain)
     : camera(camera), terrain(terrain), position(0.0f, 1.0f, 0.0f), velocity(0.0f),
       moveSpeed(5.0f), jumpForce(8.0f), gravity(-20.0f), groundLevel(0.0f),
       playerRadius(0.3f), playerHeight(1.8f),
-      onGround(true), jumping(false), moving(false), lastTerrainHeight(0.0f) {
+      onGround(true), jumping(false), moving(false), lastTerrainHeight(0.0f), jumpHeld(false),
+      collisionChecks(0) {
     
     // Initialize key states
     for (int i = 0; i < 4; i++) {
@@ -24,23 +25,28 @@ void CharacterController::update(float deltaTime) {
     handleCollision();
 }
 
-void CharacterController::processInput(GLFWwindow* window) {
+void CharacterController::applyInput(const InputState& input) {
+    // Look around first so movement follows the new view direction
+    if (input.mouseX != 0 || input.mouseY != 0) {
+        const float pixelsPerUnit = 1.0f / InputState::MOUSE_UNITS_PER_PIXEL;
+        processMouseMovement(input.mouseX * pixelsPerUnit, input.mouseY * pixelsPerUnit);
+    }
+
     // Update key states
-    keys[0] = glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS; // W
-    keys[1] = glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS; // A
-    keys[2] = glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS; // S
-    keys[3] = glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS; // D
+    keys[0] = input.isDown(INPUT_FORWARD); // W
+    keys[1] = input.isDown(INPUT_LEFT);    // A
+    keys[2] = input.isDown(INPUT_BACK);    // S
+    keys[3] = input.isDown(INPUT_RIGHT);   // D
     
     // Jump
-    static bool spacePressed = false;
-    bool spaceCurrentlyPressed = glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS;
+    bool jumpPressed = input.isDown(INPUT_JUMP);
     
-    if (spaceCurrentlyPressed && !spacePressed && onGround) {
+    if (jumpPressed && !jumpHeld && onGround) {
         velocity.y = jumpForce;
         onGround = false;
         jumping = true;
     }
-    spacePressed = spaceCurrentlyPressed;
+    jumpHeld = jumpPressed;
     
     // Calculate movement direction
     glm::vec3 moveDir(0.0f);
@@ -138,6 +144,7 @@ void CharacterController::handleCollision() {
         for (float z = -checkRadius; z <= checkRadius; z += step) {
             if (x*x + z*z <= checkRadius*checkRadius) {
                 glm::vec3 checkPos = groundCheckPos + glm::vec3(x, 0, z);
+                collisionChecks++;
                 if (terrain.hasBlockAt(static_cast<int>(checkPos.x), 
                                      static_cast<int>(checkPos.y), 
                                      static_cast<int>(checkPos.z))) {
@@ -202,6 +209,7 @@ bool CharacterController::checkBlockCollision(const glm::vec3& pos, float radius
                     float by = std::floor(checkY);
                     float bz = std::floor(pos.z + z);
                     bool hasBlock = terrain.hasBlockAt(static_cast<int>(bx), static_cast<int>(by), static_cast<int>(bz));
+                    collisionChecks++;
                     
                     if (debugThisFrame && hasBlock) {
                         std::cout << "    BLOCK FOUND at (" << bx << ", " << by << ", " << bz << ")" << std::endl;
@@ -0,0 +1,45 @@
+#include "ChunkMesh.h"
+
+ChunkMesh::ChunkMesh() : VAO(0), VBO(0), EBO(0), indexCount(0) {
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+    // Both packed words go to one integer attribute (PACKED_VERTEX variant)
+    glEnableVertexAttribArray(0);
+    glVertexAttribIPointer(0, 2, GL_UNSIGNED_INT, sizeof(ChunkVertex), (void*)0);
+
+    glBindVertexArray(0);
+}
+
+ChunkMesh::~ChunkMesh() {
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &EBO);
+}
+
+void ChunkMesh::upload(const ChunkMeshData& data) {
+    indexCount = static_cast<unsigned int>(data.indices.size());
+    if (indexCount == 0) {
+        return;
+    }
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, data.vertices.size() * sizeof(ChunkVertex), data.vertices.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.indices.size() * sizeof(unsigned int), data.indices.data(), GL_STATIC_DRAW);
+    glBindVertexArray(0);
+}
+
+void ChunkMesh::draw() {
+    if (indexCount == 0) {
+        return;
+    }
+    glBindVertexArray(VAO);
+    glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+    glBindVertexArray(0);
+}
@@ -0,0 +1,184 @@
+#include "ChunkMesher.h"
+#include "BlockMaterials.h"
+#include "Terrain.h"
+
+const int ChunkMesher::faceNormals[6][3] = {
+    { 0,  0,  1},
+    { 0,  0, -1},
+    {-1,  0,  0},
+    { 1,  0,  0},
+    { 0,  1,  0},
+    { 0, -1,  0}
+};
+
+const int ChunkMesher::faceCorners[6][4][3] = {
+    {{0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1}}, // Front
+    {{1, 0, 0}, {0, 0, 0}, {0, 1, 0}, {1, 1, 0}}, // Back
+    {{0, 0, 0}, {0, 0, 1}, {0, 1, 1}, {0, 1, 0}}, // Left
+    {{1, 0, 1}, {1, 0, 0}, {1, 1, 0}, {1, 1, 1}}, // Right
+    {{0, 1, 1}, {1, 1, 1}, {1, 1, 0}, {0, 1, 0}}, // Top
+    {{0, 0, 0}, {1, 0, 0}, {1, 0, 1}, {0, 0, 1}}  // Bottom
+};
+
+void ChunkMesher::buildMesh(const Terrain& terrain, const Chunk& chunk, ChunkMeshData& mesh) {
+    // clear() keeps the capacity from the previous build
+    mesh.vertices.clear();
+    mesh.indices.clear();
+
+    const VoxelLighting& lighting = terrain.getLighting();
+    int baseX = chunk.x * CHUNK_SIZE;
+    int baseY = chunk.y * CHUNK_SIZE;
+    int baseZ = chunk.z * CHUNK_SIZE;
+
+    for (int ly = 0; ly < CHUNK_SIZE; ly++) {
+        for (int lz = 0; lz < CHUNK_SIZE; lz++) {
+            for (int lx = 0; lx < CHUNK_SIZE; lx++) {
+                int gx = baseX + lx;
+                int gy = baseY + ly;
+                int gz = baseZ + lz;
+                uint8_t block = terrain.getGridBlock(gx, gy, gz);
+                if (!isBlockOpaque(block)) {
+                    continue;
+                }
+
+                for (int face = 0; face < 6; face++) {
+                    // The empty cell in front of the face; cells outside the world count as air
+                    int nx = gx + faceNormals[face][0];
+                    int ny = gy + faceNormals[face][1];
+                    int nz = gz + faceNormals[face][2];
+                    if (isBlockOpaque(terrain.getGridBlock(nx, ny, nz))) {
+                        continue;
+                    }
+
+                    uint8_t material = getBlockMaterial(block, face);
+                    int normalAxis = faceNormals[face][0] != 0 ? 0 : (faceNormals[face][1] != 0 ? 1 : 2);
+                    int axisA = (normalAxis + 1) % 3;
+                    int axisB = (normalAxis + 2) % 3;
+
+                    int ao[4];
+                    unsigned int firstVertex = static_cast<unsigned int>(mesh.vertices.size());
+                    for (int corner = 0; corner < 4; corner++) {
+                        const int* c = faceCorners[face][corner];
+
+                        // The three cells around this corner in the layer in front of the face
+                        int side1[3] = {nx, ny, nz};
+                        int side2[3] = {nx, ny, nz};
+                        side1[axisA] += c[axisA] ? 1 : -1;
+                        side2[axisB] += c[axisB] ? 1 : -1;
+                        int diagonal[3] = {side1[0], side1[1], side1[2]};
+                        diagonal[axisB] = side2[axisB];
+
+                        bool occluded1 = isBlockOpaque(terrain.getGridBlock(side1[0], side1[1], side1[2]));
+                        bool occluded2 = isBlockOpaque(terrain.getGridBlock(side2[0], side2[1], side2[2]));
+                        bool occludedDiagonal = isBlockOpaque(terrain.getGridBlock(diagonal[0], diagonal[1], diagonal[2]));
+                        ao[corner] = (occluded1 && occluded2)
+                            ? 0 : 3 - (occluded1 + occluded2 + occludedDiagonal);
+
+                        // Smooth lighting: average the light of the open cells sharing this corner
+                        int sun = lighting.getSunLight(nx, ny, nz);
+                        int blockLight = lighting.getBlockLight(nx, ny, nz);
+                        int samples = 1;
+                        if (!occluded1) {
+                            sun += lighting.getSunLight(side1[0], side1[1], side1[2]);
+                            blockLight += lighting.getBlockLight(side1[0], side1[1], side1[2]);
+                            samples++;
+                        }
+                        if (!occluded2) {
+                            sun += lighting.getSunLight(side2[0], side2[1], side2[2]);
+                            blockLight += lighting.getBlockLight(side2[0], side2[1], side2[2]);
+                            samples++;
+                        }
+                        if (!occludedDiagonal && !(occluded1 && occluded2)) {
+                            sun += lighting.getSunLight(diagonal[0], diagonal[1], diagonal[2]);
+                            blockLight += lighting.getBlockLight(diagonal[0], diagonal[1], diagonal[2]);
+                            samples++;
+                        }
+
+                        mesh.vertices.push_back(packChunkVertex(
+                            lx + c[0], ly + c[1], lz + c[2], face, ao[corner], material,
+                            (sun + samples / 2) / samples, (blockLight + samples / 2) / samples));
+                    }
+
+                    // Flip the quad diagonal so AO interpolates symmetrically
+                    if (ao[0] + ao[2] < ao[1] + ao[3]) {
+                        mesh.indices.insert(mesh.indices.end(), {
+                            firstVertex + 1, firstVertex + 2, firstVertex + 3,
+                            firstVertex + 3, firstVertex + 0, firstVertex + 1});
+                    } else {
+                        mesh.indices.insert(mesh.indices.end(), {
+                            firstVertex + 0, firstVertex + 1, firstVertex + 2,
+                            firstVertex + 2, firstVertex + 3, firstVertex + 0});
+                    }
+                }
+            }
+        }
+    }
+}
+
+uint64_t ChunkMesher::computeConnectivity(const Terrain& terrain, const Chunk& chunk) {
+    const int cellCount = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+    // Cell index is x + (z + y * CHUNK_SIZE) * CHUNK_SIZE; true for cells still to fill
+    bool open[cellCount];
+    int baseX = chunk.x * CHUNK_SIZE;
+    int baseY = chunk.y * CHUNK_SIZE;
+    int baseZ = chunk.z * CHUNK_SIZE;
+    int openCount = 0;
+    int cell = 0;
+    for (int ly = 0; ly < CHUNK_SIZE; ly++) {
+        for (int lz = 0; lz < CHUNK_SIZE; lz++) {
+            for (int lx = 0; lx < CHUNK_SIZE; lx++) {
+                open[cell] = !isBlockOpaque(terrain.getGridBlock(baseX + lx, baseY + ly, baseZ + lz));
+                openCount += open[cell];
+                cell++;
+            }
+        }
+    }
+
+    // Solid chunks join nothing; a single solid block cannot split an otherwise empty chunk
+    if (openCount == 0) {
+        return 0;
+    }
+    if (openCount >= cellCount - 1) {
+        return CHUNK_ALL_FACES_CONNECTED;
+    }
+
+    const int strides[3] = {1, CHUNK_SIZE * CHUNK_SIZE, CHUNK_SIZE};  // x, y, z
+    uint16_t stack[cellCount];
+    uint64_t connectivity = 0;
+    for (int seed = 0; seed < cellCount; seed++) {
+        if (!open[seed]) {
+            continue;
+        }
+        // Faces touched by this region, as a mask in ChunkMesher face order
+        int faces = 0;
+        int top = 0;
+        stack[top++] = static_cast<uint16_t>(seed);
+        open[seed] = false;
+        while (top > 0) {
+            int index = stack[--top];
+            int local[3] = {index % CHUNK_SIZE, index / (CHUNK_SIZE * CHUNK_SIZE), index / CHUNK_SIZE % CHUNK_SIZE};
+            faces |= (local[2] == CHUNK_SIZE - 1) << 0 | (local[2] == 0) << 1 | (local[0] == 0) << 2 |
+                     (local[0] == CHUNK_SIZE - 1) << 3 | (local[1] == CHUNK_SIZE - 1) << 4 | (local[1] == 0) << 5;
+            for (int axis = 0; axis < 3; axis++) {
+                if (local[axis] > 0 && open[index - strides[axis]]) {
+                    open[index - strides[axis]] = false;
+                    stack[top++] = static_cast<uint16_t>(index - strides[axis]);
+                }
+                if (local[axis] < CHUNK_SIZE - 1 && open[index + strides[axis]]) {
+                    open[index + strides[axis]] = false;
+                    stack[top++] = static_cast<uint16_t>(index + strides[axis]);
+                }
+            }
+        }
+        for (int a = 0; a < 6; a++) {
+            if (faces & (1 << a)) {
+                for (int b = 0; b < 6; b++) {
+                    if (faces & (1 << b)) {
+                        connectivity |= uint64_t(1) << (a * 6 + b);
+                    }
+                }
+            }
+        }
+    }
+    return connectivity;
+}
@@ -0,0 +1,278 @@
+#include "ChunkVisibility.h"
+#include "ChunkMesher.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    const uint8_t NO_ENTRY_FACE = 6;
+
+    // Faces come in +/- pairs: 0/1, 2/3, 4/5
+    int oppositeFace(int face) {
+        return face ^ 1;
+    }
+}
+
+Frustum extractFrustum(const glm::mat4& viewProjection) {
+    // Rows of the matrix; glm stores columns
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; i++) {
+        rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    }
+    Frustum frustum;
+    frustum.planes[0] = rows[3] + rows[0];  // left
+    frustum.planes[1] = rows[3] - rows[0];  // right
+    frustum.planes[2] = rows[3] + rows[1];  // bottom
+    frustum.planes[3] = rows[3] - rows[1];  // top
+    frustum.planes[4] = rows[3] + rows[2];  // near
+    frustum.planes[5] = rows[3] - rows[2];  // far
+    for (glm::vec4& plane : frustum.planes) {
+        plane /= glm::length(glm::vec3(plane.x, plane.y, plane.z));
+    }
+    return frustum;
+}
+
+bool isBoxInFrustum(const Frustum& frustum, const glm::vec3& boxMin, const glm::vec3& boxMax) {
+    for (const glm::vec4& plane : frustum.planes) {
+        // The corner furthest along the plane normal
+        glm::vec3 corner(plane.x >= 0.0f ? boxMax.x : boxMin.x,
+                         plane.y >= 0.0f ? boxMax.y : boxMin.y,
+                         plane.z >= 0.0f ? boxMax.z : boxMin.z);
+        if (plane.x * corner.x + plane.y * corner.y + plane.z * corner.z + plane.w < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+ChunkVisibility::ChunkVisibility(const Terrain& terrain, float coherenceMargin)
+    : terrain(terrain), coherenceMargin(coherenceMargin), testedChunks(0), fullUpdate(false), updateCount(0),
+      fullUpdateCount(0), hasReference(false), referenceMode(CULLING_NONE), referenceView(1.0f),
+      referenceProjection(1.0f), frustumRadius(0.0f), walkStart(-1), walkRevision(0) {
+    resize();
+}
+
+bool ChunkVisibility::resize() {
+    size_t count = terrain.getChunks().size();
+    if (frustumState.size() == count) {
+        return false;
+    }
+    frustumState.assign(count, 0);
+    enteredFaces.assign(count, 0);
+    chunkMins.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        chunkMins[i] = terrain.getChunkOrigin(terrain.getChunks()[i]);
+    }
+    visibleChunks.clear();
+    visibleChunks.reserve(count);
+    boundaryChunks.clear();
+    boundaryChunks.reserve(count);
+    // Each chunk is entered at most once per face
+    queue.clear();
+    queue.reserve(count * 6);
+    hasReference = false;
+    return true;
+}
+
+bool ChunkVisibility::isNearReference(const glm::vec3& eye, const glm::mat4& view) const {
+    // A plane's distance to a point r away from the eye changes by at most
+    // the eye's movement plus r times the largest stretch of the rotation
+    // difference, which is its Frobenius norm over sqrt(2)
+    float rotationSquared = 0.0f;
+    for (int column = 0; column < 3; column++) {
+        for (int row = 0; row < 3; row++) {
+            float difference = view[column][row] - referenceView[column][row];
+            rotationSquared += difference * difference;
+        }
+    }
+    float rotation = std::sqrt(rotationSquared * 0.5f);
+    // Chunks that can change result lie within this distance of the eye
+    float reach = frustumRadius + coherenceMargin + std::sqrt(3.0f) * CHUNK_SIZE;
+    return glm::length(eye - referenceEye) + rotation * reach <= coherenceMargin;
+}
+
+bool ChunkVisibility::testChunk(int index, const glm::vec3& eye, const Frustum& frustum, float* margin) {
+    const glm::vec3& boxMin = chunkMins[index];
+    glm::vec3 boxMax = boxMin + glm::vec3(static_cast<float>(CHUNK_SIZE));
+    testedChunks++;
+
+    // Smallest distance of a box's furthest-in corner to a plane; negative when a plane separates it
+    float planeSlack = 1.0e30f;
+    for (const glm::vec4& plane : frustum.planes) {
+        glm::vec3 corner(plane.x >= 0.0f ? boxMax.x : boxMin.x,
+                         plane.y >= 0.0f ? boxMax.y : boxMin.y,
+                         plane.z >= 0.0f ? boxMax.z : boxMin.z);
+        planeSlack = std::min(planeSlack, plane.x * corner.x + plane.y * corner.y + plane.z * corner.z + plane.w);
+    }
+    // The frustum fits in a sphere around the eye; that test moves only with the eye
+    glm::vec3 offset = glm::clamp(eye, boxMin, boxMax) - eye;
+    float distanceSquared = glm::dot(offset, offset);
+
+    bool inside = planeSlack >= 0.0f && distanceSquared <= frustumRadius * frustumRadius;
+    if (margin) {
+        // How far the planes or sphere must move to change the result
+        float sphereSlack = frustumRadius - std::sqrt(distanceSquared);
+        *margin = inside ? std::min(sphereSlack, planeSlack) : std::max(-sphereSlack, -planeSlack);
+    }
+    frustumState[index] = inside ? 1 : 2;
+    return inside;
+}
+
+bool ChunkVisibility::isChunkInFrustum(int index, const glm::vec3& eye, const Frustum& frustum) {
+    if (frustumState[index] == 0) {
+        // Classified against the camera of the last full pass, so the margin holds until the next one
+        float margin;
+        testChunk(index, referenceEye, referenceFrustum, &margin);
+        if (margin <= coherenceMargin) {
+            boundaryChunks.push_back(index);
+            if (!fullUpdate) {
+                testChunk(index, eye, frustum, nullptr);
+            }
+        }
+    }
+    return frustumState[index] == 1;
+}
+
+bool ChunkVisibility::retestBoundary(const glm::vec3& eye, const Frustum& frustum) {
+    bool changed = false;
+    for (int index : boundaryChunks) {
+        uint8_t previous = frustumState[index];
+        testChunk(index, eye, frustum, nullptr);
+        changed |= frustumState[index] != previous;
+    }
+    return changed;
+}
+
+int ChunkVisibility::findStartChunk(const glm::vec3& eye) const {
+    // The camera's chunk, or the nearest one when the camera is outside the world
+    glm::ivec3 counts = terrain.getChunkCounts();
+    glm::vec3 grid = eye + glm::vec3(static_cast<float>(terrain.getGridOffsetX()), 0.0f,
+                                     static_cast<float>(terrain.getGridOffsetZ()));
+    glm::ivec3 start(static_cast<int>(std::floor(grid.x / CHUNK_SIZE)), static_cast<int>(std::floor(grid.y / CHUNK_SIZE)),
+                     static_cast<int>(std::floor(grid.z / CHUNK_SIZE)));
+    start = glm::clamp(start, glm::ivec3(0), counts - 1);
+    return (start.y * counts.z + start.z) * counts.x + start.x;
+}
+
+void ChunkVisibility::update(const glm::vec3& eye, const glm::mat4& view, const glm::mat4& projection,
+                             CullingMode mode) {
+    bool resized = resize();
+    updateCount++;
+    testedChunks = 0;
+    const std::vector<Chunk>& chunks = terrain.getChunks();
+    if (chunks.empty()) {
+        visibleChunks.clear();
+        return;
+    }
+
+    bool sameProjection = true;
+    for (int column = 0; column < 4; column++) {
+        sameProjection = sameProjection && projection[column] == referenceProjection[column];
+    }
+    fullUpdate = resized || !hasReference || mode != referenceMode;
+    if (!fullUpdate && mode != CULLING_NONE) {
+        fullUpdate = !sameProjection || !isNearReference(eye, view);
+    }
+    if (fullUpdate) {
+        hasReference = true;
+        referenceMode = mode;
+        referenceEye = eye;
+        referenceView = view;
+        referenceProjection = projection;
+        fullUpdateCount++;
+    }
+
+    if (mode == CULLING_NONE) {
+        if (fullUpdate) {
+            visibleChunks.clear();
+            for (int i = 0; i < static_cast<int>(chunks.size()); i++) {
+                visibleChunks.push_back(i);
+            }
+        }
+        return;
+    }
+
+    Frustum frustum = extractFrustum(projection * view);
+    bool changed = true;
+    if (fullUpdate) {
+        referenceFrustum = frustum;
+        // Furthest frustum corner, from the corners of clip space
+        glm::mat4 inverseProjection = glm::inverse(projection);
+        frustumRadius = 0.0f;
+        for (int corner = 0; corner < 8; corner++) {
+            glm::vec4 point = inverseProjection * glm::vec4(corner & 1 ? 1.0f : -1.0f, corner & 2 ? 1.0f : -1.0f,
+                                                            corner & 4 ? 1.0f : -1.0f, 1.0f);
+            frustumRadius = std::max(frustumRadius, glm::length(glm::vec3(point) / point.w));
+        }
+        // The walk classifies only the chunks it reaches
+        std::fill(frustumState.begin(), frustumState.end(), 0);
+        boundaryChunks.clear();
+        if (mode == CULLING_FRUSTUM) {
+            for (int i = 0; i < static_cast<int>(chunks.size()); i++) {
+                isChunkInFrustum(i, eye, frustum);
+            }
+        }
+    } else {
+        changed = retestBoundary(eye, frustum);
+    }
+
+    if (mode == CULLING_FRUSTUM) {
+        if (changed) {
+            visibleChunks.clear();
+            for (int i = 0; i < static_cast<int>(chunks.size()); i++) {
+                if (frustumState[i] == 1) {
+                    visibleChunks.push_back(i);
+                }
+            }
+        }
+        return;
+    }
+
+    // The walk depends only on the frustum results, the camera's chunk and the chunks' connectivity
+    int startIndex = findStartChunk(eye);
+    if (changed || startIndex != walkStart || terrain.getMeshRevision() != walkRevision) {
+        walk(startIndex, eye, frustum);
+        walkStart = startIndex;
+        walkRevision = terrain.getMeshRevision();
+    }
+}
+
+void ChunkVisibility::walk(int startIndex, const glm::vec3& eye, const Frustum& frustum) {
+    const std::vector<Chunk>& chunks = terrain.getChunks();
+    glm::ivec3 counts = terrain.getChunkCounts();
+    visibleChunks.clear();
+    std::fill(enteredFaces.begin(), enteredFaces.end(), 0);
+    queue.clear();
+    // The camera can be anywhere in its chunk, so every face is a way out
+    enteredFaces[startIndex] = 0x3F;
+    visibleChunks.push_back(startIndex);
+    queue.push_back({startIndex, NO_ENTRY_FACE, 0});
+
+    for (size_t head = 0; head < queue.size(); head++) {
+        Step step = queue[head];
+        const Chunk& chunk = chunks[step.chunk];
+        for (int face = 0; face < 6; face++) {
+            if (step.directions & (1 << oppositeFace(face))) {
+                continue;
+            }
+            if (step.entryFace != NO_ENTRY_FACE && !areChunkFacesConnected(chunk.connectivity, step.entryFace, face)) {
+                continue;
+            }
+            int nx = chunk.x + ChunkMesher::faceNormals[face][0];
+            int ny = chunk.y + ChunkMesher::faceNormals[face][1];
+            int nz = chunk.z + ChunkMesher::faceNormals[face][2];
+            if (nx < 0 || ny < 0 || nz < 0 || nx >= counts.x || ny >= counts.y || nz >= counts.z) {
+                continue;
+            }
+            int neighbor = (ny * counts.z + nz) * counts.x + nx;
+            uint8_t entryFace = static_cast<uint8_t>(oppositeFace(face));
+            if ((enteredFaces[neighbor] & (1 << entryFace)) || !isChunkInFrustum(neighbor, eye, frustum)) {
+                continue;
+            }
+            if (enteredFaces[neighbor] == 0) {
+                visibleChunks.push_back(neighbor);
+            }
+            enteredFaces[neighbor] |= 1 << entryFace;
+            queue.push_back({neighbor, entryFace, static_cast<uint8_t>(step.directions | (1 << face))});
+        }
+    }
+}
@@ -0,0 +1,235 @@
+#include "ClusteredLighting.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+ClusteredLighting::ClusteredLighting(JobSystem& jobs)
+    : jobs(jobs), lightBuffer(0), gridBuffer(0), indexBuffer(0),
+      lightTexture(0), gridTexture(0), indexTexture(0), lightCount(0),
+      viewportWidth(1.0f), viewportHeight(1.0f), sliceScale(0.0f), sliceBias(0.0f),
+      assignMilliseconds(0.0f) {
+    clusterGrid.assign(GRID_X * GRID_Y * GRID_Z * 2, 0);
+    sliceIndices.resize(GRID_Z);
+    sliceCounts.resize(GRID_Z, std::vector<uint32_t>(GRID_X * GRID_Y, 0));
+
+    glGenBuffers(1, &lightBuffer);
+    glGenBuffers(1, &gridBuffer);
+    glGenBuffers(1, &indexBuffer);
+    glGenTextures(1, &lightTexture);
+    glGenTextures(1, &gridTexture);
+    glGenTextures(1, &indexTexture);
+
+    // Buffers never go empty, so the texture views are valid from the first frame
+    lightData.assign(2, glm::vec4(0.0f));
+    lightIndices.assign(1, 0);
+    upload();
+}
+
+ClusteredLighting::~ClusteredLighting() {
+    glDeleteTextures(1, &lightTexture);
+    glDeleteTextures(1, &gridTexture);
+    glDeleteTextures(1, &indexTexture);
+    glDeleteBuffers(1, &lightBuffer);
+    glDeleteBuffers(1, &gridBuffer);
+    glDeleteBuffers(1, &indexBuffer);
+}
+
+void ClusteredLighting::update(Camera& camera, int width, int height, const std::vector<PointLight>& lights) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    viewportWidth = static_cast<float>(std::max(width, 1));
+    viewportHeight = static_cast<float>(std::max(height, 1));
+    float nearPlane = camera.nearPlane;
+    float farPlane = camera.farPlane;
+
+    // slice = log(depth / near) / log(far / near) * GRID_Z, as scale * log(depth) + bias
+    float logRatio = std::log(farPlane / nearPlane);
+    sliceScale = GRID_Z / logRatio;
+    sliceBias = -GRID_Z * std::log(nearPlane) / logRatio;
+
+    lightCount = std::min(static_cast<int>(lights.size()), MAX_LIGHTS);
+    lightData.resize(std::max(lightCount, 1) * 2);
+    lightRanges.resize(lightCount);
+
+    glm::mat4 view = camera.getViewMatrix();
+    glm::mat4 projection = camera.getProjectionMatrix(viewportWidth / viewportHeight);
+    computeLightRanges(view, projection, nearPlane, farPlane, lights);
+
+    // Each depth slice is built independently, no locking between workers
+    jobs.parallelFor(GRID_Z, 1, [this](int begin, int end) {
+        for (int slice = begin; slice < end; slice++) {
+            buildSlice(slice);
+        }
+    });
+
+    // Concatenate the slice lists and rebase their offsets
+    size_t total = 0;
+    for (int slice = 0; slice < GRID_Z; slice++) {
+        size_t sliceBase = total;
+        for (int tile = 0; tile < GRID_X * GRID_Y; tile++) {
+            clusterGrid[(slice * GRID_X * GRID_Y + tile) * 2] += static_cast<uint32_t>(sliceBase);
+        }
+        total += sliceIndices[slice].size();
+    }
+    lightIndices.resize(std::max<size_t>(total, 1));
+    size_t offset = 0;
+    for (int slice = 0; slice < GRID_Z; slice++) {
+        std::copy(sliceIndices[slice].begin(), sliceIndices[slice].end(), lightIndices.begin() + offset);
+        offset += sliceIndices[slice].size();
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    assignMilliseconds = std::chrono::duration<float, std::milli>(end - start).count();
+
+    upload();
+}
+
+void ClusteredLighting::bind(Shader& shader) {
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_BUFFER, lightTexture);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_BUFFER, gridTexture);
+    glActiveTexture(GL_TEXTURE3);
+    glBindTexture(GL_TEXTURE_BUFFER, indexTexture);
+    glActiveTexture(GL_TEXTURE0);
+
+    shader.setInt("pointLightData", 1);
+    shader.setInt("clusterGrid", 2);
+    shader.setInt("clusterLightIndices", 3);
+    shader.setVec2("viewportSize", glm::vec2(viewportWidth, viewportHeight));
+    shader.setFloat("clusterScale", sliceScale);
+    shader.setFloat("clusterBias", sliceBias);
+}
+
+int ClusteredLighting::getSlice(float depth, float nearPlane) const {
+    if (depth <= nearPlane) {
+        return 0;
+    }
+    int slice = static_cast<int>(std::log(depth) * sliceScale + sliceBias);
+    return std::min(std::max(slice, 0), GRID_Z - 1);
+}
+
+void ClusteredLighting::computeLightRanges(const glm::mat4& view, const glm::mat4& projection,
+                                           float nearPlane, float farPlane, const std::vector<PointLight>& lights) {
+    // Captured through one reference so the job fits std::function's inline
+    // storage instead of allocating every frame
+    struct RangeInputs {
+        const glm::mat4& view;
+        const std::vector<PointLight>& lights;
+        float nearPlane, farPlane, scaleX, scaleY;
+    } inputs{view, lights, nearPlane, farPlane, projection[0][0], projection[1][1]};
+
+    jobs.parallelFor(lightCount, 64, [this, &inputs](int begin, int end) {
+        const glm::mat4& view = inputs.view;
+        const std::vector<PointLight>& lights = inputs.lights;
+        float nearPlane = inputs.nearPlane, farPlane = inputs.farPlane;
+        float scaleX = inputs.scaleX, scaleY = inputs.scaleY;
+        for (int i = begin; i < end; i++) {
+            const PointLight& light = lights[i];
+            lightData[i * 2] = glm::vec4(light.position, light.radius);
+            lightData[i * 2 + 1] = glm::vec4(light.color, light.intensity);
+
+            ClusterRange& range = lightRanges[i];
+            // Empty range unless the light touches the frustum's depth range
+            range.minZ = 1;
+            range.maxZ = 0;
+
+            glm::vec3 center = glm::vec3(view * glm::vec4(light.position, 1.0f));
+            float depth = -center.z;
+            float nearDepth = std::max(depth - light.radius, nearPlane);
+            float farDepth = depth + light.radius;
+            if (farDepth < nearPlane || nearDepth > farPlane) {
+                continue;
+            }
+
+            // Conservative screen bounds: extremes of the sphere's view-space box over its depth range
+            float x0 = center.x - light.radius, x1 = center.x + light.radius;
+            float y0 = center.y - light.radius, y1 = center.y + light.radius;
+            float ndcMinX = scaleX * std::min(x0 / nearDepth, x0 / farDepth);
+            float ndcMaxX = scaleX * std::max(x1 / nearDepth, x1 / farDepth);
+            float ndcMinY = scaleY * std::min(y0 / nearDepth, y0 / farDepth);
+            float ndcMaxY = scaleY * std::max(y1 / nearDepth, y1 / farDepth);
+            if (ndcMaxX < -1.0f || ndcMinX > 1.0f || ndcMaxY < -1.0f || ndcMinY > 1.0f) {
+                continue;
+            }
+
+            auto toTile = [](float ndc, int tiles) {
+                int tile = static_cast<int>((ndc * 0.5f + 0.5f) * tiles);
+                return std::min(std::max(tile, 0), tiles - 1);
+            };
+            range.minX = toTile(ndcMinX, GRID_X);
+            range.maxX = toTile(ndcMaxX, GRID_X);
+            range.minY = toTile(ndcMinY, GRID_Y);
+            range.maxY = toTile(ndcMaxY, GRID_Y);
+            range.minZ = getSlice(nearDepth, nearPlane);
+            range.maxZ = getSlice(std::min(farDepth, farPlane), nearPlane);
+        }
+    });
+}
+
+void ClusteredLighting::buildSlice(int slice) {
+    const int tiles = GRID_X * GRID_Y;
+    std::vector<uint32_t>& counts = sliceCounts[slice];
+    std::vector<uint32_t>& indices = sliceIndices[slice];
+    std::fill(counts.begin(), counts.end(), 0);
+
+    // Count pass
+    for (int i = 0; i < lightCount; i++) {
+        const ClusterRange& range = lightRanges[i];
+        if (slice < range.minZ || slice > range.maxZ) {
+            continue;
+        }
+        for (int y = range.minY; y <= range.maxY; y++) {
+            for (int x = range.minX; x <= range.maxX; x++) {
+                uint32_t& count = counts[y * GRID_X + x];
+                count = std::min<uint32_t>(count + 1, MAX_LIGHTS_PER_CLUSTER);
+            }
+        }
+    }
+
+    // Slice-local offsets; update() adds the slice's base offset afterwards
+    uint32_t offset = 0;
+    for (int tile = 0; tile < tiles; tile++) {
+        clusterGrid[(slice * tiles + tile) * 2] = offset;
+        clusterGrid[(slice * tiles + tile) * 2 + 1] = 0;
+        offset += counts[tile];
+    }
+    indices.resize(offset);
+
+    // Fill pass
+    for (int i = 0; i < lightCount; i++) {
+        const ClusterRange& range = lightRanges[i];
+        if (slice < range.minZ || slice > range.maxZ) {
+            continue;
+        }
+        for (int y = range.minY; y <= range.maxY; y++) {
+            for (int x = range.minX; x <= range.maxX; x++) {
+                int tile = y * GRID_X + x;
+                uint32_t* cluster = &clusterGrid[(slice * tiles + tile) * 2];
+                if (cluster[1] < counts[tile]) {
+                    indices[cluster[0] + cluster[1]] = static_cast<uint32_t>(i);
+                    cluster[1]++;
+                }
+            }
+        }
+    }
+}
+
+void ClusteredLighting::upload() {
+    // Orphan and refill each buffer, then point the buffer textures at them
+    glBindBuffer(GL_TEXTURE_BUFFER, lightBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, lightData.size() * sizeof(glm::vec4), lightData.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, gridBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, clusterGrid.size() * sizeof(uint32_t), clusterGrid.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, indexBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, lightIndices.size() * sizeof(uint32_t), lightIndices.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    glBindTexture(GL_TEXTURE_BUFFER, lightTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, lightBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, gridTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32UI, gridBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, indexTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, indexBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
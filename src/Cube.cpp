@@ -1,8 +1,6 @@
 #include "Cube.h"
 
-Cube::Cube() {
-    mesh = std::make_unique<Mesh>(getCubeVertices(), getCubeIndices());
-}
+Cube::Cube(MeshRegistry& registry) : mesh(registry.create(getCubeVertices(), getCubeIndices())) {}
 
 Cube::~Cube() = default;
 
@@ -11,7 +9,7 @@ void Cube::draw() {
 }
 
 void Cube::drawFace(int faceIndex) {
-    if (faceIndex >= 0 && faceIndex < 6) {
+    if (faceIndex >= 0 && faceIndex < 6 && mesh.isReady()) {
         // Bind the VAO and draw only the specific face
         glBindVertexArray(mesh->getVAO());
         // Each face has 6 indices, so offset by faceIndex * 6 * sizeof(unsigned int)
@@ -20,25 +18,40 @@ void Cube::drawFace(int faceIndex) {
     }
 }
 
-std::vector<unsigned int> Cube::getFaceIndices(int faceIndex) {
+void Cube::drawFaceInstanced(int faceIndex, unsigned int instanceVBO, size_t firstInstance, int instanceCount) {
+    if (faceIndex < 0 || faceIndex >= 6 || instanceCount <= 0 || !mesh.isReady()) {
+        return;
+    }
+
+    glBindVertexArray(mesh->getVAO());
+
+    // Point the instance attributes at this face's range of the instance buffer
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    size_t base = firstInstance * sizeof(CubeInstance);
+
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(CubeInstance), (void*)(base + offsetof(CubeInstance, offset)));
+    glVertexAttribDivisor(3, 1);
+
+    glEnableVertexAttribArray(4);
+    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(CubeInstance), (void*)(base + offsetof(CubeInstance, color)));
+    glVertexAttribDivisor(4, 1);
+
+    glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)(faceIndex * 6 * sizeof(unsigned int)), instanceCount);
+    glBindVertexArray(0);
+}
+
+const unsigned int* Cube::getFaceIndices(int faceIndex) {
     if (faceIndex < 0 || faceIndex >= 6) {
-        return {};
+        return nullptr;
     }
     
     // Each face has 6 indices (2 triangles)
-    std::vector<unsigned int> allIndices = getCubeIndices();
-    std::vector<unsigned int> faceIndices;
-    
-    int startIndex = faceIndex * 6;
-    for (int i = 0; i < 6; i++) {
-        faceIndices.push_back(allIndices[startIndex + i]);
-    }
-    
-    return faceIndices;
+    return getCubeIndices().data() + faceIndex * 6;
 }
 
-std::vector<Vertex> Cube::getCubeVertices() {
-    std::vector<Vertex> vertices = {
+const std::vector<Vertex>& Cube::getCubeVertices() {
+    static const std::vector<Vertex> vertices = {
         // Front face
         {{-0.5f, -0.5f,  0.5f}, { 0.0f,  0.0f,  1.0f}, {0.0f, 0.0f}},
         {{ 0.5f, -0.5f,  0.5f}, { 0.0f,  0.0f,  1.0f}, {1.0f, 0.0f}},
@@ -79,8 +92,8 @@ std::vector<Vertex> Cube::getCubeVertices() {
     return vertices;
 }
 
-std::vector<unsigned int> Cube::getCubeIndices() {
-    std::vector<unsigned int> indices = {
+const std::vector<unsigned int>& Cube::getCubeIndices() {
+    static const std::vector<unsigned int> indices = {
         // Front face
         0,  1,  2,  2,  3,  0,
         // Back face
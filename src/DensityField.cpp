@@ -0,0 +1,205 @@
+#include "DensityField.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define DENSITY_USE_SSE 1
+#endif
+
+namespace {
+    // Offset of the cave noise so its zero crossings don't line up with the terrain noise
+    const float CAVE_OFFSET = 71.3f;
+
+    // Byte mask for each 4-bit compare result
+    const uint8_t MASK_BYTES[16][4] = {
+        {0, 0, 0, 0}, {1, 0, 0, 0}, {0, 1, 0, 0}, {1, 1, 0, 0},
+        {0, 0, 1, 0}, {1, 0, 1, 0}, {0, 1, 1, 0}, {1, 1, 1, 0},
+        {0, 0, 0, 1}, {1, 0, 0, 1}, {0, 1, 0, 1}, {1, 1, 0, 1},
+        {0, 0, 1, 1}, {1, 0, 1, 1}, {0, 1, 1, 1}, {1, 1, 1, 1}
+    };
+
+    // Bilinear interpolation in y and z of one lattice row, four lattice columns at a time
+    void interpolateRow(const float* row00, const float* row01, const float* row10, const float* row11,
+                        float fy, float fz, int count, float* out) {
+#ifdef DENSITY_USE_SSE
+        __m128 vfy = _mm_set1_ps(fy);
+        __m128 vfz = _mm_set1_ps(fz);
+        for (int i = 0; i < count; i += 4) {
+            __m128 a = _mm_loadu_ps(row00 + i);
+            __m128 b = _mm_loadu_ps(row01 + i);
+            __m128 c = _mm_loadu_ps(row10 + i);
+            __m128 d = _mm_loadu_ps(row11 + i);
+            __m128 lower = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), vfz));
+            __m128 upper = _mm_add_ps(c, _mm_mul_ps(_mm_sub_ps(d, c), vfz));
+            _mm_storeu_ps(out + i, _mm_add_ps(lower, _mm_mul_ps(_mm_sub_ps(upper, lower), vfy)));
+        }
+#else
+        for (int i = 0; i < count; i++) {
+            float lower = row00[i] + (row01[i] - row00[i]) * fz;
+            float upper = row10[i] + (row11[i] - row10[i]) * fz;
+            out[i] = lower + (upper - lower) * fy;
+        }
+#endif
+    }
+}
+
+DensityField::DensityField(const NoiseGenerator& terrainNoise, const NoiseGenerator& caveNoise,
+                           const DensitySettings& settings)
+    : terrainNoise(terrainNoise), caveNoise(caveNoise), settings(settings) {}
+
+float DensityField::sample(float x, float y, float z) const {
+    float density = terrainDensity(x, y, z);
+    if (hasCaves(y)) {
+        // Carve where the cave noise is within caveThreshold of zero
+        density = std::min(density, (std::fabs(caveValue(x, y, z)) - settings.caveThreshold) * 4.0f);
+    }
+    return density;
+}
+
+float DensityField::terrainDensity(float x, float y, float z) const {
+    // Negative above the surface level, positive below, displaced by 3D noise
+    return (settings.surfaceLevel - y) / settings.surfaceRange +
+           terrainNoise.octaveNoise(x / settings.scale, y / settings.scale, z / settings.scale,
+                                    settings.octaves, settings.persistence, settings.lacunarity);
+}
+
+float DensityField::caveValue(float x, float y, float z) const {
+    // Stretching y keeps tunnels closer to horizontal
+    return caveNoise.octaveNoise(x / settings.caveScale + CAVE_OFFSET,
+                                 y / settings.caveScale * 1.5f + CAVE_OFFSET,
+                                 z / settings.caveScale + CAVE_OFFSET,
+                                 settings.caveOctaves, 0.5f, 2.0f);
+}
+
+void DensityField::sampleLatticeRow(float y, float z, int count, float* coords, float* terrainRow,
+                                    float* caveRow) const {
+    // Same values as terrainDensity()/caveValue(), through the backends' batch paths
+    float* xs = coords;
+    float* ys = coords + count;
+    float* zs = coords + 2 * count;
+    for (int i = 0; i < count; i++) {
+        xs[i] = static_cast<float>(settings.originX + i * LATTICE_SPACING) / settings.scale;
+    }
+    std::fill(ys, ys + count, y / settings.scale);
+    std::fill(zs, zs + count, z / settings.scale);
+    terrainNoise.octaveNoise(xs, ys, zs, terrainRow, count,
+                             settings.octaves, settings.persistence, settings.lacunarity);
+    for (int i = 0; i < count; i++) {
+        terrainRow[i] += (settings.surfaceLevel - y) / settings.surfaceRange;
+    }
+
+    if (caveRow) {
+        for (int i = 0; i < count; i++) {
+            xs[i] = static_cast<float>(settings.originX + i * LATTICE_SPACING) / settings.caveScale + CAVE_OFFSET;
+        }
+        std::fill(ys, ys + count, y / settings.caveScale * 1.5f + CAVE_OFFSET);
+        std::fill(zs, zs + count, z / settings.caveScale + CAVE_OFFSET);
+        caveNoise.octaveNoise(xs, ys, zs, caveRow, count, settings.caveOctaves, 0.5f, 2.0f);
+    }
+}
+
+void DensityField::fillPerVoxel(int sizeX, int sizeY, int sizeZ, std::vector<uint8_t>& solid) const {
+    solid.resize(static_cast<size_t>(sizeX) * sizeY * sizeZ);
+    size_t index = 0;
+    for (int y = 0; y < sizeY; y++) {
+        for (int z = 0; z < sizeZ; z++) {
+            for (int x = 0; x < sizeX; x++) {
+                solid[index++] = sample(static_cast<float>(settings.originX + x), static_cast<float>(y),
+                                        static_cast<float>(settings.originZ + z)) > 0.0f;
+            }
+        }
+    }
+}
+
+void DensityField::fillLattice(int sizeX, int sizeY, int sizeZ, std::vector<uint8_t>& solid) const {
+    solid.resize(static_cast<size_t>(sizeX) * sizeY * sizeZ);
+    if (solid.empty()) {
+        return;
+    }
+
+    // Lattice points every LATTICE_SPACING blocks, one past the far edge of the grid
+    const int cellsX = (sizeX + LATTICE_SPACING - 1) / LATTICE_SPACING;
+    const int pointsX = cellsX + 1;
+    const int pointsY = (sizeY + LATTICE_SPACING - 1) / LATTICE_SPACING + 1;
+    const int pointsZ = (sizeZ + LATTICE_SPACING - 1) / LATTICE_SPACING + 1;
+    // Rows are padded to whole SSE vectors
+    const int rowStride = (pointsX + 3) & ~3;
+    const bool anyCaves = hasCaves(static_cast<float>(sizeY - 1));
+
+    size_t latticeSize = static_cast<size_t>(rowStride) * pointsY * pointsZ;
+    std::vector<float> terrainLattice(latticeSize, 0.0f);
+    std::vector<float> caveLattice(anyCaves ? latticeSize : 0, 0.0f);
+    std::vector<float> coords(3 * static_cast<size_t>(pointsX));
+    for (int ly = 0; ly < pointsY; ly++) {
+        for (int lz = 0; lz < pointsZ; lz++) {
+            size_t rowStart = (static_cast<size_t>(ly) * pointsZ + lz) * rowStride;
+            sampleLatticeRow(static_cast<float>(ly * LATTICE_SPACING),
+                             static_cast<float>(settings.originZ + lz * LATTICE_SPACING),
+                             pointsX, coords.data(), &terrainLattice[rowStart], anyCaves ? &caveLattice[rowStart] : nullptr);
+        }
+    }
+
+    // Fields along x at the lattice points for the current (y, z) row
+    std::vector<float> terrainRow(rowStride, 0.0f);
+    std::vector<float> caveRow(rowStride, 0.0f);
+    const float step = 1.0f / LATTICE_SPACING;
+    const size_t sliceStride = static_cast<size_t>(pointsZ) * rowStride;
+
+    for (int y = 0; y < sizeY; y++) {
+        int ly = y / LATTICE_SPACING;
+        float fy = (y % LATTICE_SPACING) * step;
+        bool carve = hasCaves(static_cast<float>(y));
+
+        for (int z = 0; z < sizeZ; z++) {
+            int lz = z / LATTICE_SPACING;
+            float fz = (z % LATTICE_SPACING) * step;
+            size_t rowStart = (static_cast<size_t>(ly) * pointsZ + lz) * rowStride;
+
+            const float* terrain = &terrainLattice[rowStart];
+            interpolateRow(terrain, terrain + rowStride, terrain + sliceStride, terrain + sliceStride + rowStride,
+                           fy, fz, rowStride, terrainRow.data());
+            if (carve) {
+                const float* cave = &caveLattice[rowStart];
+                interpolateRow(cave, cave + rowStride, cave + sliceStride, cave + sliceStride + rowStride,
+                               fy, fz, rowStride, caveRow.data());
+            }
+
+            // Linear in x: each lattice cell expands to one vector of four voxels
+            uint8_t* out = &solid[(static_cast<size_t>(y) * sizeZ + z) * sizeX];
+#ifdef DENSITY_USE_SSE
+            const __m128 offsets = _mm_set_ps(3.0f * step, 2.0f * step, step, 0.0f);
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 signMask = _mm_set1_ps(-0.0f);
+            const __m128 threshold = _mm_set1_ps(settings.caveThreshold);
+            const __m128 carveScale = _mm_set1_ps(4.0f);
+#endif
+            for (int cell = 0; cell < cellsX; cell++) {
+                int x0 = cell * LATTICE_SPACING;
+                int count = std::min(LATTICE_SPACING, sizeX - x0);
+#ifdef DENSITY_USE_SSE
+                __m128 density = _mm_add_ps(_mm_set1_ps(terrainRow[cell]),
+                    _mm_mul_ps(_mm_set1_ps(terrainRow[cell + 1] - terrainRow[cell]), offsets));
+                if (carve) {
+                    __m128 cave = _mm_add_ps(_mm_set1_ps(caveRow[cell]),
+                        _mm_mul_ps(_mm_set1_ps(caveRow[cell + 1] - caveRow[cell]), offsets));
+                    __m128 distance = _mm_sub_ps(_mm_andnot_ps(signMask, cave), threshold);
+                    density = _mm_min_ps(density, _mm_mul_ps(distance, carveScale));
+                }
+                int bits = _mm_movemask_ps(_mm_cmpgt_ps(density, zero));
+                std::memcpy(out + x0, MASK_BYTES[bits], count);
+#else
+                for (int i = 0; i < count; i++) {
+                    float t = i * step;
+                    float density = terrainRow[cell] + (terrainRow[cell + 1] - terrainRow[cell]) * t;
+                    if (carve) {
+                        float cave = caveRow[cell] + (caveRow[cell + 1] - caveRow[cell]) * t;
+                        density = std::min(density, (std::fabs(cave) - settings.caveThreshold) * 4.0f);
+                    }
+                    out[x0 + i] = density > 0.0f;
+                }
+#endif
+            }
+        }
+    }
+}
@@ -0,0 +1,122 @@
+#include "DynamicResolution.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+    // Fullscreen triangle from gl_VertexID, no vertex buffer
+    const char* LOAD_VERTEX_SOURCE = R"(#version 330 core
+void main() {
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+    // Busy work per pixel; the result is blended away but still has to be computed
+    const char* LOAD_FRAGMENT_SOURCE = R"(#version 330 core
+uniform int iterations;
+out vec4 FragColor;
+void main() {
+    float value = gl_FragCoord.x * 0.001 + gl_FragCoord.y * 0.002;
+    for (int i = 0; i < iterations; i++) {
+        value = sin(value * 1.7 + 0.3) + cos(value * 0.9);
+    }
+    FragColor = vec4(value);
+}
+)";
+}
+
+DynamicResolution::DynamicResolution(float maxScale)
+    : maxScale(std::min(std::max(maxScale, 0.1f), 1.0f)), framebuffer(0), colorBuffer(0), depthBuffer(0),
+      targetWidth(0), targetHeight(0), windowWidth(0), windowHeight(0), renderWidth(0), renderHeight(0),
+      loadIterations(0), loadVAO(0), loadShaderReady(false) {
+    glGenFramebuffers(1, &framebuffer);
+    glGenRenderbuffers(1, &colorBuffer);
+    glGenRenderbuffers(1, &depthBuffer);
+}
+
+DynamicResolution::~DynamicResolution() {
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteRenderbuffers(1, &colorBuffer);
+    glDeleteRenderbuffers(1, &depthBuffer);
+    if (loadVAO != 0) {
+        glDeleteVertexArrays(1, &loadVAO);
+    }
+}
+
+void DynamicResolution::resize(int width, int height) {
+    targetWidth = width;
+    targetHeight = height;
+
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Dynamic resolution framebuffer incomplete" << std::endl;
+    }
+}
+
+void DynamicResolution::beginScene(int width, int height, float scale) {
+    windowWidth = std::max(width, 1);
+    windowHeight = std::max(height, 1);
+    int neededWidth = std::max(1, static_cast<int>(std::ceil(windowWidth * maxScale)));
+    int neededHeight = std::max(1, static_cast<int>(std::ceil(windowHeight * maxScale)));
+    if (neededWidth != targetWidth || neededHeight != targetHeight) {
+        resize(neededWidth, neededHeight);
+    }
+
+    scale = std::min(std::max(scale, 0.1f), maxScale);
+    renderWidth = std::min(targetWidth, std::max(1, static_cast<int>(windowWidth * scale + 0.5f)));
+    renderHeight = std::min(targetHeight, std::max(1, static_cast<int>(windowHeight * scale + 0.5f)));
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, renderWidth, renderHeight);
+}
+
+void DynamicResolution::endScene() {
+    if (loadIterations > 0) {
+        drawArtificialLoad();
+    }
+
+    // Linear filtering upscales the used corner to the whole window
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, renderWidth, renderHeight, 0, 0, windowWidth, windowHeight, GL_COLOR_BUFFER_BIT,
+                      renderWidth == windowWidth && renderHeight == windowHeight ? GL_NEAREST : GL_LINEAR);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, windowWidth, windowHeight);
+}
+
+void DynamicResolution::drawArtificialLoad() {
+    if (!loadShaderReady) {
+        if (!loadShader.loadFromStrings(LOAD_VERTEX_SOURCE, LOAD_FRAGMENT_SOURCE)) {
+            std::cerr << "Artificial load shader failed; load disabled" << std::endl;
+            loadIterations = 0;
+            return;
+        }
+        // Core profile draws need a bound vertex array, even an empty one
+        glGenVertexArrays(1, &loadVAO);
+        loadShaderReady = true;
+    }
+
+    // Blending with (ZERO, ONE) keeps the scene as it was
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ZERO, GL_ONE);
+    loadShader.use();
+    loadShader.setInt("iterations", loadIterations);
+    glBindVertexArray(loadVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glDisable(GL_BLEND);
+    if (depthTest) {
+        glEnable(GL_DEPTH_TEST);
+    }
+}
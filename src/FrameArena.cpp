@@ -0,0 +1,33 @@
+#include "FrameArena.h"
+#include <algorithm>
+
+FrameArena::FrameArena(size_t capacity)
+    : buffer(new uint8_t[capacity]), capacity(capacity), offset(0), highWater(0), overflowBytes(0) {}
+
+void* FrameArena::allocate(size_t bytes, size_t alignment) {
+    // The buffer comes from new[], so aligning the offset aligns the address
+    // for anything up to max_align_t
+    size_t start = (offset + alignment - 1) / alignment * alignment;
+    if (start + bytes <= capacity) {
+        offset = start + bytes;
+        highWater = std::max(highWater, getUsed());
+        return buffer.get() + start;
+    }
+
+    overflow.emplace_back(new uint8_t[bytes + alignment]);
+    overflowBytes += bytes + alignment;
+    highWater = std::max(highWater, getUsed());
+    uintptr_t address = reinterpret_cast<uintptr_t>(overflow.back().get());
+    return reinterpret_cast<void*>((address + alignment - 1) / alignment * alignment);
+}
+
+void FrameArena::reset() {
+    if (!overflow.empty()) {
+        // Next frames fit in one buffer again
+        overflow.clear();
+        capacity = std::max(capacity * 2, highWater);
+        buffer.reset(new uint8_t[capacity]);
+    }
+    offset = 0;
+    overflowBytes = 0;
+}
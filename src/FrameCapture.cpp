@@ -0,0 +1,247 @@
+#include "FrameCapture.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace {
+    double millisecondsBetween(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+}
+
+FrameCapture::FrameCapture()
+    : format(CAPTURE_PNG), framesPerSecond(60), active(false), oldestReadback(0), pendingReadbacks(0), freeCount(0),
+      queueHead(0), queueCount(0), framesWritten(0), stopping(false), videoSizeWarned(false), outputFailed(false),
+      framesCaptured(0), stalls(0), captureMilliseconds(0.0) {}
+
+FrameCapture::~FrameCapture() {
+    stop();
+}
+
+bool FrameCapture::start(CaptureFormat f, const std::string& p, int fps) {
+    if (active) {
+        std::cerr << "Frame capture already running" << std::endl;
+        return false;
+    }
+    format = f;
+    path = p;
+    framesPerSecond = std::max(fps, 1);
+
+    // Probe the output now rather than failing on the writer thread later
+    std::string probe = format == CAPTURE_PNG ? path + "000000.png" : path;
+    if (std::FILE* file = std::fopen(probe.c_str(), "wb")) {
+        std::fclose(file);
+    } else {
+        std::cerr << "Cannot write frame capture to " << probe << std::endl;
+        return false;
+    }
+
+    for (Readback& readback : readbacks) {
+        glGenBuffers(1, &readback.buffer);
+        readback.capacity = 0;
+    }
+    oldestReadback = 0;
+    pendingReadbacks = 0;
+    for (int i = 0; i < QUEUE_FRAMES; i++) {
+        freeFrames[i] = i;
+    }
+    freeCount = QUEUE_FRAMES;
+    queueHead = 0;
+    queueCount = 0;
+    framesWritten = 0;
+    framesCaptured = 0;
+    stalls = 0;
+    captureMilliseconds = 0.0;
+    videoSizeWarned = false;
+    outputFailed = false;
+    stopping = false;
+    active = true;
+    writer = std::thread(&FrameCapture::writerLoop, this);
+    return true;
+}
+
+void FrameCapture::captureFrame(int width, int height) {
+    if (!active || outputFailed || width <= 0 || height <= 0) {
+        return;
+    }
+    auto startTime = std::chrono::steady_clock::now();
+    if (framesCaptured == 0) {
+        firstCapture = startTime;
+    }
+
+    // Hand over whatever the GPU has finished, oldest first
+    while (pendingReadbacks > 0 && collect(false)) {
+    }
+    // Every buffer is still in flight: the GPU is PBO_COUNT frames behind
+    if (pendingReadbacks == PBO_COUNT) {
+        stalls++;
+        collect(true);
+    }
+
+    Readback& readback = readbacks[(oldestReadback + pendingReadbacks) % PBO_COUNT];
+    size_t bytes = static_cast<size_t>(width) * height * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+    if (bytes > readback.capacity) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(bytes), nullptr, GL_STREAM_READ);
+        readback.capacity = bytes;
+    }
+    // RGBA rows are always 4-byte aligned; the copy into the buffer is asynchronous
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glReadBuffer(GL_BACK);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    readback.width = width;
+    readback.height = height;
+    pendingReadbacks++;
+    framesCaptured++;
+
+    lastCapture = std::chrono::steady_clock::now();
+    captureMilliseconds += millisecondsBetween(startTime, lastCapture);
+}
+
+bool FrameCapture::collect(bool wait) {
+    Readback& readback = readbacks[oldestReadback];
+    // Flushing on the blocking path makes sure the fence can ever be reached
+    GLenum status = glClientWaitSync(readback.fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+                                     wait ? 1000000000ull : 0);
+    while (wait && status == GL_TIMEOUT_EXPIRED) {
+        status = glClientWaitSync(readback.fence, 0, 1000000000ull);
+    }
+    if (status == GL_TIMEOUT_EXPIRED) {
+        return false;
+    }
+    glDeleteSync(readback.fence);
+    readback.fence = nullptr;
+
+    int frameIndex;
+    {
+        // Back pressure: wait for the writer rather than drop the frame
+        std::unique_lock<std::mutex> lock(mutex);
+        if (freeCount == 0) {
+            stalls++;
+            condition.wait(lock, [this] { return freeCount > 0; });
+        }
+        frameIndex = freeFrames[--freeCount];
+    }
+
+    CpuFrame& frame = frames[frameIndex];
+    size_t bytes = static_cast<size_t>(readback.width) * readback.height * 4;
+    if (frame.pixels.size() < bytes) {
+        frame.pixels.resize(bytes);
+    }
+    frame.width = readback.width;
+    frame.height = readback.height;
+    frame.index = framesCaptured - pendingReadbacks;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+    const void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(bytes), GL_MAP_READ_BIT);
+    if (data) {
+        std::memcpy(frame.pixels.data(), data, bytes);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    } else {
+        std::memset(frame.pixels.data(), 0, bytes);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    oldestReadback = (oldestReadback + 1) % PBO_COUNT;
+    pendingReadbacks--;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queuedFrames[(queueHead + queueCount) % QUEUE_FRAMES] = frameIndex;
+        queueCount++;
+    }
+    condition.notify_all();
+    return true;
+}
+
+void FrameCapture::stop() {
+    if (!active) {
+        return;
+    }
+    while (pendingReadbacks > 0) {
+        collect(true);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    condition.notify_all();
+    writer.join();
+
+    for (Readback& readback : readbacks) {
+        glDeleteBuffers(1, &readback.buffer);
+        readback.buffer = 0;
+        readback.capacity = 0;
+    }
+    if (format == CAPTURE_Y4M && !video.close()) {
+        std::cerr << "Failed to finish " << path << std::endl;
+    }
+    active = false;
+}
+
+int FrameCapture::getFramesWritten() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return framesWritten;
+}
+
+double FrameCapture::getElapsedMilliseconds() const {
+    return framesCaptured > 0 ? millisecondsBetween(firstCapture, lastCapture) : 0.0;
+}
+
+void FrameCapture::writerLoop() {
+    while (true) {
+        int frameIndex;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this] { return queueCount > 0 || stopping; });
+            if (queueCount == 0) {
+                return;
+            }
+            frameIndex = queuedFrames[queueHead];
+            queueHead = (queueHead + 1) % QUEUE_FRAMES;
+            queueCount--;
+        }
+
+        writeFrame(frames[frameIndex]);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            freeFrames[freeCount++] = frameIndex;
+            framesWritten++;
+        }
+        condition.notify_all();
+    }
+}
+
+void FrameCapture::writeFrame(const CpuFrame& frame) {
+    if (format == CAPTURE_PNG) {
+        char number[16];
+        std::snprintf(number, sizeof(number), "%06d.png", frame.index);
+        writePng(path + number, frame.pixels.data(), frame.width, frame.height, encodeScratch);
+        return;
+    }
+
+    // Frames still queued after a failed open are dropped without another message
+    if (outputFailed) {
+        return;
+    }
+    if (frame.index == 0 && !video.open(path, frame.width, frame.height, framesPerSecond)) {
+        std::cerr << "Video capture stopped: cannot write " << path << std::endl;
+        outputFailed = true;
+        return;
+    }
+    if (frame.width != video.getWidth() || frame.height != video.getHeight()) {
+        // A video has one size; frames after a window resize are skipped
+        if (!videoSizeWarned) {
+            std::cerr << "Window resized during video capture; skipping " << frame.width << "x" << frame.height
+                      << " frames" << std::endl;
+            videoSizeWarned = true;
+        }
+        return;
+    }
+    video.writeFrame(frame.pixels.data());
+}
@@ -0,0 +1,74 @@
+#include "FramePacer.h"
+#include <algorithm>
+#include <thread>
+
+namespace {
+    // Bounds of the spin margin and what is added to the percentile, microseconds
+    const double MIN_MARGIN = 200.0;
+    const double MAX_MARGIN = 4000.0;
+    const double MARGIN_SLACK = 100.0;
+
+    double millisecondsOf(std::chrono::steady_clock::duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+}
+
+FramePacer::FramePacer(double framesPerSecond)
+    : rate(0.0), started(false), latenessNext(0), margin(1000.0), sleepMilliseconds(0.0), spinMilliseconds(0.0) {
+    std::fill(lateness, lateness + LATENESS_SAMPLES, margin);
+    setRate(framesPerSecond);
+}
+
+void FramePacer::setRate(double framesPerSecond) {
+    rate = std::max(framesPerSecond, 1.0);
+    period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / rate));
+    started = false;
+}
+
+void FramePacer::reset() {
+    started = false;
+}
+
+double FramePacer::getSpinMarginMilliseconds() const {
+    return margin / 1000.0;
+}
+
+void FramePacer::wait() {
+    Clock::time_point now = Clock::now();
+    if (!started) {
+        deadline = now;
+        started = true;
+    }
+    deadline += period;
+    if (now > deadline) {
+        // Already late: run the next frame at once, and skip the schedule ahead if a whole period behind
+        if (now - deadline > period) {
+            deadline = now;
+        }
+        return;
+    }
+
+    auto spin = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::micro>(margin));
+    if (deadline - now > spin) {
+        Clock::time_point target = deadline - spin;
+        std::this_thread::sleep_until(target);
+        Clock::time_point woke = Clock::now();
+        sleepMilliseconds += millisecondsOf(woke - now);
+        now = woke;
+
+        lateness[latenessNext] = std::chrono::duration<double, std::micro>(woke - target).count();
+        latenessNext = (latenessNext + 1) % LATENESS_SAMPLES;
+        double sorted[LATENESS_SAMPLES];
+        std::copy(lateness, lateness + LATENESS_SAMPLES, sorted);
+        std::nth_element(sorted, sorted + LATENESS_SAMPLES * 9 / 10, sorted + LATENESS_SAMPLES);
+        margin = std::min(std::max(sorted[LATENESS_SAMPLES * 9 / 10] + MARGIN_SLACK, MIN_MARGIN), MAX_MARGIN);
+    }
+
+    // Yielding keeps the spin polite when other threads want the core
+    while (now < deadline) {
+        std::this_thread::yield();
+        Clock::time_point next = Clock::now();
+        spinMilliseconds += millisecondsOf(next - now);
+        now = next;
+    }
+}
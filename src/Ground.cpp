@@ -1,8 +1,6 @@
 #include "Ground.h"
 
-Ground::Ground(float size) {
-    mesh = std::make_unique<Mesh>(getGroundVertices(size), getGroundIndices());
-}
+Ground::Ground(MeshRegistry& registry, float size) : mesh(registry.create(getGroundVertices(size), getGroundIndices())) {}
 
 Ground::~Ground() = default;
 
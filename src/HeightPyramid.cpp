@@ -0,0 +1,61 @@
+#include "HeightPyramid.h"
+#include <algorithm>
+
+void HeightPyramid::build(const float* heights, int width, int depth) {
+    levels.clear();
+    levelWidths.clear();
+    levelDepths.clear();
+    if (width <= 0 || depth <= 0) {
+        return;
+    }
+
+    levels.emplace_back(static_cast<size_t>(width) * depth);
+    levelWidths.push_back(width);
+    levelDepths.push_back(depth);
+    for (size_t i = 0; i < levels[0].size(); i++) {
+        levels[0][i] = static_cast<uint16_t>(std::max(heights[i], 0.0f));
+    }
+
+    while (levelWidths.back() > 1 || levelDepths.back() > 1) {
+        int level = static_cast<int>(levels.size());
+        int levelWidth = (levelWidths.back() + 1) / 2;
+        int levelDepth = (levelDepths.back() + 1) / 2;
+        levels.emplace_back(static_cast<size_t>(levelWidth) * levelDepth);
+        levelWidths.push_back(levelWidth);
+        levelDepths.push_back(levelDepth);
+        for (int z = 0; z < levelDepth; z++) {
+            for (int x = 0; x < levelWidth; x++) {
+                levels[level][static_cast<size_t>(z) * levelWidth + x] = reduce(level, x, z);
+            }
+        }
+    }
+}
+
+uint16_t HeightPyramid::reduce(int level, int x, int z) const {
+    const std::vector<uint16_t>& below = levels[level - 1];
+    int belowWidth = levelWidths[level - 1];
+    int belowDepth = levelDepths[level - 1];
+    // Odd sizes leave the last row or column of cells with fewer children
+    int x1 = std::min(2 * x + 1, belowWidth - 1);
+    int z1 = std::min(2 * z + 1, belowDepth - 1);
+    size_t row0 = static_cast<size_t>(2 * z) * belowWidth;
+    size_t row1 = static_cast<size_t>(z1) * belowWidth;
+    return std::max(std::max(below[row0 + 2 * x], below[row0 + x1]), std::max(below[row1 + 2 * x], below[row1 + x1]));
+}
+
+void HeightPyramid::setHeight(int x, int z, int height) {
+    if (levels.empty() || x < 0 || z < 0 || x >= levelWidths[0] || z >= levelDepths[0]) {
+        return;
+    }
+    levels[0][static_cast<size_t>(z) * levelWidths[0] + x] = static_cast<uint16_t>(std::max(height, 0));
+    for (int level = 1; level < static_cast<int>(levels.size()); level++) {
+        x >>= 1;
+        z >>= 1;
+        uint16_t& cell = levels[level][static_cast<size_t>(z) * levelWidths[level] + x];
+        uint16_t value = reduce(level, x, z);
+        if (cell == value) {
+            break;
+        }
+        cell = value;
+    }
+}
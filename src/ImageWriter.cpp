@@ -0,0 +1,238 @@
+#include "ImageWriter.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace {
+    // CRC-32 tables for slicing by 8: table[k][b] is the CRC of byte b
+    // followed by k zero bytes, so eight input bytes take eight lookups
+    struct CrcTables {
+        uint32_t table[8][256];
+    };
+
+    const uint32_t (*getCrcTables())[256] {
+        // Built once, thread-safely: PNGs are encoded on the capture writer thread
+        static const CrcTables tables = [] {
+            CrcTables t;
+            for (uint32_t n = 0; n < 256; n++) {
+                uint32_t c = n;
+                for (int k = 0; k < 8; k++) {
+                    c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+                }
+                t.table[0][n] = c;
+            }
+            for (uint32_t n = 0; n < 256; n++) {
+                for (int k = 1; k < 8; k++) {
+                    t.table[k][n] = t.table[0][t.table[k - 1][n] & 0xff] ^ (t.table[k - 1][n] >> 8);
+                }
+            }
+            return t;
+        }();
+        return tables.table;
+    }
+
+    uint32_t updateCrc(uint32_t crc, const uint8_t* data, size_t size) {
+        const uint32_t (*table)[256] = getCrcTables();
+        for (; size >= 8; size -= 8, data += 8) {
+            uint32_t low = crc ^ (data[0] | data[1] << 8 | data[2] << 16 | static_cast<uint32_t>(data[3]) << 24);
+            crc = table[7][low & 0xff] ^ table[6][(low >> 8) & 0xff] ^ table[5][(low >> 16) & 0xff] ^
+                  table[4][low >> 24] ^ table[3][data[4]] ^ table[2][data[5]] ^ table[1][data[6]] ^
+                  table[0][data[7]];
+        }
+        for (; size > 0; size--, data++) {
+            crc = table[0][(crc ^ *data) & 0xff] ^ (crc >> 8);
+        }
+        return crc;
+    }
+
+    void writeU32BigEndian(std::vector<uint8_t>& out, uint32_t value) {
+        out.push_back(static_cast<uint8_t>(value >> 24));
+        out.push_back(static_cast<uint8_t>(value >> 16));
+        out.push_back(static_cast<uint8_t>(value >> 8));
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    // Appends a chunk: length, type, data, CRC of type and data
+    void writeChunk(std::vector<uint8_t>& out, const char* type, const uint8_t* data, size_t size) {
+        writeU32BigEndian(out, static_cast<uint32_t>(size));
+        size_t typeStart = out.size();
+        out.insert(out.end(), type, type + 4);
+        out.insert(out.end(), data, data + size);
+        uint32_t crc = updateCrc(0xffffffffu, out.data() + typeStart, size + 4) ^ 0xffffffffu;
+        writeU32BigEndian(out, crc);
+    }
+
+    // Limited-range BT.601, 8.8 fixed point
+    inline uint8_t lumaOf(int r, int g, int b) {
+        return static_cast<uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+    }
+}
+
+bool writePng(const std::string& path, const uint8_t* rgba, int width, int height, std::vector<uint8_t>& scratch) {
+    // Filtered image data: a filter byte (0 = none) then RGB for each row, top row first
+    const size_t rowBytes = static_cast<size_t>(width) * 3 + 1;
+    const size_t rawBytes = rowBytes * height;
+    const size_t maxBlock = 65535;
+    const size_t blocks = std::max<size_t>(1, (rawBytes + maxBlock - 1) / maxBlock);
+    const size_t zlibBytes = 2 + rawBytes + blocks * 5 + 4;
+
+    std::vector<uint8_t>& out = scratch;
+    out.clear();
+    const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    out.insert(out.end(), signature, signature + 8);
+
+    uint8_t header[13] = {};
+    for (int i = 0; i < 4; i++) {
+        header[i] = static_cast<uint8_t>(static_cast<uint32_t>(width) >> (24 - 8 * i));
+        header[4 + i] = static_cast<uint8_t>(static_cast<uint32_t>(height) >> (24 - 8 * i));
+    }
+    header[8] = 8;   // bits per channel
+    header[9] = 2;   // RGB
+    writeChunk(out, "IHDR", header, sizeof(header));
+
+    // The filtered rows go after room for the IDAT chunk, then are copied into
+    // its stored blocks of at most 64 KB
+    size_t pngStart = out.size();
+    out.resize(pngStart + 8 + zlibBytes + 4 + rawBytes);
+    uint8_t* raw = out.data() + out.size() - rawBytes;
+    for (int y = 0; y < height; y++) {
+        const uint8_t* source = rgba + static_cast<size_t>(height - 1 - y) * width * 4;
+        uint8_t* row = raw + y * rowBytes;
+        row[0] = 0;
+        for (int x = 0; x < width; x++) {
+            row[1 + x * 3] = source[x * 4];
+            row[2 + x * 3] = source[x * 4 + 1];
+            row[3 + x * 3] = source[x * 4 + 2];
+        }
+    }
+
+    // IDAT: length and type, zlib header, stored blocks, Adler-32 of the rows, CRC
+    uint8_t* p = out.data() + pngStart;
+    auto putU32 = [&p](uint32_t value) {
+        p[0] = static_cast<uint8_t>(value >> 24);
+        p[1] = static_cast<uint8_t>(value >> 16);
+        p[2] = static_cast<uint8_t>(value >> 8);
+        p[3] = static_cast<uint8_t>(value);
+        p += 4;
+    };
+    putU32(static_cast<uint32_t>(zlibBytes));
+    uint8_t* typeStart = p;
+    const uint8_t idatStart[6] = {'I', 'D', 'A', 'T', 0x78, 0x01};
+    std::memcpy(p, idatStart, 6);
+    p += 6;
+    size_t remaining = rawBytes;
+    const uint8_t* source = raw;
+    do {
+        // Block header: final flag, then length and its complement, little endian
+        size_t length = std::min(remaining, maxBlock);
+        p[0] = remaining <= maxBlock ? 1 : 0;
+        p[1] = static_cast<uint8_t>(length);
+        p[2] = static_cast<uint8_t>(length >> 8);
+        p[3] = static_cast<uint8_t>(~length);
+        p[4] = static_cast<uint8_t>(~length >> 8);
+        std::memcpy(p + 5, source, length);
+        p += 5 + length;
+        source += length;
+        remaining -= length;
+    } while (remaining > 0);
+
+    // Adler-32, reducing modulo 65521 only as often as the sums could overflow
+    uint32_t adlerA = 1, adlerB = 0;
+    const uint8_t* data = typeStart + 6;
+    for (size_t block = 0; block < blocks; block++) {
+        data += 5;
+        size_t length = std::min(maxBlock, rawBytes - block * maxBlock);
+        for (size_t i = 0; i < length;) {
+            size_t chunk = std::min<size_t>(length - i, 5552);
+            for (size_t end = i + chunk; i < end; i++) {
+                adlerA += data[i];
+                adlerB += adlerA;
+            }
+            adlerA %= 65521;
+            adlerB %= 65521;
+        }
+        data += length;
+    }
+    putU32((adlerB << 16) | adlerA);
+    putU32(updateCrc(0xffffffffu, typeStart, static_cast<size_t>(p - typeStart)) ^ 0xffffffffu);
+    out.resize(static_cast<size_t>(p - out.data()));
+    writeChunk(out, "IEND", nullptr, 0);
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Failed to open " << path << " for writing" << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(out.data()), static_cast<std::streamsize>(out.size()));
+    return static_cast<bool>(file);
+}
+
+Y4mWriter::Y4mWriter() : width(0), height(0) {}
+
+bool Y4mWriter::open(const std::string& path, int w, int h, int framesPerSecond) {
+    file.open(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Failed to open " << path << " for writing" << std::endl;
+        return false;
+    }
+    width = w;
+    height = h;
+    size_t chromaSize = static_cast<size_t>((width + 1) / 2) * ((height + 1) / 2);
+    planes.assign(static_cast<size_t>(width) * height + 2 * chromaSize, 0);
+    // C420jpeg: chroma sited between the four luma samples it covers, as averaging gives
+    file << "YUV4MPEG2 W" << width << " H" << height << " F" << framesPerSecond << ":1 Ip A1:1 C420jpeg\n";
+    return static_cast<bool>(file);
+}
+
+bool Y4mWriter::writeFrame(const uint8_t* rgba) {
+    if (!file.is_open()) {
+        return false;
+    }
+    const int chromaWidth = (width + 1) / 2;
+    const int chromaHeight = (height + 1) / 2;
+    uint8_t* lumaPlane = planes.data();
+    uint8_t* uPlane = lumaPlane + static_cast<size_t>(width) * height;
+    uint8_t* vPlane = uPlane + static_cast<size_t>(chromaWidth) * chromaHeight;
+
+    // Output row y is input row height - 1 - y
+    auto pixel = [&](int x, int y) { return rgba + (static_cast<size_t>(height - 1 - y) * width + x) * 4; };
+    for (int y = 0; y < height; y++) {
+        uint8_t* lumaRow = lumaPlane + static_cast<size_t>(y) * width;
+        for (int x = 0; x < width; x++) {
+            const uint8_t* p = pixel(x, y);
+            lumaRow[x] = lumaOf(p[0], p[1], p[2]);
+        }
+    }
+    for (int cy = 0; cy < chromaHeight; cy++) {
+        for (int cx = 0; cx < chromaWidth; cx++) {
+            // Average the 2x2 block, clamped at odd edges
+            int r = 0, g = 0, b = 0;
+            for (int dy = 0; dy < 2; dy++) {
+                for (int dx = 0; dx < 2; dx++) {
+                    const uint8_t* p = pixel(std::min(cx * 2 + dx, width - 1), std::min(cy * 2 + dy, height - 1));
+                    r += p[0];
+                    g += p[1];
+                    b += p[2];
+                }
+            }
+            r = (r + 2) >> 2;
+            g = (g + 2) >> 2;
+            b = (b + 2) >> 2;
+            size_t index = static_cast<size_t>(cy) * chromaWidth + cx;
+            uPlane[index] = static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+            vPlane[index] = static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        }
+    }
+
+    file << "FRAME\n";
+    file.write(reinterpret_cast<const char*>(planes.data()), static_cast<std::streamsize>(planes.size()));
+    return static_cast<bool>(file);
+}
+
+bool Y4mWriter::close() {
+    if (!file.is_open()) {
+        return true;
+    }
+    file.close();
+    return !file.fail();
+}
@@ -0,0 +1,148 @@
+#include "InputRecording.h"
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+namespace {
+    // File layout, all little endian:
+    //   "R3DI", u16 version, u16 tick rate, u8 density terrain, u8 noise backend,
+    //   i32 agents, u32 tick count, u32 final checksum, u32 run count,
+    //   then per run: u16 length, u8 buttons, i16 mouse x, i16 mouse y
+    const char MAGIC[4] = {'R', '3', 'D', 'I'};
+    const uint16_t VERSION = 1;
+    const int MAX_RUN = 0xffff;
+
+    void writeU8(std::vector<uint8_t>& out, uint8_t value) {
+        out.push_back(value);
+    }
+
+    void writeU16(std::vector<uint8_t>& out, uint16_t value) {
+        out.push_back(static_cast<uint8_t>(value));
+        out.push_back(static_cast<uint8_t>(value >> 8));
+    }
+
+    void writeU32(std::vector<uint8_t>& out, uint32_t value) {
+        writeU16(out, static_cast<uint16_t>(value));
+        writeU16(out, static_cast<uint16_t>(value >> 16));
+    }
+
+    // Reads from a byte buffer; any read past the end marks the reader failed
+    struct Reader {
+        const std::vector<uint8_t>& data;
+        size_t offset;
+        bool failed;
+
+        uint8_t u8() {
+            if (offset + 1 > data.size()) {
+                failed = true;
+                return 0;
+            }
+            return data[offset++];
+        }
+        uint16_t u16() {
+            uint16_t low = u8();
+            return static_cast<uint16_t>(low | (u8() << 8));
+        }
+        uint32_t u32() {
+            uint32_t low = u16();
+            return low | (static_cast<uint32_t>(u16()) << 16);
+        }
+    };
+}
+
+InputRecording::InputRecording() : tickRate(DEFAULT_TICK_RATE), finalChecksum(0) {}
+
+void InputRecording::clear() {
+    ticks.clear();
+    finalChecksum = 0;
+}
+
+bool InputRecording::save(const std::string& path) const {
+    std::vector<uint8_t> data(MAGIC, MAGIC + 4);
+    writeU16(data, VERSION);
+    writeU16(data, static_cast<uint16_t>(tickRate));
+    writeU8(data, options.densityTerrain ? 1 : 0);
+    writeU8(data, static_cast<uint8_t>(options.noise));
+    writeU32(data, static_cast<uint32_t>(options.agents));
+    writeU32(data, static_cast<uint32_t>(ticks.size()));
+    writeU32(data, finalChecksum);
+
+    size_t runCountOffset = data.size();
+    writeU32(data, 0);
+    uint32_t runCount = 0;
+    for (size_t start = 0; start < ticks.size();) {
+        size_t end = start + 1;
+        while (end < ticks.size() && end - start < MAX_RUN && ticks[end] == ticks[start]) {
+            end++;
+        }
+        writeU16(data, static_cast<uint16_t>(end - start));
+        writeU8(data, ticks[start].buttons);
+        writeU16(data, static_cast<uint16_t>(ticks[start].mouseX));
+        writeU16(data, static_cast<uint16_t>(ticks[start].mouseY));
+        runCount++;
+        start = end;
+    }
+    for (int byte = 0; byte < 4; byte++) {
+        data[runCountOffset + byte] = static_cast<uint8_t>(runCount >> (byte * 8));
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Failed to open recording for writing: " << path << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    if (!file) {
+        std::cerr << "Failed to write recording: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool InputRecording::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Failed to open recording: " << path << std::endl;
+        return false;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    Reader reader{data, 0, false};
+    bool magicMatches = true;
+    for (char expected : MAGIC) {
+        magicMatches = magicMatches && reader.u8() == static_cast<uint8_t>(expected);
+    }
+    if (!magicMatches || reader.u16() != VERSION) {
+        std::cerr << "Not a version " << VERSION << " input recording: " << path << std::endl;
+        return false;
+    }
+
+    int rate = reader.u16();
+    SessionOptions loaded;
+    loaded.densityTerrain = reader.u8() != 0;
+    loaded.noise = reader.u8() == NOISE_SIMPLEX ? NOISE_SIMPLEX : NOISE_PERLIN;
+    loaded.agents = static_cast<int>(reader.u32());
+    uint32_t tickCount = reader.u32();
+    uint32_t checksum = reader.u32();
+    uint32_t runCount = reader.u32();
+
+    std::vector<InputState> loadedTicks;
+    for (uint32_t run = 0; run < runCount && !reader.failed; run++) {
+        int length = reader.u16();
+        InputState input;
+        input.buttons = reader.u8();
+        input.mouseX = static_cast<int16_t>(reader.u16());
+        input.mouseY = static_cast<int16_t>(reader.u16());
+        loadedTicks.insert(loadedTicks.end(), length, input);
+    }
+    if (reader.failed || rate <= 0 || loadedTicks.size() != tickCount) {
+        std::cerr << "Corrupt input recording: " << path << std::endl;
+        return false;
+    }
+
+    options = loaded;
+    tickRate = rate;
+    finalChecksum = checksum;
+    ticks.swap(loadedTicks);
+    return true;
+}
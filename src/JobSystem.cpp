@@ -0,0 +1,126 @@
+#include "JobSystem.h"
+#include "AllocationTracker.h"
+#include <algorithm>
+#include <atomic>
+
+JobSystem::JobSystem(unsigned int threadCount) : taskHead(0), taskCount(0), stopping(false) {
+    if (threadCount == 0) {
+        unsigned int hardwareThreads = std::thread::hardware_concurrency();
+        threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    // Room for one helper per worker from a few overlapping calls
+    tasks.resize(std::max(threadCount * 4, 16u));
+
+    for (unsigned int i = 0; i < threadCount; i++) {
+        workers.emplace_back(&JobSystem::workerLoop, this);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    condition.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void JobSystem::parallelFor(int count, int minBatch, const std::function<void(int, int)>& fn) {
+    if (count <= 0) {
+        return;
+    }
+
+    // A few batches per thread so uneven batches still balance out
+    int concurrency = static_cast<int>(getConcurrency());
+    int batchSize = std::max(std::max(minBatch, 1), (count + concurrency * 4 - 1) / (concurrency * 4));
+    int batchCount = (count + batchSize - 1) / batchSize;
+    if (batchCount == 1) {
+        fn(0, count);
+        return;
+    }
+
+    // Everything the helpers share lives in one struct, so each helper task
+    // captures a single reference and fits std::function's inline storage
+    struct Shared {
+        const std::function<void(int, int)>& fn;
+        int count;
+        int batchSize;
+        int batchCount;
+        AllocationSubsystem subsystem;
+        std::atomic<int> nextBatch;
+        std::mutex doneMutex;
+        std::condition_variable doneCondition;
+        int helpersRunning;
+
+        void runBatches() {
+            int batch;
+            while ((batch = nextBatch.fetch_add(1)) < batchCount) {
+                int begin = batch * batchSize;
+                fn(begin, std::min(begin + batchSize, count));
+            }
+        }
+    };
+
+    // Helpers reference this stack frame, so wait for all of them before returning
+    int helperCount = std::min(batchCount - 1, static_cast<int>(workers.size()));
+    Shared shared{fn, count, batchSize, batchCount, AllocationTracker::getCurrentSubsystem(), {0}, {}, {}, helperCount};
+
+    for (int i = 0; i < helperCount; i++) {
+        enqueue([&shared]() {
+            {
+                // Charge the helper's allocations to whoever called parallelFor
+                AllocationScope scope(shared.subsystem);
+                shared.runBatches();
+            }
+            std::lock_guard<std::mutex> lock(shared.doneMutex);
+            if (--shared.helpersRunning == 0) {
+                shared.doneCondition.notify_one();
+            }
+        });
+    }
+
+    shared.runBatches();
+
+    std::unique_lock<std::mutex> lock(shared.doneMutex);
+    shared.doneCondition.wait(lock, [&shared]() { return shared.helpersRunning == 0; });
+}
+
+void JobSystem::enqueue(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (taskCount == tasks.size()) {
+            // Unwrap the ring into a larger one
+            AllocationScope scope(ALLOC_JOBS);
+            std::vector<std::function<void()>> grown(tasks.size() * 2);
+            for (size_t i = 0; i < taskCount; i++) {
+                grown[i] = std::move(tasks[(taskHead + i) % tasks.size()]);
+            }
+            tasks.swap(grown);
+            taskHead = 0;
+        }
+        tasks[(taskHead + taskCount) % tasks.size()] = std::move(task);
+        taskCount++;
+    }
+    condition.notify_one();
+}
+
+void JobSystem::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]() { return stopping || taskCount > 0; });
+            if (stopping && taskCount == 0) {
+                return;
+            }
+            task = std::move(tasks[taskHead]);
+            tasks[taskHead] = nullptr;
+            taskHead = (taskHead + 1) % tasks.size();
+            taskCount--;
+        }
+        task();
+    }
+}
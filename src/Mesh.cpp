@@ -1,17 +1,62 @@
 #include "Mesh.h"
+#include <utility>
 
-Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices)
-    : vertices(vertices), indices(indices) {
-    setupMesh();
+Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, bool upload)
+    : vertices(std::move(vertices)), indices(std::move(indices)), VAO(0), VBO(0), EBO(0) {
+    vertexCount = this->vertices.size();
+    indexCount = this->indices.size();
+    if (upload) {
+        setupMesh();
+    }
 }
 
 Mesh::~Mesh() {
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &EBO);
+    destroyBuffers();
+}
+
+Mesh::Mesh(Mesh&& other) noexcept
+    : vertices(std::move(other.vertices)), indices(std::move(other.indices)), vertexCount(other.vertexCount),
+      indexCount(other.indexCount), VAO(other.VAO), VBO(other.VBO), EBO(other.EBO) {
+    // The moved-from mesh no longer owns the GL objects
+    other.VAO = other.VBO = other.EBO = 0;
+    other.vertexCount = other.indexCount = 0;
+}
+
+Mesh& Mesh::operator=(Mesh&& other) noexcept {
+    if (this != &other) {
+        destroyBuffers();
+        vertices = std::move(other.vertices);
+        indices = std::move(other.indices);
+        vertexCount = other.vertexCount;
+        indexCount = other.indexCount;
+        VAO = other.VAO;
+        VBO = other.VBO;
+        EBO = other.EBO;
+        other.VAO = other.VBO = other.EBO = 0;
+        other.vertexCount = other.indexCount = 0;
+    }
+    return *this;
+}
+
+void Mesh::destroyBuffers() {
+    if (VAO != 0) {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+        VAO = VBO = EBO = 0;
+    }
+}
+
+void Mesh::releaseCpuData() {
+    // swap() rather than clear() so the capacity goes too
+    std::vector<Vertex>().swap(vertices);
+    std::vector<unsigned int>().swap(indices);
 }
 
 void Mesh::setupMesh() {
+    if (VAO != 0 || vertices.empty()) {
+        return;
+    }
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
     glGenBuffers(1, &EBO);
@@ -40,7 +85,10 @@ void Mesh::setupMesh() {
 }
 
 void Mesh::draw() {
+    if (VAO == 0) {
+        return;
+    }
     glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
+    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indexCount), GL_UNSIGNED_INT, 0);
     glBindVertexArray(0);
 } 
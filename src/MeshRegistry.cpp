@@ -0,0 +1,179 @@
+#include "MeshRegistry.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+MeshHandle::MeshHandle(const MeshHandle& other) : registry(other.registry), slot(other.slot) {
+    if (registry) {
+        registry->addReference(slot);
+    }
+}
+
+MeshHandle::MeshHandle(MeshHandle&& other) noexcept : registry(other.registry), slot(other.slot) {
+    other.registry = nullptr;
+}
+
+MeshHandle& MeshHandle::operator=(MeshHandle other) noexcept {
+    std::swap(registry, other.registry);
+    std::swap(slot, other.slot);
+    return *this;
+}
+
+void MeshHandle::reset() {
+    if (registry) {
+        registry->removeReference(slot);
+        registry = nullptr;
+    }
+}
+
+Mesh* MeshHandle::get() const {
+    return registry ? registry->entries[slot].mesh.get() : nullptr;
+}
+
+bool MeshHandle::isReady() const {
+    return registry && registry->entries[slot].mesh->isUploaded();
+}
+
+MeshHandle MeshRegistry::create(std::vector<Vertex> vertices, std::vector<unsigned int> indices, MeshCpuData cpuData) {
+    uint64_t hash = hashGeometry(vertices, indices);
+    auto found = slotsByHash.find(hash);
+    if (found != slotsByHash.end()) {
+        for (uint32_t slot : found->second) {
+            Entry& entry = entries[slot];
+            if (!sameGeometry(*entry.mesh, vertices, indices)) {
+                continue;
+            }
+            // Matches still hold their CPU data; a caller that needs it makes it stay after upload
+            if (cpuData == MESH_KEEP_CPU) {
+                entry.keepCpu = true;
+            }
+            dedupHits++;
+            addReference(slot);
+            return MeshHandle(this, slot);
+        }
+    }
+
+    uint32_t slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(entries.size());
+        entries.emplace_back();
+    }
+
+    Entry& entry = entries[slot];
+    entry.mesh = std::make_unique<Mesh>(std::move(vertices), std::move(indices), false);
+    entry.hash = hash;
+    entry.refCount = 1;
+    entry.keepCpu = cpuData == MESH_KEEP_CPU;
+    slotsByHash[hash].push_back(slot);
+    uploadQueue.push_back(slot);
+    return MeshHandle(this, slot);
+}
+
+int MeshRegistry::processUploads(size_t byteBudget) {
+    uploadedBytes = 0;
+    int uploaded = 0;
+    while (uploadHead < uploadQueue.size()) {
+        Entry& entry = entries[uploadQueue[uploadHead]];
+        // Freed (or already uploaded through uploadNow) since it was queued
+        if (!entry.mesh || entry.mesh->isUploaded()) {
+            uploadHead++;
+            continue;
+        }
+        size_t bytes = entry.mesh->getDataBytes();
+        if (uploaded > 0 && uploadedBytes + bytes > byteBudget) {
+            break;
+        }
+        upload(entry);
+        uploadedBytes += bytes;
+        uploaded++;
+        uploadHead++;
+    }
+
+    if (uploadHead == uploadQueue.size()) {
+        // Keeps the capacity, so an idle queue doesn't allocate
+        uploadQueue.clear();
+        uploadHead = 0;
+    }
+    return uploaded;
+}
+
+void MeshRegistry::uploadNow(const MeshHandle& handle) {
+    if (handle.registry == this) {
+        upload(entries[handle.slot]);
+    }
+}
+
+MeshStats MeshRegistry::getStats() const {
+    MeshStats stats;
+    for (const Entry& entry : entries) {
+        if (!entry.mesh) {
+            continue;
+        }
+        stats.meshCount++;
+        if (entry.mesh->isUploaded()) {
+            stats.gpuBytes += entry.mesh->getDataBytes();
+        } else {
+            stats.pendingUploads++;
+        }
+        stats.cpuBytes += entry.mesh->getCpuBytes();
+    }
+    stats.dedupHits = dedupHits;
+    stats.uploadedBytes = uploadedBytes;
+    return stats;
+}
+
+void MeshRegistry::removeReference(uint32_t slot) {
+    Entry& entry = entries[slot];
+    if (--entry.refCount > 0) {
+        return;
+    }
+
+    std::vector<uint32_t>& slots = slotsByHash[entry.hash];
+    slots.erase(std::find(slots.begin(), slots.end(), slot));
+    if (slots.empty()) {
+        slotsByHash.erase(entry.hash);
+    }
+    entry.mesh.reset();
+    freeSlots.push_back(slot);
+}
+
+void MeshRegistry::upload(Entry& entry) {
+    entry.mesh->setupMesh();
+    if (!entry.keepCpu) {
+        entry.mesh->releaseCpuData();
+    }
+}
+
+uint64_t MeshRegistry::hashGeometry(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices) {
+    // FNV-1a over the raw bytes; vertex and index counts are mixed in so the
+    // boundary between the two arrays matters
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void* data, size_t bytes) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < bytes; i++) {
+            hash = (hash ^ p[i]) * 1099511628211ull;
+        }
+    };
+    uint64_t counts[2] = {vertices.size(), indices.size()};
+    mix(counts, sizeof(counts));
+    mix(vertices.data(), vertices.size() * sizeof(Vertex));
+    mix(indices.data(), indices.size() * sizeof(unsigned int));
+    return hash;
+}
+
+bool MeshRegistry::sameGeometry(const Mesh& mesh, const std::vector<Vertex>& vertices,
+                                const std::vector<unsigned int>& indices) {
+    if (mesh.getVertexCount() != vertices.size() || mesh.getIndexCount() != indices.size()) {
+        return false;
+    }
+    // Uploaded meshes that dropped their CPU copy can't be compared, so they
+    // aren't shared: a hash match alone could hand out the wrong geometry
+    if (!mesh.hasCpuData()) {
+        return false;
+    }
+    return std::memcmp(mesh.getVertices().data(), vertices.data(), vertices.size() * sizeof(Vertex)) == 0 &&
+           std::memcmp(mesh.getIndices().data(), indices.data(), indices.size() * sizeof(unsigned int)) == 0;
+}
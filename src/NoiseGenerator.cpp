@@ -0,0 +1,112 @@
+#include "NoiseGenerator.h"
+#include <algorithm>
+
+namespace {
+    // Points per batch call in the octave loops; keeps the scratch on the stack
+    const int OCTAVE_BLOCK = 64;
+}
+
+void NoiseGenerator::noise(const float* x, const float* y, float* out, int count) const {
+    for (int i = 0; i < count; i++) {
+        out[i] = noise(x[i], y[i]);
+    }
+}
+
+void NoiseGenerator::noise(const float* x, const float* y, const float* z, float* out, int count) const {
+    for (int i = 0; i < count; i++) {
+        out[i] = noise(x[i], y[i], z[i]);
+    }
+}
+
+float NoiseGenerator::octaveNoise(float x, float y, int octaves, float persistence, float lacunarity) const {
+    float total = 0.0f;
+    float frequency = 1.0f;
+    float amplitude = 1.0f;
+    float maxValue = 0.0f;
+
+    for (int i = 0; i < octaves; i++) {
+        total += noise(x * frequency, y * frequency) * amplitude;
+        maxValue += amplitude;
+        amplitude *= persistence;
+        frequency *= lacunarity;
+    }
+
+    return total / maxValue;
+}
+
+float NoiseGenerator::octaveNoise(float x, float y, float z, int octaves, float persistence, float lacunarity) const {
+    float total = 0.0f;
+    float frequency = 1.0f;
+    float amplitude = 1.0f;
+    float maxValue = 0.0f;
+
+    for (int i = 0; i < octaves; i++) {
+        total += noise(x * frequency, y * frequency, z * frequency) * amplitude;
+        maxValue += amplitude;
+        amplitude *= persistence;
+        frequency *= lacunarity;
+    }
+
+    return total / maxValue;
+}
+
+void NoiseGenerator::octaveNoise(const float* x, const float* y, float* out, int count,
+                                 int octaves, float persistence, float lacunarity) const {
+    float sx[OCTAVE_BLOCK], sy[OCTAVE_BLOCK], sample[OCTAVE_BLOCK], total[OCTAVE_BLOCK];
+    for (int start = 0; start < count; start += OCTAVE_BLOCK) {
+        int n = std::min(OCTAVE_BLOCK, count - start);
+        std::fill(total, total + n, 0.0f);
+
+        float frequency = 1.0f;
+        float amplitude = 1.0f;
+        float maxValue = 0.0f;
+        for (int octave = 0; octave < octaves; octave++) {
+            for (int i = 0; i < n; i++) {
+                sx[i] = x[start + i] * frequency;
+                sy[i] = y[start + i] * frequency;
+            }
+            noise(sx, sy, sample, n);
+            for (int i = 0; i < n; i++) {
+                total[i] += sample[i] * amplitude;
+            }
+            maxValue += amplitude;
+            amplitude *= persistence;
+            frequency *= lacunarity;
+        }
+
+        for (int i = 0; i < n; i++) {
+            out[start + i] = total[i] / maxValue;
+        }
+    }
+}
+
+void NoiseGenerator::octaveNoise(const float* x, const float* y, const float* z, float* out, int count,
+                                 int octaves, float persistence, float lacunarity) const {
+    float sx[OCTAVE_BLOCK], sy[OCTAVE_BLOCK], sz[OCTAVE_BLOCK], sample[OCTAVE_BLOCK], total[OCTAVE_BLOCK];
+    for (int start = 0; start < count; start += OCTAVE_BLOCK) {
+        int n = std::min(OCTAVE_BLOCK, count - start);
+        std::fill(total, total + n, 0.0f);
+
+        float frequency = 1.0f;
+        float amplitude = 1.0f;
+        float maxValue = 0.0f;
+        for (int octave = 0; octave < octaves; octave++) {
+            for (int i = 0; i < n; i++) {
+                sx[i] = x[start + i] * frequency;
+                sy[i] = y[start + i] * frequency;
+                sz[i] = z[start + i] * frequency;
+            }
+            noise(sx, sy, sz, sample, n);
+            for (int i = 0; i < n; i++) {
+                total[i] += sample[i] * amplitude;
+            }
+            maxValue += amplitude;
+            amplitude *= persistence;
+            frequency *= lacunarity;
+        }
+
+        for (int i = 0; i < n; i++) {
+            out[start + i] = total[i] / maxValue;
+        }
+    }
+}
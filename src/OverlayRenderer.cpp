@@ -0,0 +1,197 @@
+#include "OverlayRenderer.h"
+#include "BitmapFont.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+
+namespace {
+    const char* OVERLAY_VERTEX_SOURCE = R"(#version 330 core
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aTexCoord;
+layout (location = 2) in vec4 aColor;
+uniform vec2 screenSize;
+out vec2 texCoord;
+out vec4 color;
+void main() {
+    // Pixels from the top left to clip space
+    vec2 ndc = aPos / screenSize * 2.0 - 1.0;
+    gl_Position = vec4(ndc.x, -ndc.y, 0.0, 1.0);
+    texCoord = aTexCoord;
+    color = aColor;
+}
+)";
+
+    const char* OVERLAY_FRAGMENT_SOURCE = R"(#version 330 core
+uniform sampler2D fontTexture;
+in vec2 texCoord;
+in vec4 color;
+out vec4 FragColor;
+void main() {
+    FragColor = vec4(color.rgb, color.a * texture(fontTexture, texCoord).r);
+}
+)";
+
+    uint32_t packColor(const glm::vec4& color) {
+        auto channel = [](float value) {
+            return static_cast<uint32_t>(std::lround(std::min(std::max(value, 0.0f), 1.0f) * 255.0f));
+        };
+        return channel(color.x) | channel(color.y) << 8 | channel(color.z) << 16 | channel(color.w) << 24;
+    }
+}
+
+OverlayRenderer::OverlayRenderer()
+    : width(1), height(1), drawnVertices(0), drawCalls(0), shaderReady(false), vao(0), vbo(0), vboCapacity(0),
+      fontTexture(0) {
+    shaderReady = shader.loadFromStrings(OVERLAY_VERTEX_SOURCE, OVERLAY_FRAGMENT_SOURCE);
+    if (!shaderReady) {
+        std::cerr << "Overlay shader failed; overlay disabled" << std::endl;
+    }
+
+    // Single-channel atlas; nearest filtering keeps glyph pixels sharp
+    std::vector<uint8_t> pixels = generateFontAtlas();
+    glGenTextures(1, &fontTexture);
+    glBindTexture(GL_TEXTURE_2D, fontTexture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, FONT_ATLAS_WIDTH, FONT_ATLAS_HEIGHT, 0, GL_RED, GL_UNSIGNED_BYTE,
+                 pixels.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    int solidX, solidY;
+    getFontCell(FONT_SOLID_CHAR, solidX, solidY);
+    solidTexCoord = glm::vec2((solidX + FONT_CELL_SIZE * 0.5f) / FONT_ATLAS_WIDTH,
+                              (solidY + FONT_CELL_SIZE * 0.5f) / FONT_ATLAS_HEIGHT);
+
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(OverlayVertex),
+                          reinterpret_cast<void*>(offsetof(OverlayVertex, position)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(OverlayVertex),
+                          reinterpret_cast<void*>(offsetof(OverlayVertex, texCoord)));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(OverlayVertex),
+                          reinterpret_cast<void*>(offsetof(OverlayVertex, color)));
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    vertices.reserve(1024);
+}
+
+OverlayRenderer::~OverlayRenderer() {
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vbo);
+    glDeleteTextures(1, &fontTexture);
+}
+
+void OverlayRenderer::begin(int w, int h) {
+    width = std::max(w, 1);
+    height = std::max(h, 1);
+    vertices.clear();
+}
+
+void OverlayRenderer::addQuad(const glm::vec2 corners[4], const glm::vec2 texCoords[4], uint32_t color) {
+    // Corners go around the quad; two triangles
+    static const int order[6] = {0, 1, 2, 0, 2, 3};
+    for (int index : order) {
+        vertices.push_back({corners[index], texCoords[index], color});
+    }
+}
+
+void OverlayRenderer::addLine(const glm::vec2& from, const glm::vec2& to, float thickness, const glm::vec4& color) {
+    glm::vec2 direction = to - from;
+    float length = glm::length(direction);
+    if (length <= 0.0f) {
+        return;
+    }
+    glm::vec2 side = glm::vec2(-direction.y, direction.x) / length * (thickness * 0.5f);
+    const glm::vec2 corners[4] = {from - side, to - side, to + side, from + side};
+    const glm::vec2 texCoords[4] = {solidTexCoord, solidTexCoord, solidTexCoord, solidTexCoord};
+    addQuad(corners, texCoords, packColor(color));
+}
+
+void OverlayRenderer::addRect(const glm::vec2& min, const glm::vec2& max, const glm::vec4& color) {
+    const glm::vec2 corners[4] = {min, glm::vec2(max.x, min.y), max, glm::vec2(min.x, max.y)};
+    const glm::vec2 texCoords[4] = {solidTexCoord, solidTexCoord, solidTexCoord, solidTexCoord};
+    addQuad(corners, texCoords, packColor(color));
+}
+
+float OverlayRenderer::addText(const glm::vec2& position, const char* text, const glm::vec4& color, int scale) {
+    scale = std::max(scale, 1);
+    uint32_t packed = packColor(color);
+    const glm::vec2 glyphSize(FONT_GLYPH_WIDTH * scale, FONT_GLYPH_HEIGHT * scale);
+    // Whole pixels, so every font pixel covers exactly scale x scale screen pixels
+    glm::vec2 pen(std::floor(position.x), std::floor(position.y));
+    float widest = 0.0f;
+    for (const char* p = text; *p; p++) {
+        if (*p == '\n') {
+            pen = glm::vec2(std::floor(position.x), pen.y + FONT_LINE_HEIGHT * scale);
+            continue;
+        }
+        if (*p != ' ') {
+            int cellX, cellY;
+            getFontCell(*p, cellX, cellY);
+            glm::vec2 uvMin(static_cast<float>(cellX) / FONT_ATLAS_WIDTH, static_cast<float>(cellY) / FONT_ATLAS_HEIGHT);
+            glm::vec2 uvMax(static_cast<float>(cellX + FONT_GLYPH_WIDTH) / FONT_ATLAS_WIDTH,
+                            static_cast<float>(cellY + FONT_GLYPH_HEIGHT) / FONT_ATLAS_HEIGHT);
+            const glm::vec2 corners[4] = {pen, glm::vec2(pen.x + glyphSize.x, pen.y), pen + glyphSize,
+                                          glm::vec2(pen.x, pen.y + glyphSize.y)};
+            const glm::vec2 texCoords[4] = {uvMin, glm::vec2(uvMax.x, uvMin.y), uvMax, glm::vec2(uvMin.x, uvMax.y)};
+            addQuad(corners, texCoords, packed);
+        }
+        pen.x += FONT_ADVANCE * scale;
+        widest = std::max(widest, pen.x - std::floor(position.x) - scale);
+    }
+    return widest;
+}
+
+void OverlayRenderer::end() {
+    drawnVertices = 0;
+    drawCalls = 0;
+    if (!shaderReady || vertices.empty()) {
+        return;
+    }
+
+    // Orphan the buffer so the driver never waits for last frame's draw
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    if (vertices.size() > vboCapacity) {
+        vboCapacity = std::max(vertices.size(), vboCapacity * 2);
+    }
+    glBufferData(GL_ARRAY_BUFFER, vboCapacity * sizeof(OverlayVertex), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(OverlayVertex), vertices.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // Drawn over the finished frame: no depth, alpha from the font
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    if (depthTest) {
+        glDisable(GL_DEPTH_TEST);
+    }
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    shader.use();
+    shader.setVec2("screenSize", glm::vec2(static_cast<float>(width), static_cast<float>(height)));
+    shader.setInt("fontTexture", FONT_TEXTURE_UNIT);
+    glActiveTexture(GL_TEXTURE0 + FONT_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, fontTexture);
+    glActiveTexture(GL_TEXTURE0);
+
+    glBindVertexArray(vao);
+    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(vertices.size()));
+    glBindVertexArray(0);
+    drawnVertices = static_cast<int>(vertices.size());
+    drawCalls = 1;
+
+    glDisable(GL_BLEND);
+    if (depthTest) {
+        glEnable(GL_DEPTH_TEST);
+    }
+}
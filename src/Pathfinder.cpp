@@ -0,0 +1,637 @@
+#include "Pathfinder.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+    const float SQRT2 = 1.41421356f;
+    // A run of crossable border columns at least this long gets a node at each end
+    const int LONG_ENTRANCE = 6;
+
+    // Straight moves first, then diagonals; OPPOSITE[d] goes back along MOVES[d]
+    const int MOVES[8][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+    const int OPPOSITE[8] = {1, 0, 3, 2, 7, 6, 5, 4};
+
+    // (estimated total cost, cell), smallest first
+    using OpenEntry = std::pair<float, int>;
+
+    void pushOpen(std::vector<OpenEntry>& open, float estimate, int cell) {
+        open.push_back({estimate, cell});
+        std::push_heap(open.begin(), open.end(), std::greater<OpenEntry>());
+    }
+
+    OpenEntry popOpen(std::vector<OpenEntry>& open) {
+        std::pop_heap(open.begin(), open.end(), std::greater<OpenEntry>());
+        OpenEntry entry = open.back();
+        open.pop_back();
+        return entry;
+    }
+}
+
+NavigationRules makeNavigationRules(float jumpForce, float gravity, int maxDrop) {
+    NavigationRules rules;
+    float apex = jumpForce * jumpForce / (2.0f * std::max(std::fabs(gravity), 0.001f));
+    rules.maxClimb = static_cast<int>(std::floor(apex));
+    rules.maxDrop = maxDrop;
+    return rules;
+}
+
+struct Pathfinder::SearchScratch {
+    // One cluster, indexed by column within it; a column counts as reached or
+    // closed when its stamp equals the current search number
+    int originX = 0, originZ = 0;
+    uint32_t search = 0;
+    std::vector<float> localCost;
+    std::vector<int> localParent;  // grid cell, -1 at the source
+    std::vector<uint32_t> localReached, localClosed;
+    std::vector<OpenEntry> open;
+    std::vector<int> segment;
+
+    // Abstract graph, keyed by grid cell
+    struct Record {
+        int cell;
+        float cost;
+        int parent;  // record index
+        bool closed;
+        const int* path;  // columns of the edge from the parent, or null to search for them
+        int pathLength;
+    };
+    std::unordered_map<int, int> recordIndex;
+    std::vector<Record> records;
+    std::vector<AbstractEdge> startEdges, goalEdges;
+    std::vector<int> waypoints;  // records
+
+    // Whole grid, only allocated by flat searches
+    uint32_t flatSearch = 0;
+    std::vector<float> cellCost;
+    std::vector<int> cellParent;
+    std::vector<uint32_t> cellReached, cellClosed;
+};
+
+Pathfinder::Pathfinder(const Terrain& terrain, const NavigationRules& rules, int clusterSize)
+    : terrain(terrain), rules(rules), clusterSize(std::max(clusterSize, 2)), width(0), depth(0), clustersX(0),
+      clustersZ(0) {}
+
+Pathfinder::~Pathfinder() = default;
+
+std::unique_ptr<Pathfinder::SearchScratch> Pathfinder::acquireScratch() const {
+    {
+        std::lock_guard<std::mutex> lock(scratchMutex);
+        if (!freeScratch.empty()) {
+            std::unique_ptr<SearchScratch> scratch = std::move(freeScratch.back());
+            freeScratch.pop_back();
+            return scratch;
+        }
+    }
+    std::unique_ptr<SearchScratch> scratch = std::make_unique<SearchScratch>();
+    size_t columns = static_cast<size_t>(clusterSize) * clusterSize;
+    scratch->localCost.resize(columns);
+    scratch->localParent.resize(columns);
+    scratch->localReached.assign(columns, 0);
+    scratch->localClosed.assign(columns, 0);
+    return scratch;
+}
+
+void Pathfinder::releaseScratch(std::unique_ptr<SearchScratch> scratch) const {
+    std::lock_guard<std::mutex> lock(scratchMutex);
+    freeScratch.push_back(std::move(scratch));
+}
+
+void Pathfinder::build(JobSystem* jobs) {
+    width = terrain.getWidth();
+    depth = terrain.getHeight();
+    clustersX = (width + clusterSize - 1) / clusterSize;
+    clustersZ = (depth + clusterSize - 1) / clusterSize;
+    heights.assign(static_cast<size_t>(width) * depth, 0);
+    moveMasks.assign(heights.size(), 0);
+    readHeights(0, 0, width - 1, depth - 1);
+    updateMoveMasks(0, 0, width - 1, depth - 1);
+
+    clusters.assign(static_cast<size_t>(clustersX) * clustersZ, Cluster());
+    auto buildRange = [this](int begin, int end) {
+        std::unique_ptr<SearchScratch> scratch = acquireScratch();
+        for (int i = begin; i < end; i++) {
+            buildCluster(i, *scratch);
+        }
+        releaseScratch(std::move(scratch));
+    };
+    if (jobs) {
+        jobs->parallelFor(getClusterCount(), 16, buildRange);
+    } else {
+        buildRange(0, getClusterCount());
+    }
+}
+
+int Pathfinder::updateColumns(int minX, int minZ, int maxX, int maxZ) {
+    int gx0 = std::max(minX + terrain.getGridOffsetX(), 0);
+    int gz0 = std::max(minZ + terrain.getGridOffsetZ(), 0);
+    int gx1 = std::min(maxX + terrain.getGridOffsetX(), width - 1);
+    int gz1 = std::min(maxZ + terrain.getGridOffsetZ(), depth - 1);
+    if (gx0 > gx1 || gz0 > gz1) {
+        return 0;
+    }
+    readHeights(gx0, gz0, gx1, gz1);
+    // Moves into the changed columns start one column further out, possibly in the next cluster,
+    // and so do diagonals around their corners
+    updateMoveMasks(gx0 - 1, gz0 - 1, gx1 + 1, gz1 + 1);
+    int cx0 = std::max(gx0 - 1, 0) / clusterSize;
+    int cz0 = std::max(gz0 - 1, 0) / clusterSize;
+    int cx1 = std::min(gx1 + 1, width - 1) / clusterSize;
+    int cz1 = std::min(gz1 + 1, depth - 1) / clusterSize;
+    std::unique_ptr<SearchScratch> scratch = acquireScratch();
+    for (int cz = cz0; cz <= cz1; cz++) {
+        for (int cx = cx0; cx <= cx1; cx++) {
+            buildCluster(cz * clustersX + cx, *scratch);
+        }
+    }
+    releaseScratch(std::move(scratch));
+    return (cx1 - cx0 + 1) * (cz1 - cz0 + 1);
+}
+
+void Pathfinder::readHeights(int minX, int minZ, int maxX, int maxZ) {
+    const HeightPyramid& pyramid = terrain.getHeightPyramid();
+    bool generated = pyramid.getLevelCount() > 0 && pyramid.getLevelWidth(0) == width &&
+                     pyramid.getLevelDepth(0) == depth;
+    for (int z = minZ; z <= maxZ; z++) {
+        for (int x = minX; x <= maxX; x++) {
+            heights[static_cast<size_t>(z) * width + x] =
+                generated ? static_cast<int16_t>(pyramid.getMaxHeight(0, x, z)) : static_cast<int16_t>(0);
+        }
+    }
+}
+
+int Pathfinder::getClusterOf(int cell) const {
+    return (cell / width / clusterSize) * clustersX + (cell % width) / clusterSize;
+}
+
+void Pathfinder::updateMoveMasks(int minX, int minZ, int maxX, int maxZ) {
+    for (int z = std::max(minZ, 0); z <= std::min(maxZ, depth - 1); z++) {
+        for (int x = std::max(minX, 0); x <= std::min(maxX, width - 1); x++) {
+            uint8_t mask = 0;
+            for (int direction = 0; direction < 8; direction++) {
+                mask |= isMoveOpen(x, z, MOVES[direction][0], MOVES[direction][1]) ? 1 << direction : 0;
+            }
+            moveMasks[static_cast<size_t>(z) * width + x] = mask;
+        }
+    }
+}
+
+bool Pathfinder::isMoveOpen(int x, int z, int dx, int dz) const {
+    int nx = x + dx;
+    int nz = z + dz;
+    if (nx < 0 || nz < 0 || nx >= width || nz >= depth) {
+        return false;
+    }
+    int from = heights[static_cast<size_t>(z) * width + x];
+    int to = heights[static_cast<size_t>(nz) * width + nx];
+    int rise = to - from;
+    if (from <= 0 || to <= 0 || rise > rules.maxClimb || -rise > rules.maxDrop) {
+        return false;
+    }
+    if (dx != 0 && dz != 0) {
+        // No cutting corners: both ways around must be open
+        return isMoveOpen(x, z, dx, 0) && isMoveOpen(nx, z, 0, dz) && isMoveOpen(x, z, 0, dz) &&
+               isMoveOpen(x, nz, dx, 0);
+    }
+    return true;
+}
+
+float Pathfinder::getMoveCost(int cell, int direction) const {
+    if (!(moveMasks[cell] & (1 << direction))) {
+        return -1.0f;
+    }
+    int next = cell + MOVES[direction][1] * width + MOVES[direction][0];
+    float cost = direction < 4 ? 1.0f : SQRT2;
+    return heights[next] > heights[cell] ? cost + rules.climbCost : cost;
+}
+
+float Pathfinder::estimateCost(int fromCell, int toCell) const {
+    // Octile distance, the cost of the path ignoring terrain
+    int dx = std::abs(fromCell % width - toCell % width);
+    int dz = std::abs(fromCell / width - toCell / width);
+    return static_cast<float>(std::max(dx, dz) - std::min(dx, dz)) + SQRT2 * std::min(dx, dz);
+}
+
+void Pathfinder::findTransitions(int lowCluster, bool alongZ, std::vector<Transition>& transitions) const {
+    transitions.clear();
+    int lowX = (lowCluster % clustersX) * clusterSize;
+    int lowZ = (lowCluster / clustersX) * clusterSize;
+    int dx = alongZ ? 1 : 0;
+    int dz = alongZ ? 0 : 1;
+    int direction = alongZ ? 0 : 2;
+    int length = alongZ ? std::min(clusterSize, depth - lowZ) : std::min(clusterSize, width - lowX);
+    auto columnAt = [&](int i, int& x, int& z) {
+        x = alongZ ? lowX + clusterSize - 1 : lowX + i;
+        z = alongZ ? lowZ + i : lowZ + clusterSize - 1;
+    };
+    auto addTransition = [&](int i) {
+        int x, z;
+        columnAt(i, x, z);
+        Transition transition;
+        transition.cellA = z * width + x;
+        transition.cellB = (z + dz) * width + x + dx;
+        transition.forwardCost = getMoveCost(transition.cellA, direction);
+        transition.backwardCost = getMoveCost(transition.cellB, OPPOSITE[direction]);
+        transitions.push_back(transition);
+    };
+
+    // Runs of columns that can be crossed the same ways
+    int runStart = 0;
+    int runFlags = 0;
+    for (int i = 0; i <= length; i++) {
+        int flags = 0;
+        if (i < length) {
+            int x, z;
+            columnAt(i, x, z);
+            int cell = z * width + x;
+            int next = (z + dz) * width + x + dx;
+            flags = (moveMasks[cell] >> direction & 1) | (moveMasks[next] >> OPPOSITE[direction] & 1) << 1;
+        }
+        if (flags == runFlags) {
+            continue;
+        }
+        if (runFlags != 0) {
+            int runLength = i - runStart;
+            if (runLength >= LONG_ENTRANCE) {
+                addTransition(runStart);
+                addTransition(i - 1);
+            } else {
+                addTransition(runStart + runLength / 2);
+            }
+        }
+        runStart = i;
+        runFlags = flags;
+    }
+}
+
+void Pathfinder::buildCluster(int clusterIndex, SearchScratch& scratch) {
+    std::vector<AbstractNode>& nodes = clusters[clusterIndex].nodes;
+    std::vector<int>& paths = clusters[clusterIndex].paths;
+    nodes.clear();
+    paths.clear();
+    auto addNode = [&nodes](int cell) {
+        for (size_t i = 0; i < nodes.size(); i++) {
+            if (nodes[i].cell == cell) {
+                return i;
+            }
+        }
+        nodes.push_back({cell, {}});
+        return nodes.size() - 1;
+    };
+
+    // Entrances on all four borders; the lower cluster of a pair is always passed first,
+    // so both sides find the same ones
+    int cx = clusterIndex % clustersX;
+    int cz = clusterIndex / clustersX;
+    const int neighbours[4] = {cx > 0 ? clusterIndex - 1 : -1, cx + 1 < clustersX ? clusterIndex + 1 : -1,
+                               cz > 0 ? clusterIndex - clustersX : -1, cz + 1 < clustersZ ? clusterIndex + clustersX : -1};
+    std::vector<Transition> transitions;
+    for (int side = 0; side < 4; side++) {
+        int neighbour = neighbours[side];
+        if (neighbour < 0) {
+            continue;
+        }
+        bool low = neighbour > clusterIndex;
+        findTransitions(low ? clusterIndex : neighbour, side < 2, transitions);
+        for (const Transition& transition : transitions) {
+            size_t node = addNode(low ? transition.cellA : transition.cellB);
+            float cost = low ? transition.forwardCost : transition.backwardCost;
+            if (cost >= 0.0f) {
+                int target = low ? transition.cellB : transition.cellA;
+                nodes[node].edges.push_back({target, cost, static_cast<int>(paths.size()), 1});
+                paths.push_back(target);
+            }
+        }
+    }
+
+    // Every node to every other node it can reach without leaving the cluster, keeping the columns in between
+    for (AbstractNode& node : nodes) {
+        searchCluster(clusterIndex, node.cell, -1, false, scratch);
+        for (const AbstractNode& other : nodes) {
+            float cost = getClusterCost(other.cell, scratch);
+            if (other.cell != node.cell && cost >= 0.0f) {
+                int pathStart = static_cast<int>(paths.size());
+                appendClusterPath(other.cell, scratch, paths);
+                node.edges.push_back({other.cell, cost, pathStart, static_cast<int>(paths.size()) - pathStart});
+            }
+        }
+    }
+}
+
+int Pathfinder::getNodeCount() const {
+    int count = 0;
+    for (const Cluster& cluster : clusters) {
+        count += static_cast<int>(cluster.nodes.size());
+    }
+    return count;
+}
+
+int Pathfinder::getEdgeCount() const {
+    int count = 0;
+    for (const Cluster& cluster : clusters) {
+        for (const AbstractNode& node : cluster.nodes) {
+            count += static_cast<int>(node.edges.size());
+        }
+    }
+    return count;
+}
+
+bool Pathfinder::searchCluster(int cluster, int source, int target, bool reverse, SearchScratch& scratch) const {
+    scratch.originX = (cluster % clustersX) * clusterSize;
+    scratch.originZ = (cluster / clustersX) * clusterSize;
+    int endX = std::min(scratch.originX + clusterSize, width);
+    int endZ = std::min(scratch.originZ + clusterSize, depth);
+    if (++scratch.search == 0) {
+        std::fill(scratch.localReached.begin(), scratch.localReached.end(), 0);
+        std::fill(scratch.localClosed.begin(), scratch.localClosed.end(), 0);
+        scratch.search = 1;
+    }
+    auto localIndex = [&](int x, int z) { return (z - scratch.originZ) * clusterSize + (x - scratch.originX); };
+
+    int sourceIndex = localIndex(source % width, source / width);
+    scratch.localCost[sourceIndex] = 0.0f;
+    scratch.localParent[sourceIndex] = -1;
+    scratch.localReached[sourceIndex] = scratch.search;
+    scratch.open.clear();
+    pushOpen(scratch.open, target >= 0 ? estimateCost(source, target) : 0.0f, source);
+    while (!scratch.open.empty()) {
+        int cell = popOpen(scratch.open).second;
+        int x = cell % width;
+        int z = cell / width;
+        int index = localIndex(x, z);
+        if (scratch.localClosed[index] == scratch.search) {
+            continue;
+        }
+        scratch.localClosed[index] = scratch.search;
+        if (cell == target) {
+            return true;
+        }
+
+        float cost = scratch.localCost[index];
+        for (int direction = 0; direction < 8; direction++) {
+            int nx = x + MOVES[direction][0];
+            int nz = z + MOVES[direction][1];
+            if (nx < scratch.originX || nz < scratch.originZ || nx >= endX || nz >= endZ) {
+                continue;
+            }
+            int next = nz * width + nx;
+            float moveCost = reverse ? getMoveCost(next, OPPOSITE[direction]) : getMoveCost(cell, direction);
+            if (moveCost < 0.0f) {
+                continue;
+            }
+            int nextIndex = localIndex(nx, nz);
+            float nextCost = cost + moveCost;
+            if (scratch.localReached[nextIndex] == scratch.search &&
+                (scratch.localClosed[nextIndex] == scratch.search || nextCost >= scratch.localCost[nextIndex])) {
+                continue;
+            }
+            scratch.localCost[nextIndex] = nextCost;
+            scratch.localParent[nextIndex] = cell;
+            scratch.localReached[nextIndex] = scratch.search;
+            pushOpen(scratch.open, nextCost + (target >= 0 ? estimateCost(next, target) : 0.0f), next);
+        }
+    }
+    return target < 0;
+}
+
+float Pathfinder::getClusterCost(int cell, const SearchScratch& scratch) const {
+    int x = cell % width - scratch.originX;
+    int z = cell / width - scratch.originZ;
+    if (x < 0 || z < 0 || x >= clusterSize || z >= clusterSize) {
+        return -1.0f;
+    }
+    int index = z * clusterSize + x;
+    return scratch.localClosed[index] == scratch.search ? scratch.localCost[index] : -1.0f;
+}
+
+void Pathfinder::appendClusterPath(int target, SearchScratch& scratch, std::vector<int>& cells) const {
+    // Parents lead back to the source, which is already in the path
+    scratch.segment.clear();
+    for (int cell = target; cell >= 0;) {
+        scratch.segment.push_back(cell);
+        cell = scratch.localParent[(cell / width - scratch.originZ) * clusterSize + (cell % width - scratch.originX)];
+    }
+    cells.insert(cells.end(), scratch.segment.rbegin() + 1, scratch.segment.rend());
+}
+
+bool Pathfinder::findHierarchical(int start, int goal, SearchScratch& scratch, std::vector<int>& cells,
+                                  float& cost) const {
+    int startCluster = getClusterOf(start);
+    int goalCluster = getClusterOf(goal);
+    cells.assign(1, start);
+    cost = 0.0f;
+    if (start == goal) {
+        return true;
+    }
+    // Close enough to stay in one cluster; otherwise the way round may leave it
+    if (startCluster == goalCluster && searchCluster(startCluster, start, goal, false, scratch)) {
+        cost = getClusterCost(goal, scratch);
+        appendClusterPath(goal, scratch, cells);
+        return true;
+    }
+
+    // Join the nodes that reach the goal in its cluster to it, and the start to the nodes it
+    // can reach in its own; the start's search is kept for the first leg of the path
+    scratch.goalEdges.clear();
+    searchCluster(goalCluster, goal, -1, true, scratch);
+    for (const AbstractNode& node : clusters[goalCluster].nodes) {
+        float nodeCost = getClusterCost(node.cell, scratch);
+        if (nodeCost >= 0.0f) {
+            scratch.goalEdges.push_back({node.cell, nodeCost, 0, 0});
+        }
+    }
+    scratch.startEdges.clear();
+    searchCluster(startCluster, start, -1, false, scratch);
+    for (const AbstractNode& node : clusters[startCluster].nodes) {
+        float nodeCost = getClusterCost(node.cell, scratch);
+        if (nodeCost >= 0.0f) {
+            scratch.startEdges.push_back({node.cell, nodeCost, 0, 0});
+        }
+    }
+    if (scratch.startEdges.empty() || scratch.goalEdges.empty()) {
+        return false;
+    }
+
+    scratch.recordIndex.clear();
+    scratch.records.clear();
+    scratch.open.clear();
+    auto reach = [&](int cell, float reachCost, int parent, const int* path, int pathLength) {
+        auto inserted = scratch.recordIndex.emplace(cell, static_cast<int>(scratch.records.size()));
+        if (inserted.second) {
+            scratch.records.push_back({cell, reachCost, parent, false, path, pathLength});
+        } else {
+            SearchScratch::Record& record = scratch.records[inserted.first->second];
+            if (record.closed || reachCost >= record.cost) {
+                return;
+            }
+            record.cost = reachCost;
+            record.parent = parent;
+            record.path = path;
+            record.pathLength = pathLength;
+        }
+        pushOpen(scratch.open, reachCost + estimateCost(cell, goal), cell);
+    };
+    reach(start, 0.0f, -1, nullptr, 0);
+    int goalRecord = -1;
+    while (!scratch.open.empty()) {
+        int cell = popOpen(scratch.open).second;
+        int index = scratch.recordIndex[cell];
+        if (scratch.records[index].closed) {
+            continue;
+        }
+        scratch.records[index].closed = true;
+        if (cell == goal) {
+            goalRecord = index;
+            break;
+        }
+
+        float cellCost = scratch.records[index].cost;
+        int cluster = getClusterOf(cell);
+        const std::vector<int>& paths = clusters[cluster].paths;
+        for (const AbstractNode& node : clusters[cluster].nodes) {
+            if (node.cell == cell) {
+                for (const AbstractEdge& edge : node.edges) {
+                    reach(edge.cell, cellCost + edge.cost, index, &paths[edge.pathStart], edge.pathLength);
+                }
+                break;
+            }
+        }
+        if (cell == start) {
+            for (const AbstractEdge& edge : scratch.startEdges) {
+                reach(edge.cell, edge.cost, index, nullptr, 0);
+            }
+        }
+        if (cluster == goalCluster) {
+            for (const AbstractEdge& edge : scratch.goalEdges) {
+                if (edge.cell == cell) {
+                    reach(goal, cellCost + edge.cost, index, nullptr, 0);
+                }
+            }
+        }
+    }
+    if (goalRecord < 0) {
+        return false;
+    }
+
+    // Back to the start through the abstract path, then out again joining up the columns
+    // of each edge; only the legs to and from the start and goal need searching again
+    cost = scratch.records[goalRecord].cost;
+    std::vector<int>& waypoints = scratch.waypoints;
+    waypoints.clear();
+    for (int index = goalRecord; index >= 0; index = scratch.records[index].parent) {
+        waypoints.push_back(index);
+    }
+    for (size_t i = waypoints.size() - 1; i-- > 0;) {
+        const SearchScratch::Record& record = scratch.records[waypoints[i]];
+        if (record.path) {
+            cells.insert(cells.end(), record.path, record.path + record.pathLength);
+        } else if (record.parent == 0 && i + 2 == waypoints.size()) {
+            appendClusterPath(record.cell, scratch, cells);
+        } else {
+            int from = scratch.records[record.parent].cell;
+            searchCluster(getClusterOf(from), from, record.cell, false, scratch);
+            appendClusterPath(record.cell, scratch, cells);
+        }
+    }
+    return true;
+}
+
+bool Pathfinder::findFlat(int start, int goal, SearchScratch& scratch, std::vector<int>& cells, float& cost) const {
+    size_t columns = static_cast<size_t>(width) * depth;
+    if (scratch.cellCost.size() != columns) {
+        scratch.cellCost.resize(columns);
+        scratch.cellParent.resize(columns);
+        scratch.cellReached.assign(columns, 0);
+        scratch.cellClosed.assign(columns, 0);
+        scratch.flatSearch = 0;
+    }
+    if (++scratch.flatSearch == 0) {
+        std::fill(scratch.cellReached.begin(), scratch.cellReached.end(), 0);
+        std::fill(scratch.cellClosed.begin(), scratch.cellClosed.end(), 0);
+        scratch.flatSearch = 1;
+    }
+
+    uint32_t search = scratch.flatSearch;
+    scratch.cellCost[start] = 0.0f;
+    scratch.cellParent[start] = -1;
+    scratch.cellReached[start] = search;
+    scratch.open.clear();
+    pushOpen(scratch.open, estimateCost(start, goal), start);
+    while (!scratch.open.empty()) {
+        int cell = popOpen(scratch.open).second;
+        if (scratch.cellClosed[cell] == search) {
+            continue;
+        }
+        scratch.cellClosed[cell] = search;
+        if (cell == goal) {
+            cost = scratch.cellCost[goal];
+            scratch.segment.clear();
+            for (int step = goal; step >= 0; step = scratch.cellParent[step]) {
+                scratch.segment.push_back(step);
+            }
+            cells.assign(scratch.segment.rbegin(), scratch.segment.rend());
+            return true;
+        }
+
+        for (int direction = 0; direction < 8; direction++) {
+            float moveCost = getMoveCost(cell, direction);
+            if (moveCost < 0.0f) {
+                continue;
+            }
+            int next = cell + MOVES[direction][1] * width + MOVES[direction][0];
+            float nextCost = scratch.cellCost[cell] + moveCost;
+            if (scratch.cellReached[next] == search &&
+                (scratch.cellClosed[next] == search || nextCost >= scratch.cellCost[next])) {
+                continue;
+            }
+            scratch.cellCost[next] = nextCost;
+            scratch.cellParent[next] = cell;
+            scratch.cellReached[next] = search;
+            pushOpen(scratch.open, nextCost + estimateCost(next, goal), next);
+        }
+    }
+    return false;
+}
+
+bool Pathfinder::findPath(const glm::vec3& start, const glm::vec3& goal, Path& path, PathSearch search) const {
+    path.found = false;
+    path.cost = 0.0f;
+    path.points.clear();
+    auto cellAt = [&](const glm::vec3& position) {
+        int x = static_cast<int>(std::floor(position.x)) + terrain.getGridOffsetX();
+        int z = static_cast<int>(std::floor(position.z)) + terrain.getGridOffsetZ();
+        if (x < 0 || z < 0 || x >= width || z >= depth || heights[static_cast<size_t>(z) * width + x] <= 0) {
+            return -1;
+        }
+        return z * width + x;
+    };
+    int startCell = cellAt(start);
+    int goalCell = cellAt(goal);
+    if (startCell < 0 || goalCell < 0) {
+        return false;
+    }
+
+    std::unique_ptr<SearchScratch> scratch = acquireScratch();
+    std::vector<int> cells;
+    path.found = search == PATH_FLAT ? findFlat(startCell, goalCell, *scratch, cells, path.cost)
+                                     : findHierarchical(startCell, goalCell, *scratch, cells, path.cost);
+    releaseScratch(std::move(scratch));
+    if (path.found) {
+        path.points.reserve(cells.size());
+        for (int cell : cells) {
+            path.points.push_back(glm::vec3(cell % width - terrain.getGridOffsetX() + 0.5f, heights[cell],
+                                            cell / width - terrain.getGridOffsetZ() + 0.5f));
+        }
+    }
+    return path.found;
+}
+
+std::future<Path> Pathfinder::requestPath(JobSystem& jobs, const glm::vec3& start, const glm::vec3& goal) const {
+    return jobs.submit([this, start, goal]() {
+        Path path;
+        findPath(start, goal, path);
+        return path;
+    });
+}
@@ -1,25 +1,10 @@
 #include "PerlinNoise.h"
-#include <algorithm>
-#include <random>
 
-PerlinNoise::PerlinNoise(unsigned int seed) {
-    p.resize(256);
-    std::iota(p.begin(), p.end(), 0);
-    
-    std::default_random_engine engine(seed);
-    std::shuffle(p.begin(), p.end(), engine);
-    
-    p.insert(p.end(), p.begin(), p.end());
-}
+PerlinNoise::PerlinNoise(unsigned int seed) : p(makePermutationTable(seed)) {}
 
 void PerlinNoise::setSeed(unsigned int seed) {
-    p.resize(256);
-    std::iota(p.begin(), p.end(), 0);
-    
-    std::default_random_engine engine(seed);
-    std::shuffle(p.begin(), p.end(), engine);
-    
-    p.insert(p.end(), p.begin(), p.end());
+    // Portable shuffle, so a seed gives the same world with every standard library
+    p = makePermutationTable(seed);
 }
 
 float PerlinNoise::noise(float x, float y) const {
@@ -56,22 +41,6 @@ float PerlinNoise::noise(float x, float y, float z) const {
                                    grad(p[BB + 1], x - 1, y - 1, z - 1))));
 }
 
-float PerlinNoise::octaveNoise(float x, float y, int octaves, float persistence, float lacunarity) const {
-    float total = 0.0f;
-    float frequency = 1.0f;
-    float amplitude = 1.0f;
-    float maxValue = 0.0f;
-    
-    for (int i = 0; i < octaves; i++) {
-        total += noise(x * frequency, y * frequency) * amplitude;
-        maxValue += amplitude;
-        amplitude *= persistence;
-        frequency *= lacunarity;
-    }
-    
-    return total / maxValue;
-}
-
 float PerlinNoise::fade(float t) const {
     return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
 }
@@ -0,0 +1,126 @@
+#include "Profiler.h"
+#include <cstdio>
+
+namespace {
+    // Exponential moving average weight of the newest sample
+    const float SMOOTHING = 0.1f;
+}
+
+Profiler::Profiler() : frameIndex(0) {}
+
+Profiler::~Profiler() {
+    for (Section& section : sections) {
+        glDeleteQueries(QUERY_LATENCY, section.startQueries);
+        glDeleteQueries(QUERY_LATENCY, section.endQueries);
+    }
+}
+
+int Profiler::getSectionId(const std::string& name) {
+    for (size_t i = 0; i < sections.size(); i++) {
+        if (sections[i].name == name) {
+            return static_cast<int>(i);
+        }
+    }
+
+    Section section;
+    section.name = name;
+    glGenQueries(QUERY_LATENCY, section.startQueries);
+    glGenQueries(QUERY_LATENCY, section.endQueries);
+    for (int i = 0; i < QUERY_LATENCY; i++) {
+        section.issued[i] = false;
+    }
+    section.cpuMilliseconds = 0.0f;
+    section.gpuMilliseconds = 0.0f;
+    section.latestGpuMilliseconds = 0.0f;
+    section.latestGpuFrame = -1;
+    section.lastFrame = -1;
+    sections.push_back(section);
+    return static_cast<int>(sections.size() - 1);
+}
+
+void Profiler::beginFrame() {
+    frameIndex++;
+
+    // The slot about to be reused was issued QUERY_LATENCY frames ago
+    int slot = static_cast<int>(frameIndex % QUERY_LATENCY);
+    for (Section& section : sections) {
+        collect(section, slot);
+    }
+}
+
+void Profiler::beginSection(int id) {
+    Section& section = sections[id];
+    int slot = static_cast<int>(frameIndex % QUERY_LATENCY);
+    glQueryCounter(section.startQueries[slot], GL_TIMESTAMP);
+    section.cpuStart = std::chrono::high_resolution_clock::now();
+}
+
+void Profiler::endSection(int id) {
+    Section& section = sections[id];
+    int slot = static_cast<int>(frameIndex % QUERY_LATENCY);
+    glQueryCounter(section.endQueries[slot], GL_TIMESTAMP);
+    section.issued[slot] = true;
+
+    float cpu = std::chrono::duration<float, std::milli>(
+        std::chrono::high_resolution_clock::now() - section.cpuStart).count();
+    section.cpuMilliseconds += (cpu - section.cpuMilliseconds) * SMOOTHING;
+    section.lastFrame = frameIndex;
+}
+
+float Profiler::getCpuMilliseconds(int id) const {
+    return sections[id].cpuMilliseconds;
+}
+
+float Profiler::getGpuMilliseconds(int id) const {
+    return sections[id].gpuMilliseconds;
+}
+
+float Profiler::getLatestGpuMilliseconds(int id) const {
+    return sections[id].latestGpuMilliseconds;
+}
+
+long long Profiler::getLatestGpuFrame(int id) const {
+    return sections[id].latestGpuFrame;
+}
+
+int Profiler::getFramesSinceRun(int id) const {
+    if (sections[id].lastFrame < 0) {
+        return -1;
+    }
+    return static_cast<int>(frameIndex - sections[id].lastFrame);
+}
+
+void Profiler::report(std::ostream& out) const {
+    char line[128];
+    std::snprintf(line, sizeof(line), "%-24s %10s %10s %8s\n", "section", "cpu ms", "gpu ms", "idle");
+    out << line;
+    for (size_t i = 0; i < sections.size(); i++) {
+        const Section& section = sections[i];
+        std::snprintf(line, sizeof(line), "%-24s %10.3f %10.3f %8d\n", section.name.c_str(),
+                      section.cpuMilliseconds, section.gpuMilliseconds, getFramesSinceRun(static_cast<int>(i)));
+        out << line;
+    }
+}
+
+void Profiler::collect(Section& section, int slot) {
+    if (!section.issued[slot]) {
+        return;
+    }
+    section.issued[slot] = false;
+
+    // Still in flight after QUERY_LATENCY frames: drop the sample instead of waiting
+    GLint available = 0;
+    glGetQueryObjectiv(section.endQueries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+        return;
+    }
+
+    GLuint64 start = 0, end = 0;
+    glGetQueryObjectui64v(section.startQueries[slot], GL_QUERY_RESULT, &start);
+    glGetQueryObjectui64v(section.endQueries[slot], GL_QUERY_RESULT, &end);
+    float gpu = static_cast<float>(end - start) / 1.0e6f;
+    section.gpuMilliseconds += (gpu - section.gpuMilliseconds) * SMOOTHING;
+    section.latestGpuMilliseconds = gpu;
+    // This slot was issued QUERY_LATENCY frames before the current one
+    section.latestGpuFrame = frameIndex - QUERY_LATENCY;
+}
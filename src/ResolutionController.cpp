@@ -0,0 +1,40 @@
+#include "ResolutionController.h"
+#include <algorithm>
+#include <cmath>
+
+ResolutionController::ResolutionController(const ResolutionSettings& s) : scale(1.0f), lastSampleFrame(-1) {
+    setSettings(s);
+    scale = settings.maxScale;
+    for (int i = 0; i < HISTORY; i++) {
+        history[i] = scale;
+        historyFrames[i] = -1;
+    }
+}
+
+void ResolutionController::setSettings(const ResolutionSettings& s) {
+    settings = s;
+    settings.minScale = std::min(std::max(settings.minScale, 0.1f), 1.0f);
+    settings.maxScale = std::min(std::max(settings.maxScale, settings.minScale), 1.0f);
+    settings.targetMilliseconds = std::max(settings.targetMilliseconds, 0.1f);
+    scale = std::min(std::max(scale, settings.minScale), settings.maxScale);
+}
+
+float ResolutionController::update(long long frame, float sampleMilliseconds, long long sampleFrame) {
+    // Samples older than the history have no known scale and are skipped
+    int slot = sampleFrame >= 0 ? static_cast<int>(sampleFrame % HISTORY) : 0;
+    if (sampleFrame > lastSampleFrame && sampleFrame >= 0 && historyFrames[slot] == sampleFrame) {
+        lastSampleFrame = sampleFrame;
+        float budget = settings.targetMilliseconds * settings.headroom;
+        float fitting = history[slot] * std::sqrt(budget / std::max(sampleMilliseconds, 0.01f));
+        if (sampleMilliseconds > budget) {
+            scale = std::min(scale, fitting);
+        } else if (fitting > scale) {
+            scale += (std::min(fitting, settings.maxScale) - scale) * settings.raiseRate;
+        }
+        scale = std::min(std::max(scale, settings.minScale), settings.maxScale);
+    }
+
+    history[frame % HISTORY] = scale;
+    historyFrames[frame % HISTORY] = frame;
+    return scale;
+}
@@ -0,0 +1,79 @@
+#include "Session.h"
+#include "AllocationTracker.h"
+#include <algorithm>
+#include <cstring>
+
+Session::Session(const SessionOptions& options, Camera& camera, JobSystem& jobs)
+    : options(options), camera(camera), terrain(64, 64, 20.0f), player(camera, terrain), agents(terrain, jobs),
+      previousButtons(0) {
+    // 64x64 terrain with scale 20
+    terrain.setHeightMultiplier(8.0f);
+    terrain.setOctaves(6);
+    if (options.densityTerrain) {
+        terrain.setGenerator(TERRAIN_DENSITY);
+    }
+    for (int layer = 0; layer < TERRAIN_LAYER_COUNT; layer++) {
+        terrain.setNoiseBackend(static_cast<TerrainLayer>(layer), options.noise);
+    }
+    terrain.generate();
+
+    float startX = 0.0f;
+    float startZ = 0.0f;
+    float terrainHeight = terrain.getHeightAt(startX, startZ);
+    float startY = terrainHeight + 1.0f; // Start 1 unit above terrain
+    player.setPosition(glm::vec3(startX, startY, startZ));
+
+    // NPC agents wandering the terrain
+    agents.spawnRandom(options.agents, 1);
+}
+
+void Session::tick(const InputState& input, float deltaTime) {
+    {
+        AllocationScope scope(ALLOC_TERRAIN);
+        player.applyInput(input);
+        player.update(deltaTime);
+        editBlocks(input);
+    }
+
+    AllocationScope scope(ALLOC_AGENTS);
+    // Long stalls (window drags, first frame) would only add substeps
+    agents.update(std::min(deltaTime, 0.1f));
+    agents.pushAway(player.getPosition(), player.getRadius(), player.getHeight());
+}
+
+void Session::editBlocks(const InputState& input) {
+    // Break removes the targeted block, place puts a lamp in front of it
+    bool breakPressed = input.isDown(INPUT_BREAK) && !(previousButtons & INPUT_BREAK);
+    bool placePressed = input.isDown(INPUT_PLACE) && !(previousButtons & INPUT_PLACE);
+    previousButtons = input.buttons;
+
+    if (breakPressed || placePressed) {
+        glm::ivec3 hitBlock, previousBlock;
+        if (terrain.raycast(camera.position, camera.front, 8.0f, hitBlock, previousBlock)) {
+            if (breakPressed) {
+                terrain.setBlock(hitBlock.x, hitBlock.y, hitBlock.z, BLOCK_AIR);
+            } else {
+                terrain.setBlock(previousBlock.x, previousBlock.y, previousBlock.z, BLOCK_LAMP);
+            }
+        }
+    }
+}
+
+uint32_t Session::getPlayerChecksum() const {
+    glm::vec3 position = player.getPosition();
+    glm::vec3 velocity = player.getVelocity();
+    const float values[] = {position.x, position.y, position.z, velocity.x, velocity.y, velocity.z,
+                            camera.yaw, camera.pitch, player.isOnGround() ? 1.0f : 0.0f};
+
+    // FNV-1a over the exact bit patterns, so any drift changes the hash
+    uint32_t hash = 2166136261u;
+    for (float value : values) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        for (int byte = 0; byte < 4; byte++) {
+            hash ^= (bits >> (byte * 8)) & 0xffu;
+            hash *= 16777619u;
+        }
+    }
+    return hash;
+}
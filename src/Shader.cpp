@@ -16,39 +16,36 @@ Shader::~Shader() {
 bool Shader::loadFromFiles(const std::string& vertexPath, const std::string& fragmentPath) {
     std::string vertexCode;
     std::string fragmentCode;
-    std::ifstream vShaderFile;
-    std::ifstream fShaderFile;
-    std::string usedVertexPath = vertexPath;
-    std::string usedFragmentPath = fragmentPath;
-
-    // Try original path
-    vShaderFile.open(vertexPath);
-    fShaderFile.open(fragmentPath);
-    if (!vShaderFile.is_open() || !fShaderFile.is_open()) {
-        // Try ../ path
-        vShaderFile.close();
-        fShaderFile.close();
-        vShaderFile.open("../" + vertexPath);
-        fShaderFile.open("../" + fragmentPath);
-        usedVertexPath = "../" + vertexPath;
-        usedFragmentPath = "../" + fragmentPath;
-        if (!vShaderFile.is_open() || !fShaderFile.is_open()) {
-            std::cerr << "Failed to open shader files: " << vertexPath << ", " << fragmentPath << std::endl;
-            return false;
-        }
+    std::string usedVertexPath;
+    std::string usedFragmentPath;
+
+    if (!readSourceFile(vertexPath, vertexCode, usedVertexPath) ||
+        !readSourceFile(fragmentPath, fragmentCode, usedFragmentPath)) {
+        std::cerr << "Failed to open shader files: " << vertexPath << ", " << fragmentPath << std::endl;
+        return false;
     }
-    std::stringstream vShaderStream, fShaderStream;
-    vShaderStream << vShaderFile.rdbuf();
-    fShaderStream << fShaderFile.rdbuf();
-    vShaderFile.close();
-    fShaderFile.close();
-    vertexCode = vShaderStream.str();
-    fragmentCode = fShaderStream.str();
     std::cout << "Loaded vertex shader from: " << usedVertexPath << " (" << vertexCode.size() << " bytes)\n";
     std::cout << "Loaded fragment shader from: " << usedFragmentPath << " (" << fragmentCode.size() << " bytes)\n";
     return loadFromStrings(vertexCode, fragmentCode);
 }
 
+bool Shader::readSourceFile(const std::string& path, std::string& source, std::string& usedPath) {
+    // Try original path, then ../ path (when running from build/)
+    std::ifstream file(path);
+    usedPath = path;
+    if (!file.is_open()) {
+        file.open("../" + path);
+        usedPath = "../" + path;
+        if (!file.is_open()) {
+            return false;
+        }
+    }
+    std::stringstream stream;
+    stream << file.rdbuf();
+    source = stream.str();
+    return true;
+}
+
 bool Shader::loadFromStrings(const std::string& vertexSource, const std::string& fragmentSource) {
     unsigned int vertex, fragment;
     
@@ -116,32 +113,60 @@ void Shader::use() {
     glUseProgram(programID);
 }
 
-void Shader::setBool(const std::string& name, bool value) {
+void Shader::setBool(const char* name, bool value) {
     glUniform1i(getUniformLocation(name), (int)value);
 }
 
-void Shader::setInt(const std::string& name, int value) {
+void Shader::setInt(const char* name, int value) {
     glUniform1i(getUniformLocation(name), value);
 }
 
-void Shader::setFloat(const std::string& name, float value) {
+void Shader::setFloat(const char* name, float value) {
     glUniform1f(getUniformLocation(name), value);
 }
 
-void Shader::setVec3(const std::string& name, const glm::vec3& value) {
+void Shader::setFloatArray(const char* name, const float* values, int count) {
+    glUniform1fv(getUniformLocation(name), count, values);
+}
+
+void Shader::setVec2(const char* name, const glm::vec2& value) {
+    glUniform2fv(getUniformLocation(name), 1, glm::value_ptr(value));
+}
+
+void Shader::setVec3(const char* name, const glm::vec3& value) {
     glUniform3fv(getUniformLocation(name), 1, glm::value_ptr(value));
 }
 
-void Shader::setMat4(const std::string& name, const glm::mat4& value) {
+void Shader::setVec3Array(const char* name, const glm::vec3* values, int count) {
+    glUniform3fv(getUniformLocation(name), count, glm::value_ptr(values[0]));
+}
+
+void Shader::setMat3(const char* name, const glm::mat3& value) {
+    glUniformMatrix3fv(getUniformLocation(name), 1, GL_FALSE, glm::value_ptr(value));
+}
+
+void Shader::setMat4(const char* name, const glm::mat4& value) {
     glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, glm::value_ptr(value));
 }
 
-int Shader::getUniformLocation(const std::string& name) {
-    if (uniformCache.find(name) != uniformCache.end()) {
-        return uniformCache[name];
+void Shader::setMat4Array(const char* name, const glm::mat4* values, int count) {
+    glUniformMatrix4fv(getUniformLocation(name), count, GL_FALSE, glm::value_ptr(values[0]));
+}
+
+int Shader::getUniformLocation(const char* name) {
+    // FNV-1a of the name
+    uint32_t hash = 2166136261u;
+    for (const char* c = name; *c; c++) {
+        hash = (hash ^ static_cast<uint8_t>(*c)) * 16777619u;
     }
-    
-    int location = glGetUniformLocation(programID, name.c_str());
-    uniformCache[name] = location;
+
+    for (const UniformEntry& entry : uniformCache) {
+        if (entry.hash == hash && entry.name == name) {
+            return entry.location;
+        }
+    }
+
+    int location = glGetUniformLocation(programID, name);
+    uniformCache.push_back({hash, name, location});
     return location;
 }
@@ -0,0 +1,138 @@
+#include "ShaderLibrary.h"
+#include <algorithm>
+#include <iostream>
+
+namespace {
+    const char* featureNames[SHADER_FEATURE_COUNT] = {
+        "INSTANCED",
+        "NORMAL_MATRIX",
+        "NO_SPECULAR",
+        "FOG",
+        "PACKED_VERTEX",
+        "BAKED_LIGHT",
+        "CLUSTERED",
+        "SHADOWS",
+        "DEPTH_ONLY"
+    };
+}
+
+ShaderLibrary::ShaderLibrary() = default;
+
+ShaderLibrary::~ShaderLibrary() = default;
+
+bool ShaderLibrary::loadSources(const std::string& vertexPath, const std::string& fragmentPath) {
+    std::string usedVertexPath;
+    std::string usedFragmentPath;
+
+    if (!Shader::readSourceFile(vertexPath, vertexSource, usedVertexPath) ||
+        !Shader::readSourceFile(fragmentPath, fragmentSource, usedFragmentPath)) {
+        std::cerr << "Failed to open shader files: " << vertexPath << ", " << fragmentPath << std::endl;
+        return false;
+    }
+    std::cout << "Loaded shader sources from: " << usedVertexPath << ", " << usedFragmentPath << std::endl;
+
+    variants.clear();
+    failedVariants.clear();
+    return true;
+}
+
+void ShaderLibrary::setDefine(const std::string& name, const std::string& value) {
+    auto it = std::find_if(defines.begin(), defines.end(),
+                           [&](const std::pair<std::string, std::string>& d) { return d.first == name; });
+    if (it != defines.end()) {
+        it->second = value;
+    } else {
+        defines.emplace_back(name, value);
+    }
+
+    // Every cached variant was built with the old defines
+    variants.clear();
+    failedVariants.clear();
+}
+
+Shader* ShaderLibrary::get(unsigned int features) {
+    auto it = variants.find(features);
+    if (it != variants.end()) {
+        return it->second.get();
+    }
+    if (failedVariants.count(features)) {
+        return nullptr;
+    }
+    return compileVariant(features);
+}
+
+void ShaderLibrary::request(unsigned int features) {
+    if (isReady(features) || failedVariants.count(features)) {
+        return;
+    }
+    if (std::find(pendingVariants.begin(), pendingVariants.end(), features) == pendingVariants.end()) {
+        pendingVariants.push_back(features);
+    }
+}
+
+int ShaderLibrary::compilePending(int maxVariants) {
+    // GL contexts are single threaded, so "background" compilation is amortized
+    // over frames instead of stalling the first draw that needs a variant
+    int compiled = 0;
+    while (!pendingVariants.empty() && compiled < maxVariants) {
+        unsigned int features = pendingVariants.front();
+        pendingVariants.erase(pendingVariants.begin());
+        if (!isReady(features) && !failedVariants.count(features)) {
+            compileVariant(features);
+            compiled++;
+        }
+    }
+    return compiled;
+}
+
+bool ShaderLibrary::isReady(unsigned int features) const {
+    return variants.find(features) != variants.end();
+}
+
+std::string ShaderLibrary::getFeatureDefines(unsigned int features) {
+    std::string result;
+    for (int i = 0; i < SHADER_FEATURE_COUNT; i++) {
+        if (features & (1u << i)) {
+            result += "#define ";
+            result += featureNames[i];
+            result += "\n";
+        }
+    }
+    return result;
+}
+
+Shader* ShaderLibrary::compileVariant(unsigned int features) {
+    auto shader = std::make_unique<Shader>();
+    if (!shader->loadFromStrings(specialize(vertexSource, features), specialize(fragmentSource, features))) {
+        std::cerr << "Failed to compile shader variant 0x" << std::hex << features << std::dec
+                  << " (" << getFeatureDefines(features) << ")" << std::endl;
+        failedVariants.insert(features);
+        return nullptr;
+    }
+
+    Shader* result = shader.get();
+    variants[features] = std::move(shader);
+    return result;
+}
+
+std::string ShaderLibrary::specialize(const std::string& source, unsigned int features) const {
+    // Defines must come after #version, which has to stay the first statement
+    size_t insertAt = 0;
+    size_t versionPos = source.find("#version");
+    if (versionPos != std::string::npos) {
+        size_t lineEnd = source.find('\n', versionPos);
+        insertAt = (lineEnd == std::string::npos) ? source.size() : lineEnd + 1;
+    }
+
+    std::string header = getFeatureDefines(features);
+    for (const auto& define : defines) {
+        header += "#define " + define.first + " " + define.second + "\n";
+    }
+    // Keep compiler error line numbers matching the source file
+    int nextLine = static_cast<int>(std::count(source.begin(), source.begin() + insertAt, '\n')) + 1;
+    header += "#line " + std::to_string(nextLine) + "\n";
+
+    std::string result = source;
+    result.insert(insertAt, header);
+    return result;
+}
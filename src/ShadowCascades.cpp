@@ -0,0 +1,221 @@
+#include "ShadowCascades.h"
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace {
+    // Cascade radii are whole multiples of this, in blocks
+    const float RADIUS_STEP = 4.0f;
+}
+
+ShadowCascades::ShadowCascades(Terrain& terrain, TerrainRenderer& renderer)
+    : terrain(terrain), renderer(renderer), profiler(nullptr),
+      lightDirection(glm::normalize(glm::vec3(-0.4f, -1.0f, -0.3f))), shadowDistance(48.0f),
+      renderedThisFrame(0), depthTexture(0), framebuffer(0) {
+    for (int i = 0; i < NUM_CASCADES; i++) {
+        cascades[i].splitFar = 0.0f;
+        cascades[i].center = glm::vec3(0.0f);
+        cascades[i].radius = 0.0f;
+        cascades[i].lightViewProjection = glm::mat4(1.0f);
+        cascades[i].terrainRevision = 0;
+        cascades[i].valid = false;
+        profilerSections[i] = -1;
+    }
+
+    // One depth layer per cascade, sampled with hardware depth comparison
+    glGenTextures(1, &depthTexture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, depthTexture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, RESOLUTION, RESOLUTION, NUM_CASCADES,
+                 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    float border[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, border);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthTexture, 0, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+ShadowCascades::~ShadowCascades() {
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteTextures(1, &depthTexture);
+}
+
+void ShadowCascades::setLightDirection(const glm::vec3& direction) {
+    glm::vec3 newDirection = glm::normalize(direction);
+    if (glm::length(newDirection - lightDirection) > 0.0001f) {
+        lightDirection = newDirection;
+        for (Cascade& cascade : cascades) {
+            cascade.valid = false;
+        }
+    }
+}
+
+void ShadowCascades::setProfiler(Profiler* p) {
+    profiler = p;
+    if (profiler) {
+        for (int i = 0; i < NUM_CASCADES; i++) {
+            profilerSections[i] = profiler->getSectionId("shadow cascade " + std::to_string(i));
+        }
+    }
+}
+
+void ShadowCascades::update(Camera& camera, float aspectRatio, Shader& depthShader) {
+    renderedThisFrame = 0;
+
+    float nearPlane = camera.nearPlane;
+    float farPlane = std::min(camera.farPlane, shadowDistance);
+    float tanHalfFov = std::tan(glm::radians(camera.zoom) * 0.5f);
+    float splitNear = nearPlane;
+
+    for (int i = 0; i < NUM_CASCADES; i++) {
+        // Practical split scheme: blend of logarithmic and uniform splits
+        float fraction = static_cast<float>(i + 1) / NUM_CASCADES;
+        float logSplit = nearPlane * std::pow(farPlane / nearPlane, fraction);
+        float uniformSplit = nearPlane + (farPlane - nearPlane) * fraction;
+        float splitFar = 0.75f * logSplit + 0.25f * uniformSplit;
+
+        // Bounding sphere of the frustum slice; a sphere keeps the cascade size
+        // independent of camera rotation
+        glm::vec3 corners[8];
+        int cornerCount = 0;
+        for (float depth : {splitNear, splitFar}) {
+            glm::vec3 sliceCenter = camera.position + camera.front * depth;
+            float halfHeight = depth * tanHalfFov;
+            float halfWidth = halfHeight * aspectRatio;
+            for (int sx = -1; sx <= 1; sx += 2) {
+                for (int sy = -1; sy <= 1; sy += 2) {
+                    corners[cornerCount++] = sliceCenter + camera.right * (halfWidth * sx) + camera.up * (halfHeight * sy);
+                }
+            }
+        }
+        glm::vec3 center(0.0f);
+        for (const glm::vec3& corner : corners) {
+            center += corner / 8.0f;
+        }
+        float radius = 0.0f;
+        for (const glm::vec3& corner : corners) {
+            radius = std::max(radius, glm::length(corner - center));
+        }
+
+        Cascade& cascade = cascades[i];
+        cascade.splitFar = splitFar;
+
+        // Keep the cached map while the slice stays inside the region it covers
+        bool covered = cascade.valid && glm::length(center - cascade.center) + radius <= cascade.radius;
+        if (!covered) {
+            // Recenter with margin so small camera moves keep hitting the cache.
+            // Edges don't shimmer across recenters: the radius is rounded to
+            // RADIUS_STEP so the texel size stays the same, and the center
+            // moves by whole texels across the light's view.
+            cascade.radius = std::ceil(radius * 1.25f / RADIUS_STEP) * RADIUS_STEP;
+            float texelSize = 2.0f * cascade.radius / RESOLUTION;
+            glm::mat3 lightRotation(glm::lookAt(glm::vec3(0.0f), lightDirection, getLightUp()));
+            glm::vec3 lightCenter = lightRotation * center;
+            lightCenter.x = std::floor(lightCenter.x / texelSize) * texelSize;
+            lightCenter.y = std::floor(lightCenter.y / texelSize) * texelSize;
+            cascade.center = glm::transpose(lightRotation) * lightCenter;
+            cascade.valid = false;
+        }
+        cascade.lightViewProjection = getLightViewProjection(cascade.center, cascade.radius);
+
+        unsigned long long revision = getTerrainRevision(cascade.lightViewProjection);
+        if (!cascade.valid || revision != cascade.terrainRevision) {
+            renderCascade(i, depthShader);
+            cascade.terrainRevision = revision;
+            cascade.valid = true;
+            renderedThisFrame++;
+        }
+
+        splitNear = splitFar;
+    }
+}
+
+void ShadowCascades::bind(Shader& shader, int textureUnit) {
+    glm::mat4 matrices[NUM_CASCADES];
+    float splits[NUM_CASCADES];
+    for (int i = 0; i < NUM_CASCADES; i++) {
+        matrices[i] = cascades[i].lightViewProjection;
+        splits[i] = cascades[i].splitFar;
+    }
+
+    glActiveTexture(GL_TEXTURE0 + textureUnit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, depthTexture);
+    glActiveTexture(GL_TEXTURE0);
+
+    shader.setInt("shadowMap", textureUnit);
+    shader.setMat4Array("lightSpaceMatrices", matrices, NUM_CASCADES);
+    shader.setFloatArray("cascadeSplits", splits, NUM_CASCADES);
+    shader.setVec3("sunDirection", lightDirection);
+}
+
+glm::mat4 ShadowCascades::getLightViewProjection(const glm::vec3& center, float radius) const {
+    // Pull the eye back far enough to include casters above the region
+    float depthRange = radius + static_cast<float>(terrain.getWorldHeight());
+    glm::vec3 eye = center - lightDirection * depthRange;
+    glm::mat4 view = glm::lookAt(eye, center, getLightUp());
+    glm::mat4 projection = glm::ortho(-radius, radius, -radius, radius, 0.0f, depthRange * 2.0f);
+    return projection * view;
+}
+
+glm::vec3 ShadowCascades::getLightUp() const {
+    return std::abs(lightDirection.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+}
+
+unsigned long long ShadowCascades::getTerrainRevision(const glm::mat4& lightViewProjection) const {
+    // Sum of mesh revisions of the chunks inside the cascade's light volume.
+    // Revisions only grow, so any remesh in the area changes the sum.
+    unsigned long long revision = 0;
+    for (const Chunk& chunk : terrain.getChunks()) {
+        glm::vec3 origin = terrain.getChunkOrigin(chunk);
+        glm::vec2 minXY(1.0e9f), maxXY(-1.0e9f);
+        for (int corner = 0; corner < 8; corner++) {
+            glm::vec3 offset((corner & 1) ? CHUNK_SIZE : 0, (corner & 2) ? CHUNK_SIZE : 0, (corner & 4) ? CHUNK_SIZE : 0);
+            glm::vec4 clip = lightViewProjection * glm::vec4(origin + offset, 1.0f);
+            minXY = glm::min(minXY, glm::vec2(clip.x, clip.y));
+            maxXY = glm::max(maxXY, glm::vec2(clip.x, clip.y));
+        }
+        if (maxXY.x >= -1.0f && minXY.x <= 1.0f && maxXY.y >= -1.0f && minXY.y <= 1.0f) {
+            revision += chunk.revision;
+        }
+    }
+    return revision;
+}
+
+void ShadowCascades::renderCascade(int index, Shader& depthShader) {
+    ProfileScope scope(profiler, profilerSections[index]);
+
+    // Restore whatever target the caller was rendering to
+    GLint previousFramebuffer = 0;
+    GLint previousViewport[4];
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, previousViewport);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthTexture, 0, index);
+    glViewport(0, 0, RESOLUTION, RESOLUTION);
+    glClear(GL_DEPTH_BUFFER_BIT);
+
+    depthShader.use();
+    depthShader.setMat4("projection", cascades[index].lightViewProjection);
+    depthShader.setMat4("view", glm::mat4(1.0f));
+
+    // Slope-scaled bias against shadow acne
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(2.0f, 4.0f);
+    renderer.draw(depthShader);
+    glDisable(GL_POLYGON_OFFSET_FILL);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+}
@@ -0,0 +1,222 @@
+#include "SimplexNoise.h"
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SIMPLEX_USE_SSE 1
+#endif
+
+namespace {
+    // Skew factors between the input space and the simplex lattice
+    const float F2 = 0.366025403784f;  // (sqrt(3) - 1) / 2
+    const float G2 = 0.211324865405f;  // (3 - sqrt(3)) / 6
+    const float G2x2 = 2.0f * G2;
+    const float F3 = 1.0f / 3.0f;
+    const float G3 = 1.0f / 6.0f;
+
+    // Bring the kernel sums to roughly [-1, 1]
+    const float SCALE_2D = 99.2f;
+    const float SCALE_3D = 32.7f;
+
+    // 16 unit gradients, rotated half a step off the axes
+    const float GRADIENTS_2D[16][2] = {
+        { 0.980785280f,  0.195090322f}, { 0.831469612f,  0.555570233f},
+        { 0.555570233f,  0.831469612f}, { 0.195090322f,  0.980785280f},
+        {-0.195090322f,  0.980785280f}, {-0.555570233f,  0.831469612f},
+        {-0.831469612f,  0.555570233f}, {-0.980785280f,  0.195090322f},
+        {-0.980785280f, -0.195090322f}, {-0.831469612f, -0.555570233f},
+        {-0.555570233f, -0.831469612f}, {-0.195090322f, -0.980785280f},
+        { 0.195090322f, -0.980785280f}, { 0.555570233f, -0.831469612f},
+        { 0.831469612f, -0.555570233f}, { 0.980785280f, -0.195090322f}
+    };
+
+    // The 12 cube edge directions, 4 repeated to fill 16 slots
+    const float GRADIENTS_3D[16][3] = {
+        { 1,  1,  0}, {-1,  1,  0}, { 1, -1,  0}, {-1, -1,  0},
+        { 1,  0,  1}, {-1,  0,  1}, { 1,  0, -1}, {-1,  0, -1},
+        { 0,  1,  1}, { 0, -1,  1}, { 0,  1, -1}, { 0, -1, -1},
+        { 1,  1,  0}, { 0, -1,  1}, {-1,  1,  0}, { 0, -1, -1}
+    };
+
+    inline int fastFloor(float x) {
+        int i = static_cast<int>(x);
+        return i - static_cast<int>(x < static_cast<float>(i));
+    }
+
+    inline float corner2D(float x, float y, int gradient) {
+        float t = 0.5f - x * x - y * y;
+        if (t <= 0.0f) {
+            return 0.0f;
+        }
+        t *= t;
+        return t * t * (GRADIENTS_2D[gradient][0] * x + GRADIENTS_2D[gradient][1] * y);
+    }
+
+    inline float corner3D(float x, float y, float z, int gradient) {
+        float t = 0.6f - x * x - y * y - z * z;
+        if (t <= 0.0f) {
+            return 0.0f;
+        }
+        t *= t;
+        const float* g = GRADIENTS_3D[gradient];
+        return t * t * (g[0] * x + g[1] * y + g[2] * z);
+    }
+}
+
+SimplexNoise::SimplexNoise(unsigned int seed) : p(makePermutationTable(seed)) {}
+
+void SimplexNoise::setSeed(unsigned int seed) {
+    p = makePermutationTable(seed);
+}
+
+float SimplexNoise::noise(float x, float y) const {
+    return noise2D(x, y);
+}
+
+float SimplexNoise::noise(float x, float y, float z) const {
+    return noise3D(x, y, z);
+}
+
+float SimplexNoise::noise2D(float x, float y) const {
+    // Cell of the skewed lattice, then the corner offsets in input space
+    float s = (x + y) * F2;
+    int i = fastFloor(x + s);
+    int j = fastFloor(y + s);
+    float t = static_cast<float>(i + j) * G2;
+    float x0 = x - (static_cast<float>(i) - t);
+    float y0 = y - (static_cast<float>(j) - t);
+
+    // Which of the cell's two triangles the point is in
+    int i1 = x0 > y0 ? 1 : 0;
+    int j1 = 1 - i1;
+
+    float x1 = x0 - static_cast<float>(i1) + G2;
+    float y1 = y0 - static_cast<float>(j1) + G2;
+    float x2 = x0 - 1.0f + G2x2;
+    float y2 = y0 - 1.0f + G2x2;
+
+    int ii = i & 255;
+    int jj = j & 255;
+    int g0 = p[ii + p[jj]] & 15;
+    int g1 = p[ii + i1 + p[jj + j1]] & 15;
+    int g2 = p[ii + 1 + p[jj + 1]] & 15;
+
+    return SCALE_2D * (corner2D(x0, y0, g0) + corner2D(x1, y1, g1) + corner2D(x2, y2, g2));
+}
+
+float SimplexNoise::noise3D(float x, float y, float z) const {
+    float s = (x + y + z) * F3;
+    int i = fastFloor(x + s);
+    int j = fastFloor(y + s);
+    int k = fastFloor(z + s);
+    float t = static_cast<float>(i + j + k) * G3;
+    float x0 = x - (static_cast<float>(i) - t);
+    float y0 = y - (static_cast<float>(j) - t);
+    float z0 = z - (static_cast<float>(k) - t);
+
+    // Order the offsets to find which of the cube's six tetrahedra holds the point
+    int i1, j1, k1, i2, j2, k2;
+    if (x0 >= y0) {
+        if (y0 >= z0)      { i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 1; k2 = 0; }
+        else if (x0 >= z0) { i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 0; k2 = 1; }
+        else               { i1 = 0; j1 = 0; k1 = 1; i2 = 1; j2 = 0; k2 = 1; }
+    } else {
+        if (y0 < z0)       { i1 = 0; j1 = 0; k1 = 1; i2 = 0; j2 = 1; k2 = 1; }
+        else if (x0 < z0)  { i1 = 0; j1 = 1; k1 = 0; i2 = 0; j2 = 1; k2 = 1; }
+        else               { i1 = 0; j1 = 1; k1 = 0; i2 = 1; j2 = 1; k2 = 0; }
+    }
+
+    float x1 = x0 - i1 + G3, y1 = y0 - j1 + G3, z1 = z0 - k1 + G3;
+    float x2 = x0 - i2 + 2.0f * G3, y2 = y0 - j2 + 2.0f * G3, z2 = z0 - k2 + 2.0f * G3;
+    float x3 = x0 - 1.0f + 3.0f * G3, y3 = y0 - 1.0f + 3.0f * G3, z3 = z0 - 1.0f + 3.0f * G3;
+
+    int ii = i & 255;
+    int jj = j & 255;
+    int kk = k & 255;
+    int g0 = p[ii + p[jj + p[kk]]] & 15;
+    int g1 = p[ii + i1 + p[jj + j1 + p[kk + k1]]] & 15;
+    int g2 = p[ii + i2 + p[jj + j2 + p[kk + k2]]] & 15;
+    int g3 = p[ii + 1 + p[jj + 1 + p[kk + 1]]] & 15;
+
+    return SCALE_3D * (corner3D(x0, y0, z0, g0) + corner3D(x1, y1, z1, g1) +
+                       corner3D(x2, y2, z2, g2) + corner3D(x3, y3, z3, g3));
+}
+
+void SimplexNoise::noise(const float* x, const float* y, float* out, int count) const {
+    int index = 0;
+#ifdef SIMPLEX_USE_SSE
+    // Four points per iteration; only the permutation lookups stay scalar
+    const __m128 f2 = _mm_set1_ps(F2);
+    const __m128 g2 = _mm_set1_ps(G2);
+    const __m128 g2x2 = _mm_set1_ps(G2x2);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 zero = _mm_setzero_ps();
+
+    alignas(16) int cellI[4], cellJ[4], upper[4];
+    alignas(16) float gx[3][4], gy[3][4];
+
+    for (; index + 4 <= count; index += 4) {
+        __m128 vx = _mm_loadu_ps(x + index);
+        __m128 vy = _mm_loadu_ps(y + index);
+        __m128 s = _mm_mul_ps(_mm_add_ps(vx, vy), f2);
+
+        // floor() as truncation corrected for negative inputs
+        __m128 sx = _mm_add_ps(vx, s);
+        __m128 sy = _mm_add_ps(vy, s);
+        __m128i i = _mm_cvttps_epi32(sx);
+        __m128i j = _mm_cvttps_epi32(sy);
+        i = _mm_add_epi32(i, _mm_castps_si128(_mm_cmplt_ps(sx, _mm_cvtepi32_ps(i))));
+        j = _mm_add_epi32(j, _mm_castps_si128(_mm_cmplt_ps(sy, _mm_cvtepi32_ps(j))));
+
+        __m128 t = _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(i, j)), g2);
+        __m128 x0 = _mm_sub_ps(vx, _mm_sub_ps(_mm_cvtepi32_ps(i), t));
+        __m128 y0 = _mm_sub_ps(vy, _mm_sub_ps(_mm_cvtepi32_ps(j), t));
+
+        __m128 lowerMask = _mm_cmpgt_ps(x0, y0);
+        __m128 i1 = _mm_and_ps(lowerMask, one);
+        __m128 j1 = _mm_sub_ps(one, i1);
+        __m128 x1 = _mm_add_ps(_mm_sub_ps(x0, i1), g2);
+        __m128 y1 = _mm_add_ps(_mm_sub_ps(y0, j1), g2);
+        __m128 x2 = _mm_add_ps(_mm_sub_ps(x0, one), g2x2);
+        __m128 y2 = _mm_add_ps(_mm_sub_ps(y0, one), g2x2);
+
+        _mm_store_si128(reinterpret_cast<__m128i*>(cellI), i);
+        _mm_store_si128(reinterpret_cast<__m128i*>(cellJ), j);
+        _mm_store_si128(reinterpret_cast<__m128i*>(upper), _mm_castps_si128(lowerMask));
+        for (int lane = 0; lane < 4; lane++) {
+            int ii = cellI[lane] & 255;
+            int jj = cellJ[lane] & 255;
+            int li = upper[lane] ? 1 : 0;
+            int g0 = p[ii + p[jj]] & 15;
+            int g1 = p[ii + li + p[jj + 1 - li]] & 15;
+            int g2i = p[ii + 1 + p[jj + 1]] & 15;
+            gx[0][lane] = GRADIENTS_2D[g0][0];  gy[0][lane] = GRADIENTS_2D[g0][1];
+            gx[1][lane] = GRADIENTS_2D[g1][0];  gy[1][lane] = GRADIENTS_2D[g1][1];
+            gx[2][lane] = GRADIENTS_2D[g2i][0]; gy[2][lane] = GRADIENTS_2D[g2i][1];
+        }
+
+        // Kernels of the three corners; clamping t at zero drops corners out of range
+        const __m128 cx[3] = {x0, x1, x2};
+        const __m128 cy[3] = {y0, y1, y2};
+        __m128 sum = zero;
+        for (int c = 0; c < 3; c++) {
+            __m128 k = _mm_sub_ps(_mm_sub_ps(half, _mm_mul_ps(cx[c], cx[c])), _mm_mul_ps(cy[c], cy[c]));
+            k = _mm_max_ps(k, zero);
+            k = _mm_mul_ps(k, k);
+            __m128 dot = _mm_add_ps(_mm_mul_ps(_mm_load_ps(gx[c]), cx[c]), _mm_mul_ps(_mm_load_ps(gy[c]), cy[c]));
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_mul_ps(k, k), dot));
+        }
+        _mm_storeu_ps(out + index, _mm_mul_ps(sum, _mm_set1_ps(SCALE_2D)));
+    }
+#endif
+    for (; index < count; index++) {
+        out[index] = noise2D(x[index], y[index]);
+    }
+}
+
+void SimplexNoise::noise(const float* x, const float* y, const float* z, float* out, int count) const {
+    // The tetrahedron selection branches too much to pay off in SIMD; the batch
+    // path still saves the virtual call per point
+    for (int i = 0; i < count; i++) {
+        out[i] = noise3D(x[i], y[i], z[i]);
+    }
+}
@@ -0,0 +1,592 @@
+#include "SoftwareRasterizer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define RASTER_USE_SSE 1
+#endif
+
+namespace {
+    // Input triangles per setup batch; at most 7 come out of clipping each, so ids fit 16 bits
+    const int BATCH_TRIANGLES = 2048;
+    // Triangles are clipped to |x|, |y| <= GUARD_BAND * w; beyond the viewport
+    // the bounding box does the clipping, and window coordinates stay small
+    // enough to snap exactly in a double
+    const float GUARD_BAND = 4.0f;
+    const double SUBPIXEL_STEPS = 256.0;
+    const uint32_t NO_TRIANGLE = 0xffffffffu;
+    const int CLIP_PLANE_COUNT = 6;
+    const int MAX_CLIP_VERTICES = 3 + CLIP_PLANE_COUNT;
+
+    // Positive inside clip plane p: near, far, then the guard band's left, right, bottom and top
+    float planeDistance(const glm::vec4& clip, int plane) {
+        switch (plane) {
+            case 0: return clip.z + clip.w;
+            case 1: return clip.w - clip.z;
+            case 2: return clip.x + GUARD_BAND * clip.w;
+            case 3: return GUARD_BAND * clip.w - clip.x;
+            case 4: return clip.y + GUARD_BAND * clip.w;
+            default: return GUARD_BAND * clip.w - clip.y;
+        }
+    }
+
+    unsigned int getOutcode(const glm::vec4& clip) {
+        unsigned int outcode = 0;
+        for (int plane = 0; plane < CLIP_PLANE_COUNT; plane++) {
+            outcode |= static_cast<unsigned int>(planeDistance(clip, plane) < 0.0f) << plane;
+        }
+        return outcode;
+    }
+
+    // pow(), by squaring for whole exponents such as the default shininess
+    float power(float base, float exponent) {
+        int whole = static_cast<int>(exponent);
+        if (static_cast<float>(whole) != exponent || whole < 0 || whole > 1024) {
+            return std::pow(base, exponent);
+        }
+        float result = 1.0f;
+        for (; whole > 0; whole >>= 1, base *= base) {
+            if (whole & 1) {
+                result *= base;
+            }
+        }
+        return result;
+    }
+
+    uint8_t toUnorm8(float value) {
+        return static_cast<uint8_t>(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+    }
+}
+
+ImageDifference compareImages(const uint8_t* a, const uint8_t* b, int width, int height, int tolerance) {
+    ImageDifference difference;
+    long long total = 0;
+    size_t pixels = static_cast<size_t>(width) * height;
+    for (size_t i = 0; i < pixels; i++) {
+        int pixelMax = 0;
+        for (int channel = 0; channel < 3; channel++) {
+            int channelDifference = std::abs(a[i * 4 + channel] - b[i * 4 + channel]);
+            pixelMax = std::max(pixelMax, channelDifference);
+            total += channelDifference;
+        }
+        difference.maxDifference = std::max(difference.maxDifference, pixelMax);
+        difference.pixelsOverTolerance += pixelMax > tolerance;
+    }
+    difference.meanDifference = pixels > 0 ? static_cast<double>(total) / (pixels * 3) : 0.0;
+    return difference;
+}
+
+SoftwareRasterizer::SoftwareRasterizer(JobSystem* jobs)
+    : jobs(jobs), simd(isSimdAvailable()), width(0), height(0), tilesX(0), tilesY(0), clearRgba{0, 0, 0, 255},
+      view(1.0f), projection(1.0f), triangleCount(0) {}
+
+bool SoftwareRasterizer::isSimdAvailable() {
+#ifdef RASTER_USE_SSE
+    return true;
+#else
+    return false;
+#endif
+}
+
+void SoftwareRasterizer::begin(int width, int height, const glm::vec3& clearColor) {
+    this->width = std::max(width, 0);
+    this->height = std::max(height, 0);
+    tilesX = (this->width + TILE_SIZE - 1) / TILE_SIZE;
+    tilesY = (this->height + TILE_SIZE - 1) / TILE_SIZE;
+    clearRgba[0] = toUnorm8(clearColor.x);
+    clearRgba[1] = toUnorm8(clearColor.y);
+    clearRgba[2] = toUnorm8(clearColor.z);
+    clearRgba[3] = 255;
+    size_t pixels = static_cast<size_t>(this->width) * this->height;
+    color.resize(pixels * 4);
+    depth.resize(pixels);
+    draws.clear();
+}
+
+void SoftwareRasterizer::setCamera(const glm::mat4& view, const glm::mat4& projection) {
+    this->view = view;
+    this->projection = projection;
+}
+
+void SoftwareRasterizer::draw(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+                              const glm::mat4& model, const glm::vec3& objectColor) {
+    DrawCall call;
+    call.vertices = vertices.data();
+    call.indices = indices.data();
+    call.vertexCount = vertices.size();
+    call.triangleCount = indices.size() / 3;
+    call.firstVertex = draws.empty() ? 0 : draws.back().firstVertex + draws.back().vertexCount;
+    call.firstTriangle = draws.empty() ? 0 : draws.back().firstTriangle + draws.back().triangleCount;
+    call.model = model;
+    call.normalModel = glm::mat3(model);
+    call.color = objectColor;
+    draws.push_back(call);
+}
+
+void SoftwareRasterizer::end() {
+    size_t inputTriangles = draws.empty() ? 0 : draws.back().firstTriangle + draws.back().triangleCount;
+    transformVertices();
+
+    int batchCount = static_cast<int>((inputTriangles + BATCH_TRIANGLES - 1) / BATCH_TRIANGLES);
+    if (static_cast<int>(batches.size()) < batchCount) {
+        batches.resize(batchCount);
+    }
+    runBatches(batchCount, 1, [this, inputTriangles](int begin, int end) {
+        for (int batch = begin; batch < end; batch++) {
+            size_t first = static_cast<size_t>(batch) * BATCH_TRIANGLES;
+            setupBatch(batch, first, std::min(first + BATCH_TRIANGLES, inputTriangles));
+        }
+    });
+    triangleCount = 0;
+    for (int batch = 0; batch < batchCount; batch++) {
+        triangleCount += static_cast<int>(batches[batch].triangles.size());
+    }
+    // Batches past this frame's count keep their capacity but must not be binned
+    for (size_t batch = batchCount; batch < batches.size(); batch++) {
+        batches[batch].binTiles.clear();
+        batches[batch].binTriangles.clear();
+    }
+    sortBins();
+
+    runBatches(tilesX * tilesY, 1, [this](int begin, int end) {
+        for (int tile = begin; tile < end; tile++) {
+            rasterizeTile(tile);
+        }
+    });
+}
+
+void SoftwareRasterizer::runBatches(int count, int minBatch, const std::function<void(int, int)>& fn) {
+    if (jobs) {
+        jobs->parallelFor(count, minBatch, fn);
+    } else if (count > 0) {
+        fn(0, count);
+    }
+}
+
+size_t SoftwareRasterizer::findDraw(size_t index, bool byTriangle) const {
+    // Last draw starting at or before index
+    auto after = std::upper_bound(draws.begin(), draws.end(), index, [byTriangle](size_t value, const DrawCall& call) {
+        return value < (byTriangle ? call.firstTriangle : call.firstVertex);
+    });
+    return static_cast<size_t>(after - draws.begin()) - 1;
+}
+
+void SoftwareRasterizer::transformVertices() {
+    size_t vertexCount = draws.empty() ? 0 : draws.back().firstVertex + draws.back().vertexCount;
+    transformed.resize(vertexCount);
+    glm::mat4 viewProjection = projection * view;
+    runBatches(static_cast<int>(vertexCount), 1024, [this, &viewProjection](int begin, int end) {
+        size_t drawIndex = findDraw(begin, false);
+        for (int i = begin; i < end; i++) {
+            while (static_cast<size_t>(i) >= draws[drawIndex].firstVertex + draws[drawIndex].vertexCount) {
+                drawIndex++;
+            }
+            const DrawCall& call = draws[drawIndex];
+            const Vertex& vertex = call.vertices[i - call.firstVertex];
+            glm::vec4 world = call.model * glm::vec4(vertex.position, 1.0f);
+            TransformedVertex& out = transformed[i];
+            out.clip = viewProjection * world;
+            out.world = glm::vec3(world);
+            out.normal = call.normalModel * vertex.normal;
+        }
+    });
+}
+
+void SoftwareRasterizer::setupBatch(int batchIndex, size_t firstTriangle, size_t endTriangle) {
+    TriangleBatch& batch = batches[batchIndex];
+    batch.triangles.clear();
+    batch.binTiles.clear();
+    batch.binTriangles.clear();
+    if (firstTriangle >= endTriangle) {
+        return;
+    }
+
+    TransformedVertex polygon[MAX_CLIP_VERTICES];
+    size_t drawIndex = findDraw(firstTriangle, true);
+    for (size_t t = firstTriangle; t < endTriangle; t++) {
+        while (t >= draws[drawIndex].firstTriangle + draws[drawIndex].triangleCount) {
+            drawIndex++;
+        }
+        const DrawCall& call = draws[drawIndex];
+        const unsigned int* indices = call.indices + (t - call.firstTriangle) * 3;
+        if (indices[0] >= call.vertexCount || indices[1] >= call.vertexCount || indices[2] >= call.vertexCount) {
+            continue;
+        }
+        const TransformedVertex* base = transformed.data() + call.firstVertex;
+        const TransformedVertex& v0 = base[indices[0]];
+        const TransformedVertex& v1 = base[indices[1]];
+        const TransformedVertex& v2 = base[indices[2]];
+
+        unsigned int outcode0 = getOutcode(v0.clip);
+        unsigned int outcode1 = getOutcode(v1.clip);
+        unsigned int outcode2 = getOutcode(v2.clip);
+        if (outcode0 & outcode1 & outcode2) {
+            continue;
+        }
+        unsigned int planes = outcode0 | outcode1 | outcode2;
+        if (planes == 0) {
+            addTriangle(v0, v1, v2, static_cast<int>(drawIndex), batchIndex);
+            continue;
+        }
+        polygon[0] = v0;
+        polygon[1] = v1;
+        polygon[2] = v2;
+        int count = clipPolygon(polygon, 3, planes);
+        for (int i = 1; i + 1 < count; i++) {
+            addTriangle(polygon[0], polygon[i], polygon[i + 1], static_cast<int>(drawIndex), batchIndex);
+        }
+    }
+}
+
+void SoftwareRasterizer::addTriangle(const TransformedVertex& v0, const TransformedVertex& v1,
+                                     const TransformedVertex& v2, int drawIndex, int batchIndex) {
+    TriangleBatch& batch = batches[batchIndex];
+    batch.triangles.emplace_back();
+    if (!setupTriangle(v0, v1, v2, drawIndex, batch.triangles.back())) {
+        batch.triangles.pop_back();
+        return;
+    }
+    uint32_t id = static_cast<uint32_t>(batchIndex) << 16 | static_cast<uint32_t>(batch.triangles.size() - 1);
+    binTriangle(batch.triangles.back(), id, batch);
+}
+
+int SoftwareRasterizer::clipPolygon(TransformedVertex* polygon, int count, unsigned int planes) {
+    TransformedVertex clipped[MAX_CLIP_VERTICES];
+    for (int plane = 0; plane < CLIP_PLANE_COUNT && count >= 3; plane++) {
+        if (!(planes & (1u << plane))) {
+            continue;
+        }
+        int clippedCount = 0;
+        for (int i = 0; i < count; i++) {
+            const TransformedVertex& current = polygon[i];
+            const TransformedVertex& next = polygon[(i + 1) % count];
+            float currentDistance = planeDistance(current.clip, plane);
+            float nextDistance = planeDistance(next.clip, plane);
+            if (currentDistance >= 0.0f) {
+                clipped[clippedCount++] = current;
+            }
+            if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f)) {
+                // Every attribute is linear in clip space, before the perspective divide
+                float t = currentDistance / (currentDistance - nextDistance);
+                TransformedVertex& vertex = clipped[clippedCount++];
+                vertex.clip = current.clip + (next.clip - current.clip) * t;
+                vertex.world = current.world + (next.world - current.world) * t;
+                vertex.normal = current.normal + (next.normal - current.normal) * t;
+            }
+        }
+        count = clippedCount;
+        std::copy(clipped, clipped + count, polygon);
+    }
+    return count;
+}
+
+bool SoftwareRasterizer::setupTriangle(const TransformedVertex& v0, const TransformedVertex& v1,
+                                       const TransformedVertex& v2, int drawIndex, Triangle& triangle) const {
+    const TransformedVertex* vertices[3] = {&v0, &v1, &v2};
+    double x[3], y[3], z[3];
+    float inverseW[3];
+    for (int i = 0; i < 3; i++) {
+        const glm::vec4& clip = vertices[i]->clip;
+        if (!(clip.w > 0.0f)) {
+            return false;
+        }
+        inverseW[i] = 1.0f / clip.w;
+        // Viewport transform, then snap to the subpixel grid
+        double windowX = (clip.x * inverseW[i] * 0.5 + 0.5) * width;
+        double windowY = (clip.y * inverseW[i] * 0.5 + 0.5) * height;
+        x[i] = std::round(windowX * SUBPIXEL_STEPS) / SUBPIXEL_STEPS;
+        y[i] = std::round(windowY * SUBPIXEL_STEPS) / SUBPIXEL_STEPS;
+        z[i] = clip.z * inverseW[i] * 0.5 + 0.5;
+    }
+
+    double area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if (area == 0.0) {
+        return false;
+    }
+    // Without culling both windings are drawn; make every triangle counter-clockwise
+    int order[3] = {0, 1, 2};
+    if (area < 0.0) {
+        std::swap(order[1], order[2]);
+        area = -area;
+    }
+
+    double minX = std::min(std::min(x[0], x[1]), x[2]);
+    double maxX = std::max(std::max(x[0], x[1]), x[2]);
+    double minY = std::min(std::min(y[0], y[1]), y[2]);
+    double maxY = std::max(std::max(y[0], y[1]), y[2]);
+    triangle.minX = std::max(static_cast<int>(std::ceil(minX - 0.5)), 0);
+    triangle.maxX = std::min(static_cast<int>(std::floor(maxX - 0.5)), width - 1);
+    triangle.minY = std::max(static_cast<int>(std::ceil(minY - 0.5)), 0);
+    triangle.maxY = std::min(static_cast<int>(std::floor(maxY - 0.5)), height - 1);
+    if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) {
+        return false;
+    }
+
+    triangle.ownedEdges = 0;
+    for (int i = 0; i < 3; i++) {
+        int a = order[(i + 1) % 3];
+        int b = order[(i + 2) % 3];
+        // A shared edge comes out exactly negated for the triangle on its other
+        // side, so a pixel center is inside exactly one of them
+        triangle.edgeA[i] = y[a] - y[b];
+        triangle.edgeB[i] = x[b] - x[a];
+        triangle.edgeC[i] = x[a] * y[b] - y[a] * x[b];
+        // Top-left rule: with y up, left edges have inside towards +x, top edges inside towards -y
+        bool owned = triangle.edgeA[i] > 0.0 || (triangle.edgeA[i] == 0.0 && triangle.edgeB[i] < 0.0);
+        triangle.ownedEdges |= static_cast<uint8_t>(owned) << i;
+    }
+
+    // Depth is linear in window space: z0 + l1 (z1 - z0) + l2 (z2 - z0), with l = E / area
+    triangle.inverseArea = 1.0 / area;
+    double z0 = z[order[0]];
+    double dz1 = (z[order[1]] - z0) * triangle.inverseArea;
+    double dz2 = (z[order[2]] - z0) * triangle.inverseArea;
+    triangle.depthA = dz1 * triangle.edgeA[1] + dz2 * triangle.edgeA[2];
+    triangle.depthB = dz1 * triangle.edgeB[1] + dz2 * triangle.edgeB[2];
+    triangle.depthC = z0 + dz1 * triangle.edgeC[1] + dz2 * triangle.edgeC[2];
+
+    // Attributes over w for perspective-correct interpolation
+    for (int i = 0; i < 3; i++) {
+        const TransformedVertex& vertex = *vertices[order[i]];
+        triangle.inverseW[i] = inverseW[order[i]];
+        triangle.worldOverW[i] = vertex.world * inverseW[order[i]];
+        triangle.normalOverW[i] = vertex.normal * inverseW[order[i]];
+    }
+    triangle.draw = drawIndex;
+    return true;
+}
+
+void SoftwareRasterizer::binTriangle(const Triangle& triangle, uint32_t id, TriangleBatch& batch) const {
+    int firstTileX = triangle.minX / TILE_SIZE;
+    int lastTileX = triangle.maxX / TILE_SIZE;
+    int firstTileY = triangle.minY / TILE_SIZE;
+    int lastTileY = triangle.maxY / TILE_SIZE;
+    bool singleTile = firstTileX == lastTileX && firstTileY == lastTileY;
+    for (int tileY = firstTileY; tileY <= lastTileY; tileY++) {
+        for (int tileX = firstTileX; tileX <= lastTileX; tileX++) {
+            if (!singleTile) {
+                // Skip tiles wholly outside an edge: the largest value over the tile's pixel
+                // centers is at one of its corners. The margin of a pixel keeps rounding in
+                // the per-pixel evaluation from ever mattering.
+                double x0 = tileX * TILE_SIZE + 0.5;
+                double y0 = tileY * TILE_SIZE + 0.5;
+                double x1 = std::min((tileX + 1) * TILE_SIZE, width) - 0.5;
+                double y1 = std::min((tileY + 1) * TILE_SIZE, height) - 0.5;
+                bool outside = false;
+                for (int i = 0; i < 3 && !outside; i++) {
+                    double a = triangle.edgeA[i];
+                    double b = triangle.edgeB[i];
+                    double largest = std::max(a * x0, a * x1) + std::max(b * y0, b * y1) + triangle.edgeC[i];
+                    outside = largest < -(std::fabs(a) + std::fabs(b));
+                }
+                if (outside) {
+                    continue;
+                }
+            }
+            batch.binTiles.push_back(static_cast<uint32_t>(tileY * tilesX + tileX));
+            batch.binTriangles.push_back(id);
+        }
+    }
+}
+
+void SoftwareRasterizer::sortBins() {
+    // Counting sort by tile; walking the batches in order keeps each tile's
+    // triangles in draw order
+    int tileCount = tilesX * tilesY;
+    tileStarts.assign(tileCount + 1, 0);
+    size_t total = 0;
+    for (const TriangleBatch& batch : batches) {
+        for (uint32_t tile : batch.binTiles) {
+            tileStarts[tile + 1]++;
+        }
+        total += batch.binTiles.size();
+    }
+    for (int tile = 0; tile < tileCount; tile++) {
+        tileStarts[tile + 1] += tileStarts[tile];
+    }
+    tileTriangles.resize(total);
+    for (const TriangleBatch& batch : batches) {
+        for (size_t i = 0; i < batch.binTiles.size(); i++) {
+            tileTriangles[tileStarts[batch.binTiles[i]]++] = batch.binTriangles[i];
+        }
+    }
+    // The fill advanced each start to the next tile's; shift them back
+    for (int tile = tileCount; tile > 0; tile--) {
+        tileStarts[tile] = tileStarts[tile - 1];
+    }
+    tileStarts[0] = 0;
+}
+
+void SoftwareRasterizer::rasterizeTile(int tile) {
+    int tileX = (tile % tilesX) * TILE_SIZE;
+    int tileY = (tile / tilesX) * TILE_SIZE;
+    int tileWidth = std::min(TILE_SIZE, width - tileX);
+    int tileHeight = std::min(TILE_SIZE, height - tileY);
+
+    // Nearest triangle per pixel; shading waits until every triangle is in,
+    // so each pixel is shaded once
+#ifdef RASTER_USE_SSE
+    alignas(16) float tileDepth[TILE_SIZE * TILE_SIZE];
+    alignas(16) uint32_t tileIds[TILE_SIZE * TILE_SIZE];
+#else
+    float tileDepth[TILE_SIZE * TILE_SIZE];
+    uint32_t tileIds[TILE_SIZE * TILE_SIZE];
+#endif
+    std::fill(tileDepth, tileDepth + TILE_SIZE * TILE_SIZE, 1.0f);
+    std::fill(tileIds, tileIds + TILE_SIZE * TILE_SIZE, NO_TRIANGLE);
+
+    for (uint32_t k = tileStarts[tile]; k < tileStarts[tile + 1]; k++) {
+        uint32_t id = tileTriangles[k];
+        const Triangle& triangle = getTriangle(id);
+        int x0 = std::max(triangle.minX, tileX) - tileX;
+        int x1 = std::min(triangle.maxX, tileX + tileWidth - 1) - tileX;
+        int y0 = std::max(triangle.minY, tileY) - tileY;
+        int y1 = std::min(triangle.maxY, tileY + tileHeight - 1) - tileY;
+        if (x0 > x1 || y0 > y1) {
+            continue;
+        }
+
+        // Edge and depth values at the tile's first pixel center and their steps per
+        // pixel. Going to float after the offset to the tile keeps them precise, and
+        // both paths below evaluate (origin + stepY * dy) + stepX * dx the same way.
+        double centerX = tileX + 0.5;
+        double centerY = tileY + 0.5;
+        float edgeOrigin[3], edgeStepX[3], edgeStepY[3];
+        for (int i = 0; i < 3; i++) {
+            edgeOrigin[i] = static_cast<float>(triangle.edgeA[i] * centerX + triangle.edgeB[i] * centerY + triangle.edgeC[i]);
+            edgeStepX[i] = static_cast<float>(triangle.edgeA[i]);
+            edgeStepY[i] = static_cast<float>(triangle.edgeB[i]);
+        }
+        float depthOrigin = static_cast<float>(triangle.depthA * centerX + triangle.depthB * centerY + triangle.depthC);
+        float depthStepX = static_cast<float>(triangle.depthA);
+        float depthStepY = static_cast<float>(triangle.depthB);
+
+#ifdef RASTER_USE_SSE
+        if (simd) {
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 laneOffsets = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+            const __m128 first = _mm_set1_ps(static_cast<float>(x0));
+            const __m128 last = _mm_set1_ps(static_cast<float>(x1));
+            const __m128i idVector = _mm_set1_epi32(static_cast<int>(id));
+            __m128 stepX[3], owned[3];
+            for (int i = 0; i < 3; i++) {
+                stepX[i] = _mm_set1_ps(edgeStepX[i]);
+                owned[i] = _mm_castsi128_ps(_mm_set1_epi32((triangle.ownedEdges >> i & 1) ? -1 : 0));
+            }
+            const __m128 depthX = _mm_set1_ps(depthStepX);
+            for (int y = y0; y <= y1; y++) {
+                float dy = static_cast<float>(y);
+                __m128 rowEdge[3];
+                for (int i = 0; i < 3; i++) {
+                    rowEdge[i] = _mm_set1_ps(edgeOrigin[i] + edgeStepY[i] * dy);
+                }
+                __m128 rowDepth = _mm_set1_ps(depthOrigin + depthStepY * dy);
+                float* depthRow = tileDepth + y * TILE_SIZE;
+                uint32_t* idRow = tileIds + y * TILE_SIZE;
+                // Groups of four are aligned to the tile, which is a multiple of four wide
+                for (int x = x0 & ~3; x <= x1; x += 4) {
+                    __m128 dx = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneOffsets);
+                    __m128 mask = _mm_and_ps(_mm_cmpge_ps(dx, first), _mm_cmple_ps(dx, last));
+                    for (int i = 0; i < 3; i++) {
+                        __m128 edge = _mm_add_ps(rowEdge[i], _mm_mul_ps(stepX[i], dx));
+                        __m128 inside = _mm_or_ps(_mm_cmpgt_ps(edge, zero), _mm_and_ps(_mm_cmpeq_ps(edge, zero), owned[i]));
+                        mask = _mm_and_ps(mask, inside);
+                    }
+                    __m128 oldDepth = _mm_load_ps(depthRow + x);
+                    __m128 newDepth = _mm_add_ps(rowDepth, _mm_mul_ps(depthX, dx));
+                    mask = _mm_and_ps(mask, _mm_cmplt_ps(newDepth, oldDepth));
+                    if (_mm_movemask_ps(mask) == 0) {
+                        continue;
+                    }
+                    _mm_store_ps(depthRow + x, _mm_or_ps(_mm_and_ps(mask, newDepth), _mm_andnot_ps(mask, oldDepth)));
+                    __m128i idMask = _mm_castps_si128(mask);
+                    __m128i oldIds = _mm_load_si128(reinterpret_cast<const __m128i*>(idRow + x));
+                    _mm_store_si128(reinterpret_cast<__m128i*>(idRow + x),
+                                    _mm_or_si128(_mm_and_si128(idMask, idVector), _mm_andnot_si128(idMask, oldIds)));
+                }
+            }
+            continue;
+        }
+#endif
+        for (int y = y0; y <= y1; y++) {
+            float dy = static_cast<float>(y);
+            float rowEdge[3];
+            for (int i = 0; i < 3; i++) {
+                rowEdge[i] = edgeOrigin[i] + edgeStepY[i] * dy;
+            }
+            float rowDepth = depthOrigin + depthStepY * dy;
+            for (int x = x0; x <= x1; x++) {
+                float dx = static_cast<float>(x);
+                bool inside = true;
+                for (int i = 0; i < 3 && inside; i++) {
+                    float edge = rowEdge[i] + edgeStepX[i] * dx;
+                    inside = edge > 0.0f || (edge == 0.0f && (triangle.ownedEdges >> i & 1));
+                }
+                float pixelDepth = rowDepth + depthStepX * dx;
+                if (inside && pixelDepth < tileDepth[y * TILE_SIZE + x]) {
+                    tileDepth[y * TILE_SIZE + x] = pixelDepth;
+                    tileIds[y * TILE_SIZE + x] = id;
+                }
+            }
+        }
+    }
+
+    for (int y = 0; y < tileHeight; y++) {
+        size_t row = static_cast<size_t>(tileY + y) * width + tileX;
+        std::copy(tileDepth + y * TILE_SIZE, tileDepth + y * TILE_SIZE + tileWidth, depth.begin() + row);
+        uint8_t* pixel = color.data() + row * 4;
+        for (int x = 0; x < tileWidth; x++, pixel += 4) {
+            uint32_t id = tileIds[y * TILE_SIZE + x];
+            if (id == NO_TRIANGLE) {
+                std::copy(clearRgba, clearRgba + 4, pixel);
+                continue;
+            }
+            glm::vec3 result = shadePixel(getTriangle(id), tileX + x, tileY + y);
+            pixel[0] = toUnorm8(result.x);
+            pixel[1] = toUnorm8(result.y);
+            pixel[2] = toUnorm8(result.z);
+            pixel[3] = 255;
+        }
+    }
+}
+
+glm::vec3 SoftwareRasterizer::shadePixel(const Triangle& triangle, int x, int y) const {
+    // Barycentrics at the pixel center, then attributes corrected for perspective
+    double centerX = x + 0.5;
+    double centerY = y + 0.5;
+    float l1 = static_cast<float>((triangle.edgeA[1] * centerX + triangle.edgeB[1] * centerY + triangle.edgeC[1]) *
+                                  triangle.inverseArea);
+    float l2 = static_cast<float>((triangle.edgeA[2] * centerX + triangle.edgeB[2] * centerY + triangle.edgeC[2]) *
+                                  triangle.inverseArea);
+    float l0 = 1.0f - l1 - l2;
+    float inverseW = l0 * triangle.inverseW[0] + l1 * triangle.inverseW[1] + l2 * triangle.inverseW[2];
+    glm::vec3 fragPos = (triangle.worldOverW[0] * l0 + triangle.worldOverW[1] * l1 + triangle.worldOverW[2] * l2) /
+                        inverseW;
+    // Normalized right away, so the division by 1 / w cancels out
+    glm::vec3 normal = triangle.normalOverW[0] * l0 + triangle.normalOverW[1] * l1 + triangle.normalOverW[2] * l2;
+
+    // fragment.glsl without BAKED_LIGHT
+    glm::vec3 ambient = shading.ambientStrength * shading.lightColor;
+    glm::vec3 norm = glm::normalize(normal);
+    glm::vec3 lightDir = glm::normalize(shading.lightPos - fragPos);
+    float diff = std::max(glm::dot(norm, lightDir), 0.0f);
+    glm::vec3 diffuse = diff * shading.lightColor;
+    glm::vec3 specular(0.0f);
+    if (shading.specularStrength > 0.0f) {
+        glm::vec3 viewDir = glm::normalize(shading.viewPos - fragPos);
+        // reflect(-lightDir, norm)
+        glm::vec3 reflectDir = -lightDir + 2.0f * glm::dot(norm, lightDir) * norm;
+        float spec = power(std::max(glm::dot(viewDir, reflectDir), 0.0f), shading.shininess);
+        specular = shading.specularStrength * spec * shading.lightColor;
+    }
+    glm::vec3 result = (ambient + diffuse + specular) * draws[triangle.draw].color;
+
+    if (shading.fog) {
+        float fogDistance = glm::length(shading.viewPos - fragPos);
+        float fogScaled = shading.fogDensity * fogDistance;
+        float fogFactor = std::exp(-fogScaled * fogScaled);
+        result = glm::mix(shading.fogColor, result, std::min(std::max(fogFactor, 0.0f), 1.0f));
+    }
+    return result;
+}
@@ -0,0 +1,159 @@
+#include "SpatialHash.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    const int MIN_BUCKETS = 64;
+}
+
+SpatialHash::SpatialHash(float cellSize)
+    : cellSize(cellSize), inverseCellSize(1.0f / cellSize), radius(0.0f), height(0.0f), bucketMask(0) {}
+
+int SpatialHash::cellOf(float coordinate) const {
+    return static_cast<int>(std::floor(coordinate * inverseCellSize));
+}
+
+uint32_t SpatialHash::bucketOf(int x, int z) const {
+    // Large odd multipliers spread neighbouring cells across the table
+    return (static_cast<uint32_t>(x) * 73856093u ^ static_cast<uint32_t>(z) * 19349663u) & bucketMask;
+}
+
+void SpatialHash::build(const float* xs, const float* ys, const float* zs, int count, float bodyRadius,
+                        float bodyHeight) {
+    radius = bodyRadius;
+    height = bodyHeight;
+
+    // About two buckets per body keeps unrelated cells from sharing buckets
+    int bucketCount = MIN_BUCKETS;
+    while (bucketCount < count * 2) {
+        bucketCount *= 2;
+    }
+    bucketMask = static_cast<uint32_t>(bucketCount - 1);
+
+    bucketStart.assign(bucketCount + 1, 0);
+    bodyBucket.resize(count);
+    for (int i = 0; i < count; i++) {
+        bodyBucket[i] = bucketOf(cellOf(xs[i]), cellOf(zs[i]));
+        bucketStart[bodyBucket[i] + 1]++;
+    }
+    for (int b = 0; b < bucketCount; b++) {
+        bucketStart[b + 1] += bucketStart[b];
+    }
+
+    sortedX.resize(count);
+    sortedY.resize(count);
+    sortedZ.resize(count);
+    cellX.resize(count);
+    cellZ.resize(count);
+    bodies.resize(count);
+    // Fill back to front so each bucket's counter ends at its start
+    for (int i = count - 1; i >= 0; i--) {
+        int entry = --bucketStart[bodyBucket[i] + 1];
+        sortedX[entry] = xs[i];
+        sortedY[entry] = ys[i];
+        sortedZ[entry] = zs[i];
+        cellX[entry] = cellOf(xs[i]);
+        cellZ[entry] = cellOf(zs[i]);
+        bodies[entry] = i;
+    }
+    // bucketStart[b + 1] now holds the start of bucket b; move it into place
+    for (int b = 0; b < bucketCount; b++) {
+        bucketStart[b] = bucketStart[b + 1];
+    }
+    bucketStart[bucketCount] = count;
+}
+
+template<typename F>
+void SpatialHash::forEachInCells(int minX, int minZ, int maxX, int maxZ, F&& visit) const {
+    for (int z = minZ; z <= maxZ; z++) {
+        for (int x = minX; x <= maxX; x++) {
+            uint32_t bucket = bucketOf(x, z);
+            for (int entry = bucketStart[bucket]; entry < bucketStart[bucket + 1]; entry++) {
+                // Buckets are shared by distant cells; checking the cell also
+                // reports each body once even when two query cells share a bucket
+                if (cellX[entry] == x && cellZ[entry] == z) {
+                    visit(entry);
+                }
+            }
+        }
+    }
+}
+
+void SpatialHash::queryBox(const glm::vec3& boxMin, const glm::vec3& boxMax, std::vector<int>& out) const {
+    if (bodies.empty()) {
+        return;
+    }
+    // Bodies are filed by their centre, so widen the cell range by the radius
+    forEachInCells(cellOf(boxMin.x - radius), cellOf(boxMin.z - radius),
+                   cellOf(boxMax.x + radius), cellOf(boxMax.z + radius), [&](int entry) {
+        if (sortedX[entry] + radius >= boxMin.x && sortedX[entry] - radius <= boxMax.x &&
+            sortedZ[entry] + radius >= boxMin.z && sortedZ[entry] - radius <= boxMax.z &&
+            sortedY[entry] + height >= boxMin.y && sortedY[entry] <= boxMax.y) {
+            out.push_back(bodies[entry]);
+        }
+    });
+}
+
+void SpatialHash::queryRadius(const glm::vec3& center, float queryRadius, std::vector<int>& out) const {
+    if (bodies.empty()) {
+        return;
+    }
+    float reach = queryRadius + radius;
+    forEachInCells(cellOf(center.x - reach), cellOf(center.z - reach),
+                   cellOf(center.x + reach), cellOf(center.z + reach), [&](int entry) {
+        // Distance from the centre to the nearest point of the cylinder
+        float dx = sortedX[entry] - center.x;
+        float dz = sortedZ[entry] - center.z;
+        float side = std::max(0.0f, std::sqrt(dx * dx + dz * dz) - radius);
+        float below = sortedY[entry] - center.y;
+        float above = center.y - (sortedY[entry] + height);
+        float vertical = std::max(0.0f, std::max(below, above));
+        if (side * side + vertical * vertical <= queryRadius * queryRadius) {
+            out.push_back(bodies[entry]);
+        }
+    });
+}
+
+void SpatialHash::queryCylinder(const glm::vec3& feet, float queryRadius, float queryHeight,
+                                std::vector<int>& out) const {
+    if (bodies.empty()) {
+        return;
+    }
+    float reach = queryRadius + radius;
+    forEachInCells(cellOf(feet.x - reach), cellOf(feet.z - reach),
+                   cellOf(feet.x + reach), cellOf(feet.z + reach), [&](int entry) {
+        glm::vec3 body(sortedX[entry], sortedY[entry], sortedZ[entry]);
+        if (cylindersOverlap(feet, queryRadius, queryHeight, body, radius, height)) {
+            out.push_back(bodies[entry]);
+        }
+    });
+}
+
+void SpatialHash::findPairs(std::vector<BodyPair>& out) const {
+    float reach = radius * 2.0f;
+    for (int entry = 0; entry < static_cast<int>(bodies.size()); entry++) {
+        float x = sortedX[entry], y = sortedY[entry], z = sortedZ[entry];
+        int body = bodies[entry];
+        forEachInCells(cellOf(x - reach), cellOf(z - reach), cellOf(x + reach), cellOf(z + reach), [&](int other) {
+            // Each pair is found from both sides; keep the one from the lower index
+            if (bodies[other] <= body) {
+                return;
+            }
+            if (std::abs(sortedX[other] - x) < reach && std::abs(sortedZ[other] - z) < reach &&
+                std::abs(sortedY[other] - y) < height) {
+                out.push_back({body, bodies[other]});
+            }
+        });
+    }
+}
+
+bool SpatialHash::cylindersOverlap(const glm::vec3& feetA, float radiusA, float heightA,
+                                   const glm::vec3& feetB, float radiusB, float heightB) {
+    if (feetA.y >= feetB.y + heightB || feetB.y >= feetA.y + heightA) {
+        return false;
+    }
+    float dx = feetA.x - feetB.x;
+    float dz = feetA.z - feetB.z;
+    float reach = radiusA + radiusB;
+    return dx * dx + dz * dz < reach * reach;
+}
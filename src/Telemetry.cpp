@@ -0,0 +1,259 @@
+#include "Telemetry.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <new>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    const uint32_t TELEMETRY_MAGIC = 0x54443352;  // "R3DT"
+
+    // Readers spin through std::atomic in another process, so it must not hide a lock
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "telemetry needs lock-free 64-bit atomics");
+
+    uint64_t nowMicroseconds() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // Seqlock slot: the sequence is odd while the frame is being written and
+    // 2 * (frame + 1) once frame is complete
+    struct TelemetrySlot {
+        std::atomic<uint64_t> sequence;
+        TelemetryFrame frame;
+    };
+}
+
+struct TelemetryBlock {
+    // Fixed header, checked by readers before anything else
+    std::atomic<uint32_t> magic;   // stored last when the block is created
+    uint32_t version;
+    uint32_t blockBytes;
+    uint32_t frameBytes;
+    uint32_t ringFrames;
+    uint32_t counterCount;
+    uint32_t histogramBuckets;
+    float bucketMilliseconds;
+    std::atomic<uint32_t> closed;
+    uint32_t padding;
+    std::atomic<uint64_t> framesPublished;
+
+    std::atomic<uint64_t> histogram[TELEMETRY_HISTOGRAM_BUCKETS];
+    TelemetrySlot slots[TELEMETRY_RING_FRAMES];
+};
+
+namespace {
+    // Maps the block, creating and sizing it for the publisher
+    void* mapBlock(const std::string& name, bool create, void*& handle) {
+        const size_t bytes = sizeof(TelemetryBlock);
+        handle = nullptr;
+#ifdef _WIN32
+        // Windows object names cannot contain backslashes; a leading slash is harmless
+        HANDLE mapping = create
+            ? CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, static_cast<DWORD>(bytes), name.c_str())
+            : OpenFileMappingA(FILE_MAP_READ, FALSE, name.c_str());
+        if (!mapping) {
+            return nullptr;
+        }
+        void* memory = MapViewOfFile(mapping, create ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, bytes);
+        if (!memory) {
+            CloseHandle(mapping);
+            return nullptr;
+        }
+        handle = mapping;
+        return memory;
+#else
+        if (create) {
+            // A block left by a crashed run may have an older size or layout
+            shm_unlink(name.c_str());
+        }
+        int fd = create ? shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644) : shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            return nullptr;
+        }
+        struct stat info;
+        bool sized = create ? ftruncate(fd, static_cast<off_t>(bytes)) == 0
+                            : fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= bytes;
+        void* memory = sized ? mmap(nullptr, bytes, create ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0)
+                             : MAP_FAILED;
+        ::close(fd);
+        return memory != MAP_FAILED ? memory : nullptr;
+#endif
+    }
+
+    void unmapBlock(const void* memory, void* handle) {
+#ifdef _WIN32
+        UnmapViewOfFile(memory);
+        CloseHandle(static_cast<HANDLE>(handle));
+#else
+        (void)handle;
+        munmap(const_cast<void*>(memory), sizeof(TelemetryBlock));
+#endif
+    }
+
+    int histogramBucket(float milliseconds) {
+        int bucket = static_cast<int>(milliseconds / TELEMETRY_BUCKET_MILLISECONDS);
+        return bucket < 0 ? 0 : (bucket < TELEMETRY_HISTOGRAM_BUCKETS ? bucket : TELEMETRY_HISTOGRAM_BUCKETS - 1);
+    }
+}
+
+TelemetryPublisher::TelemetryPublisher() : block(nullptr), handle(nullptr), pending(), frameCount(0),
+                                           openMicroseconds(0) {}
+
+TelemetryPublisher::~TelemetryPublisher() {
+    close();
+}
+
+bool TelemetryPublisher::open(const std::string& blockName) {
+    close();
+    void* memory = mapBlock(blockName, true, handle);
+    if (!memory) {
+        std::cerr << "Failed to create telemetry block " << blockName << std::endl;
+        return false;
+    }
+
+    // Fresh shared memory is zeroed; construct the atomics over it, then publish the header
+    block = new (memory) TelemetryBlock();
+    block->version = TELEMETRY_VERSION;
+    block->blockBytes = sizeof(TelemetryBlock);
+    block->frameBytes = sizeof(TelemetryFrame);
+    block->ringFrames = TELEMETRY_RING_FRAMES;
+    block->counterCount = TELEMETRY_COUNTER_COUNT;
+    block->histogramBuckets = TELEMETRY_HISTOGRAM_BUCKETS;
+    block->bucketMilliseconds = TELEMETRY_BUCKET_MILLISECONDS;
+    block->magic.store(TELEMETRY_MAGIC, std::memory_order_release);
+
+    name = blockName;
+    pending = TelemetryFrame();
+    frameCount = 0;
+    openMicroseconds = nowMicroseconds();
+    return true;
+}
+
+void TelemetryPublisher::close() {
+    if (!block) {
+        return;
+    }
+    block->closed.store(1, std::memory_order_release);
+    unmapBlock(block, handle);
+#ifndef _WIN32
+    shm_unlink(name.c_str());
+#endif
+    block = nullptr;
+    handle = nullptr;
+}
+
+void TelemetryPublisher::publishFrame(float frameMilliseconds, float cpuMilliseconds) {
+    if (!block) {
+        return;
+    }
+    pending.frame = frameCount;
+    pending.timeMicroseconds = nowMicroseconds() - openMicroseconds;
+    pending.frameMilliseconds = frameMilliseconds;
+    pending.cpuMilliseconds = cpuMilliseconds;
+
+    TelemetrySlot& slot = block->slots[frameCount % TELEMETRY_RING_FRAMES];
+    slot.sequence.store(frameCount * 2 + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&slot.frame, &pending, sizeof(TelemetryFrame));
+    slot.sequence.store(frameCount * 2 + 2, std::memory_order_release);
+
+    // Only this thread writes, so a load and store is enough
+    std::atomic<uint64_t>& bucket = block->histogram[histogramBucket(frameMilliseconds)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    frameCount++;
+    block->framesPublished.store(frameCount, std::memory_order_release);
+    std::memset(pending.counters, 0, sizeof(pending.counters));
+}
+
+TelemetryReader::TelemetryReader() : block(nullptr), handle(nullptr) {}
+
+TelemetryReader::~TelemetryReader() {
+    close();
+}
+
+bool TelemetryReader::open(const std::string& blockName) {
+    close();
+    void* memory = mapBlock(blockName, false, handle);
+    if (!memory) {
+        return false;
+    }
+    const TelemetryBlock* mapped = static_cast<const TelemetryBlock*>(memory);
+    if (mapped->magic.load(std::memory_order_acquire) != TELEMETRY_MAGIC) {
+        // Not there yet, or not a telemetry block at all
+        unmapBlock(memory, handle);
+        return false;
+    }
+    if (mapped->version != TELEMETRY_VERSION || mapped->blockBytes != sizeof(TelemetryBlock) ||
+        mapped->frameBytes != sizeof(TelemetryFrame)) {
+        std::cerr << "Telemetry block " << blockName << " has layout version " << mapped->version << ", expected "
+                  << TELEMETRY_VERSION << std::endl;
+        unmapBlock(memory, handle);
+        return false;
+    }
+    block = mapped;
+    return true;
+}
+
+void TelemetryReader::close() {
+    if (block) {
+        unmapBlock(block, handle);
+        block = nullptr;
+        handle = nullptr;
+    }
+}
+
+uint64_t TelemetryReader::readFrames(uint64_t cursor, std::vector<TelemetryFrame>& frames) const {
+    uint64_t published = getFramesPublished();
+    // Everything older than one ring has been overwritten
+    uint64_t first = published > static_cast<uint64_t>(TELEMETRY_RING_FRAMES)
+        ? std::max(cursor, published - TELEMETRY_RING_FRAMES) : cursor;
+    for (uint64_t index = first; index < published; index++) {
+        const TelemetrySlot& slot = block->slots[index % TELEMETRY_RING_FRAMES];
+        uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != index * 2 + 2) {
+            continue;
+        }
+        TelemetryFrame frame;
+        std::memcpy(&frame, &slot.frame, sizeof(TelemetryFrame));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // The publisher lapped us mid-copy
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+            continue;
+        }
+        frames.push_back(frame);
+    }
+    return published;
+}
+
+uint64_t TelemetryReader::getFramesPublished() const {
+    return block ? block->framesPublished.load(std::memory_order_acquire) : 0;
+}
+
+void TelemetryReader::readHistogram(uint64_t (&buckets)[TELEMETRY_HISTOGRAM_BUCKETS]) const {
+    for (int i = 0; i < TELEMETRY_HISTOGRAM_BUCKETS; i++) {
+        buckets[i] = block ? block->histogram[i].load(std::memory_order_relaxed) : 0;
+    }
+}
+
+bool TelemetryReader::isClosed() const {
+    return !block || block->closed.load(std::memory_order_acquire) != 0;
+}
+
+const char* getTelemetryCounterName(TelemetryCounter counter) {
+    static const char* names[TELEMETRY_COUNTER_COUNT] = {
+        "draw calls", "triangles", "chunks resident", "chunks drawn", "ticks", "collision checks", "allocations"
+    };
+    return counter >= 0 && counter < TELEMETRY_COUNTER_COUNT ? names[counter] : "unknown";
+}
@@ -1,37 +1,243 @@
 #include "Terrain.h"
-#include <glm/gtc/matrix_transform.hpp>
+#include "ChunkMesher.h"
+#include "StaticPerlinNoise.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TERRAIN_USE_SSE 1
+#endif
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
-Terrain::Terrain(int w, int h, float s) 
-    : width(w), height(h), scale(s), baseHeight(2.0f), heightMultiplier(8.0f),
-      octaves(4), persistence(0.5f), lacunarity(2.0f), noiseGenerator(42) {
-    heightMap.resize(height, std::vector<float>(width, 0.0f));
+namespace {
+    const unsigned int NOISE_SEED = 42;
+
+    // Heightfield noise with the octave count as a template argument, so the
+    // octave loop unrolls; same values as PerlinNoise::octaveNoise
+    template<int Octaves>
+    void sampleHeightNoise(unsigned int seed, int originX, int originZ, int width, int height, float scale,
+                           float persistence, float lacunarity, float* noiseValues) {
+        StaticPerlinNoise<Octaves, RuntimeSeed> noise(seed);
+        for (int z = 0; z < height; z++) {
+            for (int x = 0; x < width; x++) {
+                noiseValues[z * width + x] = noise.octaveNoise(static_cast<float>(originX + x) / scale,
+                                                              static_cast<float>(originZ + z) / scale, persistence,
+                                                              lacunarity);
+            }
+        }
+    }
+
+#ifdef TERRAIN_USE_SSE
+    // floor() of four floats. Lanes too large for an int (or NaN) come out
+    // near INT_MIN or INT_MAX, which every bounds check rejects.
+    inline __m128i floorToInt4(__m128 x) {
+        __m128i truncated = _mm_cvttps_epi32(x);
+        // Truncation rounds negative values up; the compare mask is -1 exactly there
+        __m128 roundedUp = _mm_cmpgt_ps(_mm_cvtepi32_ps(truncated), x);
+        return _mm_add_epi32(truncated, _mm_castps_si128(roundedUp));
+    }
+
+#ifndef __AVX2__
+    // 32-bit multiply of four lanes, which SSE2 lacks
+    inline __m128i multiplyLow(__m128i a, __m128i b) {
+        __m128i even = _mm_mul_epu32(a, b);
+        __m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                  _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+    }
+#endif
+
+    // Heights of four columns; lanes outside the world read outside
+    inline __m128 gatherColumns(const float* columns, int width, int depth, float outside, __m128i gx, __m128i gz) {
+        const __m128i minusOne = _mm_set1_epi32(-1);
+        __m128i inside = _mm_and_si128(
+            _mm_and_si128(_mm_cmpgt_epi32(gx, minusOne), _mm_cmplt_epi32(gx, _mm_set1_epi32(width))),
+            _mm_and_si128(_mm_cmpgt_epi32(gz, minusOne), _mm_cmplt_epi32(gz, _mm_set1_epi32(depth))));
+#ifdef __AVX2__
+        __m128i index = _mm_add_epi32(_mm_mullo_epi32(gz, _mm_set1_epi32(width)), gx);
+        return _mm_mask_i32gather_ps(_mm_set1_ps(outside), columns, index, _mm_castsi128_ps(inside), 4);
+#else
+        // No gather before AVX2: outside lanes load column 0 and are blended away, so nothing branches
+        __m128i index = _mm_and_si128(inside, _mm_add_epi32(multiplyLow(gz, _mm_set1_epi32(width)), gx));
+        alignas(16) int lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), index);
+        __m128 loaded = _mm_setr_ps(columns[lanes[0]], columns[lanes[1]], columns[lanes[2]], columns[lanes[3]]);
+        __m128 insideMask = _mm_castsi128_ps(inside);
+        return _mm_or_ps(_mm_and_ps(insideMask, loaded), _mm_andnot_ps(insideMask, _mm_set1_ps(outside)));
+#endif
+    }
+#endif
+}
+
+Terrain::Terrain(int w, int h, float s)
+    : width(w), height(h), worldHeight(32), scale(s), baseHeight(2.0f), heightMultiplier(8.0f),
+      octaves(4), persistence(0.5f), lacunarity(2.0f), generator(TERRAIN_HEIGHTMAP),
+      densitySampling(DENSITY_LATTICE), caveThreshold(0.06f), seed(NOISE_SEED), noiseOriginX(0), noiseOriginZ(0),
+      lighting(*this), chunksX(0), chunksY(0), chunksZ(0), meshRevision(0), noiseGenerator(NOISE_SEED), simplexNoise(NOISE_SEED) {
+    heightMap.assign(static_cast<size_t>(width) * height, 0.0f);
+    surfaceBlocks.assign(heightMap.size(), BLOCK_AIR);
+    for (NoiseBackend& backend : layerBackends) {
+        backend = NOISE_PERLIN;
+    }
 }
 
 Terrain::~Terrain() = default;
 
 void Terrain::generate() {
-    generateHeightMap();
-    generateCubes();
+    if (generator == TERRAIN_DENSITY) {
+        generateDensityBlocks();
+    } else {
+        generateHeightMap();
+        generateBlocks();
+    }
+    heightPyramid.build(heightMap.data(), width, height);
+
+    lighting.resize(width, worldHeight, height);
+    lighting.computeAll();
+    lighting.resetChanges();
+
+    createChunks();
+}
+
+float Terrain::getHeightAt(float x, float z) const {
+    // Convert world coordinates to terrain grid coordinates; floor so
+    // x = -0.5 lands in column -1 like the blocks do
+    int gridX = static_cast<int>(std::floor(x)) + getGridOffsetX();
+    int gridZ = static_cast<int>(std::floor(z)) + getGridOffsetZ();
+    return getColumnHeight(gridX, gridZ);
 }
 
-void Terrain::draw(Shader& shader) {
-    for (size_t i = 0; i < cubePositions.size(); i++) {
-        drawCubeWithFaceCulling(shader, cubePositions[i], cubeColors[i]);
+void Terrain::querySurface(const float* xs, const float* zs, int count, HeightSampling sampling, float* heights,
+                           glm::vec3* normals, uint8_t* surfaceBlockTypes) const {
+    int i = 0;
+#ifdef TERRAIN_USE_SSE
+    // Same arithmetic as querySurfaceScalar in the same order, so both give identical results
+    const float* columns = heightMap.data();
+    const __m128i offsetX = _mm_set1_epi32(getGridOffsetX());
+    const __m128i offsetZ = _mm_set1_epi32(getGridOffsetZ());
+    const __m128i oneInt = _mm_set1_epi32(1);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    auto gather = [&](__m128i gx, __m128i gz) {
+        return gatherColumns(columns, width, height, baseHeight, gx, gz);
+    };
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(xs + i);
+        __m128 z = _mm_loadu_ps(zs + i);
+        __m128i gx = _mm_add_epi32(floorToInt4(x), offsetX);
+        __m128i gz = _mm_add_epi32(floorToInt4(z), offsetZ);
+
+        __m128 h, slopeX, slopeZ;
+        if (sampling == HEIGHT_NEAREST) {
+            h = gather(gx, gz);
+            slopeX = _mm_mul_ps(_mm_sub_ps(gather(_mm_add_epi32(gx, oneInt), gz),
+                                           gather(_mm_sub_epi32(gx, oneInt), gz)), half);
+            slopeZ = _mm_mul_ps(_mm_sub_ps(gather(gx, _mm_add_epi32(gz, oneInt)),
+                                           gather(gx, _mm_sub_epi32(gz, oneInt))), half);
+        } else {
+            __m128 u = _mm_sub_ps(x, half);
+            __m128 v = _mm_sub_ps(z, half);
+            __m128i cellX = floorToInt4(u);
+            __m128i cellZ = floorToInt4(v);
+            __m128 tx = _mm_sub_ps(u, _mm_cvtepi32_ps(cellX));
+            __m128 tz = _mm_sub_ps(v, _mm_cvtepi32_ps(cellZ));
+            __m128i cx = _mm_add_epi32(cellX, offsetX);
+            __m128i cz = _mm_add_epi32(cellZ, offsetZ);
+            __m128 h00 = gather(cx, cz);
+            __m128 h10 = gather(_mm_add_epi32(cx, oneInt), cz);
+            __m128 h01 = gather(cx, _mm_add_epi32(cz, oneInt));
+            __m128 h11 = gather(_mm_add_epi32(cx, oneInt), _mm_add_epi32(cz, oneInt));
+            __m128 d0 = _mm_sub_ps(h10, h00);
+            __m128 d1 = _mm_sub_ps(h11, h01);
+            __m128 h0 = _mm_add_ps(h00, _mm_mul_ps(d0, tx));
+            __m128 h1 = _mm_add_ps(h01, _mm_mul_ps(d1, tx));
+            h = _mm_add_ps(h0, _mm_mul_ps(_mm_sub_ps(h1, h0), tz));
+            slopeX = _mm_add_ps(d0, _mm_mul_ps(_mm_sub_ps(d1, d0), tz));
+            slopeZ = _mm_sub_ps(h1, h0);
+        }
+
+        if (heights) {
+            _mm_storeu_ps(heights + i, h);
+        }
+        if (normals) {
+            __m128 lengthSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(slopeX, slopeX), one), _mm_mul_ps(slopeZ, slopeZ));
+            __m128 inverse = _mm_div_ps(one, _mm_sqrt_ps(lengthSq));
+            alignas(16) float nx[4], ny[4], nz[4];
+            _mm_store_ps(nx, _mm_mul_ps(slopeX, inverse));
+            _mm_store_ps(ny, inverse);
+            _mm_store_ps(nz, _mm_mul_ps(slopeZ, inverse));
+            for (int lane = 0; lane < 4; lane++) {
+                normals[i + lane] = glm::vec3(-nx[lane], ny[lane], -nz[lane]);
+            }
+        }
+        if (surfaceBlockTypes) {
+            alignas(16) int laneX[4], laneZ[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(laneX), gx);
+            _mm_store_si128(reinterpret_cast<__m128i*>(laneZ), gz);
+            for (int lane = 0; lane < 4; lane++) {
+                surfaceBlockTypes[i + lane] = isInBounds(laneX[lane], laneZ[lane])
+                    ? surfaceBlocks[static_cast<size_t>(laneZ[lane]) * width + laneX[lane]]
+                    : static_cast<uint8_t>(BLOCK_AIR);
+            }
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        querySurfaceScalar(xs[i], zs[i], sampling, heights ? heights + i : nullptr, normals ? normals + i : nullptr,
+                           surfaceBlockTypes ? surfaceBlockTypes + i : nullptr);
     }
 }
 
-float Terrain::getHeightAt(float x, float z) const {
-    // Convert world coordinates to terrain grid coordinates
-    // Terrain is centered at (0,0) and goes from -width/2 to width/2
-    int gridX = static_cast<int>(x + width / 2.0f);
-    int gridZ = static_cast<int>(z + height / 2.0f);
-    
-    if (!isInBounds(gridX, gridZ)) {
-        return baseHeight;
+void Terrain::querySurfaceScalar(float x, float z, HeightSampling sampling, float* outHeight, glm::vec3* outNormal,
+                                 uint8_t* outBlock) const {
+    int gx = static_cast<int>(std::floor(x)) + getGridOffsetX();
+    int gz = static_cast<int>(std::floor(z)) + getGridOffsetZ();
+
+    float h, slopeX, slopeZ;
+    if (sampling == HEIGHT_NEAREST) {
+        // Central differences over the neighboring columns
+        h = getColumnHeight(gx, gz);
+        slopeX = (getColumnHeight(gx + 1, gz) - getColumnHeight(gx - 1, gz)) * 0.5f;
+        slopeZ = (getColumnHeight(gx, gz + 1) - getColumnHeight(gx, gz - 1)) * 0.5f;
+    } else {
+        // Column centers sit half a block in from the column's corner
+        float u = x - 0.5f;
+        float v = z - 0.5f;
+        float cellX = std::floor(u);
+        float cellZ = std::floor(v);
+        float tx = u - cellX;
+        float tz = v - cellZ;
+        int cx = static_cast<int>(cellX) + getGridOffsetX();
+        int cz = static_cast<int>(cellZ) + getGridOffsetZ();
+        float h00 = getColumnHeight(cx, cz);
+        float h10 = getColumnHeight(cx + 1, cz);
+        float h01 = getColumnHeight(cx, cz + 1);
+        float h11 = getColumnHeight(cx + 1, cz + 1);
+        float d0 = h10 - h00;
+        float d1 = h11 - h01;
+        float h0 = h00 + d0 * tx;
+        float h1 = h01 + d1 * tx;
+        h = h0 + (h1 - h0) * tz;
+        // Gradient of the bilinear patch
+        slopeX = d0 + (d1 - d0) * tz;
+        slopeZ = h1 - h0;
+    }
+
+    if (outHeight) {
+        *outHeight = h;
+    }
+    if (outNormal) {
+        float inverse = 1.0f / std::sqrt(slopeX * slopeX + 1.0f + slopeZ * slopeZ);
+        *outNormal = glm::vec3(-(slopeX * inverse), inverse, -(slopeZ * inverse));
+    }
+    if (outBlock) {
+        *outBlock = isInBounds(gx, gz) ? surfaceBlocks[static_cast<size_t>(gz) * width + gx]
+                                       : static_cast<uint8_t>(BLOCK_AIR);
     }
-    
-    return heightMap[gridZ][gridX];
 }
 
 bool Terrain::isInBounds(int x, int z) const {
@@ -40,166 +246,517 @@ bool Terrain::isInBounds(int x, int z) const {
 
 bool Terrain::hasBlockAt(int x, int y, int z) const {
     // Convert world coordinates to terrain grid coordinates
-    int gridX = static_cast<int>(x + width / 2.0f);
-    int gridZ = static_cast<int>(z + height / 2.0f);
+    int gridX = x + getGridOffsetX();
+    int gridZ = z + getGridOffsetZ();
     int gridY = y;
-    
+
     // Track block checks
     static int debugCounter = 0;
     bool debugThisCheck = (debugCounter < 50);
-    
+
     if (debugThisCheck) {
         std::cout << "hasBlockAt: world(" << x << "," << y << "," << z << ") -> grid(" << gridX << "," << gridY << "," << gridZ << ")";
         debugCounter++;
     }
-    
+
     // Check if position is in bounds
-    if (!isInBounds(gridX, gridZ) || gridY < 0) {
+    if (!isGridInside(gridX, gridY, gridZ)) {
         if (debugThisCheck) {
             std::cout << " -> OUT OF BOUNDS" << std::endl;
         }
         return false;
     }
-    
+
     // Check if there's a block at this position
-    bool hasBlock = (gridY < heightMap[gridZ][gridX]);
-    
+    bool hasBlock = isBlockOpaque(blocks[gridIndex(gridX, gridY, gridZ)]);
+
     if (debugThisCheck) {
-        std::cout << " -> height=" << heightMap[gridZ][gridX] << " -> " << (hasBlock ? "BLOCK" : "EMPTY") << std::endl;
+        std::cout << " -> height=" << getColumnHeight(gridX, gridZ) << " -> " << (hasBlock ? "BLOCK" : "EMPTY") << std::endl;
     }
-    
+
     return hasBlock;
 }
 
+uint8_t Terrain::getBlock(int x, int y, int z) const {
+    return getGridBlock(x + getGridOffsetX(), y, z + getGridOffsetZ());
+}
+
+bool Terrain::setBlock(int x, int y, int z, uint8_t type) {
+    int gx = x + getGridOffsetX();
+    int gz = z + getGridOffsetZ();
+    if (!isGridInside(gx, y, gz)) {
+        return false;
+    }
+
+    uint8_t& block = blocks[gridIndex(gx, y, gz)];
+    uint8_t oldType = block;
+    if (oldType == type) {
+        return false;
+    }
+    block = type;
+    updateColumnHeight(gx, gz);
+
+    // Relight incrementally; only the cells the BFS touched are reported back
+    lighting.resetChanges();
+    lighting.onBlockChanged(gx, y, gz, oldType, type);
+
+    // Neighbors sample this block for face culling and ambient occlusion
+    glm::ivec3 dirtyMin(gx - 1, y - 1, gz - 1);
+    glm::ivec3 dirtyMax(gx + 1, y + 1, gz + 1);
+    if (lighting.hasChanges()) {
+        dirtyMin = glm::min(dirtyMin, lighting.getChangedMin() - glm::ivec3(1));
+        dirtyMax = glm::max(dirtyMax, lighting.getChangedMax() + glm::ivec3(1));
+    }
+    lighting.resetChanges();
+    markChunksDirty(dirtyMin, dirtyMax);
+
+    return true;
+}
+
+int Terrain::getSunLight(int x, int y, int z) const {
+    return lighting.getSunLight(x + getGridOffsetX(), y, z + getGridOffsetZ());
+}
+
+int Terrain::getBlockLight(int x, int y, int z) const {
+    return lighting.getBlockLight(x + getGridOffsetX(), y, z + getGridOffsetZ());
+}
+
+bool Terrain::raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+                      glm::ivec3& hitBlock, glm::ivec3& previousBlock, RaycastMethod method) const {
+    if (glm::length(direction) < 0.0001f) {
+        return false;
+    }
+    glm::vec3 dir = glm::normalize(direction);
+    if (method == RAYCAST_PYRAMID) {
+        return raycastPyramid(origin, dir, maxDistance, hitBlock, previousBlock);
+    }
+    return raycastDda(origin, dir, maxDistance, hitBlock, previousBlock);
+}
+
+bool Terrain::hasLineOfSight(const glm::vec3& from, const glm::vec3& to, RaycastMethod method) const {
+    glm::ivec3 hitBlock, previousBlock;
+    return !raycast(from, to - from, glm::length(to - from), hitBlock, previousBlock, method);
+}
+
+bool Terrain::raycastDda(const glm::vec3& origin, const glm::vec3& dir, float maxDistance,
+                         glm::ivec3& hitBlock, glm::ivec3& previousBlock) const {
+    // Amanatides & Woo voxel traversal, blocks occupy [x, x + 1)
+    glm::ivec3 cell(static_cast<int>(std::floor(origin.x)),
+                    static_cast<int>(std::floor(origin.y)),
+                    static_cast<int>(std::floor(origin.z)));
+    // Each crossing is computed from its boundary rather than by adding up
+    // steps, so it rounds exactly as in raycastPyramid
+    glm::ivec3 step;
+    glm::vec3 tMax;
+    glm::vec3 inverse;
+    auto crossing = [&](int axis) {
+        return (static_cast<float>(cell[axis] + (step[axis] > 0 ? 1 : 0)) - origin[axis]) * inverse[axis];
+    };
+    for (int axis = 0; axis < 3; axis++) {
+        if (dir[axis] == 0.0f) {
+            step[axis] = 0;
+            inverse[axis] = INFINITY;
+            tMax[axis] = INFINITY;
+            continue;
+        }
+        step[axis] = dir[axis] > 0.0f ? 1 : -1;
+        inverse[axis] = 1.0f / dir[axis];
+        tMax[axis] = crossing(axis);
+    }
+
+    // Blocks count if the ray enters them before maxDistance; one it only
+    // touches at the end point doesn't, the same rule as raycastPyramid
+    previousBlock = cell;
+    float t = 0.0f;
+    while (t < maxDistance) {
+        if (isBlockOpaque(getBlock(cell.x, cell.y, cell.z))) {
+            hitBlock = cell;
+            return true;
+        }
+
+        previousBlock = cell;
+        int axis = (tMax.x < tMax.y) ? (tMax.x < tMax.z ? 0 : 2) : (tMax.y < tMax.z ? 1 : 2);
+        t = tMax[axis];
+        cell[axis] += step[axis];
+        tMax[axis] = crossing(axis);
+    }
+    return false;
+}
+
+bool Terrain::raycastPyramid(const glm::vec3& origin, const glm::vec3& dir, float maxDistance,
+                             glm::ivec3& hitBlock, glm::ivec3& previousBlock) const {
+    int topLevel = heightPyramid.getLevelCount() - 1;
+    if (topLevel < 0 || blocks.empty()) {
+        return false;
+    }
+    const int offsetX = getGridOffsetX();
+    const int offsetZ = getGridOffsetZ();
+    const glm::vec3 boxMin(static_cast<float>(-offsetX), 0.0f, static_cast<float>(-offsetZ));
+    const glm::vec3 boxMax(static_cast<float>(width - offsetX), static_cast<float>(worldHeight),
+                           static_cast<float>(height - offsetZ));
+    glm::ivec3 step(dir.x > 0.0f ? 1 : -1, dir.y > 0.0f ? 1 : -1, dir.z > 0.0f ? 1 : -1);
+    glm::vec3 inverse;
+
+    // Clip the ray to the grid, outside of which there is only air; remember
+    // which side it came in through, for the block before a hit
+    float tStart = 0.0f;
+    float tEnd = maxDistance;
+    int entryAxis = -1;
+    for (int axis = 0; axis < 3; axis++) {
+        if (dir[axis] == 0.0f) {
+            inverse[axis] = INFINITY;
+            if (origin[axis] < boxMin[axis] || origin[axis] >= boxMax[axis]) {
+                return false;
+            }
+            continue;
+        }
+        inverse[axis] = 1.0f / dir[axis];
+        float t0 = (boxMin[axis] - origin[axis]) * inverse[axis];
+        float t1 = (boxMax[axis] - origin[axis]) * inverse[axis];
+        if (t0 > t1) {
+            std::swap(t0, t1);
+        }
+        if (t0 > tStart) {
+            tStart = t0;
+            entryAxis = axis;
+        }
+        tEnd = std::min(tEnd, t1);
+    }
+    if (tStart > tEnd) {
+        return false;
+    }
+
+    // Column the ray starts in, in grid coordinates
+    auto columnAt = [&](int axis, float t, int low, int high) {
+        int cell = static_cast<int>(std::floor(origin[axis] + dir[axis] * t)) + (axis == 0 ? offsetX : offsetZ);
+        return std::min(std::max(cell, low), high);
+    };
+    int gx = entryAxis == 0 ? (step.x > 0 ? 0 : width - 1) : columnAt(0, tStart, 0, width - 1);
+    int gz = entryAxis == 2 ? (step.z > 0 ? 0 : height - 1) : columnAt(2, tStart, 0, height - 1);
+
+    // Descend into cells the ray dips below, skip the rest, and climb a level after each skip
+    int level = topLevel;
+    float t = tStart;
+    while (true) {
+        int size = 1 << level;
+        int nodeX = gx >> level;
+        int nodeZ = gz >> level;
+        float tx = INFINITY;
+        float tz = INFINITY;
+        if (dir.x != 0.0f) {
+            tx = (static_cast<float>((nodeX << level) + (step.x > 0 ? size : 0) - offsetX) - origin.x) * inverse.x;
+        }
+        if (dir.z != 0.0f) {
+            tz = (static_cast<float>((nodeZ << level) + (step.z > 0 ? size : 0) - offsetZ) - origin.z) * inverse.z;
+        }
+        float tNode = std::min(std::min(tx, tz), tEnd);
+        float lowest = std::min(origin.y + dir.y * t, origin.y + dir.y * tNode);
+        int maxHeight = heightPyramid.getMaxHeight(level, nodeX, nodeZ);
+
+        if (lowest < maxHeight) {
+            if (level > 0) {
+                level--;
+                continue;
+            }
+
+            // One column: walk its blocks from where the ray enters to where it leaves
+            int first = entryAxis == 1 ? (step.y > 0 ? 0 : worldHeight - 1)
+                                       : static_cast<int>(std::floor(origin.y + dir.y * t));
+            // A ray ending exactly on a block's bottom face doesn't enter it, as in the DDA
+            float endY = origin.y + dir.y * tNode;
+            int last = static_cast<int>(std::floor(endY));
+            if (tNode >= maxDistance && step.y > 0 && static_cast<float>(last) == endY) {
+                last--;
+            }
+            if ((last - first) * step.y < 0) {
+                last = first;
+            }
+            int top = std::min(maxHeight, worldHeight) - 1;
+            for (int y = first;; y += step.y) {
+                if (y > top) {
+                    if (step.y > 0 || last > top) {
+                        break;
+                    }
+                    y = top;
+                }
+                if (y >= 0 && isBlockOpaque(blocks[gridIndex(gx, y, gz)])) {
+                    hitBlock = glm::ivec3(gx - offsetX, y, gz - offsetZ);
+                    previousBlock = hitBlock;
+                    if (y != first) {
+                        previousBlock.y -= step.y;
+                    } else if (entryAxis >= 0) {
+                        previousBlock[entryAxis] -= step[entryAxis];
+                    }
+                    return true;
+                }
+                if (y == last || (step.y < 0 && y < 0)) {
+                    break;
+                }
+            }
+        }
+
+        // Leave the cell through whichever side comes first; z first on a tie, like the DDA
+        float tNext = std::min(tx, tz);
+        if (tNext >= tEnd) {
+            return false;
+        }
+        if (tz <= tx) {
+            gz = step.z > 0 ? (nodeZ << level) + size : (nodeZ << level) - 1;
+            gx = columnAt(0, tNext, nodeX << level, std::min((nodeX << level) + size, width) - 1);
+            entryAxis = 2;
+        } else {
+            gx = step.x > 0 ? (nodeX << level) + size : (nodeX << level) - 1;
+            gz = columnAt(2, tNext, nodeZ << level, std::min((nodeZ << level) + size, height) - 1);
+            entryAxis = 0;
+        }
+        if (gx < 0 || gx >= width || gz < 0 || gz >= height) {
+            return false;
+        }
+        t = tNext;
+        level = std::min(level + 1, topLevel);
+    }
+}
+
+bool Terrain::isGridInside(int gx, int gy, int gz) const {
+    return gx >= 0 && gx < width && gy >= 0 && gy < worldHeight && gz >= 0 && gz < height;
+}
+
+uint8_t Terrain::getGridBlock(int gx, int gy, int gz) const {
+    if (!isGridInside(gx, gy, gz) || blocks.empty()) {
+        return BLOCK_AIR;
+    }
+    return blocks[gridIndex(gx, gy, gz)];
+}
+
+int Terrain::updateDirtyChunks(int maxChunks) {
+    int rebuilt = 0;
+    for (Chunk& chunk : chunks) {
+        if (maxChunks >= 0 && rebuilt >= maxChunks) {
+            break;
+        }
+        if (!chunk.dirty) {
+            continue;
+        }
+        ChunkMesher::buildMesh(*this, chunk, chunk.mesh);
+        chunk.connectivity = ChunkMesher::computeConnectivity(*this, chunk);
+        chunk.dirty = false;
+        chunk.revision++;
+        meshRevision++;
+        rebuilt++;
+    }
+    return rebuilt;
+}
+
+glm::vec3 Terrain::getChunkOrigin(const Chunk& chunk) const {
+    return glm::vec3(chunk.x * CHUNK_SIZE - getGridOffsetX(),
+                     chunk.y * CHUNK_SIZE,
+                     chunk.z * CHUNK_SIZE - getGridOffsetZ());
+}
+
+glm::vec3 Terrain::getBlockColor(uint8_t type) {
+    switch (type) {
+        case BLOCK_SAND:       return glm::vec3(0.6f, 0.4f, 0.2f);
+        case BLOCK_GRASS:      return glm::vec3(0.2f, 0.8f, 0.2f);
+        case BLOCK_DARK_GRASS: return glm::vec3(0.4f, 0.6f, 0.2f);
+        case BLOCK_STONE:      return glm::vec3(0.5f, 0.5f, 0.5f);
+        case BLOCK_SNOW:       return glm::vec3(1.0f, 1.0f, 1.0f);
+        case BLOCK_LAMP:       return glm::vec3(1.0f, 0.9f, 0.6f);
+        default:               return glm::vec3(0.0f);
+    }
+}
+
 void Terrain::setScale(float s) { scale = s; }
 void Terrain::setOctaves(int o) { octaves = o; }
 void Terrain::setPersistence(float p) { persistence = p; }
 void Terrain::setLacunarity(float l) { lacunarity = l; }
 void Terrain::setBaseHeight(float h) { baseHeight = h; }
 void Terrain::setHeightMultiplier(float m) { heightMultiplier = m; }
+void Terrain::setWorldHeight(int h) { worldHeight = std::max(1, h); }
+void Terrain::setGenerator(TerrainGenerator g) { generator = g; }
+void Terrain::setDensitySampling(DensitySampling d) { densitySampling = d; }
+void Terrain::setCaveThreshold(float t) { caveThreshold = t; }
+void Terrain::setNoiseBackend(TerrainLayer layer, NoiseBackend backend) { layerBackends[layer] = backend; }
+
+void Terrain::setSeed(unsigned int s) {
+    seed = s;
+    noiseGenerator.setSeed(s);
+    simplexNoise.setSeed(s);
+}
+
+void Terrain::setNoiseOrigin(int x, int z) {
+    noiseOriginX = x;
+    noiseOriginZ = z;
+}
+
+const NoiseGenerator& Terrain::getLayerNoise(TerrainLayer layer) const {
+    if (layerBackends[layer] == NOISE_SIMPLEX) {
+        return simplexNoise;
+    }
+    return noiseGenerator;
+}
+
+DensitySettings Terrain::getDensitySettings() const {
+    // The heightfield parameters carry over: relief of heightMultiplier around the middle of its range
+    DensitySettings settings;
+    settings.scale = scale;
+    settings.octaves = octaves;
+    settings.persistence = persistence;
+    settings.lacunarity = lacunarity;
+    settings.surfaceLevel = baseHeight + heightMultiplier * 0.5f;
+    settings.surfaceRange = heightMultiplier;
+    settings.caveThreshold = caveThreshold;
+    settings.originX = noiseOriginX;
+    settings.originZ = noiseOriginZ;
+    return settings;
+}
 
 void Terrain::generateHeightMap() {
+    // Perlin noise for the common octave counts comes from the unrolled variant
+    bool perlin = layerBackends[LAYER_HEIGHT] == NOISE_PERLIN;
+    if (perlin && octaves == 4) {
+        sampleHeightNoise<4>(seed, noiseOriginX, noiseOriginZ, width, height, scale, persistence, lacunarity,
+                                 heightMap.data());
+    } else if (perlin && octaves == 6) {
+        sampleHeightNoise<6>(seed, noiseOriginX, noiseOriginZ, width, height, scale, persistence, lacunarity,
+                                 heightMap.data());
+    } else if (perlin && octaves == 8) {
+        sampleHeightNoise<8>(seed, noiseOriginX, noiseOriginZ, width, height, scale, persistence, lacunarity,
+                                 heightMap.data());
+    } else {
+        // Everything else goes through the backend's batch path, a row at a time
+        const NoiseGenerator& noise = getLayerNoise(LAYER_HEIGHT);
+        std::vector<float> xs(width), zs(width);
+        for (int x = 0; x < width; x++) {
+            xs[x] = static_cast<float>(noiseOriginX + x) / scale;
+        }
+        for (int z = 0; z < height; z++) {
+            std::fill(zs.begin(), zs.end(), static_cast<float>(noiseOriginZ + z) / scale);
+            noise.octaveNoise(xs.data(), zs.data(), &heightMap[static_cast<size_t>(z) * width], width, octaves, persistence, lacunarity);
+        }
+    }
+
+    for (float& columnHeight : heightMap) {
+        // Convert to positive height range and round to integer
+        float roundedHeight = std::round(baseHeight + columnHeight * heightMultiplier);
+        columnHeight = std::min(std::max(roundedHeight, 0.0f), static_cast<float>(worldHeight));
+    }
+}
+
+void Terrain::generateBlocks() {
+    blocks.assign(static_cast<size_t>(width) * worldHeight * height, BLOCK_AIR);
+
     for (int z = 0; z < height; z++) {
         for (int x = 0; x < width; x++) {
-            float sampleX = x / scale;
-            float sampleZ = z / scale;
-            
-            // Generate noise value using Perlin noise
-            float noiseHeight = noiseGenerator.octaveNoise(sampleX, sampleZ, octaves, persistence, lacunarity);
-            
-            // Convert to positive height range and round to integer
-            heightMap[z][x] = std::round(baseHeight + noiseHeight * heightMultiplier);
+            // Fill from ground up to the terrain height
+            size_t column = static_cast<size_t>(z) * width + x;
+            int columnHeight = static_cast<int>(heightMap[column]);
+            for (int y = 0; y < columnHeight; y++) {
+                blocks[gridIndex(x, y, z)] = getBlockTypeForHeight(y);
+            }
+            surfaceBlocks[column] = columnHeight > 0 ? getBlockTypeForHeight(columnHeight - 1)
+                                                     : static_cast<uint8_t>(BLOCK_AIR);
         }
     }
 }
 
-void Terrain::generateCubes() {
-    cubePositions.clear();
-    cubeColors.clear();
-    
+void Terrain::generateDensityBlocks() {
+    DensityField field(getLayerNoise(LAYER_DENSITY), getLayerNoise(LAYER_CAVES), getDensitySettings());
+    std::vector<uint8_t> solid;
+    if (densitySampling == DENSITY_PER_VOXEL) {
+        field.fillPerVoxel(width, worldHeight, height, solid);
+    } else {
+        field.fillLattice(width, worldHeight, height, solid);
+    }
+
+    // Surface materials follow the heightfield bands; anything buried deeper is stone
+    const int surfaceDepth = 3;
+    blocks.assign(solid.size(), BLOCK_AIR);
     for (int z = 0; z < height; z++) {
         for (int x = 0; x < width; x++) {
-            float terrainHeight = heightMap[z][x];
-            
-            // Only place cubes above ground level
-            if (terrainHeight > 0.0f) {
-                // Calculate world position
-                float worldX = x - width / 2.0f;
-                float worldZ = z - height / 2.0f;
-                
-                // Place cubes from ground up to the terrain height
-                for (int y = 0; y < static_cast<int>(terrainHeight); y++) {
-                    cubePositions.push_back(glm::vec3(worldX, y, worldZ));
-                    cubeColors.push_back(getTerrainColor(y));
+            int depth = 0;
+            for (int y = worldHeight - 1; y >= 0; y--) {
+                size_t index = gridIndex(x, y, z);
+                if (!solid[index]) {
+                    depth = 0;
+                    continue;
                 }
+                blocks[index] = depth < surfaceDepth ? getBlockTypeForHeight(y) : static_cast<uint8_t>(BLOCK_STONE);
+                depth++;
             }
+            updateColumnHeight(x, z);
         }
     }
 }
 
-glm::vec3 Terrain::getTerrainColor(float height) const {
-    if (height < 1.0f) {
-        return glm::vec3(0.6f, 0.4f, 0.2f); // Sand
-    } else if (height < 2.0f) {
-        return glm::vec3(0.2f, 0.8f, 0.2f); // Grass
-    } else if (height < 4.0f) {
-        return glm::vec3(0.4f, 0.6f, 0.2f); // Darker grass
-    } else if (height < 6.0f) {
-        return glm::vec3(0.5f, 0.5f, 0.5f); // Stone
+void Terrain::createChunks() {
+    chunksX = (width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    chunksY = (worldHeight + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    chunksZ = (height + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+    chunks.clear();
+    meshRevision++;
+    chunks.reserve(static_cast<size_t>(chunksX) * chunksY * chunksZ);
+    for (int cy = 0; cy < chunksY; cy++) {
+        for (int cz = 0; cz < chunksZ; cz++) {
+            for (int cx = 0; cx < chunksX; cx++) {
+                Chunk chunk;
+                chunk.x = cx;
+                chunk.y = cy;
+                chunk.z = cz;
+                chunk.dirty = true;
+                chunk.revision = 0;
+                chunk.connectivity = CHUNK_ALL_FACES_CONNECTED;
+                chunks.push_back(std::move(chunk));
+            }
+        }
+    }
+}
+
+uint8_t Terrain::getBlockTypeForHeight(int y) const {
+    if (y < 1) {
+        return BLOCK_SAND;
+    } else if (y < 2) {
+        return BLOCK_GRASS;
+    } else if (y < 4) {
+        return BLOCK_DARK_GRASS;
+    } else if (y < 6) {
+        return BLOCK_STONE;
     } else {
-        return glm::vec3(1.0f, 1.0f, 1.0f); // Snow
+        return BLOCK_SNOW;
     }
-} 
+}
 
-bool Terrain::isFaceVisible(int x, int y, int z, int face) const {
-    // Convert world coordinates to terrain grid coordinates
-    int gridX = static_cast<int>(x + width / 2.0f);
-    int gridZ = static_cast<int>(z + height / 2.0f);
-    
-    // Check if the position is in bounds
-    if (!isInBounds(gridX, gridZ)) {
-        return true; // Render faces at boundaries
-    }
-    
-    // Check if there's a cube at the current position
-    if (y >= heightMap[gridZ][gridX]) {
-        return false; // No cube here, don't render
-    }
-    
-    // Check adjacent positions based on face direction
-    // Face indices: 0=Front, 1=Back, 2=Left, 3=Right, 4=Top, 5=Bottom
-    int adjX = gridX, adjY = y, adjZ = gridZ;
-    
-    switch (face) {
-        case 0: adjZ++; break; // Front face (positive Z)
-        case 1: adjZ--; break; // Back face (negative Z)
-        case 2: adjX--; break; // Left face (negative X)
-        case 3: adjX++; break; // Right face (positive X)
-        case 4: adjY++; break; // Top face (positive Y)
-        case 5: adjY--; break; // Bottom face (negative Y)
-    }
-    
-    // If adjacent position is out of bounds, render the face
-    if (!isInBounds(adjX, adjZ)) {
-        return true;
-    }
-    
-    // For bottom face, always render if we're at ground level
-    if (face == 5 && y == 0) {
-        return true;
-    }
-    
-    // For top face, always render if we're at the top of the terrain
-    if (face == 4 && y == static_cast<int>(heightMap[gridZ][gridX]) - 1) {
-        return true;
-    }
-    
-    // If adjacent position has no cube (y >= height), render the face
-    if (adjY >= heightMap[adjZ][adjX]) {
-        return true;
-    }
-    
-    // Face is hidden by adjacent cube
-    return false;
+void Terrain::updateColumnHeight(int gx, int gz) {
+    // Height of a column is one above its topmost solid block
+    int top = 0;
+    uint8_t surface = BLOCK_AIR;
+    for (int y = worldHeight - 1; y >= 0; y--) {
+        uint8_t block = blocks[gridIndex(gx, y, gz)];
+        if (isBlockOpaque(block)) {
+            top = y + 1;
+            surface = block;
+            break;
+        }
+    }
+    size_t column = static_cast<size_t>(gz) * width + gx;
+    heightMap[column] = static_cast<float>(top);
+    surfaceBlocks[column] = surface;
+    heightPyramid.setHeight(gx, gz, top);
 }
 
-void Terrain::drawCubeWithFaceCulling(Shader& shader, const glm::vec3& position, const glm::vec3& color) {
-    int x = static_cast<int>(position.x);
-    int y = static_cast<int>(position.y);
-    int z = static_cast<int>(position.z);
-    
-    // Create model matrix for this cube
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, position);
-    
-    // Set shader uniforms
-    shader.setMat4("model", model);
-    shader.setVec3("objectColor", color);
-    
-    // Draw only visible faces
-    for (int face = 0; face < 6; face++) {
-        if (isFaceVisible(x, y, z, face)) {
-            cube.drawFace(face);
+void Terrain::markChunksDirty(const glm::ivec3& gridMin, const glm::ivec3& gridMax) {
+    int minCX = std::max(0, gridMin.x / CHUNK_SIZE);
+    int minCY = std::max(0, gridMin.y / CHUNK_SIZE);
+    int minCZ = std::max(0, gridMin.z / CHUNK_SIZE);
+    int maxCX = std::min(chunksX - 1, std::max(0, gridMax.x) / CHUNK_SIZE);
+    int maxCY = std::min(chunksY - 1, std::max(0, gridMax.y) / CHUNK_SIZE);
+    int maxCZ = std::min(chunksZ - 1, std::max(0, gridMax.z) / CHUNK_SIZE);
+
+    for (int cy = minCY; cy <= maxCY; cy++) {
+        for (int cz = minCZ; cz <= maxCZ; cz++) {
+            for (int cx = minCX; cx <= maxCX; cx++) {
+                chunks[(static_cast<size_t>(cy) * chunksZ + cz) * chunksX + cx].dirty = true;
+            }
         }
     }
 }
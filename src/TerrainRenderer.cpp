@@ -0,0 +1,90 @@
+#include "TerrainRenderer.h"
+#include "BlockMaterials.h"
+
+TerrainRenderer::TerrainRenderer(Terrain& terrain) : terrain(terrain), drawCalls(0), trianglesDrawn(0), residentChunks(0),
+                                                     materialTexture(0) {
+    createMaterialTexture();
+}
+
+TerrainRenderer::~TerrainRenderer() {
+    glDeleteTextures(1, &materialTexture);
+}
+
+void TerrainRenderer::createMaterialTexture() {
+    std::vector<uint8_t> pixels = generateMaterialPixels();
+
+    glGenTextures(1, &materialTexture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, materialTexture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, MATERIAL_TEXTURE_SIZE, MATERIAL_TEXTURE_SIZE, MATERIAL_LAYER_COUNT,
+                 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+
+    // Crisp texels up close, mipmaps instead of shimmering in the distance
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+int TerrainRenderer::update(int maxChunkUpdates) {
+    terrain.updateDirtyChunks(maxChunkUpdates);
+
+    const std::vector<Chunk>& chunks = terrain.getChunks();
+    int uploaded = 0;
+    if (meshes.size() != chunks.size()) {
+        meshes.clear();
+        meshes.resize(chunks.size());
+        uploadedRevisions.assign(chunks.size(), 0);
+    }
+
+    for (size_t i = 0; i < chunks.size(); i++) {
+        if (chunks[i].revision == uploadedRevisions[i]) {
+            continue;
+        }
+        if (!meshes[i]) {
+            meshes[i] = std::make_unique<ChunkMesh>();
+        }
+        meshes[i]->upload(chunks[i].mesh);
+        uploadedRevisions[i] = chunks[i].revision;
+        uploaded++;
+    }
+    return uploaded;
+}
+
+void TerrainRenderer::draw(Shader& shader, const ChunkVisibility* visibility) {
+    // One texture bind for all chunks: each vertex carries its material layer
+    glActiveTexture(GL_TEXTURE0 + MATERIAL_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, materialTexture);
+    glActiveTexture(GL_TEXTURE0);
+    shader.setInt("blockTextures", MATERIAL_TEXTURE_UNIT);
+
+    drawCalls = 0;
+    trianglesDrawn = 0;
+    residentChunks = 0;
+    for (const std::unique_ptr<ChunkMesh>& mesh : meshes) {
+        if (mesh && mesh->getIndexCount() > 0) {
+            residentChunks++;
+        }
+    }
+
+    const std::vector<Chunk>& chunks = terrain.getChunks();
+    auto drawChunk = [&](size_t i) {
+        if (i >= meshes.size() || !meshes[i] || meshes[i]->getIndexCount() == 0) {
+            return;
+        }
+        shader.setVec3("chunkOrigin", terrain.getChunkOrigin(chunks[i]));
+        meshes[i]->draw();
+        drawCalls++;
+        trianglesDrawn += static_cast<int>(meshes[i]->getIndexCount() / 3);
+    };
+    if (visibility) {
+        for (int i : visibility->getVisibleChunks()) {
+            drawChunk(static_cast<size_t>(i));
+        }
+    } else {
+        for (size_t i = 0; i < meshes.size(); i++) {
+            drawChunk(i);
+        }
+    }
+}
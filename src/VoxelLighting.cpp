@@ -0,0 +1,219 @@
+#include "VoxelLighting.h"
+#include "Terrain.h"
+#include <algorithm>
+
+namespace {
+    // Neighbor offsets; index 5 is straight down, where sunlight does not attenuate
+    const int neighborOffsets[6][3] = {
+        { 1, 0, 0}, {-1, 0, 0},
+        { 0, 0, 1}, { 0, 0,-1},
+        { 0, 1, 0}, { 0,-1, 0}
+    };
+    const int DOWN = 5;
+}
+
+VoxelLighting::VoxelLighting(const Terrain& terrain)
+    : terrain(terrain), sizeX(0), sizeY(0), sizeZ(0), changed(false),
+      changedMin(0), changedMax(0) {}
+
+void VoxelLighting::resize(int x, int y, int z) {
+    sizeX = x;
+    sizeY = y;
+    sizeZ = z;
+    light.assign(static_cast<size_t>(sizeX) * sizeY * sizeZ, 0);
+}
+
+bool VoxelLighting::isInside(int x, int y, int z) const {
+    return x >= 0 && x < sizeX && y >= 0 && y < sizeY && z >= 0 && z < sizeZ;
+}
+
+int VoxelLighting::getLevel(Channel channel, int x, int y, int z) const {
+    uint8_t value = light[index(x, y, z)];
+    return channel == SUN ? (value >> 4) : (value & 15);
+}
+
+void VoxelLighting::setLevel(Channel channel, int x, int y, int z, int level) {
+    uint8_t& value = light[index(x, y, z)];
+    if (channel == SUN) {
+        value = static_cast<uint8_t>((value & 0x0F) | (level << 4));
+    } else {
+        value = static_cast<uint8_t>((value & 0xF0) | level);
+    }
+
+    // Track the touched region so only the affected chunks get remeshed
+    glm::ivec3 cell(x, y, z);
+    if (!changed) {
+        changedMin = cell;
+        changedMax = cell;
+        changed = true;
+    } else {
+        changedMin = glm::min(changedMin, cell);
+        changedMax = glm::max(changedMax, cell);
+    }
+}
+
+int VoxelLighting::getSunLight(int x, int y, int z) const {
+    if (!isInside(x, y, z)) {
+        // Everything outside the grid is open sky
+        return MAX_LIGHT_LEVEL;
+    }
+    return getLevel(SUN, x, y, z);
+}
+
+int VoxelLighting::getBlockLight(int x, int y, int z) const {
+    if (!isInside(x, y, z)) {
+        return 0;
+    }
+    return getLevel(BLOCK, x, y, z);
+}
+
+void VoxelLighting::resetChanges() {
+    changed = false;
+}
+
+void VoxelLighting::computeAll() {
+    std::fill(light.begin(), light.end(), 0);
+    addQueue.clear();
+
+    // Sunlight falls straight down each column until it hits an opaque block
+    for (int z = 0; z < sizeZ; z++) {
+        for (int x = 0; x < sizeX; x++) {
+            for (int y = sizeY - 1; y >= 0; y--) {
+                if (isBlockOpaque(terrain.getGridBlock(x, y, z))) {
+                    break;
+                }
+                setLevel(SUN, x, y, z, MAX_LIGHT_LEVEL);
+                addQueue.push_back({x, y, z, MAX_LIGHT_LEVEL});
+            }
+        }
+    }
+    propagate(SUN);
+
+    // Block light starts at every emitter
+    for (int y = 0; y < sizeY; y++) {
+        for (int z = 0; z < sizeZ; z++) {
+            for (int x = 0; x < sizeX; x++) {
+                int emission = getBlockEmission(terrain.getGridBlock(x, y, z));
+                if (emission > 0) {
+                    setLevel(BLOCK, x, y, z, emission);
+                    addQueue.push_back({x, y, z, emission});
+                }
+            }
+        }
+    }
+    propagate(BLOCK);
+}
+
+void VoxelLighting::onBlockChanged(int x, int y, int z, uint8_t oldBlock, uint8_t newBlock) {
+    if (!isInside(x, y, z)) {
+        return;
+    }
+
+    bool wasOpaque = isBlockOpaque(oldBlock);
+    bool nowOpaque = isBlockOpaque(newBlock);
+    int oldEmission = getBlockEmission(oldBlock);
+    int newEmission = getBlockEmission(newBlock);
+
+    for (Channel channel : {SUN, BLOCK}) {
+        bool removeLight = (nowOpaque && !wasOpaque) || (channel == BLOCK && oldEmission > 0);
+        if (removeLight) {
+            // Unlight everything that depended on this cell, then refill from the
+            // surviving sources found at the edge of the removed region
+            int level = getLevel(channel, x, y, z);
+            if (level > 0) {
+                setLevel(channel, x, y, z, 0);
+                removeQueue.push_back({x, y, z, level});
+                propagateRemoval(channel);
+            }
+        }
+
+        if (!nowOpaque && wasOpaque) {
+            // The opened cell is lit by its neighbors
+            if (channel == SUN && y == sizeY - 1) {
+                setLevel(SUN, x, y, z, MAX_LIGHT_LEVEL);
+                addQueue.push_back({x, y, z, MAX_LIGHT_LEVEL});
+            }
+            for (const auto& offset : neighborOffsets) {
+                int nx = x + offset[0], ny = y + offset[1], nz = z + offset[2];
+                if (isInside(nx, ny, nz)) {
+                    int level = getLevel(channel, nx, ny, nz);
+                    if (level > 0) {
+                        addQueue.push_back({nx, ny, nz, level});
+                    }
+                }
+            }
+        }
+
+        if (channel == BLOCK && newEmission > getLevel(BLOCK, x, y, z)) {
+            setLevel(BLOCK, x, y, z, newEmission);
+            addQueue.push_back({x, y, z, newEmission});
+        }
+
+        propagate(channel);
+    }
+}
+
+void VoxelLighting::propagate(Channel channel) {
+    for (size_t head = 0; head < addQueue.size(); head++) {
+        LightNode node = addQueue[head];
+        // The cell may have been relit brighter after it was queued
+        int level = getLevel(channel, node.x, node.y, node.z);
+        if (level <= 1) {
+            continue;
+        }
+
+        for (int dir = 0; dir < 6; dir++) {
+            int nx = node.x + neighborOffsets[dir][0];
+            int ny = node.y + neighborOffsets[dir][1];
+            int nz = node.z + neighborOffsets[dir][2];
+            if (!isInside(nx, ny, nz) || isBlockOpaque(terrain.getGridBlock(nx, ny, nz))) {
+                continue;
+            }
+
+            int nextLevel = (channel == SUN && dir == DOWN && level == MAX_LIGHT_LEVEL)
+                ? MAX_LIGHT_LEVEL : level - 1;
+            if (getLevel(channel, nx, ny, nz) < nextLevel) {
+                setLevel(channel, nx, ny, nz, nextLevel);
+                addQueue.push_back({nx, ny, nz, nextLevel});
+            }
+        }
+    }
+    addQueue.clear();
+}
+
+void VoxelLighting::propagateRemoval(Channel channel) {
+    for (size_t head = 0; head < removeQueue.size(); head++) {
+        LightNode node = removeQueue[head];
+
+        for (int dir = 0; dir < 6; dir++) {
+            int nx = node.x + neighborOffsets[dir][0];
+            int ny = node.y + neighborOffsets[dir][1];
+            int nz = node.z + neighborOffsets[dir][2];
+            if (!isInside(nx, ny, nz)) {
+                continue;
+            }
+
+            int level = getLevel(channel, nx, ny, nz);
+            if (level == 0) {
+                continue;
+            }
+
+            bool sunColumn = channel == SUN && dir == DOWN && node.level == MAX_LIGHT_LEVEL;
+            if (level < node.level || (sunColumn && level == MAX_LIGHT_LEVEL)) {
+                // Lit only through the removed cell
+                setLevel(channel, nx, ny, nz, 0);
+                removeQueue.push_back({nx, ny, nz, level});
+
+                int emission = channel == BLOCK ? getBlockEmission(terrain.getGridBlock(nx, ny, nz)) : 0;
+                if (emission > 0) {
+                    setLevel(BLOCK, nx, ny, nz, emission);
+                    addQueue.push_back({nx, ny, nz, emission});
+                }
+            } else {
+                // An independent source, it refills the removed region afterwards
+                addQueue.push_back({nx, ny, nz, level});
+            }
+        }
+    }
+    removeQueue.clear();
+}
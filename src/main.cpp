@@ -1,37 +1,185 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <random>
+#include <string>
 #include <vector>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
 #include "Shader.h"
+#include "ShaderLibrary.h"
+#include "AgentSimulation.h"
+#include "AllocationTracker.h"
+#include "BitmapFont.h"
 #include "Camera.h"
+#include "ChunkVisibility.h"
+#include "InputRecording.h"
 #include "Cube.h"
 #include "CharacterController.h"
+#include "ClusteredLighting.h"
+#include "DynamicResolution.h"
+#include "FrameArena.h"
+#include "FrameCapture.h"
+#include "FramePacer.h"
+#include "ImageWriter.h"
 #include "Ground.h"
+#include "MeshRegistry.h"
+#include "OverlayRenderer.h"
+#include "Profiler.h"
+#include "ResolutionController.h"
+#include "Session.h"
+#include "ShadowCascades.h"
+#include "SoftwareRasterizer.h"
+#include "Telemetry.h"
 #include "Terrain.h"
+#include "TerrainRenderer.h"
+#include "JobSystem.h"
 
 // Global variables
 Camera camera(glm::vec3(0.0f, 1.5f, 3.0f));
-CharacterController* player = nullptr;
 float lastX = 400.0f;
 float lastY = 300.0f;
 bool firstMouse = true;
+// Mouse motion not yet handed to a tick, in pixels
+float pendingMouseX = 0.0f;
+float pendingMouseY = 0.0f;
+// Set by window events that need a redraw while idle, see --idle
+bool redrawRequested = true;
 
 // Timing
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
+// Command line options
+struct AppOptions {
+    int pointLights = 0;          // --lights N
+    bool lightBenchmark = false;  // --light-benchmark
+    bool profile = false;         // --profile
+    bool allocCheck = false;      // --alloc-check
+    bool telemetry = false;       // --telemetry
+    bool dynamicResolution = false;  // --dynamic-resolution
+    ResolutionSettings resolution;   // --target-ms F, --min-scale F, --max-scale F
+    int gpuLoad = 0;                 // --gpu-load N, artificial per-pixel work
+    std::string capturePngPrefix;    // --capture-png PREFIX
+    std::string captureVideoPath;    // --capture-y4m FILE
+    bool hidden = false;             // --hidden, render without showing the window
+    bool idle = false;               // --idle, redraw only when something changed
+    int maxFps = 0;                  // --max-fps N, 0 = unlimited
+    bool hud = false;                // --hud, frame stats drawn over the scene
+    CullingMode culling = CULLING_CONNECTIVITY;  // --culling none|frustum|connectivity
+    SessionOptions session;       // --caves, --noise perlin|simplex, --agents N
+    std::string recordPath;       // --record FILE
+    std::string replayPath;       // --replay FILE
+    std::string softwareComparePrefix;  // --software-compare PREFIX
+};
+
+// Frames after startup before --alloc-check expects the loop to stop allocating
+const int ALLOC_CHECK_WARMUP_FRAMES = 120;
+
+// Mesh data uploaded per frame; larger batches are spread over several frames
+const size_t MESH_UPLOAD_BUDGET = 1 << 20;
+
+// --software-compare: channel difference a pixel may have, and the share of
+// pixels allowed over it (triangle edges land on different pixels with the
+// GPU's own subpixel precision)
+const int SOFTWARE_COMPARE_TOLERANCE = 8;
+const double SOFTWARE_COMPARE_MAX_MISMATCH = 0.005;
+
+// Recorded sessions tick at a fixed rate; a slow frame runs at most this many
+const int MAX_TICKS_PER_FRAME = 5;
+
+// With --idle, frames drawn after the last change before the loop sleeps, and
+// the longest sleep between checks when no event arrives
+const int IDLE_SETTLE_FRAMES = 3;
+const double IDLE_WAIT_SECONDS = 0.5;
+
+// What the image depends on besides the world, compared frame to frame for --idle
+struct ViewState {
+    glm::vec3 position = glm::vec3(0.0f);
+    float yaw = 0.0f, pitch = 0.0f, zoom = 0.0f;
+    int width = 0, height = 0;
+
+    bool operator==(const ViewState& other) const {
+        return position == other.position && yaw == other.yaw && pitch == other.pitch && zoom == other.zoom &&
+               width == other.width && height == other.height;
+    }
+};
+
+// Numbers shown by --hud, from the previous frame where this one is not done yet
+struct HudStats {
+    float frameMilliseconds = 0.0f;  // smoothed
+    float cpuMilliseconds = 0.0f;
+    float gpuMilliseconds = 0.0f;
+    int drawCalls = 0;
+    int triangles = 0;
+    int residentChunks = 0;
+    int drawnChunks = 0;
+    float renderScale = 0.0f;        // 0 without an offscreen scene target
+};
+
+// Frame times of a windowed replay
+struct ReplayStats {
+    int frames = 0;
+    double totalMilliseconds = 0.0;
+    double worstMilliseconds = 0.0;
+};
+
+// Sweeps the point light count and reports average frame and light assignment times
+struct LightBenchmark {
+    std::vector<int> lightCounts = {1, 10, 100, 250, 500, 1000};
+    size_t step = 0;
+    int frame = 0;
+    double frameMilliseconds = 0.0;
+    double assignMilliseconds = 0.0;
+    static const int warmupFrames = 30;
+    static const int measuredFrames = 240;
+};
+
 // Function declarations
+bool parseOptions(int argc, char** argv, AppOptions& options);
+std::vector<PointLight> createPointLights(int count, const Terrain& terrain);
+void animatePointLights(std::vector<PointLight>& lights, const std::vector<glm::vec3>& basePositions, float time);
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void window_refresh_callback(GLFWwindow* window);
 void processInput(GLFWwindow* window);
-void renderCrosshair();
+void addCrosshair(OverlayRenderer& overlay, int width, int height);
+void addHud(OverlayRenderer& overlay, const HudStats& stats);
+void renderAgents(const AgentSimulation& agents, FrameArena& arena, unsigned int instanceVBO, Cube& cube);
+int compareSoftwareRaster(ShaderLibrary& shaders, int width, int height, const std::string& prefix);
+InputState readInput(GLFWwindow* window);
+bool hasPendingInput(GLFWwindow* window);
+
+int main(int argc, char** argv) {
+    AppOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        return -1;
+    }
+
+    // A replay rebuilds the world it was recorded in
+    InputRecording recording;
+    bool replaying = !options.replayPath.empty();
+    bool recordingInput = !options.recordPath.empty();
+    if (replaying) {
+        if (!recording.load(options.replayPath)) {
+            return -1;
+        }
+        options.session = recording.getOptions();
+        std::cout << "Replaying " << recording.getTickCount() << " ticks from " << options.replayPath << std::endl;
+    } else {
+        recording.setOptions(options.session);
+    }
 
-int main() {
     // Initialize GLFW
     if (!glfwInit()) {
         std::cerr << "Failed to initialize GLFW" << std::endl;
@@ -41,6 +189,9 @@ int main() {
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    if (options.hidden) {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    }
 
     // Create a windowed mode window and its OpenGL context
     GLFWwindow* window = glfwCreateWindow(800, 600, "3D Cube Renderer", nullptr, nullptr);
@@ -53,6 +204,7 @@ int main() {
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
     glfwSetCursorPosCallback(window, mouse_callback);
     glfwSetScrollCallback(window, scroll_callback);
+    glfwSetWindowRefreshCallback(window, window_refresh_callback);
 
     // Capture the cursor
     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
@@ -72,53 +224,247 @@ int main() {
     // Enable depth testing
     glEnable(GL_DEPTH_TEST);
 
-    // Build and compile shaders
-    Shader shader;
-    if (!shader.loadFromFiles("shaders/vertex.glsl", "shaders/fragment.glsl")) {
+    // Load shader sources; variants are compiled on first use
+    ShaderLibrary shaders;
+    if (!shaders.loadSources("shaders/vertex.glsl", "shaders/fragment.glsl")) {
         std::cerr << "Failed to load shaders" << std::endl;
         return -1;
     }
+    shaders.setDefine("CLUSTER_GRID_X", std::to_string(ClusteredLighting::GRID_X));
+    shaders.setDefine("CLUSTER_GRID_Y", std::to_string(ClusteredLighting::GRID_Y));
+    shaders.setDefine("CLUSTER_GRID_Z", std::to_string(ClusteredLighting::GRID_Z));
+    shaders.setDefine("SHADOW_CASCADES", std::to_string(ShadowCascades::NUM_CASCADES));
 
-    // Create terrain
-    Terrain terrain(64, 64, 20.0f); // 64x64 terrain with scale 20
-    terrain.setHeightMultiplier(8.0f);
-    terrain.setOctaves(6);
-    terrain.generate();
+    // Terrain is lit by baked voxel light in packed chunk vertices with sun
+    // shadows, plus clustered point lights when any are requested
+    bool useClusteredLights = options.pointLights > 0 || options.lightBenchmark;
+    const unsigned int terrainFeatures = SHADER_PACKED_VERTEX | SHADER_BAKED_LIGHT | SHADER_FOG | SHADER_SHADOWS |
+                                         (useClusteredLights ? SHADER_CLUSTERED : 0u);
+    const unsigned int shadowFeatures = SHADER_PACKED_VERTEX | SHADER_DEPTH_ONLY;
+    if (!shaders.get(terrainFeatures) || !shaders.get(shadowFeatures)) {
+        std::cerr << "Failed to compile terrain shader" << std::endl;
+        return -1;
+    }
+    // Render a test scene on both paths, compare and exit
+    if (!options.softwareComparePrefix.empty()) {
+        int result = compareSoftwareRaster(shaders, width, height, options.softwareComparePrefix);
+        glfwTerminate();
+        return result;
+    }
 
-    // Create character controller
-    player = new CharacterController(camera, terrain);
-    
-    float startX = 0.0f;
-    float startZ = 0.0f;
-    float terrainHeight = terrain.getHeightAt(startX, startZ);
-    float startY = terrainHeight + 1.0f; // Start 1 unit above terrain
-    
-    std::cout << "Terrain height at (0,0): " << terrainHeight << std::endl;
-    std::cout << "Setting player start position to: (" << startX << ", " << startY << ", " << startZ << ")" << std::endl;
-    
-    player->setPosition(glm::vec3(startX, startY, startZ));
+    // Warm up the specular variant in the background for objects that need it
+    shaders.request(SHADER_INSTANCED | SHADER_FOG);
+
+    // Create the world: terrain, player and agents
+    JobSystem jobs;
+    Session session(options.session, camera, jobs);
+    Terrain& terrain = session.getTerrain();
+    AgentSimulation& agents = session.getAgents();
+    glm::vec3 start = session.getPlayer().getPosition();
+    std::cout << "Player starts at (" << start.x << ", " << start.y << ", " << start.z << ")" << std::endl;
+
+    TerrainRenderer terrainRenderer(terrain);
+    terrainRenderer.update(-1);
+    ChunkVisibility chunkVisibility(terrain);
+
+    // Frame timings; shadow cascades report their own sections
+    Profiler profiler;
+    int frameSection = profiler.getSectionId("frame");
+    int terrainSection = profiler.getSectionId("terrain");
+    int cullingSection = profiler.getSectionId("culling");
+    int captureSection = profiler.getSectionId("capture");
+    float lastProfileReport = 0.0f;
+
+    // Sun shadows, cached per cascade while the world is static
+    ShadowCascades shadows(terrain, terrainRenderer);
+    shadows.setLightDirection(glm::vec3(-0.4f, -1.0f, -0.3f));
+    shadows.setProfiler(&profiler);
+
+    // Dynamic point lights
+    ClusteredLighting clusteredLighting(jobs);
+    LightBenchmark lightBenchmark;
+    int lightCount = options.lightBenchmark ? lightBenchmark.lightCounts[0] : options.pointLights;
+    std::vector<PointLight> pointLights = createPointLights(lightCount, terrain);
+    std::vector<glm::vec3> lightBasePositions;
+    for (const PointLight& light : pointLights) {
+        lightBasePositions.push_back(light.position);
+    }
+    if (options.lightBenchmark) {
+        std::cout << "Light benchmark: " << jobs.getConcurrency() << " assignment threads" << std::endl;
+        std::printf("%8s %12s %12s\n", "lights", "frame ms", "assign ms");
+    }
+
+    // Shared meshes, uploaded a budgeted amount per frame
+    MeshRegistry meshes;
+
+    // Offscreen scene target. With --dynamic-resolution its scale follows the
+    // GPU frame time; --gpu-load alone renders it at full scale under load.
+    ResolutionController resolutionController(options.resolution);
+    std::unique_ptr<DynamicResolution> sceneTarget;
+    if (options.dynamicResolution || options.gpuLoad > 0) {
+        sceneTarget = std::make_unique<DynamicResolution>(resolutionController.getSettings().maxScale);
+        sceneTarget->setArtificialLoad(options.gpuLoad);
+    }
+
+    // Crosshair and --hud, batched into one draw at the end of the frame
+    OverlayRenderer overlay;
+    HudStats hudStats;
+
+    // Agents are drawn as instanced cubes, built in the per-frame arena
+    FrameArena frameArena(std::max<size_t>(agents.getAgentCount() * sizeof(CubeInstance), 64 * 1024));
+    Cube agentCube(meshes);
+    unsigned int agentVBO = 0;
+    const unsigned int agentFeatures = SHADER_INSTANCED | SHADER_FOG;
+    if (agents.getAgentCount() > 0) {
+        glGenBuffers(1, &agentVBO);
+        glBindBuffer(GL_ARRAY_BUFFER, agentVBO);
+        glBufferData(GL_ARRAY_BUFFER, agents.getAgentCount() * sizeof(CubeInstance), nullptr, GL_STREAM_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    int replayTick = 0;
+    ReplayStats replayStats;
+    float tickAccumulator = 0.0f;
+
+    // Heap allocations counted by the frame loop, see --alloc-check
+    int frameNumber = 0;
+    int allocatingFrames = 0;
+    uint64_t reportAllocations = 0;
+    int reportFrames = 0;
+
+    // Live counters for Rendering3DTelemetry, see --telemetry
+    TelemetryPublisher telemetry;
+    if (options.telemetry && telemetry.open()) {
+        std::cout << "Publishing telemetry to " << TELEMETRY_DEFAULT_NAME << std::endl;
+    }
+    uint64_t lastCollisionChecks = session.getPlayer().getCollisionChecks();
+
+    // Frame dumps, see --capture-png and --capture-y4m. A replay is captured at
+    // its tick rate, one tick per frame, so the video plays in real time.
+    FrameCapture capture;
+    if (!options.capturePngPrefix.empty() || !options.captureVideoPath.empty()) {
+        bool video = !options.captureVideoPath.empty();
+        int framesPerSecond = replaying ? static_cast<int>(std::lround(1.0 / recording.getTickSeconds())) : 60;
+        if (capture.start(video ? CAPTURE_Y4M : CAPTURE_PNG,
+                          video ? options.captureVideoPath : options.capturePngPrefix, framesPerSecond)) {
+            std::cout << "Capturing frames to " << (video ? options.captureVideoPath : options.capturePngPrefix + "*.png")
+                      << std::endl;
+        }
+    }
+
+    // Render on demand: scenes that animate on their own, and runs that must
+    // produce every frame, keep drawing continuously
+    bool idleAllowed = options.idle && !replaying && !recordingInput && !options.lightBenchmark &&
+                       !capture.isActive() && agents.getAgentCount() == 0 && !useClusteredLights;
+    if (options.idle && !idleAllowed) {
+        std::cout << "Idle mode off: the scene animates or every frame is needed" << std::endl;
+    }
+    ViewState lastView;
+    int quietFrames = 0;
+    double idleSeconds = 0.0;
+
+    // Frame limiter, see --max-fps
+    FramePacer pacer(options.maxFps > 0 ? options.maxFps : 60.0);
 
     // Main render loop
     while (!glfwWindowShouldClose(window)) {
-        
+        // Nothing changed for a few frames and no input is waiting: block until
+        // an event arrives instead of drawing the same image again
+        if (idleAllowed && quietFrames >= IDLE_SETTLE_FRAMES && !redrawRequested && !hasPendingInput(window)) {
+            double waitStart = glfwGetTime();
+            glfwWaitEventsTimeout(IDLE_WAIT_SECONDS);
+            // The next tick sees an ordinary time step rather than the time spent waiting
+            lastFrame = static_cast<float>(glfwGetTime());
+            idleSeconds += lastFrame - waitStart;
+            pacer.reset();
+            continue;
+        }
+        redrawRequested = false;
+
         float currentFrame = static_cast<float>(glfwGetTime());
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
 
-        // Input and update
-        player->processInput(window);
-        player->update(deltaTime);
+        AllocationTracker::beginFrame();
+        frameArena.reset();
+        int ticksThisFrame = 0;
+
+        profiler.beginFrame();
+        profiler.beginSection(frameSection);
+
+        // Input and update (the benchmark keeps a fixed view). Replays advance
+        // one recorded tick per frame, so every run renders the same frames.
+        if (replaying) {
+            if (replayTick < recording.getTickCount()) {
+                session.tick(recording.getTick(replayTick++), recording.getTickSeconds());
+                ticksThisFrame++;
+            }
+        } else if (recordingInput) {
+            tickAccumulator += deltaTime;
+            int ticks = 0;
+            while (tickAccumulator >= recording.getTickSeconds() && ticks < MAX_TICKS_PER_FRAME) {
+                InputState input = readInput(window);
+                recording.addTick(input);
+                session.tick(input, recording.getTickSeconds());
+                tickAccumulator -= recording.getTickSeconds();
+                ticks++;
+            }
+            if (ticks == MAX_TICKS_PER_FRAME) {
+                tickAccumulator = 0.0f;
+            }
+            ticksThisFrame = ticks;
+        } else if (!options.lightBenchmark) {
+            session.tick(readInput(window), deltaTime);
+            ticksThisFrame++;
+        }
+
+        // Remesh chunks touched by edits or relighting
+        int meshesChanged = 0;
+        {
+            AllocationScope scope(ALLOC_TERRAIN);
+            meshesChanged += terrainRenderer.update();
+        }
+        {
+            AllocationScope scope(ALLOC_RENDER);
+            meshesChanged += meshes.processUploads(MESH_UPLOAD_BUDGET);
+        }
+
+        // Get current framebuffer size for correct aspect ratio
+        glfwGetFramebufferSize(window, &width, &height);
+        float aspectRatio = static_cast<float>(width) / height;
+
+        // Re-render only the shadow cascades whose cached maps went stale
+        {
+            AllocationScope scope(ALLOC_SHADOWS);
+            shadows.update(camera, aspectRatio, *shaders.get(shadowFeatures));
+        }
+
+        AllocationScope renderScope(ALLOC_RENDER);
+
+        // Scene size: the window, or the scaled offscreen target
+        int renderWidth = width;
+        int renderHeight = height;
+        if (sceneTarget) {
+            float scale = resolutionController.getSettings().maxScale;
+            if (options.dynamicResolution) {
+                scale = resolutionController.update(profiler.getFrameIndex(),
+                                                    profiler.getLatestGpuMilliseconds(frameSection),
+                                                    profiler.getLatestGpuFrame(frameSection));
+            }
+            sceneTarget->beginScene(width, height, scale);
+            renderWidth = sceneTarget->getRenderWidth();
+            renderHeight = sceneTarget->getRenderHeight();
+        }
 
         // Render
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        // Activate shader
+        // Activate the variant matching the terrain's feature set
+        Shader& shader = *shaders.get(terrainFeatures);
         shader.use();
 
-        // Get current framebuffer size for correct aspect ratio
-        glfwGetFramebufferSize(window, &width, &height);
-        glm::mat4 projection = camera.getProjectionMatrix(static_cast<float>(width) / height);
+        glm::mat4 projection = camera.getProjectionMatrix(aspectRatio);
         shader.setMat4("projection", projection);
 
         // Camera/view transformation
@@ -129,28 +475,333 @@ int main() {
         shader.setVec3("lightPos", glm::vec3(10.0f, 20.0f, 10.0f));
         shader.setVec3("lightColor", glm::vec3(1.0f, 1.0f, 1.0f));
         shader.setVec3("viewPos", camera.position);
+        shader.setVec3("fogColor", glm::vec3(0.2f, 0.3f, 0.3f));
+        shader.setFloat("fogDensity", 0.015f);
+        shader.setFloat("sunBrightness", 1.0f);
+        shader.setVec3("blockLightColor", glm::vec3(1.0f, 0.85f, 0.6f));
+        shadows.bind(shader, 4);
+
+        // Assign this frame's point lights to clusters
+        if (useClusteredLights) {
+            AllocationScope scope(ALLOC_LIGHTING);
+            animatePointLights(pointLights, lightBasePositions, currentFrame);
+            clusteredLighting.update(camera, renderWidth, renderHeight, pointLights);
+            clusteredLighting.bind(shader);
+        }
+
+        // Only chunks in view and reachable from the camera through open space
+        profiler.beginSection(cullingSection);
+        chunkVisibility.update(camera.position, view, projection, options.culling);
+        profiler.endSection(cullingSection);
 
         // Render terrain
-        terrain.draw(shader);
+        profiler.beginSection(terrainSection);
+        terrainRenderer.draw(shader, &chunkVisibility);
+        profiler.endSection(terrainSection);
 
-        // Render crosshair overlay
-        renderCrosshair();
+        if (agents.getAgentCount() > 0) {
+            Shader& agentShader = *shaders.get(agentFeatures);
+            agentShader.use();
+            agentShader.setMat4("projection", projection);
+            agentShader.setMat4("view", view);
+            agentShader.setVec3("lightPos", glm::vec3(10.0f, 20.0f, 10.0f));
+            agentShader.setVec3("lightColor", glm::vec3(1.0f, 1.0f, 1.0f));
+            agentShader.setVec3("viewPos", camera.position);
+            agentShader.setVec3("fogColor", glm::vec3(0.2f, 0.3f, 0.3f));
+            agentShader.setFloat("fogDensity", 0.015f);
+            renderAgents(agents, frameArena, agentVBO, agentCube);
+        }
+
+        // Upscale the scene into the window; the overlay stays at full resolution
+        if (sceneTarget) {
+            sceneTarget->endScene();
+        }
+
+        // Overlay at full resolution: crosshair, and the HUD if asked for
+        overlay.begin(width, height);
+        addCrosshair(overlay, width, height);
+        if (options.hud) {
+            int agentDrawCalls = agents.getAgentCount() > 0 ? 6 : 0;
+            hudStats.frameMilliseconds += (deltaTime * 1000.0f - hudStats.frameMilliseconds) * 0.1f;
+            hudStats.gpuMilliseconds = profiler.getGpuMilliseconds(frameSection);
+            hudStats.drawCalls = terrainRenderer.getDrawCalls() + agentDrawCalls + overlay.getDrawCalls();
+            hudStats.triangles = terrainRenderer.getTrianglesDrawn() + agentDrawCalls * 2 * agents.getAgentCount();
+            hudStats.residentChunks = terrainRenderer.getResidentChunks();
+            hudStats.drawnChunks = terrainRenderer.getDrawCalls();
+            hudStats.renderScale = sceneTarget ? resolutionController.getScale() : 0.0f;
+            addHud(overlay, hudStats);
+        }
+        overlay.end();
+
+        // Compile at most one queued shader variant per frame
+        int shadersCompiled = shaders.compilePending(1);
+
+        // Queue a readback of the finished frame; it is written frames later
+        if (capture.isActive()) {
+            profiler.beginSection(captureSection);
+            capture.captureFrame(width, height);
+            profiler.endSection(captureSection);
+        }
+
+        profiler.endSection(frameSection);
+        float cpuMilliseconds = static_cast<float>((glfwGetTime() - currentFrame) * 1000.0);
+        hudStats.cpuMilliseconds = cpuMilliseconds;
 
         // Swap front and back buffers
         glfwSwapBuffers(window);
 
+        // Anything that changed the image keeps the loop drawing, see --idle
+        ViewState viewState;
+        viewState.position = camera.position;
+        viewState.yaw = camera.yaw;
+        viewState.pitch = camera.pitch;
+        viewState.zoom = camera.zoom;
+        viewState.width = width;
+        viewState.height = height;
+        bool changed = !(viewState == lastView) || meshesChanged > 0 || shadersCompiled > 0 ||
+                       shadows.getRenderedCascadeCount() > 0;
+        quietFrames = changed ? 0 : quietFrames + 1;
+        lastView = viewState;
+
+        if (replaying) {
+            // Wait for the GPU so frame times include the rendering cost
+            glFinish();
+            double frameMilliseconds = (glfwGetTime() - currentFrame) * 1000.0;
+            replayStats.frames++;
+            replayStats.totalMilliseconds += frameMilliseconds;
+            replayStats.worstMilliseconds = std::max(replayStats.worstMilliseconds, frameMilliseconds);
+            if (replayTick == recording.getTickCount()) {
+                glfwSetWindowShouldClose(window, true);
+            }
+        }
+
+        if (options.profile && currentFrame - lastProfileReport >= 2.0f) {
+            profiler.report(std::cout);
+            std::printf("heap allocations: %.1f per frame\n",
+                        static_cast<double>(reportAllocations) / std::max(reportFrames, 1));
+            MeshStats meshStats = meshes.getStats();
+            std::printf("meshes: %d (%d deduplicated, %d pending), %.1f KB GPU, %.1f KB CPU\n", meshStats.meshCount,
+                        meshStats.dedupHits, meshStats.pendingUploads, meshStats.gpuBytes / 1024.0,
+                        meshStats.cpuBytes / 1024.0);
+            std::printf("chunks: %d visible, %d drawn of %d resident, %d frustum tests, %d%% of culling passes reused\n",
+                        chunkVisibility.getVisibleCount(), terrainRenderer.getDrawCalls(),
+                        terrainRenderer.getResidentChunks(), chunkVisibility.getTestedCount(),
+                        100 - 100 * chunkVisibility.getFullUpdateCount() / std::max(chunkVisibility.getUpdateCount(), 1));
+            if (sceneTarget) {
+                std::printf("render scale %.2f: %dx%d of %dx%d\n", resolutionController.getScale(),
+                            sceneTarget->getRenderWidth(), sceneTarget->getRenderHeight(), width, height);
+            }
+            if (idleAllowed) {
+                std::printf("idle: %.0f%% of the time\n", 100.0 * idleSeconds / (currentFrame - lastProfileReport));
+                idleSeconds = 0.0;
+            }
+            reportAllocations = 0;
+            reportFrames = 0;
+            lastProfileReport = currentFrame;
+        }
+
+        if (options.lightBenchmark) {
+            // Wait for the GPU so frame times include the shading cost
+            glFinish();
+            float frameEnd = static_cast<float>(glfwGetTime());
+            if (lightBenchmark.frame >= LightBenchmark::warmupFrames) {
+                lightBenchmark.frameMilliseconds += (frameEnd - currentFrame) * 1000.0;
+                lightBenchmark.assignMilliseconds += clusteredLighting.getAssignMilliseconds();
+            }
+
+            if (++lightBenchmark.frame == LightBenchmark::warmupFrames + LightBenchmark::measuredFrames) {
+                std::printf("%8d %12.3f %12.3f\n", lightCount,
+                            lightBenchmark.frameMilliseconds / LightBenchmark::measuredFrames,
+                            lightBenchmark.assignMilliseconds / LightBenchmark::measuredFrames);
+
+                if (++lightBenchmark.step == lightBenchmark.lightCounts.size()) {
+                    glfwSetWindowShouldClose(window, true);
+                } else {
+                    lightCount = lightBenchmark.lightCounts[lightBenchmark.step];
+                    pointLights = createPointLights(lightCount, terrain);
+                    lightBasePositions.clear();
+                    for (const PointLight& light : pointLights) {
+                        lightBasePositions.push_back(light.position);
+                    }
+                    lightBenchmark.frame = 0;
+                    lightBenchmark.frameMilliseconds = 0.0;
+                    lightBenchmark.assignMilliseconds = 0.0;
+                }
+            }
+        }
+
+        if (options.maxFps > 0) {
+            pacer.wait();
+        }
+
         // Poll for and process events
         glfwPollEvents();
+
+        AllocationCounts frameAllocations = AllocationTracker::getFrameTotal();
+        reportAllocations += frameAllocations.allocations;
+        reportFrames++;
+        if (options.allocCheck && ++frameNumber > ALLOC_CHECK_WARMUP_FRAMES && frameAllocations.allocations > 0) {
+            std::cout << "Frame " << frameNumber << " allocated " << frameAllocations.allocations << " times ("
+                      << frameAllocations.bytes << " bytes):" << std::endl;
+            AllocationTracker::reportFrame(std::cout);
+            allocatingFrames++;
+        }
+
+        if (telemetry.isOpen()) {
+            // Agents are six instanced draws, one per cube face
+            int agentDrawCalls = agents.getAgentCount() > 0 ? 6 : 0;
+            uint64_t collisionChecks = session.getPlayer().getCollisionChecks();
+            telemetry.setCounter(TELEMETRY_DRAW_CALLS, static_cast<uint32_t>(terrainRenderer.getDrawCalls() + agentDrawCalls));
+            telemetry.setCounter(TELEMETRY_TRIANGLES, static_cast<uint32_t>(terrainRenderer.getTrianglesDrawn() +
+                                                                             agentDrawCalls * 2 * agents.getAgentCount()));
+            telemetry.setCounter(TELEMETRY_CHUNKS_RESIDENT, static_cast<uint32_t>(terrainRenderer.getResidentChunks()));
+            telemetry.setCounter(TELEMETRY_CHUNKS_DRAWN, static_cast<uint32_t>(terrainRenderer.getDrawCalls()));
+            telemetry.setCounter(TELEMETRY_TICKS, static_cast<uint32_t>(ticksThisFrame));
+            telemetry.setCounter(TELEMETRY_COLLISION_CHECKS, static_cast<uint32_t>(collisionChecks - lastCollisionChecks));
+            telemetry.setCounter(TELEMETRY_ALLOCATIONS, static_cast<uint32_t>(frameAllocations.allocations));
+            telemetry.publishFrame(deltaTime * 1000.0f, cpuMilliseconds);
+            lastCollisionChecks = collisionChecks;
+        }
+    }
+
+    uint32_t checksum = session.getPlayerChecksum();
+    if (replaying) {
+        std::printf("Replayed %d of %d ticks: %.3f ms/frame average, %.3f ms worst\n", replayTick,
+                    recording.getTickCount(), replayStats.totalMilliseconds / std::max(replayStats.frames, 1),
+                    replayStats.worstMilliseconds);
+        bool complete = replayTick == recording.getTickCount();
+        bool matches = complete && checksum == recording.getFinalChecksum();
+        std::printf("Player checksum %08x, recorded %08x: %s\n", checksum, recording.getFinalChecksum(),
+                    matches ? "match" : (complete ? "DRIFT" : "incomplete"));
+    } else if (recordingInput) {
+        recording.setFinalChecksum(checksum);
+        if (recording.save(options.recordPath)) {
+            std::printf("Recorded %d ticks to %s, player checksum %08x\n", recording.getTickCount(),
+                        options.recordPath.c_str(), checksum);
+        }
+    }
+
+    if (capture.isActive()) {
+        capture.stop();
+        double elapsed = capture.getElapsedMilliseconds();
+        std::printf("Captured %d frames (%d written): %.3f ms/frame on the render thread, %.2f%% of frame time, %d stalls\n",
+                    capture.getFramesCaptured(), capture.getFramesWritten(),
+                    capture.getCaptureMilliseconds() / std::max(capture.getFramesCaptured(), 1),
+                    elapsed > 0.0 ? 100.0 * capture.getCaptureMilliseconds() / elapsed : 0.0, capture.getStalls());
     }
 
     // Cleanup
-    delete player;
+    if (agentVBO != 0) {
+        glDeleteBuffers(1, &agentVBO);
+    }
     
     glfwDestroyWindow(window);
     glfwTerminate();
+
+    if (options.allocCheck) {
+        int checkedFrames = std::max(frameNumber - ALLOC_CHECK_WARMUP_FRAMES, 0);
+        std::printf("Allocation check: %d of %d frames after warmup allocated\n", allocatingFrames, checkedFrames);
+        return allocatingFrames > 0 ? 1 : 0;
+    }
     return 0;
 }
 
+bool parseOptions(int argc, char** argv, AppOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--lights") == 0 && i + 1 < argc) {
+            options.pointLights = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--light-benchmark") == 0) {
+            options.lightBenchmark = true;
+        } else if (std::strcmp(argv[i], "--profile") == 0) {
+            options.profile = true;
+        } else if (std::strcmp(argv[i], "--alloc-check") == 0) {
+            options.allocCheck = true;
+        } else if (std::strcmp(argv[i], "--telemetry") == 0) {
+            options.telemetry = true;
+        } else if (std::strcmp(argv[i], "--dynamic-resolution") == 0) {
+            options.dynamicResolution = true;
+        } else if (std::strcmp(argv[i], "--target-ms") == 0 && i + 1 < argc) {
+            options.resolution.targetMilliseconds = static_cast<float>(std::atof(argv[++i]));
+        } else if (std::strcmp(argv[i], "--min-scale") == 0 && i + 1 < argc) {
+            options.resolution.minScale = static_cast<float>(std::atof(argv[++i]));
+        } else if (std::strcmp(argv[i], "--max-scale") == 0 && i + 1 < argc) {
+            options.resolution.maxScale = static_cast<float>(std::atof(argv[++i]));
+        } else if (std::strcmp(argv[i], "--gpu-load") == 0 && i + 1 < argc) {
+            options.gpuLoad = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--capture-png") == 0 && i + 1 < argc) {
+            options.capturePngPrefix = argv[++i];
+        } else if (std::strcmp(argv[i], "--capture-y4m") == 0 && i + 1 < argc) {
+            options.captureVideoPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--hidden") == 0) {
+            options.hidden = true;
+        } else if (std::strcmp(argv[i], "--hud") == 0) {
+            options.hud = true;
+        } else if (std::strcmp(argv[i], "--idle") == 0) {
+            options.idle = true;
+        } else if (std::strcmp(argv[i], "--max-fps") == 0 && i + 1 < argc) {
+            options.maxFps = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--caves") == 0) {
+            options.session.densityTerrain = true;
+        } else if (std::strcmp(argv[i], "--noise") == 0 && i + 1 < argc &&
+                   (std::strcmp(argv[i + 1], "perlin") == 0 || std::strcmp(argv[i + 1], "simplex") == 0)) {
+            options.session.noise = std::strcmp(argv[++i], "simplex") == 0 ? NOISE_SIMPLEX : NOISE_PERLIN;
+        } else if (std::strcmp(argv[i], "--culling") == 0 && i + 1 < argc) {
+            const char* mode = argv[++i];
+            if (std::strcmp(mode, "none") == 0) {
+                options.culling = CULLING_NONE;
+            } else if (std::strcmp(mode, "frustum") == 0) {
+                options.culling = CULLING_FRUSTUM;
+            } else if (std::strcmp(mode, "connectivity") == 0) {
+                options.culling = CULLING_CONNECTIVITY;
+            } else {
+                std::cerr << "Unknown culling mode: " << mode << " (none, frustum or connectivity)" << std::endl;
+                return false;
+            }
+        } else if (std::strcmp(argv[i], "--agents") == 0 && i + 1 < argc) {
+            options.session.agents = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            options.recordPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            options.replayPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--software-compare") == 0 && i + 1 < argc) {
+            options.softwareComparePrefix = argv[++i];
+        } else {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+            std::cerr << "Usage: " << argv[0] << " [--lights N] [--light-benchmark] [--profile] [--hud] [--culling none|frustum|connectivity] [--alloc-check] [--telemetry] [--dynamic-resolution [--target-ms F] [--min-scale F] [--max-scale F]] [--gpu-load N] [--capture-png PREFIX | --capture-y4m FILE] [--hidden] [--idle] [--max-fps N] [--caves] [--noise perlin|simplex] [--agents N] [--record FILE | --replay FILE] [--software-compare PREFIX]" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<PointLight> createPointLights(int count, const Terrain& terrain) {
+    // Fixed seed so benchmark runs see the same scene
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    std::vector<PointLight> lights;
+    lights.reserve(count);
+    for (int i = 0; i < count; i++) {
+        PointLight light;
+        float x = (unit(rng) - 0.5f) * terrain.getWidth();
+        float z = (unit(rng) - 0.5f) * terrain.getHeight();
+        light.position = glm::vec3(x, terrain.getHeightAt(x, z) + 1.0f + unit(rng) * 3.0f, z);
+        light.radius = 3.0f + unit(rng) * 4.0f;
+        light.color = glm::vec3(0.3f + 0.7f * unit(rng), 0.3f + 0.7f * unit(rng), 0.3f + 0.7f * unit(rng));
+        light.intensity = 1.5f;
+        lights.push_back(light);
+    }
+    return lights;
+}
+
+void animatePointLights(std::vector<PointLight>& lights, const std::vector<glm::vec3>& basePositions, float time) {
+    for (size_t i = 0; i < lights.size(); i++) {
+        float phase = static_cast<float>(i) * 0.37f;
+        lights[i].position = basePositions[i] + glm::vec3(std::cos(time + phase), 0.5f * std::sin(time * 1.3f + phase),
+                                                          std::sin(time + phase)) * 1.5f;
+    }
+}
+
 void processInput(GLFWwindow* window) {
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
@@ -158,6 +809,12 @@ void processInput(GLFWwindow* window) {
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     glViewport(0, 0, width, height);
+    redrawRequested = true;
+}
+
+void window_refresh_callback(GLFWwindow* window) {
+    // Uncovered or restored: the window contents may be gone
+    redrawRequested = true;
 }
 
 void mouse_callback(GLFWwindow* window, double xposIn, double yposIn) {
@@ -176,50 +833,201 @@ void mouse_callback(GLFWwindow* window, double xposIn, double yposIn) {
     lastX = xpos;
     lastY = ypos;
 
-    if (player) {
-        player->processMouseMovement(xoffset, yoffset);
-    }
+    // Applied at the next tick, so recordings see exactly what the player saw
+    pendingMouseX += xoffset;
+    pendingMouseY += yoffset;
 }
 
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
     camera.zoom -= (float)yoffset;
+    redrawRequested = true;
     if (camera.zoom < 1.0f)
         camera.zoom = 1.0f;
     if (camera.zoom > 45.0f)
         camera.zoom = 45.0f;
 }
 
-void renderCrosshair() {
-    // Disable depth testing for 2D overlay
-    glDisable(GL_DEPTH_TEST);
-    
-    // Save current matrix
-    glMatrixMode(GL_PROJECTION);
-    glPushMatrix();
-    glLoadIdentity();
-    glOrtho(-1.0, 1.0, -1.0, 1.0, -1.0, 1.0);
-    
-    glMatrixMode(GL_MODELVIEW);
-    glPushMatrix();
-    glLoadIdentity();
-    
-    // Draw crosshair
-    glColor3f(1.0f, 1.0f, 1.0f);
-    glLineWidth(2.0f);
-    
-    glBegin(GL_LINES);
-    glVertex2f(-0.2f, 0.0f);
-    glVertex2f(0.2f, 0.0f);
-    glVertex2f(0.0f, -0.2f);
-    glVertex2f(0.0f, 0.2f);
-    glEnd();
-    
-    // Restore matrix
-    glMatrixMode(GL_PROJECTION);
-    glPopMatrix();
-    glMatrixMode(GL_MODELVIEW);
-    glPopMatrix();
-    
-    // Re-enable depth testing
-    glEnable(GL_DEPTH_TEST);
+// WASD moves, space jumps, left click breaks a block, right click places a lamp
+const struct {
+    int key;
+    InputButton button;
+} KEY_BINDINGS[] = {
+    {GLFW_KEY_W, INPUT_FORWARD}, {GLFW_KEY_A, INPUT_LEFT}, {GLFW_KEY_S, INPUT_BACK},
+    {GLFW_KEY_D, INPUT_RIGHT}, {GLFW_KEY_SPACE, INPUT_JUMP}
+};
+
+InputState readInput(GLFWwindow* window) {
+    InputState input;
+    for (const auto& binding : KEY_BINDINGS) {
+        if (glfwGetKey(window, binding.key) == GLFW_PRESS) {
+            input.buttons |= binding.button;
+        }
+    }
+    if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS) {
+        input.buttons |= INPUT_BREAK;
+    }
+    if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS) {
+        input.buttons |= INPUT_PLACE;
+    }
+
+    // Hand over the mouse motion in whole input units; the remainder carries to the next tick
+    const float units = static_cast<float>(InputState::MOUSE_UNITS_PER_PIXEL);
+    long mouseX = std::lround(std::clamp(pendingMouseX * units, -32767.0f, 32767.0f));
+    long mouseY = std::lround(std::clamp(pendingMouseY * units, -32767.0f, 32767.0f));
+    input.mouseX = static_cast<int16_t>(mouseX);
+    input.mouseY = static_cast<int16_t>(mouseY);
+    pendingMouseX -= mouseX / units;
+    pendingMouseY -= mouseY / units;
+    return input;
+}
+
+bool hasPendingInput(GLFWwindow* window) {
+    // Mouse motion below half an input unit is the remainder readInput() carries, not movement
+    const float units = static_cast<float>(InputState::MOUSE_UNITS_PER_PIXEL);
+    if (std::abs(pendingMouseX * units) >= 0.5f || std::abs(pendingMouseY * units) >= 0.5f) {
+        return true;
+    }
+    for (const auto& binding : KEY_BINDINGS) {
+        if (glfwGetKey(window, binding.key) == GLFW_PRESS) {
+            return true;
+        }
+    }
+    return glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS ||
+           glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS;
+}
+
+void renderAgents(const AgentSimulation& agents, FrameArena& arena, unsigned int instanceVBO, Cube& cube) {
+    // Unit cubes standing on the agents' feet, straight from the SoA position arrays
+    int count = agents.getAgentCount();
+    CubeInstance* instances = arena.allocateArray<CubeInstance>(count);
+    const float* xs = agents.getPositionsX();
+    const float* ys = agents.getPositionsY();
+    const float* zs = agents.getPositionsZ();
+    for (int i = 0; i < count; i++) {
+        instances[i].offset = glm::vec3(xs[i], ys[i] + 0.5f, zs[i]);
+        instances[i].color = (agents.getFlags(i) & AGENT_ON_GROUND)
+            ? glm::vec3(0.9f, 0.5f, 0.2f) : glm::vec3(0.9f, 0.9f, 0.3f);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(CubeInstance), instances);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    for (int face = 0; face < 6; face++) {
+        cube.drawFaceInstanced(face, instanceVBO, 0, count);
+    }
+}
+
+int compareSoftwareRaster(ShaderLibrary& shaders, int width, int height, const std::string& prefix) {
+    Shader* shader = shaders.get(SHADER_FOG);
+    if (!shader) {
+        std::cerr << "Failed to compile the comparison shader" << std::endl;
+        return -1;
+    }
+
+    // Rotated and scaled cubes, and a floor slab reaching behind the camera so
+    // the near plane clips it
+    struct TestObject {
+        glm::mat4 model;
+        glm::vec3 color;
+    };
+    std::vector<TestObject> objects;
+    objects.push_back({glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -0.6f, 0.0f)),
+                                  glm::vec3(30.0f, 0.2f, 30.0f)),
+                       glm::vec3(0.4f, 0.6f, 0.3f)});
+    for (int i = 0; i < 15; i++) {
+        glm::vec3 position(static_cast<float>(i % 5) * 2.0f - 4.0f, static_cast<float>(i % 3) * 0.6f,
+                           -2.0f - static_cast<float>(i / 5) * 4.0f);
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), position);
+        model = glm::rotate(model, glm::radians(17.0f * i), glm::normalize(glm::vec3(1.0f, 2.0f, 0.5f)));
+        model = glm::scale(model, glm::vec3(0.6f + 0.1f * (i % 4)));
+        objects.push_back({model, glm::vec3(0.3f + 0.045f * i, 0.8f - 0.04f * i, 0.5f)});
+    }
+
+    glm::vec3 eye(0.0f, 1.0f, 3.0f);
+    glm::mat4 view = glm::lookAt(eye, glm::vec3(0.0f, 0.0f, -6.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), static_cast<float>(width) / height, 0.1f, 100.0f);
+    PhongShading shading;
+    shading.viewPos = eye;
+    shading.fog = true;
+    const glm::vec3 clearColor(0.2f, 0.3f, 0.3f);
+
+    // GL: the default shader's FOG variant, read back from the back buffer
+    Mesh cube(Cube::getCubeVertices(), Cube::getCubeIndices());
+    glViewport(0, 0, width, height);
+    glClearColor(clearColor.x, clearColor.y, clearColor.z, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    shader->use();
+    shader->setMat4("projection", projection);
+    shader->setMat4("view", view);
+    shader->setVec3("lightPos", shading.lightPos);
+    shader->setVec3("lightColor", shading.lightColor);
+    shader->setVec3("viewPos", shading.viewPos);
+    shader->setVec3("fogColor", shading.fogColor);
+    shader->setFloat("fogDensity", shading.fogDensity);
+    for (const TestObject& object : objects) {
+        shader->setMat4("model", object.model);
+        shader->setVec3("objectColor", object.color);
+        cube.draw();
+    }
+    std::vector<uint8_t> glPixels(static_cast<size_t>(width) * height * 4);
+    glReadBuffer(GL_BACK);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, glPixels.data());
+
+    // The same scene on the CPU
+    JobSystem jobs;
+    SoftwareRasterizer rasterizer(&jobs);
+    rasterizer.begin(width, height, clearColor);
+    rasterizer.setCamera(view, projection);
+    rasterizer.setShading(shading);
+    for (const TestObject& object : objects) {
+        rasterizer.draw(Cube::getCubeVertices(), Cube::getCubeIndices(), object.model, object.color);
+    }
+    rasterizer.end();
+
+    std::vector<uint8_t> scratch;
+    if (!writePng(prefix + "-gl.png", glPixels.data(), width, height, scratch) ||
+        !writePng(prefix + "-software.png", rasterizer.getColor().data(), width, height, scratch)) {
+        return -1;
+    }
+    ImageDifference difference = compareImages(glPixels.data(), rasterizer.getColor().data(), width, height,
+                                               SOFTWARE_COMPARE_TOLERANCE);
+    double mismatch = static_cast<double>(difference.pixelsOverTolerance) / (static_cast<double>(width) * height);
+    std::printf("Software raster vs GL at %dx%d: max difference %d, mean %.3f, %.2f%% of pixels over %d\n", width,
+                height, difference.maxDifference, difference.meanDifference, mismatch * 100.0,
+                SOFTWARE_COMPARE_TOLERANCE);
+    std::cout << "Wrote " << prefix << "-gl.png and " << prefix << "-software.png" << std::endl;
+    return mismatch <= SOFTWARE_COMPARE_MAX_MISMATCH ? 0 : 1;
+}
+
+void addCrosshair(OverlayRenderer& overlay, int width, int height) {
+    // Arms reach a fifth of the way to the window edges
+    glm::vec2 center(width * 0.5f, height * 0.5f);
+    glm::vec2 arm(width * 0.1f, height * 0.1f);
+    const glm::vec4 white(1.0f);
+    overlay.addLine(center - glm::vec2(arm.x, 0.0f), center + glm::vec2(arm.x, 0.0f), 2.0f, white);
+    overlay.addLine(center - glm::vec2(0.0f, arm.y), center + glm::vec2(0.0f, arm.y), 2.0f, white);
+}
+
+void addHud(OverlayRenderer& overlay, const HudStats& stats) {
+    // Formatted into a fixed buffer, so the HUD does not allocate
+    char text[256];
+    int length = std::snprintf(text, sizeof(text),
+                               "%5.1f fps %6.2f ms\ncpu %6.2f ms\ngpu %6.2f ms\ndraws %d, %d tris\nchunks %d of %d",
+                               stats.frameMilliseconds > 0.0f ? 1000.0f / stats.frameMilliseconds : 0.0f,
+                               stats.frameMilliseconds, stats.cpuMilliseconds, stats.gpuMilliseconds, stats.drawCalls,
+                               stats.triangles, stats.drawnChunks, stats.residentChunks);
+    if (stats.renderScale > 0.0f && length > 0 && length < static_cast<int>(sizeof(text))) {
+        std::snprintf(text + length, sizeof(text) - length, "\nscale %.2f", stats.renderScale);
+    }
+
+    const int scale = 2;
+    const glm::vec2 origin(10.0f, 10.0f);
+    int textWidth, textHeight;
+    measureText(text, textWidth, textHeight);
+    glm::vec2 padding(6.0f);
+    overlay.addRect(origin - padding, origin + glm::vec2(textWidth, textHeight) * static_cast<float>(scale) + padding,
+                    glm::vec4(0.0f, 0.0f, 0.0f, 0.5f));
+    overlay.addText(origin, text, glm::vec4(1.0f, 1.0f, 0.6f, 1.0f), scale);
 }
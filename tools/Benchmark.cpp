@@ -0,0 +1,1550 @@
+// Headless benchmarks of the CPU-side systems; links only the GL-free core.
+// Usage: Rendering3DBench <benchmark> [options]
+#include "AgentSimulation.h"
+#include "AllocationTracker.h"
+#include "ChunkMesher.h"
+#include "ChunkVisibility.h"
+#include "DensityField.h"
+#include "FramePacer.h"
+#include "ImageWriter.h"
+#include "InputRecording.h"
+#include "Pathfinder.h"
+#include "PerlinNoise.h"
+#include "ResolutionController.h"
+#include "Session.h"
+#include "SimplexNoise.h"
+#include "SoftwareRasterizer.h"
+#include "SpatialHash.h"
+#include "StaticPerlinNoise.h"
+#include "Telemetry.h"
+#include "Terrain.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace {
+    using Clock = std::chrono::high_resolution_clock;
+
+    double secondsSince(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // Best of several runs, to keep scheduler noise out of the comparison
+    template<typename F>
+    double bestSeconds(int runs, F&& fn) {
+        double best = 1.0e30;
+        for (int i = 0; i < runs; i++) {
+            Clock::time_point start = Clock::now();
+            fn();
+            best = std::min(best, secondsSince(start));
+        }
+        return best;
+    }
+
+    // Reads "--name value" integer options, leaving the default when absent
+    int intOption(int argc, char** argv, const char* name, int defaultValue) {
+        for (int i = 2; i + 1 < argc; i++) {
+            if (std::strcmp(argv[i], name) == 0) {
+                return std::atoi(argv[i + 1]);
+            }
+        }
+        return defaultValue;
+    }
+
+    // Reads "--name value" string options
+    std::string stringOption(int argc, char** argv, const char* name, const std::string& defaultValue) {
+        for (int i = 2; i + 1 < argc; i++) {
+            if (std::strcmp(argv[i], name) == 0) {
+                return argv[i + 1];
+            }
+        }
+        return defaultValue;
+    }
+
+    // Density terrain: coarse-lattice interpolation vs. noise at every voxel
+    int benchDensity(int argc, char** argv) {
+        int sizeX = intOption(argc, argv, "--size", 128);
+        int sizeY = intOption(argc, argv, "--height", 64);
+        int sizeZ = sizeX;
+        int runs = intOption(argc, argv, "--runs", 3);
+
+        PerlinNoise noise(42);
+        DensitySettings settings;
+        settings.surfaceLevel = sizeY * 0.5f;
+        settings.surfaceRange = sizeY * 0.25f;
+        DensityField field(noise, noise, settings);
+
+        std::vector<uint8_t> perVoxel, lattice;
+        double perVoxelSeconds = bestSeconds(runs, [&] { field.fillPerVoxel(sizeX, sizeY, sizeZ, perVoxel); });
+        double latticeSeconds = bestSeconds(runs, [&] { field.fillLattice(sizeX, sizeY, sizeZ, lattice); });
+
+        size_t mismatched = 0, solid = 0;
+        for (size_t i = 0; i < perVoxel.size(); i++) {
+            mismatched += perVoxel[i] != lattice[i];
+            solid += perVoxel[i];
+        }
+
+        double voxels = static_cast<double>(sizeX) * sizeY * sizeZ;
+        std::printf("density field %dx%dx%d, %d octaves, lattice spacing %d, best of %d\n",
+                    sizeX, sizeY, sizeZ, settings.octaves, DensityField::LATTICE_SPACING, runs);
+        std::printf("%-12s %12s %16s\n", "method", "ms", "voxels/sec");
+        std::printf("%-12s %12.2f %16.0f\n", "per-voxel", perVoxelSeconds * 1000.0, voxels / perVoxelSeconds);
+        std::printf("%-12s %12.2f %16.0f\n", "lattice", latticeSeconds * 1000.0, voxels / latticeSeconds);
+        std::printf("speedup %.1fx, %.2f%% of voxels differ (%.1f%% solid)\n", perVoxelSeconds / latticeSeconds,
+                    100.0 * mismatched / voxels, 100.0 * solid / voxels);
+        return 0;
+    }
+
+    // Hash of noise quantized to 1/65536 over a fixed set of points; constexpr so
+    // fixed-seed noise can be pinned at compile time as well as at run time
+    template<typename Noise>
+    constexpr uint32_t hashNoise2D(const Noise& noise) {
+        uint32_t hash = 2166136261u;
+        for (int i = 0; i < 64; i++) {
+            float x = (i % 8) * 0.73f - 2.9f;
+            float y = (i / 8) * 1.31f + 0.17f;
+            uint32_t value = static_cast<uint32_t>(static_cast<int32_t>(noise.octaveNoise(x, y, 0.5f, 2.0f) * 65536.0f));
+            for (int byte = 0; byte < 4; byte++) {
+                hash = (hash ^ ((value >> (byte * 8)) & 255u)) * 16777619u;
+            }
+        }
+        return hash;
+    }
+
+    template<typename Noise>
+    uint32_t hashNoise3D(const Noise& noise) {
+        uint32_t hash = 2166136261u;
+        for (int i = 0; i < 512; i++) {
+            float x = (i % 8) * 0.73f - 2.9f;
+            float y = (i / 8 % 8) * 1.31f + 0.17f;
+            float z = (i / 64) * 0.59f - 40.3f;
+            uint32_t value = static_cast<uint32_t>(static_cast<int32_t>(noise.octaveNoise(x, y, z, 0.5f, 2.0f) * 65536.0f));
+            for (int byte = 0; byte < 4; byte++) {
+                hash = (hash ^ ((value >> (byte * 8)) & 255u)) * 16777619u;
+            }
+        }
+        return hash;
+    }
+
+    // PerlinNoise with runtime octaves, behind the same interface as StaticPerlinNoise
+    struct DynamicOctaves {
+        const PerlinNoise& noise;
+        int octaves;
+        float octaveNoise(float x, float y, float persistence, float lacunarity) const {
+            return noise.octaveNoise(x, y, octaves, persistence, lacunarity);
+        }
+        float octaveNoise(float x, float y, float z, float persistence, float lacunarity) const {
+            return noise.octaveNoise(x, y, z, octaves, persistence, lacunarity);
+        }
+    };
+
+    // Pinned worlds: a change to the PRNG, the shuffle or the noise math changes these
+    const uint32_t PINNED_NOISE_2D = 0x7fb82e6d;  // 4 octaves, seed 42
+    const uint32_t PINNED_NOISE_3D = 0xd565ecb0;
+    static_assert(hashPermutationTable(makePermutationTable(0)) == 0xf7f02251, "seed 0 table changed");
+    static_assert(hashPermutationTable(makePermutationTable(42)) == 0xcafb92ad, "seed 42 table changed");
+    static_assert(hashNoise2D(StaticPerlinNoise<4, FixedSeed<42>>()) == PINNED_NOISE_2D, "seed 42 noise changed");
+
+    template<typename Noise>
+    double noiseSamplesPerSecond(const Noise& noise, int dimensions, int samples, float& checksum) {
+        Clock::time_point start = Clock::now();
+        float sum = 0.0f;
+        for (int i = 0; i < samples; i++) {
+            float x = (i & 1023) * 0.0137f;
+            float y = (i >> 10) * 0.0171f;
+            sum += dimensions == 2 ? noise.octaveNoise(x, y, 0.5f, 2.0f) : noise.octaveNoise(x, y, x * 0.5f, 0.5f, 2.0f);
+        }
+        checksum += sum;
+        return samples / secondsSince(start);
+    }
+
+    // PerlinNoise vs. StaticPerlinNoise: identical output, then speed at 6 octaves
+    int benchNoise(int argc, char** argv) {
+        int samples = intOption(argc, argv, "--samples", 1 << 22);
+        const int octaves = 6;
+
+        PerlinNoise dynamicNoise(42);
+        DynamicOctaves dynamicOctaves{dynamicNoise, octaves};
+        StaticPerlinNoise<octaves, FixedSeed<42>> fixedNoise;
+        StaticPerlinNoise<octaves, RuntimeSeed> runtimeNoise(42);
+
+        // Pinned hashes at run time; the compile-time ones are the static_asserts above
+        bool ok = true;
+        DynamicOctaves fourOctaves{dynamicNoise, 4};
+        uint32_t hash2D = hashNoise2D(fourOctaves);
+        uint32_t hash3D = hashNoise3D(fourOctaves);
+        std::printf("pinned 2D hash %08x %s\n", hash2D, hash2D == PINNED_NOISE_2D ? "ok" : "MISMATCH");
+        std::printf("pinned 3D hash %08x %s\n", hash3D, hash3D == PINNED_NOISE_3D ? "ok" : "MISMATCH");
+        ok = ok && hash2D == PINNED_NOISE_2D && hash3D == PINNED_NOISE_3D;
+
+        // Every implementation must agree bit for bit
+        for (int dimensions = 2; dimensions <= 3; dimensions++) {
+            uint32_t reference = dimensions == 2 ? hashNoise2D(dynamicOctaves) : hashNoise3D(dynamicOctaves);
+            uint32_t fixedHash = dimensions == 2 ? hashNoise2D(fixedNoise) : hashNoise3D(fixedNoise);
+            uint32_t runtimeHash = dimensions == 2 ? hashNoise2D(runtimeNoise) : hashNoise3D(runtimeNoise);
+            bool match = reference == fixedHash && reference == runtimeHash;
+            std::printf("%dD output identical: %s\n", dimensions, match ? "yes" : "NO");
+            ok = ok && match;
+        }
+
+        float checksum = 0.0f;
+        std::printf("%d octaves, %d samples\n", octaves, samples);
+        std::printf("%-4s %-26s %14s %8s\n", "dims", "implementation", "samples/sec", "speedup");
+        for (int dimensions = 2; dimensions <= 3; dimensions++) {
+            double base = noiseSamplesPerSecond(dynamicOctaves, dimensions, samples, checksum);
+            double fixedRate = noiseSamplesPerSecond(fixedNoise, dimensions, samples, checksum);
+            double runtimeRate = noiseSamplesPerSecond(runtimeNoise, dimensions, samples, checksum);
+            std::printf("%-4d %-26s %14.0f %8s\n", dimensions, "PerlinNoise", base, "1.00x");
+            std::printf("%-4d %-26s %14.0f %7.2fx\n", dimensions, "StaticPerlinNoise fixed", fixedRate, fixedRate / base);
+            std::printf("%-4d %-26s %14.0f %7.2fx\n", dimensions, "StaticPerlinNoise runtime", runtimeRate, runtimeRate / base);
+        }
+        std::printf("checksum %f\n", checksum);
+        return ok ? 0 : 1;
+    }
+
+    // Octave noise through the scalar or the batch path of a backend
+    double backendSamplesPerSecond(const NoiseGenerator& noise, int dimensions, bool batch, int octaves,
+                                   const std::vector<float>& xs, const std::vector<float>& ys,
+                                   const std::vector<float>& zs, std::vector<float>& out) {
+        int count = static_cast<int>(xs.size());
+        double seconds = bestSeconds(3, [&] {
+            if (batch && dimensions == 2) {
+                noise.octaveNoise(xs.data(), ys.data(), out.data(), count, octaves, 0.5f, 2.0f);
+            } else if (batch) {
+                noise.octaveNoise(xs.data(), ys.data(), zs.data(), out.data(), count, octaves, 0.5f, 2.0f);
+            } else {
+                for (int i = 0; i < count; i++) {
+                    out[i] = dimensions == 2 ? noise.octaveNoise(xs[i], ys[i], octaves, 0.5f, 2.0f)
+                                             : noise.octaveNoise(xs[i], ys[i], zs[i], octaves, 0.5f, 2.0f);
+                }
+            }
+        });
+        return count / seconds;
+    }
+
+    // Perlin vs. simplex noise, scalar and batch, at equal octave counts
+    int benchBackends(int argc, char** argv) {
+        int samples = intOption(argc, argv, "--samples", 1 << 20);
+
+        PerlinNoise perlin(42);
+        SimplexNoise simplex(42);
+        struct Backend {
+            const char* name;
+            const NoiseGenerator& noise;
+        };
+        const Backend backends[] = {{"perlin", perlin}, {"simplex", simplex}};
+
+        std::vector<float> xs(samples), ys(samples), zs(samples), out(samples);
+        for (int i = 0; i < samples; i++) {
+            xs[i] = (i & 1023) * 0.0137f;
+            ys[i] = (i >> 10) * 0.0171f;
+            zs[i] = xs[i] * 0.5f + 3.1f;
+        }
+
+        std::printf("%d samples per run, best of 3\n", samples);
+        std::printf("%-4s %-8s %-8s %14s %14s %10s\n", "dims", "octaves", "backend", "scalar/sec", "batch/sec", "vs perlin");
+        for (int dimensions = 2; dimensions <= 3; dimensions++) {
+            for (int octaves : {1, 4, 6}) {
+                double perlinRate = 0.0;
+                for (const Backend& backend : backends) {
+                    double scalarRate = backendSamplesPerSecond(backend.noise, dimensions, false, octaves, xs, ys, zs, out);
+                    double batchRate = backendSamplesPerSecond(backend.noise, dimensions, true, octaves, xs, ys, zs, out);
+                    double best = std::max(scalarRate, batchRate);
+                    if (perlinRate == 0.0) {
+                        perlinRate = best;
+                    }
+                    std::printf("%-4d %-8d %-8s %14.0f %14.0f %9.2fx\n", dimensions, octaves, backend.name,
+                                scalarRate, batchRate, best / perlinRate);
+                }
+            }
+        }
+        return 0;
+    }
+
+    // Agent simulation: ms per 60 Hz tick on the calling thread vs. the job system
+    int benchAgents(int argc, char** argv) {
+        int agentCount = intOption(argc, argv, "--agents", 10000);
+        int ticks = intOption(argc, argv, "--ticks", 600);
+        int size = intOption(argc, argv, "--size", 256);
+        int threads = intOption(argc, argv, "--threads", 0);
+        const float tickSeconds = 1.0f / 60.0f;
+
+        Terrain terrain(size, size, 20.0f);
+        terrain.setHeightMultiplier(8.0f);
+        terrain.setOctaves(6);
+        terrain.generate();
+
+        JobSystem jobs(threads);
+        std::printf("%d agents on a %dx%d world, %d ticks at 60 Hz\n", agentCount, size, size, ticks);
+        std::printf("%-8s %10s %12s %10s %10s\n", "threads", "ms/tick", "agents/sec", "budget", "airborne");
+
+        double serialMs = 0.0;
+        for (bool parallel : {false, true}) {
+            // Same seed both runs, so both simulate the same walk
+            AgentSimulation agents(terrain, jobs);
+            agents.spawnRandom(agentCount, 7);
+            if (!parallel) {
+                agents.setBatchSize(agentCount);
+            }
+
+            Clock::time_point start = Clock::now();
+            for (int i = 0; i < ticks; i++) {
+                agents.update(tickSeconds);
+            }
+            double ms = secondsSince(start) * 1000.0 / ticks;
+            if (!parallel) {
+                serialMs = ms;
+            }
+
+            int airborne = 0;
+            for (int i = 0; i < agents.getAgentCount(); i++) {
+                airborne += (agents.getFlags(i) & AGENT_ON_GROUND) ? 0 : 1;
+            }
+            std::printf("%-8u %10.3f %12.0f %9.0f%% %10d\n", parallel ? jobs.getConcurrency() : 1u, ms,
+                        agentCount * 1000.0 / ms, ms / (tickSeconds * 1000.0) * 100.0, airborne);
+            if (parallel) {
+                std::printf("speedup %.2fx\n", serialMs / ms);
+            }
+        }
+        return 0;
+    }
+
+    // Touching pairs by testing every pair of bodies, the reference for the broadphase
+    int naiveContacts(const std::vector<float>& xs, const std::vector<float>& ys, const std::vector<float>& zs,
+                      float radius, float height) {
+        int contacts = 0;
+        int count = static_cast<int>(xs.size());
+        for (int a = 0; a < count; a++) {
+            glm::vec3 feetA(xs[a], ys[a], zs[a]);
+            for (int b = a + 1; b < count; b++) {
+                contacts += SpatialHash::cylindersOverlap(feetA, radius, height, glm::vec3(xs[b], ys[b], zs[b]),
+                                                          radius, height) ? 1 : 0;
+            }
+        }
+        return contacts;
+    }
+
+    // Spatial hash: build + pairs + narrowphase per body as the count doubles, at a
+    // fixed crowd density, against all-pairs testing for the smaller counts
+    int benchBroadphase(int argc, char** argv) {
+        int maxBodies = intOption(argc, argv, "--max", 256000);
+        int naiveLimit = intOption(argc, argv, "--naive", 16000);
+        const float radius = 0.3f;
+        const float height = 1.8f;
+        const float density = 0.5f;  // bodies per square block
+
+        std::printf("%d bodies per 100 square blocks, radius %.1f, height %.1f\n",
+                    static_cast<int>(density * 100), radius, height);
+        std::printf("%-8s %10s %10s %10s %10s %9s %10s %12s\n", "bodies", "build ms", "pairs ms", "ns/body",
+                    "contacts", "queries", "naive ms", "naive check");
+
+        for (int count = 1000; count <= maxBodies; count *= 2) {
+            float side = std::sqrt(count / density);
+            std::vector<float> xs(count), ys(count), zs(count);
+            uint32_t state = 12345;
+            auto unit = [&state]() {
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+                return (state >> 8) * (1.0f / 16777216.0f);
+            };
+            for (int i = 0; i < count; i++) {
+                xs[i] = (unit() - 0.5f) * side;
+                zs[i] = (unit() - 0.5f) * side;
+                ys[i] = std::floor(unit() * 4.0f);
+            }
+
+            SpatialHash hash;
+            std::vector<BodyPair> pairs;
+            int contacts = 0;
+            double buildSeconds = bestSeconds(3, [&] { hash.build(xs.data(), ys.data(), zs.data(), count, radius, height); });
+            double pairSeconds = bestSeconds(3, [&] {
+                pairs.clear();
+                hash.findPairs(pairs);
+                contacts = 0;
+                for (const BodyPair& pair : pairs) {
+                    contacts += SpatialHash::cylindersOverlap(glm::vec3(xs[pair.a], ys[pair.a], zs[pair.a]), radius, height,
+                                                              glm::vec3(xs[pair.b], ys[pair.b], zs[pair.b]), radius, height) ? 1 : 0;
+                }
+            });
+
+            // Neighbourhood queries of a player-sized cylinder and a 4 block radius
+            std::vector<int> found;
+            size_t queryHits = 0;
+            for (int i = 0; i < 1000; i++) {
+                glm::vec3 point(xs[i % count], ys[i % count], zs[i % count]);
+                found.clear();
+                hash.queryCylinder(point, radius, height, found);
+                hash.queryRadius(point, 4.0f, found);
+                queryHits += found.size();
+            }
+
+            double ns = (buildSeconds + pairSeconds) * 1.0e9 / count;
+            if (count <= naiveLimit) {
+                int naive = 0;
+                double naiveSeconds = bestSeconds(1, [&] { naive = naiveContacts(xs, ys, zs, radius, height); });
+                std::printf("%-8d %10.3f %10.3f %10.1f %10d %9zu %10.1f %12s\n", count, buildSeconds * 1000.0,
+                            pairSeconds * 1000.0, ns, contacts, queryHits, naiveSeconds * 1000.0,
+                            naive == contacts ? "match" : "MISMATCH");
+                if (naive != contacts) {
+                    return 1;
+                }
+            } else {
+                std::printf("%-8d %10.3f %10.3f %10.1f %10d %9zu %10s %12s\n", count, buildSeconds * 1000.0,
+                            pairSeconds * 1000.0, ns, contacts, queryHits, "-", "-");
+            }
+        }
+        return 0;
+    }
+
+    // Scripted player input: walks in changing directions, looks around, jumps and
+    // digs now and then. Used when no recording is given.
+    void scriptRecording(InputRecording& recording, int ticks) {
+        uint32_t state = 2024;
+        InputState input;
+        for (int tick = 0; tick < ticks; tick++) {
+            if (tick % 30 == 0) {
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+                const uint8_t moves[] = {INPUT_FORWARD, INPUT_FORWARD | INPUT_LEFT, INPUT_FORWARD | INPUT_RIGHT,
+                                         INPUT_BACK, 0};
+                input.buttons = moves[state % 5];
+                input.mouseX = static_cast<int16_t>(static_cast<int>(state >> 8) % 161 - 80);
+                input.mouseY = static_cast<int16_t>(static_cast<int>(state >> 16) % 41 - 20);
+            }
+            InputState tickInput = input;
+            if (tick % 90 == 45) {
+                tickInput.buttons |= INPUT_JUMP;
+            }
+            if (tick % 240 == 120) {
+                tickInput.buttons |= INPUT_BREAK;
+            }
+            recording.addTick(tickInput);
+        }
+    }
+
+    // Headless replay at the recording's fixed timestep. Returns the final player checksum.
+    uint32_t replaySession(const InputRecording& recording, JobSystem& jobs, double& worstTickMs, double& totalMs) {
+        Camera camera(glm::vec3(0.0f, 1.5f, 3.0f));
+        Session session(recording.getOptions(), camera, jobs);
+        worstTickMs = 0.0;
+        Clock::time_point start = Clock::now();
+        for (int tick = 0; tick < recording.getTickCount(); tick++) {
+            Clock::time_point tickStart = Clock::now();
+            session.tick(recording.getTick(tick), recording.getTickSeconds());
+            worstTickMs = std::max(worstTickMs, secondsSince(tickStart) * 1000.0);
+        }
+        totalMs = secondsSince(start) * 1000.0;
+        return session.getPlayerChecksum();
+    }
+
+    // Input replay: runs a recorded (or scripted) session several times without a
+    // window and checks every run ends in the same player state
+    int benchReplay(int argc, char** argv) {
+        std::string inputPath = stringOption(argc, argv, "--input", "");
+        std::string savePath = stringOption(argc, argv, "--save", "");
+        int runs = intOption(argc, argv, "--runs", 3);
+        JobSystem jobs;
+
+        InputRecording recording;
+        double worstMs = 0.0, totalMs = 0.0;
+        if (!inputPath.empty()) {
+            if (!recording.load(inputPath)) {
+                return 1;
+            }
+        } else {
+            SessionOptions options;
+            options.agents = intOption(argc, argv, "--agents", 0);
+            recording.setOptions(options);
+            scriptRecording(recording, intOption(argc, argv, "--ticks", 3600));
+            recording.setFinalChecksum(replaySession(recording, jobs, worstMs, totalMs));
+            if (!savePath.empty() && !recording.save(savePath)) {
+                return 1;
+            }
+        }
+
+        std::printf("%d ticks at %d Hz, %d agents, expected checksum %08x\n", recording.getTickCount(),
+                    recording.getTickRate(), recording.getOptions().agents, recording.getFinalChecksum());
+        std::printf("%-4s %10s %10s %10s %10s\n", "run", "total ms", "ms/tick", "worst ms", "checksum");
+        bool drift = false;
+        for (int run = 0; run < runs; run++) {
+            uint32_t checksum = replaySession(recording, jobs, worstMs, totalMs);
+            bool matches = checksum == recording.getFinalChecksum();
+            drift = drift || !matches;
+            std::printf("%-4d %10.1f %10.4f %10.3f   %08x %s\n", run, totalMs,
+                        totalMs / std::max(recording.getTickCount(), 1), worstMs, checksum,
+                        matches ? "match" : "DRIFT");
+        }
+        return drift ? 1 : 0;
+    }
+
+    // Heap allocations of headless session ticks: after a warmup the steady-state
+    // loop must not allocate, so this fails when any measured tick does
+    int benchAllocations(int argc, char** argv) {
+        int ticks = intOption(argc, argv, "--ticks", 600);
+        int warmup = intOption(argc, argv, "--warmup", 120);
+        JobSystem jobs;
+
+        InputRecording recording;
+        SessionOptions options;
+        options.agents = intOption(argc, argv, "--agents", 2000);
+        recording.setOptions(options);
+        scriptRecording(recording, warmup + ticks);
+
+        Camera camera(glm::vec3(0.0f, 1.5f, 3.0f));
+        Session session(recording.getOptions(), camera, jobs);
+        AllocationCounts totals[ALLOC_SUBSYSTEM_COUNT];
+        int allocatingTicks = 0;
+        for (int tick = 0; tick < warmup + ticks; tick++) {
+            AllocationTracker::beginFrame();
+            session.tick(recording.getTick(tick), recording.getTickSeconds());
+            if (tick < warmup) {
+                continue;
+            }
+            if (AllocationTracker::getFrameTotal().allocations > 0) {
+                allocatingTicks++;
+            }
+            for (int i = 0; i < ALLOC_SUBSYSTEM_COUNT; i++) {
+                AllocationCounts counts = AllocationTracker::getFrameCounts(static_cast<AllocationSubsystem>(i));
+                totals[i].allocations += counts.allocations;
+                totals[i].bytes += counts.bytes;
+            }
+        }
+
+        std::printf("%d ticks after %d warmup, %d agents\n", ticks, warmup, options.agents);
+        std::printf("%-10s %12s %12s %14s\n", "subsystem", "allocs", "bytes", "allocs/tick");
+        for (int i = 0; i < ALLOC_SUBSYSTEM_COUNT; i++) {
+            std::printf("%-10s %12llu %12llu %14.3f\n", AllocationTracker::getSubsystemName(static_cast<AllocationSubsystem>(i)),
+                        static_cast<unsigned long long>(totals[i].allocations),
+                        static_cast<unsigned long long>(totals[i].bytes),
+                        static_cast<double>(totals[i].allocations) / std::max(ticks, 1));
+        }
+        std::printf("%d of %d ticks allocated: %s\n", allocatingTicks, ticks, allocatingTicks == 0 ? "ok" : "FAIL");
+        return allocatingTicks == 0 ? 0 : 1;
+    }
+
+    // Surface queries: one getHeightAt per point against batched querySurface,
+    // checking the batch against the same query made one point at a time
+    int benchSurface(int argc, char** argv) {
+        int count = intOption(argc, argv, "--points", 1 << 20);
+        int size = intOption(argc, argv, "--size", 256);
+        int runs = intOption(argc, argv, "--runs", 3);
+
+        Terrain terrain(size, size, 20.0f);
+        terrain.setHeightMultiplier(8.0f);
+        terrain.setOctaves(6);
+        terrain.generate();
+
+        // Points spread a little past the world edge, so some fall outside
+        std::vector<float> xs(count), zs(count);
+        uint32_t state = 12345;
+        auto unit = [&state]() {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return (state >> 8) * (1.0f / 16777216.0f);
+        };
+        float span = size + 16.0f;
+        for (int i = 0; i < count; i++) {
+            xs[i] = (unit() - 0.5f) * span;
+            zs[i] = (unit() - 0.5f) * span;
+        }
+
+        std::vector<float> heights(count), reference(count);
+        std::vector<glm::vec3> normals(count);
+        std::vector<uint8_t> blocks(count);
+        double singleSeconds = bestSeconds(runs, [&] {
+            for (int i = 0; i < count; i++) {
+                reference[i] = terrain.getHeightAt(xs[i], zs[i]);
+            }
+        });
+        double nearestSeconds = bestSeconds(runs, [&] {
+            terrain.querySurface(xs.data(), zs.data(), count, HEIGHT_NEAREST, heights.data(), nullptr, nullptr);
+        });
+        int heightMismatches = 0;
+        for (int i = 0; i < count; i++) {
+            heightMismatches += heights[i] != reference[i];
+        }
+
+        std::printf("%d points on a %dx%d world\n", count, size, size);
+        std::printf("%-28s %10s %10s %10s\n", "query", "ms", "ns/point", "mismatch");
+        std::printf("%-28s %10.2f %10.2f %10s\n", "getHeightAt per point", singleSeconds * 1000.0,
+                    singleSeconds * 1.0e9 / count, "-");
+        std::printf("%-28s %10.2f %10.2f %10d\n", "batch nearest height", nearestSeconds * 1000.0,
+                    nearestSeconds * 1.0e9 / count, heightMismatches);
+
+        const HeightSampling samplings[] = {HEIGHT_NEAREST, HEIGHT_BILINEAR};
+        const char* names[] = {"batch nearest full", "batch bilinear full"};
+        int totalMismatches = heightMismatches;
+        for (int mode = 0; mode < 2; mode++) {
+            double seconds = bestSeconds(runs, [&] {
+                terrain.querySurface(xs.data(), zs.data(), count, samplings[mode], heights.data(), normals.data(),
+                                     blocks.data());
+            });
+            // A single point always takes the scalar path
+            int mismatches = 0;
+            for (int i = 0; i < count; i++) {
+                float height;
+                glm::vec3 normal;
+                uint8_t block;
+                terrain.querySurface(&xs[i], &zs[i], 1, samplings[mode], &height, &normal, &block);
+                mismatches += height != heights[i] || normal != normals[i] || block != blocks[i];
+            }
+            totalMismatches += mismatches;
+            std::printf("%-28s %10.2f %10.2f %10d\n", names[mode], seconds * 1000.0, seconds * 1.0e9 / count,
+                        mismatches);
+        }
+        std::printf("speedup of batch nearest height %.2fx\n", singleSeconds / std::max(nearestSeconds, 1.0e-12));
+        return totalMismatches == 0 ? 0 : 1;
+    }
+
+    // Telemetry publishing cost per frame, and a reader check that the ring
+    // hands back the last frames intact
+    int benchTelemetry(int argc, char** argv) {
+        int frames = intOption(argc, argv, "--frames", 1000000);
+        std::string name = stringOption(argc, argv, "--name", "/rendering3d-telemetry-bench");
+
+        TelemetryPublisher publisher;
+        TelemetryReader reader;
+        if (!publisher.open(name) || !reader.open(name)) {
+            return 1;
+        }
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < frames; i++) {
+            publisher.setCounter(TELEMETRY_DRAW_CALLS, static_cast<uint32_t>(i));
+            publisher.addCounter(TELEMETRY_TRIANGLES, static_cast<uint32_t>(i) * 3u);
+            publisher.publishFrame(static_cast<float>(i % 40), 1.0f);
+        }
+        double seconds = secondsSince(start);
+
+        std::vector<TelemetryFrame> read;
+        uint64_t cursor = reader.readFrames(0, read);
+        int bad = 0;
+        for (size_t i = 0; i < read.size(); i++) {
+            uint64_t expected = cursor - read.size() + i;
+            bad += read[i].frame != expected || read[i].counters[TELEMETRY_DRAW_CALLS] != expected ||
+                   read[i].counters[TELEMETRY_TRIANGLES] != static_cast<uint32_t>(expected) * 3u;
+        }
+        uint64_t buckets[TELEMETRY_HISTOGRAM_BUCKETS];
+        reader.readHistogram(buckets);
+        uint64_t histogramFrames = 0;
+        for (uint64_t count : buckets) {
+            histogramFrames += count;
+        }
+        publisher.close();
+
+        bool ok = bad == 0 && read.size() == static_cast<size_t>(std::min(frames, TELEMETRY_RING_FRAMES)) &&
+                  histogramFrames == static_cast<uint64_t>(frames) && reader.isClosed();
+        std::printf("%d frames published: %.1f ns/frame\n", frames, seconds * 1.0e9 / std::max(frames, 1));
+        std::printf("reader got %zu frames (%d bad), histogram holds %llu, closed %s: %s\n", read.size(), bad,
+                    static_cast<unsigned long long>(histogramFrames), reader.isClosed() ? "yes" : "no",
+                    ok ? "ok" : "FAIL");
+        return ok ? 0 : 1;
+    }
+
+    // Dynamic resolution against a simulated GPU: a fixed cost plus a per-pixel
+    // cost that jumps during a load spike, with samples arriving a few frames late
+    int benchResolution(int argc, char** argv) {
+        const int latency = 4;  // as Profiler::QUERY_LATENCY
+        ResolutionSettings settings;
+        settings.targetMilliseconds = 16.6f;
+        settings.minScale = 0.5f;
+        float fixedMilliseconds = 2.0f;
+        float pixelMilliseconds = intOption(argc, argv, "--pixel-ms", 20);  // at scale 1
+        float spike = intOption(argc, argv, "--spike", 200) / 100.0f;       // per-pixel cost factor
+
+        struct Phase {
+            const char* name;
+            int frames;
+            float pixelFactor;
+        };
+        const Phase phases[] = {{"normal", 300, 1.0f}, {"spike", 300, spike}, {"recovered", 300, 1.0f}};
+
+        ResolutionController controller(settings);
+        std::vector<float> gpuTimes;
+        long long frame = 0;
+        int over = 0;
+        std::printf("target %.1f ms, scale %.2f-%.2f, GPU %.1f ms + %.1f ms per full-size frame, %d frames latency\n",
+                    settings.targetMilliseconds, settings.minScale, settings.maxScale, fixedMilliseconds,
+                    pixelMilliseconds, latency);
+        std::printf("%-10s %10s %10s %10s %10s %10s %12s\n", "phase", "scale", "min scale", "gpu ms", "p99 ms",
+                    "over", "settled over");
+        for (const Phase& phase : phases) {
+            std::vector<float> phaseTimes;
+            float scaleSum = 0.0f, minScale = 1.0f;
+            int phaseOver = 0, settledOver = 0;
+            for (int i = 0; i < phase.frames; i++, frame++) {
+                long long sampleFrame = frame - latency;
+                float sample = sampleFrame >= 0 ? gpuTimes[static_cast<size_t>(sampleFrame)] : 0.0f;
+                float scale = controller.update(frame, sample, sampleFrame);
+                float gpu = fixedMilliseconds + pixelMilliseconds * phase.pixelFactor * scale * scale;
+                gpuTimes.push_back(gpu);
+                phaseTimes.push_back(gpu);
+                scaleSum += scale;
+                minScale = std::min(minScale, scale);
+                bool isOver = gpu > settings.targetMilliseconds;
+                phaseOver += isOver;
+                // The first frames of a phase react to the change; after that it should
+                // hold, unless the minimum scale is still too expensive
+                settledOver += isOver && i >= 30 && scale > settings.minScale;
+            }
+            std::vector<float> sorted = phaseTimes;
+            std::sort(sorted.begin(), sorted.end());
+            float p99 = sorted[static_cast<size_t>(0.99 * (sorted.size() - 1))];
+            std::printf("%-10s %10.3f %10.3f %10.2f %10.2f %10d %12d\n", phase.name, scaleSum / phase.frames, minScale,
+                        std::accumulate(phaseTimes.begin(), phaseTimes.end(), 0.0f) / phase.frames, p99, phaseOver,
+                        settledOver);
+            over += settledOver;
+        }
+        std::printf("settled frames over target: %d (%s)\n", over, over == 0 ? "ok" : "FAIL");
+        return over == 0 ? 0 : 1;
+    }
+
+    // Encoding cost of captured frames, which the capture writer thread has to
+    // keep up with, and a size check of what it wrote
+    int benchCapture(int argc, char** argv) {
+        int width = intOption(argc, argv, "--width", 1280);
+        int height = intOption(argc, argv, "--height", 720);
+        int frames = intOption(argc, argv, "--frames", 30);
+        std::string prefix = stringOption(argc, argv, "--output", "/tmp/rendering3d-capture");
+
+        // A gradient with some noise, as glReadPixels would return it
+        std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+        uint32_t state = 1;
+        for (size_t i = 0; i < pixels.size(); i += 4) {
+            state = state * 1664525u + 1013904223u;
+            size_t pixel = i / 4;
+            pixels[i] = static_cast<uint8_t>(pixel % width * 255 / std::max(width - 1, 1));
+            pixels[i + 1] = static_cast<uint8_t>(pixel / width * 255 / std::max(height - 1, 1));
+            pixels[i + 2] = static_cast<uint8_t>(state >> 24);
+            pixels[i + 3] = 255;
+        }
+
+        std::string pngPath = prefix + ".png";
+        std::vector<uint8_t> scratch;
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < frames; i++) {
+            if (!writePng(pngPath, pixels.data(), width, height, scratch)) {
+                return 1;
+            }
+        }
+        double pngMilliseconds = secondsSince(start) * 1000.0 / std::max(frames, 1);
+
+        std::string videoPath = prefix + ".y4m";
+        Y4mWriter video;
+        if (!video.open(videoPath, width, height, 60)) {
+            return 1;
+        }
+        start = Clock::now();
+        for (int i = 0; i < frames; i++) {
+            video.writeFrame(pixels.data());
+        }
+        bool closed = video.close();
+        double videoMilliseconds = secondsSince(start) * 1000.0 / std::max(frames, 1);
+
+        // Stored deflate: 5 bytes per 64 KB block on top of the raw rows
+        auto fileSize = [](const std::string& path) {
+            std::ifstream file(path, std::ios::binary | std::ios::ate);
+            return file ? static_cast<long long>(file.tellg()) : -1LL;
+        };
+        long long raw = static_cast<long long>(width * 3 + 1) * height;
+        long long expectedPng = 8 + 25 + 12 + 2 + raw + (raw + 65534) / 65535 * 5 + 4 + 12;
+        std::string videoHeader = "YUV4MPEG2 W" + std::to_string(width) + " H" + std::to_string(height) +
+                                  " F60:1 Ip A1:1 C420jpeg\n";
+        long long chroma = static_cast<long long>((width + 1) / 2) * ((height + 1) / 2);
+        long long expectedVideo = static_cast<long long>(videoHeader.size()) +
+                                  frames * (6 + static_cast<long long>(width) * height + 2 * chroma);
+        bool ok = closed && fileSize(pngPath) == expectedPng && fileSize(videoPath) == expectedVideo;
+
+        std::printf("%dx%d, %d frames\n", width, height, frames);
+        std::printf("png: %.2f ms/frame (%.0f fps), %lld bytes\n", pngMilliseconds, 1000.0 / pngMilliseconds,
+                    fileSize(pngPath));
+        std::printf("y4m: %.2f ms/frame (%.0f fps), %lld bytes\n", videoMilliseconds, 1000.0 / videoMilliseconds,
+                    fileSize(videoPath));
+        std::printf("output sizes: %s\n", ok ? "ok" : "FAIL");
+        return ok ? 0 : 1;
+    }
+
+    // Frame pacing with simulated frame work: plain sleeping against FramePacer,
+    // by how far each frame interval lands from the target period
+    int benchPacing(int argc, char** argv) {
+        double fps = intOption(argc, argv, "--fps", 60);
+        int frames = intOption(argc, argv, "--frames", 300);
+        double workMilliseconds = intOption(argc, argv, "--work-us", 4000) / 1000.0;
+        double periodMilliseconds = 1000.0 / fps;
+
+        // Busy work of varying length, like frames of a varying scene
+        auto work = [&](int frame) {
+            double length = workMilliseconds * (0.5 + (frame * 7919 % 100) / 100.0);
+            Clock::time_point start = Clock::now();
+            while (secondsSince(start) * 1000.0 < length) {
+            }
+        };
+
+        struct Result {
+            double meanError, medianError, p99Error, maxError;
+        };
+        auto measure = [&](auto&& waitForFrame) {
+            std::vector<double> errors;
+            Clock::time_point last = Clock::now();
+            for (int i = 0; i < frames; i++) {
+                work(i);
+                waitForFrame();
+                Clock::time_point now = Clock::now();
+                errors.push_back(std::abs(std::chrono::duration<double, std::milli>(now - last).count() -
+                                          periodMilliseconds));
+                last = now;
+            }
+            // The first interval starts before the schedule does
+            errors.erase(errors.begin());
+            std::vector<double> sorted = errors;
+            std::sort(sorted.begin(), sorted.end());
+            return Result{std::accumulate(errors.begin(), errors.end(), 0.0) / errors.size(), sorted[sorted.size() / 2],
+                          sorted[static_cast<size_t>(0.99 * (sorted.size() - 1))], sorted.back()};
+        };
+
+        Clock::time_point deadline = Clock::now();
+        const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fps));
+        Result sleeping = measure([&] {
+            deadline += period;
+            std::this_thread::sleep_until(deadline);
+        });
+
+        FramePacer pacer(fps);
+        Result paced = measure([&] { pacer.wait(); });
+
+        std::printf("%.0f fps (%.3f ms), %d frames, %.1f ms average work\n", fps, periodMilliseconds, frames,
+                    workMilliseconds);
+        std::printf("%-8s %12s %12s %12s %12s %14s\n", "wait", "mean err ms", "p50 err ms", "p99 err ms",
+                    "max err ms", "spin ms/frame");
+        std::printf("%-8s %12.3f %12.3f %12.3f %12.3f %14s\n", "sleep", sleeping.meanError, sleeping.medianError,
+                    sleeping.p99Error, sleeping.maxError, "-");
+        std::printf("%-8s %12.3f %12.3f %12.3f %12.3f %14.3f\n", "pacer", paced.meanError, paced.medianError,
+                    paced.p99Error, paced.maxError, pacer.getSpinMilliseconds() / frames);
+        std::printf("spin margin settled at %.3f ms\n", pacer.getSpinMarginMilliseconds());
+        return 0;
+    }
+
+    // One camera of the culling benchmark
+    struct CullingView {
+        glm::vec3 eye;
+        glm::mat4 view;
+        glm::mat4 viewProjection;
+    };
+
+    // Chunks hit by rays through the frustum that are missing from the visible set
+    int countMissedChunks(const Terrain& terrain, const ChunkVisibility& visibility, const CullingView& view,
+                          int rays, uint32_t& state) {
+        std::vector<uint8_t> visible(terrain.getChunks().size(), 0);
+        for (int index : visibility.getVisibleChunks()) {
+            visible[index] = 1;
+        }
+        glm::mat4 inverse = glm::inverse(view.viewProjection);
+        glm::ivec3 counts = terrain.getChunkCounts();
+        int missed = 0;
+        for (int i = 0; i < rays; i++) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            float ndcX = (state & 0xFFFF) / 32767.5f - 1.0f;
+            float ndcY = (state >> 16) / 32767.5f - 1.0f;
+            glm::vec4 farPoint = inverse * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+            glm::vec3 target = glm::vec3(farPoint) / farPoint.w;
+            glm::ivec3 hit, previous;
+            if (!terrain.raycast(view.eye, target - view.eye, glm::length(target - view.eye), hit, previous)) {
+                continue;
+            }
+            glm::ivec3 chunk((hit.x + terrain.getGridOffsetX()) / CHUNK_SIZE, hit.y / CHUNK_SIZE,
+                             (hit.z + terrain.getGridOffsetZ()) / CHUNK_SIZE);
+            missed += !visible[(chunk.y * counts.z + chunk.z) * counts.x + chunk.x];
+        }
+        return missed;
+    }
+
+    int benchCulling(int argc, char** argv) {
+        int size = intOption(argc, argv, "--size", 192);
+        int worldHeight = intOption(argc, argv, "--height", 96);
+        int viewCount = intOption(argc, argv, "--views", 64);
+        int rays = intOption(argc, argv, "--rays", 4096);
+        float caveThreshold = static_cast<float>(std::atof(stringOption(argc, argv, "--cave-threshold", "0.06").c_str()));
+        int pathFrames = intOption(argc, argv, "--frames", 600);
+        float panDegrees = static_cast<float>(intOption(argc, argv, "--pan", 30));
+        float margin = static_cast<float>(std::atof(stringOption(argc, argv, "--margin", "8").c_str()));
+
+        // Deep ground with caves, so most of the world is underground
+        Terrain terrain(size, size, 20.0f);
+        terrain.setGenerator(TERRAIN_DENSITY);
+        terrain.setWorldHeight(worldHeight);
+        terrain.setBaseHeight(worldHeight * 0.6f);
+        terrain.setHeightMultiplier(12.0f);
+        terrain.setOctaves(6);
+        terrain.setCaveThreshold(caveThreshold);
+        terrain.generate();
+        terrain.updateDirtyChunks(-1);
+
+        const std::vector<Chunk>& chunks = terrain.getChunks();
+        int meshed = 0;
+        for (const Chunk& chunk : chunks) {
+            meshed += !chunk.mesh.indices.empty();
+        }
+        double connectivitySeconds = bestSeconds(3, [&] {
+            for (const Chunk& chunk : chunks) {
+                ChunkMesher::computeConnectivity(terrain, chunk);
+            }
+        });
+
+        // Surface views stand just above the ground, cave views in open cells well below it
+        uint32_t state = 2463534242u;
+        auto unit = [&state]() {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return (state >> 8) * (1.0f / 16777216.0f);
+        };
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+        auto makeView = [&](const glm::vec3& eye) {
+            float yaw = unit() * 6.2831853f;
+            float pitch = (unit() - 0.5f) * 0.6f;
+            glm::vec3 front(std::cos(yaw) * std::cos(pitch), std::sin(pitch), std::sin(yaw) * std::cos(pitch));
+            glm::mat4 view = glm::lookAt(eye, eye + front, glm::vec3(0.0f, 1.0f, 0.0f));
+            return CullingView{eye, view, projection * view};
+        };
+        std::vector<CullingView> surfaceViews, caveViews;
+        for (int attempt = 0; attempt < viewCount * 1000 && (static_cast<int>(surfaceViews.size()) < viewCount ||
+                                                             static_cast<int>(caveViews.size()) < viewCount); attempt++) {
+            int gx = static_cast<int>(unit() * size);
+            int gz = static_cast<int>(unit() * size);
+            int gy = static_cast<int>(unit() * worldHeight);
+            glm::vec3 eye(gx - terrain.getGridOffsetX() + 0.5f, gy + 0.5f, gz - terrain.getGridOffsetZ() + 0.5f);
+            float surface = terrain.getHeightAt(eye.x, eye.z);
+            if (terrain.getGridBlock(gx, gy, gz) != BLOCK_AIR) {
+                continue;
+            }
+            if (gy == static_cast<int>(surface) + 1 && static_cast<int>(surfaceViews.size()) < viewCount) {
+                surfaceViews.push_back(makeView(eye + glm::vec3(0.0f, 1.2f, 0.0f)));
+            } else if (gy < surface - 12.0f && static_cast<int>(caveViews.size()) < viewCount) {
+                caveViews.push_back(makeView(eye));
+            }
+        }
+
+        std::printf("%dx%dx%d world, %zu chunks (%d with geometry), connectivity %.1f us per chunk\n", size,
+                    worldHeight, size, chunks.size(), meshed, connectivitySeconds * 1.0e6 / chunks.size());
+        std::printf("%-8s %-13s %10s %10s %10s %10s\n", "views", "culling", "visible", "drawn", "us/update", "missed");
+        // Unrelated views, so every update is a full pass
+        ChunkVisibility visibility(terrain, -1.0f);
+        const char* modeNames[] = {"none", "frustum", "connectivity"};
+        const std::vector<CullingView>* viewSets[] = {&surfaceViews, &caveViews};
+        const char* viewNames[] = {"surface", "caves"};
+        for (int set = 0; set < 2; set++) {
+            const std::vector<CullingView>& views = *viewSets[set];
+            if (views.empty()) {
+                continue;
+            }
+            for (int mode = CULLING_NONE; mode <= CULLING_CONNECTIVITY; mode++) {
+                long long visible = 0, drawn = 0;
+                int missed = 0;
+                uint32_t rayState = 12345;
+                for (const CullingView& view : views) {
+                    visibility.update(view.eye, view.view, projection, static_cast<CullingMode>(mode));
+                    visible += visibility.getVisibleCount();
+                    for (int index : visibility.getVisibleChunks()) {
+                        drawn += !chunks[index].mesh.indices.empty();
+                    }
+                    missed += countMissedChunks(terrain, visibility, view, rays / static_cast<int>(views.size()),
+                                                rayState);
+                }
+                double seconds = bestSeconds(3, [&] {
+                    for (const CullingView& view : views) {
+                        visibility.update(view.eye, view.view, projection, static_cast<CullingMode>(mode));
+                    }
+                });
+                std::printf("%-8s %-13s %10.1f %10.1f %10.2f %10d\n", viewNames[set], modeNames[mode],
+                            static_cast<double>(visible) / views.size(), static_cast<double>(drawn) / views.size(),
+                            seconds * 1.0e6 / views.size(), missed);
+            }
+        }
+
+        // Walk and pan along a path, reusing the last pass where the camera allows,
+        // and check every frame against a full pass
+        std::printf("\n%d frames at 60 fps, 4 blocks/s, panning %.0f deg/s, coherence margin %.1f blocks\n",
+                    pathFrames, panDegrees, margin);
+        std::printf("%-8s %-13s %10s %10s %10s %10s %10s\n", "path", "culling", "full us", "reused us", "full %",
+                    "tested", "differ");
+        const CullingView* pathStarts[] = {surfaceViews.empty() ? nullptr : &surfaceViews[0],
+                                           caveViews.empty() ? nullptr : &caveViews[0]};
+        for (int set = 0; set < 2; set++) {
+            if (!pathStarts[set]) {
+                continue;
+            }
+            for (int mode = CULLING_FRUSTUM; mode <= CULLING_CONNECTIVITY; mode++) {
+                ChunkVisibility full(terrain, -1.0f);
+                ChunkVisibility coherent(terrain, margin);
+                double fullSeconds = 0.0, coherentSeconds = 0.0;
+                long long tested = 0;
+                int differ = 0;
+                for (int frame = 0; frame < pathFrames; frame++) {
+                    float time = frame / 60.0f;
+                    float yaw = glm::radians(panDegrees) * time + 0.3f * std::sin(time * 0.7f);
+                    float pitch = 0.2f * std::sin(time * 0.5f);
+                    glm::vec3 heading(std::cos(yaw), 0.0f, std::sin(yaw));
+                    glm::vec3 eye = pathStarts[set]->eye + heading * (4.0f * time);
+                    glm::vec3 front(std::cos(yaw) * std::cos(pitch), std::sin(pitch), std::sin(yaw) * std::cos(pitch));
+                    glm::mat4 view = glm::lookAt(eye, eye + front, glm::vec3(0.0f, 1.0f, 0.0f));
+
+                    Clock::time_point start = Clock::now();
+                    full.update(eye, view, projection, static_cast<CullingMode>(mode));
+                    fullSeconds += secondsSince(start);
+                    start = Clock::now();
+                    coherent.update(eye, view, projection, static_cast<CullingMode>(mode));
+                    coherentSeconds += secondsSince(start);
+                    tested += coherent.getTestedCount();
+                    differ += full.getVisibleChunks() != coherent.getVisibleChunks();
+                }
+                std::printf("%-8s %-13s %10.2f %10.2f %10.1f %10.1f %10d\n", viewNames[set], modeNames[mode],
+                            fullSeconds * 1.0e6 / pathFrames, coherentSeconds * 1.0e6 / pathFrames,
+                            100.0 * coherent.getFullUpdateCount() / coherent.getUpdateCount(),
+                            static_cast<double>(tested) / pathFrames, differ);
+            }
+        }
+
+        // Digging a shaft from a cave to the sky only remeshes the chunks it passes through,
+        // and the sky above it becomes visible from the cave without moving the camera
+        if (!caveViews.empty()) {
+            glm::vec3 eye = caveViews[0].eye;
+            glm::vec3 up(0.3f, 1.0f, 0.0f);
+            glm::mat4 view = glm::lookAt(eye, eye + up, glm::vec3(0.0f, 0.0f, 1.0f));
+            ChunkVisibility coherent(terrain, margin);
+            coherent.update(eye, view, projection, CULLING_CONNECTIVITY);
+            int before = coherent.getVisibleCount();
+            glm::ivec3 cell(static_cast<int>(std::floor(eye.x)), static_cast<int>(std::floor(eye.y)),
+                            static_cast<int>(std::floor(eye.z)));
+            for (int y = cell.y + 1; y < worldHeight; y++) {
+                terrain.setBlock(cell.x, y, cell.z, BLOCK_AIR);
+            }
+            Clock::time_point start = Clock::now();
+            int remeshed = terrain.updateDirtyChunks(-1);
+            double remeshSeconds = secondsSince(start);
+            coherent.update(eye, view, projection, CULLING_CONNECTIVITY);
+            std::printf("\nshaft to the surface: %d chunks remeshed in %.2f ms, visible looking up %d -> %d\n",
+                        remeshed, remeshSeconds * 1000.0, before, coherent.getVisibleCount());
+        }
+        return 0;
+    }
+
+    // Long rays against the terrain: block-by-block DDA against the max-height
+    // pyramid, on far picking rays, line of sight between points near the
+    // ground and shadow rays towards the sun, then again after random edits
+    int benchRaycast(int argc, char** argv) {
+        int size = intOption(argc, argv, "--size", 512);
+        int worldHeight = intOption(argc, argv, "--height", 64);
+        int count = intOption(argc, argv, "--rays", 20000);
+        int edits = intOption(argc, argv, "--edits", 2000);
+        int runs = intOption(argc, argv, "--runs", 3);
+        bool density = stringOption(argc, argv, "--generator", "heightmap") == "density";
+
+        Terrain terrain(size, size, 40.0f);
+        terrain.setWorldHeight(worldHeight);
+        if (density) {
+            terrain.setGenerator(TERRAIN_DENSITY);
+            terrain.setBaseHeight(worldHeight * 0.5f);
+        } else {
+            terrain.setBaseHeight(worldHeight * 0.35f);
+        }
+        terrain.setHeightMultiplier(worldHeight * 0.3f);
+        terrain.setOctaves(6);
+        Clock::time_point start = Clock::now();
+        terrain.generate();
+        double generateSeconds = secondsSince(start);
+        const HeightPyramid& pyramid = terrain.getHeightPyramid();
+        HeightPyramid rebuilt = pyramid;
+        std::vector<float> columns(static_cast<size_t>(size) * size);
+        for (int z = 0; z < size; z++) {
+            for (int x = 0; x < size; x++) {
+                columns[static_cast<size_t>(z) * size + x] = static_cast<float>(pyramid.getMaxHeight(0, x, z));
+            }
+        }
+        double buildSeconds = bestSeconds(runs, [&] { rebuilt.build(columns.data(), size, size); });
+
+        uint32_t state = 88172645u;
+        auto unit = [&state]() {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return (state >> 8) * (1.0f / 16777216.0f);
+        };
+        auto groundPoint = [&](float above) {
+            float x = (unit() - 0.5f) * (size - 2);
+            float z = (unit() - 0.5f) * (size - 2);
+            return glm::vec3(x, terrain.getHeightAt(x, z) + above, z);
+        };
+        struct Ray {
+            glm::vec3 origin, direction;
+            float distance;
+        };
+        const int setCount = 3;
+        const char* setNames[setCount] = {"far picking", "line of sight", "shadow"};
+        std::vector<Ray> sets[setCount];
+        const glm::vec3 sun = glm::normalize(glm::vec3(0.4f, 0.7f, 0.3f));
+        for (int i = 0; i < count; i++) {
+            // Eye height looking anywhere from a little up to steeply down, out to the far plane
+            float yaw = unit() * 6.2831853f;
+            float pitch = -0.6f + unit() * 0.7f;
+            glm::vec3 front(std::cos(yaw) * std::cos(pitch), std::sin(pitch), std::sin(yaw) * std::cos(pitch));
+            sets[0].push_back({groundPoint(1.7f + unit() * 20.0f), front, 400.0f});
+            // Agents within 64 blocks of each other
+            glm::vec3 from = groundPoint(1.7f);
+            float toX = std::min(std::max(from.x + (unit() - 0.5f) * 128.0f, -size * 0.5f + 1.0f), size * 0.5f - 1.0f);
+            float toZ = std::min(std::max(from.z + (unit() - 0.5f) * 128.0f, -size * 0.5f + 1.0f), size * 0.5f - 1.0f);
+            glm::vec3 to(toX, terrain.getHeightAt(toX, toZ) + 1.7f, toZ);
+            sets[1].push_back({from, to - from, glm::length(to - from)});
+            sets[2].push_back({groundPoint(0.01f), sun, 1000.0f});
+        }
+
+        // A ray through a block's edge or corner can step either way first depending on rounding;
+        // results one block apart count as such ties, anything else as a mismatch
+        auto compare = [&](const std::vector<Ray>& rays, int& hits, int& ties) {
+            int mismatches = 0;
+            hits = 0;
+            ties = 0;
+            for (const Ray& ray : rays) {
+                glm::ivec3 ddaHit, ddaPrevious, pyramidHit, pyramidPrevious;
+                bool dda = terrain.raycast(ray.origin, ray.direction, ray.distance, ddaHit, ddaPrevious, RAYCAST_DDA);
+                bool fast = terrain.raycast(ray.origin, ray.direction, ray.distance, pyramidHit, pyramidPrevious,
+                                            RAYCAST_PYRAMID);
+                hits += dda;
+                if (dda != fast) {
+                    mismatches++;
+                } else if (dda && (ddaHit != pyramidHit || ddaPrevious != pyramidPrevious)) {
+                    glm::ivec3 apart = glm::abs(ddaHit - pyramidHit);
+                    if (std::max(std::max(apart.x, apart.y), apart.z) <= 1) {
+                        ties++;
+                    } else {
+                        mismatches++;
+                    }
+                }
+            }
+            return mismatches;
+        };
+        auto time = [&](const std::vector<Ray>& rays, RaycastMethod method) {
+            return bestSeconds(runs, [&] {
+                for (const Ray& ray : rays) {
+                    glm::ivec3 hitBlock, previousBlock;
+                    terrain.raycast(ray.origin, ray.direction, ray.distance, hitBlock, previousBlock, method);
+                }
+            });
+        };
+
+        std::printf("%dx%dx%d %s world generated in %.1f ms, %d pyramid levels built in %.2f ms\n", size, worldHeight,
+                    size, density ? "density" : "heightmap", generateSeconds * 1000.0, pyramid.getLevelCount(),
+                    buildSeconds * 1000.0);
+        std::printf("%-14s %8s %12s %12s %9s %6s %9s\n", "rays", "hit %", "DDA ray/s", "pyramid/s", "speedup", "ties",
+                    "mismatch");
+        int totalMismatches = 0;
+        for (int set = 0; set < setCount; set++) {
+            int hits, ties;
+            int mismatches = compare(sets[set], hits, ties);
+            totalMismatches += mismatches;
+            double ddaSeconds = time(sets[set], RAYCAST_DDA);
+            double pyramidSeconds = time(sets[set], RAYCAST_PYRAMID);
+            std::printf("%-14s %8.1f %12.0f %12.0f %8.2fx %6d %9d\n", setNames[set], 100.0 * hits / count,
+                        count / ddaSeconds, count / pyramidSeconds, ddaSeconds / std::max(pyramidSeconds, 1.0e-12),
+                        ties, mismatches);
+        }
+
+        // Random digging and building near the surface keeps the pyramid current one column at a time
+        start = Clock::now();
+        for (int i = 0; i < edits; i++) {
+            glm::vec3 point = groundPoint(0.0f);
+            int x = static_cast<int>(std::floor(point.x));
+            int z = static_cast<int>(std::floor(point.z));
+            int y = static_cast<int>(point.y) + static_cast<int>(unit() * 8.0f) - 4;
+            terrain.setBlock(x, y, z, unit() < 0.5f ? BLOCK_AIR : BLOCK_STONE);
+        }
+        double editSeconds = secondsSince(start);
+        for (int z = 0; z < size; z++) {
+            for (int x = 0; x < size; x++) {
+                int top = 0;
+                for (int y = worldHeight - 1; y >= 0; y--) {
+                    if (isBlockOpaque(terrain.getGridBlock(x, y, z))) {
+                        top = y + 1;
+                        break;
+                    }
+                }
+                columns[static_cast<size_t>(z) * size + x] = static_cast<float>(top);
+            }
+        }
+        rebuilt.build(columns.data(), size, size);
+        int staleCells = 0;
+        for (int level = 0; level < pyramid.getLevelCount(); level++) {
+            for (int z = 0; z < pyramid.getLevelDepth(level); z++) {
+                for (int x = 0; x < pyramid.getLevelWidth(level); x++) {
+                    staleCells += pyramid.getMaxHeight(level, x, z) != rebuilt.getMaxHeight(level, x, z);
+                }
+            }
+        }
+        int editMismatches = 0;
+        for (int set = 0; set < setCount; set++) {
+            int hits, ties;
+            editMismatches += compare(sets[set], hits, ties);
+        }
+        totalMismatches += editMismatches + staleCells;
+        std::printf("\n%d edits in %.2f ms (%.2f us each), pyramid cells differing from a rebuild %d, "
+                    "ray mismatches after edits %d\n",
+                    edits, editSeconds * 1000.0, editSeconds * 1.0e6 / std::max(edits, 1), staleCells, editMismatches);
+        return totalMismatches == 0 ? 0 : 1;
+    }
+
+    // Path requests on a large world: the cluster graph against plain A* over
+    // every column, served serially and from the worker pool, then local
+    // repairs after edits checked against a fresh build
+    int benchPaths(int argc, char** argv) {
+        int size = intOption(argc, argv, "--size", 1024);
+        int worldHeight = intOption(argc, argv, "--height", 64);
+        int requests = intOption(argc, argv, "--requests", 2000);
+        int range = intOption(argc, argv, "--range", 256);
+        int flatCount = intOption(argc, argv, "--flat", 100);
+        int clusterSize = intOption(argc, argv, "--cluster", 16);
+        int edits = intOption(argc, argv, "--edits", 500);
+        int maxThreads = intOption(argc, argv, "--threads", static_cast<int>(std::thread::hardware_concurrency()));
+
+        Terrain terrain(size, size, 40.0f);
+        terrain.setWorldHeight(worldHeight);
+        terrain.setBaseHeight(worldHeight * 0.35f);
+        terrain.setHeightMultiplier(28.0f);
+        terrain.setOctaves(6);
+        terrain.generate();
+
+        // Agents jump like the player
+        AgentSettings agentSettings;
+        NavigationRules rules = makeNavigationRules(agentSettings.jumpForce, agentSettings.gravity);
+        Pathfinder pathfinder(terrain, rules, clusterSize);
+        Clock::time_point start = Clock::now();
+        pathfinder.build();
+        double serialBuildSeconds = secondsSince(start);
+        JobSystem buildJobs(std::max(maxThreads - 1, 0));
+        start = Clock::now();
+        pathfinder.build(&buildJobs);
+        double parallelBuildSeconds = secondsSince(start);
+        std::printf("%dx%d world, climb %d drop %d, %d clusters of %d, %d nodes, %d edges\n", size, size,
+                    rules.maxClimb, rules.maxDrop, pathfinder.getClusterCount(), clusterSize,
+                    pathfinder.getNodeCount(), pathfinder.getEdgeCount());
+        std::printf("build %.1f ms on one thread, %.1f ms on %u\n", serialBuildSeconds * 1000.0,
+                    parallelBuildSeconds * 1000.0, buildJobs.getConcurrency());
+
+        // Start and goal columns up to range blocks apart
+        uint32_t state = 1013904223u;
+        auto unit = [&state]() {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return (state >> 8) * (1.0f / 16777216.0f);
+        };
+        float half = size * 0.5f - 1.0f;
+        std::vector<std::pair<glm::vec3, glm::vec3>> pairs;
+        for (int i = 0; i < requests; i++) {
+            glm::vec3 from((unit() - 0.5f) * 2.0f * half, 0.0f, (unit() - 0.5f) * 2.0f * half);
+            glm::vec3 to(std::min(std::max(from.x + (unit() - 0.5f) * 2.0f * range, -half), half), 0.0f,
+                         std::min(std::max(from.z + (unit() - 0.5f) * 2.0f * range, -half), half));
+            pairs.push_back({from, to});
+        }
+
+        std::vector<Path> paths(requests);
+        double hierarchicalSeconds = bestSeconds(1, [&] {
+            for (int i = 0; i < requests; i++) {
+                pathfinder.findPath(pairs[i].first, pairs[i].second, paths[i]);
+            }
+        });
+        int found = 0;
+        int badSteps = 0;
+        for (const Path& path : paths) {
+            found += path.found;
+            for (size_t i = 1; i < path.points.size(); i++) {
+                glm::vec3 step = path.points[i] - path.points[i - 1];
+                badSteps += std::fabs(step.x) > 1.0f || std::fabs(step.z) > 1.0f || step.y > rules.maxClimb ||
+                            -step.y > rules.maxDrop;
+            }
+        }
+
+        // Plain A* on the first few pairs, for speed and how much longer the cluster paths are
+        flatCount = std::min(flatCount, requests);
+        std::vector<Path> flatPaths(flatCount);
+        double flatSeconds = bestSeconds(1, [&] {
+            for (int i = 0; i < flatCount; i++) {
+                pathfinder.findPath(pairs[i].first, pairs[i].second, flatPaths[i], PATH_FLAT);
+            }
+        });
+        int missed = 0;
+        int compared = 0;
+        double ratioSum = 0.0;
+        double worstRatio = 1.0;
+        for (int i = 0; i < flatCount; i++) {
+            missed += flatPaths[i].found && !paths[i].found;
+            if (flatPaths[i].found && paths[i].found && flatPaths[i].cost > 0.0f) {
+                double ratio = paths[i].cost / flatPaths[i].cost;
+                ratioSum += ratio;
+                worstRatio = std::max(worstRatio, ratio);
+                compared++;
+            }
+        }
+
+        std::printf("%d requests up to %d blocks apart, %.1f%% found, %d invalid steps\n", requests, range,
+                    100.0 * found / requests, badSteps);
+        std::printf("%-22s %10s %12s\n", "search", "ms/path", "paths/sec");
+        std::printf("%-22s %10.3f %12.0f\n", "flat A*", flatSeconds * 1000.0 / std::max(flatCount, 1),
+                    flatCount / flatSeconds);
+        std::printf("%-22s %10.3f %12.0f\n", "hierarchical", hierarchicalSeconds * 1000.0 / requests,
+                    requests / hierarchicalSeconds);
+        for (int threads = 1; threads <= maxThreads; threads *= 2) {
+            // Requests only run on workers, so every thread is one
+            JobSystem jobs(threads);
+            std::vector<std::future<Path>> pending;
+            pending.reserve(requests);
+            start = Clock::now();
+            for (int i = 0; i < requests; i++) {
+                pending.push_back(pathfinder.requestPath(jobs, pairs[i].first, pairs[i].second));
+            }
+            for (std::future<Path>& result : pending) {
+                result.wait();
+            }
+            double seconds = secondsSince(start);
+            char name[32];
+            std::snprintf(name, sizeof(name), "requests, %d workers", threads);
+            std::printf("%-22s %10.3f %12.0f\n", name, seconds * 1000.0 / requests, requests / seconds);
+        }
+        std::printf("hierarchical cost / shortest: mean %.3f, worst %.3f over %d paths, %d missed\n",
+                    compared > 0 ? ratioSum / compared : 1.0, worstRatio, compared, missed);
+
+        // Digging and building single blocks at the surface, each repaired on its own
+        double repairSeconds = 0.0;
+        int rebuilt = 0;
+        for (int i = 0; i < edits; i++) {
+            int x = static_cast<int>(std::floor((unit() - 0.5f) * 2.0f * half));
+            int z = static_cast<int>(std::floor((unit() - 0.5f) * 2.0f * half));
+            int y = static_cast<int>(terrain.getHeightAt(x + 0.5f, z + 0.5f));
+            if (unit() < 0.5f) {
+                terrain.setBlock(x, y - 1, z, BLOCK_AIR);
+            } else {
+                terrain.setBlock(x, y, z, BLOCK_STONE);
+            }
+            start = Clock::now();
+            rebuilt += pathfinder.updateColumns(x, z, x, z);
+            repairSeconds += secondsSince(start);
+        }
+        Pathfinder fresh(terrain, rules, clusterSize);
+        fresh.build(&buildJobs);
+        int differ = fresh.getNodeCount() != pathfinder.getNodeCount() || fresh.getEdgeCount() != pathfinder.getEdgeCount();
+        for (int i = 0; i < flatCount; i++) {
+            Path repaired, rebuiltPath;
+            pathfinder.findPath(pairs[i].first, pairs[i].second, repaired);
+            fresh.findPath(pairs[i].first, pairs[i].second, rebuiltPath);
+            differ += repaired.found != rebuiltPath.found || repaired.cost != rebuiltPath.cost;
+        }
+        std::printf("%d edits: %.1f clusters and %.3f ms per repair, %d differences from a fresh build\n", edits,
+                    static_cast<double>(rebuilt) / std::max(edits, 1), repairSeconds * 1000.0 / std::max(edits, 1),
+                    differ);
+        return badSteps == 0 && missed == 0 && differ == 0 ? 0 : 1;
+    }
+
+    // A chunk's packed mesh as Mesh vertices relative to the chunk origin, decoded like vertex.glsl
+    void unpackChunkMesh(const ChunkMeshData& mesh, std::vector<Vertex>& vertices) {
+        static const glm::vec3 faceNormals[6] = {
+            glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(-1.0f, 0.0f, 0.0f),
+            glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f)};
+        vertices.clear();
+        for (const ChunkVertex& packed : mesh.vertices) {
+            uint32_t data = packed.data0;
+            Vertex vertex;
+            vertex.position = glm::vec3(static_cast<float>(data & 31u), static_cast<float>((data >> 5) & 31u),
+                                        static_cast<float>((data >> 10) & 31u));
+            vertex.normal = faceNormals[((data >> 15) & 7u) % 6];
+            vertex.texCoords = glm::vec2(0.0f);
+            vertices.push_back(vertex);
+        }
+    }
+
+    // Software rasterizer throughput on the terrain meshes at several
+    // resolutions and thread counts. Every thread count and the scalar edge
+    // loop must give the same image, and no background pixel may be boxed in
+    // by covered ones on all four sides, which would be a crack between triangles.
+    int benchRaster(int argc, char** argv) {
+        int size = intOption(argc, argv, "--size", 128);
+        int worldHeight = intOption(argc, argv, "--height", 64);
+        int frames = intOption(argc, argv, "--frames", 5);
+        int maxThreads = intOption(argc, argv, "--threads", static_cast<int>(std::thread::hardware_concurrency()));
+        std::string output = stringOption(argc, argv, "--output", "");
+
+        Terrain terrain(size, size, 40.0f);
+        terrain.setWorldHeight(worldHeight);
+        terrain.setBaseHeight(worldHeight * 0.35f);
+        terrain.setHeightMultiplier(20.0f);
+        terrain.setOctaves(6);
+        terrain.generate();
+        terrain.updateDirtyChunks(-1);
+
+        // One draw per chunk, colored in a checkerboard so chunk borders show
+        std::vector<std::vector<Vertex>> chunkVertices;
+        std::vector<const Chunk*> drawnChunks;
+        size_t inputTriangles = 0;
+        for (const Chunk& chunk : terrain.getChunks()) {
+            if (chunk.mesh.indices.empty()) {
+                continue;
+            }
+            chunkVertices.emplace_back();
+            unpackChunkMesh(chunk.mesh, chunkVertices.back());
+            drawnChunks.push_back(&chunk);
+            inputTriangles += chunk.mesh.indices.size() / 3;
+        }
+
+        // Looking across the world from above one corner, as main.cpp sets up the view
+        glm::vec3 eye(-size * 0.4f, worldHeight * 0.8f, -size * 0.4f);
+        glm::mat4 view = glm::lookAt(eye, glm::vec3(0.0f, worldHeight * 0.3f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        PhongShading shading;
+        shading.lightPos = glm::vec3(0.0f, worldHeight * 2.0f, 0.0f);
+        shading.viewPos = eye;
+        shading.fog = true;
+        const glm::vec3 clearColor(0.2f, 0.3f, 0.3f);
+
+        auto render = [&](SoftwareRasterizer& rasterizer, int width, int height) {
+            rasterizer.begin(width, height, clearColor);
+            float aspect = static_cast<float>(width) / static_cast<float>(height);
+            rasterizer.setCamera(view, glm::perspective(glm::radians(45.0f), aspect, 0.1f, 100.0f));
+            rasterizer.setShading(shading);
+            for (size_t i = 0; i < drawnChunks.size(); i++) {
+                const Chunk& chunk = *drawnChunks[i];
+                uint8_t block = (chunk.x + chunk.z) % 2 == 0 ? BLOCK_GRASS : BLOCK_DARK_GRASS;
+                rasterizer.draw(chunkVertices[i], chunk.mesh.indices,
+                                glm::translate(glm::mat4(1.0f), terrain.getChunkOrigin(chunk)),
+                                Terrain::getBlockColor(block));
+            }
+            rasterizer.end();
+        };
+
+        std::printf("%dx%d world, %zu chunk draws, %zu triangles, %s edge functions\n", size, size, drawnChunks.size(),
+                    inputTriangles, SoftwareRasterizer::isSimdAvailable() ? "SSE" : "scalar");
+        std::printf("%-11s %8s %10s %12s %10s %10s %8s\n", "resolution", "threads", "ms/frame", "Mpixels/s",
+                    "triangles", "binned", "differ");
+
+        const int resolutions[][2] = {{320, 180}, {640, 360}, {1280, 720}, {1920, 1080}};
+        int totalDiffering = 0;
+        int totalCracks = 0;
+        std::vector<uint8_t> reference;
+        for (const auto& resolution : resolutions) {
+            int width = resolution[0];
+            int height = resolution[1];
+            char name[32];
+            std::snprintf(name, sizeof(name), "%dx%d", width, height);
+
+            // Single-threaded reference image
+            SoftwareRasterizer serial;
+            render(serial, width, height);
+            reference = serial.getColor();
+
+            for (int threads = 1; threads <= std::max(maxThreads, 1); threads *= 2) {
+                std::unique_ptr<JobSystem> jobs;
+                if (threads > 1) {
+                    jobs = std::make_unique<JobSystem>(threads - 1);
+                }
+                SoftwareRasterizer rasterizer(jobs.get());
+                render(rasterizer, width, height);
+                double seconds = bestSeconds(frames, [&] { render(rasterizer, width, height); });
+                int differing = reference != rasterizer.getColor();
+                totalDiffering += differing;
+                std::printf("%-11s %8d %10.2f %12.1f %10d %10d %8d\n", name, threads, seconds * 1000.0,
+                            width * height / seconds * 1.0e-6, rasterizer.getTriangleCount(),
+                            rasterizer.getBinnedCount(), differing);
+            }
+
+            // The scalar edge loop, where the SSE one is the default
+            if (SoftwareRasterizer::isSimdAvailable()) {
+                SoftwareRasterizer scalar;
+                scalar.setSimd(false);
+                render(scalar, width, height);
+                double seconds = bestSeconds(frames, [&] { render(scalar, width, height); });
+                int differing = reference != scalar.getColor();
+                totalDiffering += differing;
+                std::printf("%-11s %8s %10.2f %12.1f %10d %10d %8d\n", name, "scalar", seconds * 1000.0,
+                            width * height / seconds * 1.0e-6, scalar.getTriangleCount(), scalar.getBinnedCount(),
+                            differing);
+            }
+
+            // Terrain cut open by the far plane may show background legitimately,
+            // so only pixels boxed in by nearer surfaces count
+            const std::vector<float>& depth = serial.getDepth();
+            const float nearerThanFar = 0.99999f;
+            for (int y = 1; y + 1 < height; y++) {
+                for (int x = 1; x + 1 < width; x++) {
+                    size_t i = static_cast<size_t>(y) * width + x;
+                    totalCracks += depth[i] == 1.0f && depth[i - 1] < nearerThanFar && depth[i + 1] < nearerThanFar &&
+                                   depth[i - width] < nearerThanFar && depth[i + width] < nearerThanFar;
+                }
+            }
+
+            if (!output.empty()) {
+                std::vector<uint8_t> scratch;
+                std::string path = output + "-" + name + ".png";
+                if (!writePng(path, reference.data(), width, height, scratch)) {
+                    return 1;
+                }
+                std::printf("wrote %s\n", path.c_str());
+            }
+        }
+        std::printf("images differing from one thread: %d, background pixels boxed in by triangles: %d\n",
+                    totalDiffering, totalCracks);
+        return totalDiffering == 0 && totalCracks == 0 ? 0 : 1;
+    }
+
+    struct Benchmark {
+        const char* name;
+        const char* usage;
+        int (*run)(int argc, char** argv);
+    };
+
+    const Benchmark benchmarks[] = {
+        {"density", "[--size N] [--height N] [--runs N]", benchDensity},
+        {"noise", "[--samples N]", benchNoise},
+        {"backends", "[--samples N]", benchBackends},
+        {"agents", "[--agents N] [--ticks N] [--size N] [--threads N]", benchAgents},
+        {"broadphase", "[--max N] [--naive N]", benchBroadphase},
+        {"replay", "[--input FILE | --ticks N --agents N [--save FILE]] [--runs N]", benchReplay},
+        {"allocations", "[--ticks N] [--warmup N] [--agents N]", benchAllocations},
+        {"surface", "[--points N] [--size N] [--runs N]", benchSurface},
+        {"telemetry", "[--frames N] [--name NAME]", benchTelemetry},
+        {"resolution", "[--pixel-ms N] [--spike PERCENT]", benchResolution},
+        {"capture", "[--width N] [--height N] [--frames N] [--output PREFIX]", benchCapture},
+        {"pacing", "[--fps N] [--frames N] [--work-us N]", benchPacing},
+        {"culling", "[--size N] [--height N] [--cave-threshold F] [--views N] [--rays N] [--frames N] [--pan DEG] [--margin F]",
+         benchCulling},
+        {"raycast", "[--size N] [--height N] [--generator heightmap|density] [--rays N] [--edits N] [--runs N]",
+         benchRaycast},
+        {"paths", "[--size N] [--requests N] [--range N] [--flat N] [--cluster N] [--edits N] [--threads N]",
+         benchPaths},
+        {"raster", "[--size N] [--height N] [--frames N] [--threads N] [--output PREFIX]", benchRaster},
+    };
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2) {
+        for (const Benchmark& benchmark : benchmarks) {
+            if (std::strcmp(argv[1], benchmark.name) == 0) {
+                return benchmark.run(argc, argv);
+            }
+        }
+    }
+
+    std::cerr << "Usage: " << argv[0] << " <benchmark> [options]" << std::endl;
+    for (const Benchmark& benchmark : benchmarks) {
+        std::cerr << "  " << benchmark.name << " " << benchmark.usage << std::endl;
+    }
+    return -1;
+}
@@ -0,0 +1,162 @@
+// Live view of the telemetry a running Rendering3D --telemetry publishes:
+// frame time percentiles, per-frame counters and stutter events
+#include "Telemetry.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct ViewerOptions {
+        std::string name = TELEMETRY_DEFAULT_NAME;
+        int intervalMilliseconds = 1000;
+        float stutterFactor = 2.0f;   // frames this many times the window's p50 are stutters
+        float stutterMinimum = 4.0f;  // ...and at least this many ms over it
+        bool once = false;
+    };
+
+    // Nearest-rank percentile of sorted values
+    float percentile(const std::vector<float>& sorted, float fraction) {
+        if (sorted.empty()) {
+            return 0.0f;
+        }
+        size_t rank = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5f);
+        return sorted[std::min(rank, sorted.size() - 1)];
+    }
+
+    // Percentile of every frame so far, from the shared histogram (bucket upper edges)
+    float histogramPercentile(const uint64_t (&buckets)[TELEMETRY_HISTOGRAM_BUCKETS], float fraction) {
+        uint64_t total = 0;
+        for (uint64_t count : buckets) {
+            total += count;
+        }
+        uint64_t target = static_cast<uint64_t>(fraction * total);
+        uint64_t seen = 0;
+        for (int i = 0; i < TELEMETRY_HISTOGRAM_BUCKETS; i++) {
+            seen += buckets[i];
+            if (seen > target) {
+                return (i + 1) * TELEMETRY_BUCKET_MILLISECONDS;
+            }
+        }
+        return TELEMETRY_HISTOGRAM_BUCKETS * TELEMETRY_BUCKET_MILLISECONDS;
+    }
+
+    void report(const TelemetryReader& reader, const std::vector<TelemetryFrame>& frames,
+                const ViewerOptions& options) {
+        std::vector<float> times;
+        times.reserve(frames.size());
+        double cpuTotal = 0.0;
+        double counterTotals[TELEMETRY_COUNTER_COUNT] = {};
+        for (const TelemetryFrame& frame : frames) {
+            times.push_back(frame.frameMilliseconds);
+            cpuTotal += frame.cpuMilliseconds;
+            for (int i = 0; i < TELEMETRY_COUNTER_COUNT; i++) {
+                counterTotals[i] += frame.counters[i];
+            }
+        }
+        std::vector<float> sorted = times;
+        std::sort(sorted.begin(), sorted.end());
+        float p50 = percentile(sorted, 0.5f);
+
+        double seconds = frames.size() > 1
+            ? (frames.back().timeMicroseconds - frames.front().timeMicroseconds) * 1.0e-6 : 0.0;
+        double count = static_cast<double>(frames.size());
+        std::printf("frame %llu  %3zu frames %6.1f fps  frame p50 %6.2f p99 %6.2f max %6.2f ms  cpu %5.2f ms\n",
+                    static_cast<unsigned long long>(frames.back().frame), frames.size(),
+                    seconds > 0.0 ? (count - 1.0) / seconds : 0.0, p50, percentile(sorted, 0.99f), sorted.back(),
+                    cpuTotal / count);
+
+        std::printf("  per frame:");
+        for (int i = 0; i < TELEMETRY_COUNTER_COUNT; i++) {
+            std::printf("%s %s %.1f", i > 0 ? "," : "", getTelemetryCounterName(static_cast<TelemetryCounter>(i)),
+                        counterTotals[i] / count);
+        }
+        uint64_t buckets[TELEMETRY_HISTOGRAM_BUCKETS];
+        reader.readHistogram(buckets);
+        std::printf("\n  since start: %llu frames, p50 %.2f p99 %.2f ms\n",
+                    static_cast<unsigned long long>(reader.getFramesPublished()),
+                    histogramPercentile(buckets, 0.5f), histogramPercentile(buckets, 0.99f));
+
+        for (const TelemetryFrame& frame : frames) {
+            if (frame.frameMilliseconds > p50 * options.stutterFactor &&
+                frame.frameMilliseconds > p50 + options.stutterMinimum) {
+                std::printf("  stutter: frame %llu at %.3f s took %.2f ms (%.1fx p50), cpu %.2f ms, %u ticks, "
+                            "%u allocations\n",
+                            static_cast<unsigned long long>(frame.frame), frame.timeMicroseconds * 1.0e-6,
+                            frame.frameMilliseconds, frame.frameMilliseconds / std::max(p50, 1.0e-3f),
+                            frame.cpuMilliseconds, frame.counters[TELEMETRY_TICKS],
+                            frame.counters[TELEMETRY_ALLOCATIONS]);
+            }
+        }
+        std::fflush(stdout);
+    }
+
+    bool parseOptions(int argc, char** argv, ViewerOptions& options) {
+        for (int i = 1; i < argc; i++) {
+            bool hasValue = i + 1 < argc;
+            if (std::strcmp(argv[i], "--name") == 0 && hasValue) {
+                options.name = argv[++i];
+            } else if (std::strcmp(argv[i], "--interval") == 0 && hasValue) {
+                options.intervalMilliseconds = std::max(10, std::atoi(argv[++i]));
+            } else if (std::strcmp(argv[i], "--stutter") == 0 && hasValue) {
+                options.stutterFactor = static_cast<float>(std::atof(argv[++i]));
+            } else if (std::strcmp(argv[i], "--once") == 0) {
+                options.once = true;
+            } else {
+                std::cerr << "Usage: " << argv[0] << " [--name NAME] [--interval MS] [--stutter FACTOR] [--once]"
+                          << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    ViewerOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        return -1;
+    }
+
+    // Wait for a publisher to start
+    TelemetryReader reader;
+    bool waiting = false;
+    while (!reader.open(options.name)) {
+        if (options.once) {
+            std::cerr << "No telemetry published at " << options.name << std::endl;
+            return 1;
+        }
+        if (!waiting) {
+            std::printf("Waiting for telemetry at %s (run Rendering3D --telemetry)\n", options.name.c_str());
+            std::fflush(stdout);
+            waiting = true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    }
+
+    // Start one ring back so the first report has data
+    uint64_t published = reader.getFramesPublished();
+    uint64_t cursor = published > static_cast<uint64_t>(TELEMETRY_RING_FRAMES) ? published - TELEMETRY_RING_FRAMES : 0;
+    std::vector<TelemetryFrame> frames;
+    frames.reserve(TELEMETRY_RING_FRAMES);
+    while (true) {
+        frames.clear();
+        cursor = reader.readFrames(cursor, frames);
+        if (!frames.empty()) {
+            report(reader, frames, options);
+        }
+        if (options.once) {
+            return frames.empty() ? 1 : 0;
+        }
+        if (frames.empty() && reader.isClosed()) {
+            std::printf("Publisher closed\n");
+            return 0;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(options.intervalMilliseconds));
+    }
+}
@@ -0,0 +1,232 @@
+// Offline world baker: generates, lights and meshes a region of the world
+// without a window and streams the chunk meshes to disk
+#include "BakedWorldWriter.h"
+#include "ChunkMesher.h"
+#include "JobSystem.h"
+#include "Terrain.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::high_resolution_clock;
+
+    double secondsSince(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // Border generated around every tile and thrown away. Light spreads at most
+    // 15 blocks, so with a chunk of border the kept chunks match one big world:
+    // same faces, same ambient occlusion, same light.
+    const int APRON = CHUNK_SIZE;
+
+    struct BakeOptions {
+        unsigned int seed = 42;
+        int minX = -256, minZ = -256;   // baked block range [min, max), snapped to chunks
+        int maxX = 256, maxZ = 256;
+        int tileSize = 128;             // blocks per tile side, a multiple of CHUNK_SIZE
+        int worldHeight = 32;
+        int threads = 0;                // 0 = all cores
+        bool densityTerrain = false;
+        NoiseBackend noise = NOISE_PERLIN;
+        std::string chunkPath, objPath, gltfPath;
+    };
+
+    struct BakedChunk {
+        int originX, originY, originZ;
+        ChunkMeshData mesh;
+    };
+
+    // Everything one tile produced, handed to the writer and then freed
+    struct TileResult {
+        std::vector<BakedChunk> chunks;
+        int chunksMeshed = 0;
+        double generateSeconds = 0.0;
+        double meshSeconds = 0.0;
+    };
+
+    int floorToChunk(int value) {
+        return value >= 0 ? value / CHUNK_SIZE * CHUNK_SIZE : -((-value + CHUNK_SIZE - 1) / CHUNK_SIZE * CHUNK_SIZE);
+    }
+
+    // Same world parameters as Session
+    void bakeTile(const BakeOptions& options, int tileMinX, int tileMinZ, TileResult& result) {
+        int sizeX = std::min(options.tileSize, options.maxX - tileMinX);
+        int sizeZ = std::min(options.tileSize, options.maxZ - tileMinZ);
+
+        Clock::time_point start = Clock::now();
+        Terrain terrain(sizeX + 2 * APRON, sizeZ + 2 * APRON, 20.0f);
+        terrain.setHeightMultiplier(8.0f);
+        terrain.setOctaves(6);
+        terrain.setWorldHeight(options.worldHeight);
+        terrain.setSeed(options.seed);
+        terrain.setNoiseOrigin(tileMinX - APRON, tileMinZ - APRON);
+        if (options.densityTerrain) {
+            terrain.setGenerator(TERRAIN_DENSITY);
+        }
+        for (int layer = 0; layer < TERRAIN_LAYER_COUNT; layer++) {
+            terrain.setNoiseBackend(static_cast<TerrainLayer>(layer), options.noise);
+        }
+        terrain.generate();
+        result.generateSeconds = secondsSince(start);
+
+        // Only the chunks inside the tile are meshed; the apron just feeds them neighbors
+        start = Clock::now();
+        for (const Chunk& chunk : terrain.getChunks()) {
+            int gridX = chunk.x * CHUNK_SIZE;
+            int gridZ = chunk.z * CHUNK_SIZE;
+            if (gridX < APRON || gridX >= APRON + sizeX || gridZ < APRON || gridZ >= APRON + sizeZ) {
+                continue;
+            }
+            BakedChunk baked;
+            ChunkMesher::buildMesh(terrain, chunk, baked.mesh);
+            result.chunksMeshed++;
+            if (baked.mesh.vertices.empty()) {
+                continue;
+            }
+            baked.originX = tileMinX - APRON + gridX;
+            baked.originY = chunk.y * CHUNK_SIZE;
+            baked.originZ = tileMinZ - APRON + gridZ;
+            result.chunks.push_back(std::move(baked));
+        }
+        result.meshSeconds = secondsSince(start);
+    }
+
+    bool parseOptions(int argc, char** argv, BakeOptions& options) {
+        for (int i = 1; i < argc; i++) {
+            bool hasValue = i + 1 < argc;
+            if (std::strcmp(argv[i], "--seed") == 0 && hasValue) {
+                options.seed = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+            } else if (std::strcmp(argv[i], "--min-x") == 0 && hasValue) {
+                options.minX = std::atoi(argv[++i]);
+            } else if (std::strcmp(argv[i], "--min-z") == 0 && hasValue) {
+                options.minZ = std::atoi(argv[++i]);
+            } else if (std::strcmp(argv[i], "--max-x") == 0 && hasValue) {
+                options.maxX = std::atoi(argv[++i]);
+            } else if (std::strcmp(argv[i], "--max-z") == 0 && hasValue) {
+                options.maxZ = std::atoi(argv[++i]);
+            } else if (std::strcmp(argv[i], "--tile") == 0 && hasValue) {
+                options.tileSize = std::atoi(argv[++i]);
+            } else if (std::strcmp(argv[i], "--height") == 0 && hasValue) {
+                options.worldHeight = std::atoi(argv[++i]);
+            } else if (std::strcmp(argv[i], "--threads") == 0 && hasValue) {
+                options.threads = std::atoi(argv[++i]);
+            } else if (std::strcmp(argv[i], "--caves") == 0) {
+                options.densityTerrain = true;
+            } else if (std::strcmp(argv[i], "--noise") == 0 && hasValue) {
+                options.noise = std::strcmp(argv[++i], "simplex") == 0 ? NOISE_SIMPLEX : NOISE_PERLIN;
+            } else if (std::strcmp(argv[i], "--out") == 0 && hasValue) {
+                options.chunkPath = argv[++i];
+            } else if (std::strcmp(argv[i], "--obj") == 0 && hasValue) {
+                options.objPath = argv[++i];
+            } else if (std::strcmp(argv[i], "--gltf") == 0 && hasValue) {
+                options.gltfPath = argv[++i];
+            } else {
+                std::cerr << "Usage: " << argv[0]
+                          << " [--seed N] [--min-x N] [--min-z N] [--max-x N] [--max-z N] [--tile N] [--height N]"
+                             " [--threads N] [--caves] [--noise perlin|simplex] [--out FILE] [--obj FILE]"
+                             " [--gltf FILE]" << std::endl;
+                return false;
+            }
+        }
+
+        // Tiles and bounds on chunk boundaries keep every chunk whole and the density lattice aligned
+        options.tileSize = std::max(CHUNK_SIZE, options.tileSize / CHUNK_SIZE * CHUNK_SIZE);
+        options.minX = floorToChunk(options.minX);
+        options.minZ = floorToChunk(options.minZ);
+        options.maxX = -floorToChunk(-options.maxX);
+        options.maxZ = -floorToChunk(-options.maxZ);
+        options.worldHeight = std::min(std::max(options.worldHeight, 1), 256);
+        if (options.maxX <= options.minX || options.maxZ <= options.minZ) {
+            std::cerr << "Empty bake region" << std::endl;
+            return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    BakeOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        return -1;
+    }
+
+    BakeHeader header;
+    header.seed = options.seed;
+    header.minX = options.minX;
+    header.minZ = options.minZ;
+    header.maxX = options.maxX;
+    header.maxZ = options.maxZ;
+    header.worldHeight = static_cast<uint16_t>(options.worldHeight);
+    BakedWorldWriter writer;
+    if (!writer.open(options.chunkPath, options.objPath, options.gltfPath, header)) {
+        return 1;
+    }
+
+    int tilesX = (options.maxX - options.minX + options.tileSize - 1) / options.tileSize;
+    int tilesZ = (options.maxZ - options.minZ + options.tileSize - 1) / options.tileSize;
+    int tileCount = tilesX * tilesZ;
+
+    // The calling thread takes part in parallelFor, so it counts as one of the threads
+    JobSystem jobs(options.threads > 1 ? options.threads - 1 : 0);
+    unsigned int threadCount = options.threads == 1 ? 1 : jobs.getConcurrency();
+    std::printf("Baking [%d, %d) x [%d, %d), height %d, seed %u: %d tiles of %d blocks on %u threads\n",
+                options.minX, options.maxX, options.minZ, options.maxZ, options.worldHeight, options.seed, tileCount,
+                options.tileSize, threadCount);
+
+    // Tiles are baked a wave at a time and written in order, so memory holds at
+    // most one wave of meshes however large the region is
+    int waveSize = static_cast<int>(threadCount) * 2;
+    std::vector<TileResult> wave(waveSize);
+    int chunksMeshed = 0;
+    double generateSeconds = 0.0, meshSeconds = 0.0, writeSeconds = 0.0;
+    bool ok = true;
+
+    Clock::time_point start = Clock::now();
+    for (int first = 0; first < tileCount && ok; first += waveSize) {
+        int count = std::min(waveSize, tileCount - first);
+        // One batch of the whole wave runs on this thread alone
+        jobs.parallelFor(count, threadCount == 1 ? count : 1, [&](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                int tile = first + i;
+                wave[i] = TileResult();
+                bakeTile(options, options.minX + (tile % tilesX) * options.tileSize,
+                         options.minZ + (tile / tilesX) * options.tileSize, wave[i]);
+            }
+        });
+
+        Clock::time_point writeStart = Clock::now();
+        for (int i = 0; i < count && ok; i++) {
+            TileResult& result = wave[i];
+            for (const BakedChunk& chunk : result.chunks) {
+                ok = ok && writer.writeChunk(chunk.originX, chunk.originY, chunk.originZ, chunk.mesh);
+            }
+            chunksMeshed += result.chunksMeshed;
+            generateSeconds += result.generateSeconds;
+            meshSeconds += result.meshSeconds;
+            result = TileResult();
+        }
+        writeSeconds += secondsSince(writeStart);
+
+        std::printf("\r%d / %d tiles", std::min(first + count, tileCount), tileCount);
+        std::fflush(stdout);
+    }
+    ok = writer.close() && ok;
+    double totalSeconds = secondsSince(start);
+    std::printf("\n");
+
+    std::printf("%d chunks (%d with geometry) in %.2f s: %.0f chunks/s\n", chunksMeshed, writer.getChunksWritten(),
+                totalSeconds, chunksMeshed / std::max(totalSeconds, 1.0e-9));
+    std::printf("thread time: generate + light %.2f s, mesh %.2f s (%.0f chunks/s per thread); write %.2f s\n",
+                generateSeconds, meshSeconds, chunksMeshed / std::max(generateSeconds + meshSeconds, 1.0e-9),
+                writeSeconds);
+    if (writer.getBytesWritten() > 0) {
+        std::printf("wrote %.1f MB\n", writer.getBytesWritten() / (1024.0 * 1024.0));
+    }
+    return ok ? 0 : 1;
+}